@@ -157,6 +157,13 @@ if (Sqxc_FOUND)
 		message(STATUS "PostgreSQL libraries: ${PostgreSQL_LIBRARIES}")
 	endif (PostgreSQL_FOUND)
 
+	# --- Threads --- SqThread, SqdbPool
+	find_package(Threads)
+	set(Sqxc_LIBRARIES
+	    ${Sqxc_LIBRARIES}
+	    ${CMAKE_THREAD_LIBS_INIT}
+	)
+
 	# --- cJSON ---
 	find_package(cJSON)
 	if (cJSON_FOUND)
@@ -153,6 +153,42 @@
 /* SqxcSql.c */
 #define SQ_CONFIG_SQXC_SQL_BUFFER_SIZE_DEAULT    256
 
+/* SqxcSql.c - SqxcSql sends COPY data to Sqdb when it has buffered this size of data. */
+#define SQ_CONFIG_SQXC_SQL_COPY_SIZE           65536
+
+/* SqxcSql.c - SqxcSql splits INSERT with multiple rows when statement has this number of rows or this size of data.
+   They keep statement below SQLite SQLITE_MAX_SQL_LENGTH and MySQL max_allowed_packet by default.
+ */
+#define SQ_CONFIG_SQXC_SQL_INSERT_ROWS           500
+#define SQ_CONFIG_SQXC_SQL_INSERT_SIZE        (512 * 1024)
+
+/* SqxcSql.c - SqxcSql splits UPDATE with multiple rows when statement has this number of rows.
+   Database compares primary key with every WHEN of CASE expression, statement with fewer rows runs faster.
+   It is also split by SQ_CONFIG_SQXC_SQL_INSERT_SIZE.
+ */
+#define SQ_CONFIG_SQXC_SQL_UPDATE_ROWS           200
+
+/* SqStorage.c - sq_storage_get_many() and sq_storage_remove_many() split list of ids when statement has this number of ids. */
+#define SQ_CONFIG_STORAGE_MANY_KEYS              500
+
+/* SqdbStmtCache.c, SqdbSqlite.c, SqdbMysql.c, SqdbPostgre.c
+   Number of prepared statements cached per connection if SqdbConfig doesn't specify it.
+ */
+#define SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT    32
+
+/* SqdbPool.c - max number of connections if SqdbPoolConfig doesn't specify it. */
+#define SQ_CONFIG_SQDB_POOL_SIZE_DEFAULT          16
+
+/* SqIdentityMap.c, SqStorage.c - max number of instances cached by SqIdentityMap if capacity is 0. */
+#define SQ_CONFIG_IDENTITY_MAP_SIZE_DEFAULT     1024
+
+/* SqRowCache.c - memory (bytes) and number of shards of SqRowCache if they are 0 in SqRowCacheConfig. */
+#define SQ_CONFIG_ROW_CACHE_BYTES_DEFAULT      (16 * 1024 * 1024)
+#define SQ_CONFIG_ROW_CACHE_SHARDS_DEFAULT       16
+
+/* SqQueryCache.c - memory (bytes) of SqQueryCache if SqQueryCacheConfig::max_bytes is 0. */
+#define SQ_CONFIG_QUERY_CACHE_BYTES_DEFAULT    (4 * 1024 * 1024)
+
 /* SqType-array.c - SQ_TYPE_ARRAY_SIZE_DEFAULT */
 #define SQ_CONFIG_TYPE_ARRAY_SIZE_DEFAULT         16
 
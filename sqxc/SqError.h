@@ -50,6 +50,10 @@ extern "C" {
 #define SQCODE_OPEN_FAILED           (51  + SQCODE_ERROR)
 #define SQCODE_EXEC_ERROR            (52  + SQCODE_ERROR)
 #define SQCODE_NO_DATA               (53  + SQCODE_ERROR)    // if the result set is empty.
+#define SQCODE_ROW                   (54  + SQCODE_STATUS)   // sqdb_step() has another row ready
+#define SQCODE_DONE                  (55  + SQCODE_STATUS)   // sqdb_step() has finished executing
+#define SQCODE_TIMEOUT               (56  + SQCODE_ERROR)    // SqdbPool: no connection is available before timeout
+#define SQCODE_AGAIN                 (57  + SQCODE_STATUS)   // sqdb_async_poll(): statement is still in progress
 
 // JSON
 #define SQCODE_JSON_CONTINUE         (61  + SQCODE_STATUS)
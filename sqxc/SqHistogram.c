@@ -0,0 +1,105 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#include <string.h>            // memset()
+
+#include <sqxc/SqHistogram.h>
+
+#define SUB_BUCKETS    (1 << SQ_HISTOGRAM_SUB_BITS)
+
+// index of bucket that counts 'value'
+static int  histogram_index(uint64_t value)
+{
+	int   shift = 0;
+
+	if (value >= ((uint64_t)1 << SQ_HISTOGRAM_VALUE_BITS))
+		return SQ_HISTOGRAM_N_BUCKETS - 1;
+	// values less than (2 * SUB_BUCKETS) have their own bucket
+	while ((value >> shift) >= 2 * SUB_BUCKETS)
+		shift++;
+	return (shift << SQ_HISTOGRAM_SUB_BITS) + (int)(value >> shift);
+}
+
+// the highest value that is counted in bucket 'index'
+static uint64_t  histogram_value(int index)
+{
+	int   shift;
+
+	if (index < 2 * SUB_BUCKETS)
+		return (uint64_t)index;
+	shift = (index >> SQ_HISTOGRAM_SUB_BITS) - 1;
+	index = (index & (SUB_BUCKETS - 1)) + SUB_BUCKETS;
+	return (((uint64_t)index + 1) << shift) - 1;
+}
+
+void  sq_histogram_init(SqHistogram *histogram)
+{
+	memset(histogram, 0, sizeof(SqHistogram));
+}
+
+void  sq_histogram_record(SqHistogram *histogram, uint64_t value)
+{
+	if (histogram->count == 0 || histogram->min > value)
+		histogram->min = value;
+	if (histogram->max < value)
+		histogram->max = value;
+	histogram->count++;
+	histogram->sum += value;
+	histogram->buckets[histogram_index(value)]++;
+}
+
+void  sq_histogram_merge(SqHistogram *dest, const SqHistogram *src)
+{
+	if (src->count == 0)
+		return;
+	if (dest->count == 0 || dest->min > src->min)
+		dest->min = src->min;
+	if (dest->max < src->max)
+		dest->max = src->max;
+	dest->count += src->count;
+	dest->sum   += src->sum;
+	for (int index = 0;  index < SQ_HISTOGRAM_N_BUCKETS;  index++)
+		dest->buckets[index] += src->buckets[index];
+}
+
+uint64_t  sq_histogram_percentile(const SqHistogram *histogram, double percentile)
+{
+	uint64_t  target;
+	uint64_t  total = 0;
+	uint64_t  value;
+
+	if (histogram->count == 0)
+		return 0;
+	if (percentile >= 100.0)
+		return histogram->max;
+
+	target = (uint64_t)(percentile / 100.0 * (double)histogram->count + 0.5);
+	if (target == 0)
+		target = 1;
+	for (int index = 0;  index < SQ_HISTOGRAM_N_BUCKETS;  index++) {
+		total += histogram->buckets[index];
+		if (total >= target) {
+			value = histogram_value(index);
+			return (value > histogram->max) ? histogram->max : value;
+		}
+	}
+	return histogram->max;
+}
+
+double  sq_histogram_mean(const SqHistogram *histogram)
+{
+	if (histogram->count == 0)
+		return 0.0;
+	return (double)histogram->sum / (double)histogram->count;
+}
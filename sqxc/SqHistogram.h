@@ -0,0 +1,110 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqHistogram - histogram of latency that has fixed relative precision. (like HdrHistogram)
+
+	Values are counted in log-linear buckets. Each power of 2 is divided into 32 sub-buckets,
+	so relative error of percentile is less than 1/32 (about 3%). Values >= 2^40 are counted in the last bucket.
+	SqHistogram is not thread safe. It doesn't allocate memory, it can be copied by assignment.
+ */
+
+#ifndef SQ_HISTOGRAM_H
+#define SQ_HISTOGRAM_H
+
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqHistogram    SqHistogram;
+
+#define SQ_HISTOGRAM_SUB_BITS       5           // 32 sub-buckets
+#define SQ_HISTOGRAM_VALUE_BITS     40          // max value is (2^40 - 1)
+#define SQ_HISTOGRAM_N_BUCKETS      ((SQ_HISTOGRAM_VALUE_BITS - SQ_HISTOGRAM_SUB_BITS + 1) << SQ_HISTOGRAM_SUB_BITS)
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void      sq_histogram_init(SqHistogram *histogram);
+
+// count 'value' (e.g. microseconds)
+void      sq_histogram_record(SqHistogram *histogram, uint64_t value);
+
+// add counts of 'src' to 'dest'
+void      sq_histogram_merge(SqHistogram *dest, const SqHistogram *src);
+
+// return value at 'percentile' (0 ~ 100). e.g. 50, 99, 99.9
+// It returns the highest value that is equivalent to bucket (but not more than 'max'). return 0 if histogram is empty.
+uint64_t  sq_histogram_percentile(const SqHistogram *histogram, double percentile);
+
+// return mean of recorded values
+double    sq_histogram_mean(const SqHistogram *histogram);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+struct SqHistogram
+{
+	uint64_t  count;           // number of recorded values
+	uint64_t  min;
+	uint64_t  max;
+	uint64_t  sum;
+
+	uint64_t  buckets[SQ_HISTOGRAM_N_BUCKETS];
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+struct Histogram : SqHistogram
+{
+	// constructor
+	Histogram() {
+		sq_histogram_init((SqHistogram*)this);
+	}
+
+	void      record(uint64_t value) {
+		sq_histogram_record((SqHistogram*)this, value);
+	}
+	void      merge(const SqHistogram *src) {
+		sq_histogram_merge((SqHistogram*)this, src);
+	}
+	uint64_t  percentile(double percentile) const {
+		return sq_histogram_percentile((const SqHistogram*)this, percentile);
+	}
+	double    mean() const {
+		return sq_histogram_mean((const SqHistogram*)this);
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQ_HISTOGRAM_H
@@ -0,0 +1,181 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqxc/SqConfig.h>
+#include <sqxc/SqIdentityMap.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+typedef struct MapEntry    MapEntry;
+typedef struct MapKey      MapKey;
+
+struct MapEntry
+{
+	char          *table_name;
+	int64_t        id;
+	const SqType  *type;
+	void          *instance;
+	uint64_t       last_used;
+};
+
+struct MapKey
+{
+	const char    *table_name;
+	int64_t        id;
+};
+
+static void  map_entry_free(MapEntry *entry)
+{
+	sq_type_final_instance(entry->type, entry->instance, false);
+	free(entry->instance);
+	free(entry->table_name);
+	free(entry);
+}
+
+static int   map_entry_cmp_key(const void *key, const void *entryAddr)
+{
+	const MapKey   *mkey  = (const MapKey*)key;
+	const MapEntry *entry = *(MapEntry**)entryAddr;
+	int   result;
+
+	result = strcmp(mkey->table_name, entry->table_name);
+	if (result != 0)
+		return result;
+	return (mkey->id > entry->id) - (mkey->id < entry->id);
+}
+
+void  sq_identity_map_init(SqIdentityMap *map, int capacity)
+{
+	if (capacity == 0)
+		capacity = SQ_CONFIG_IDENTITY_MAP_SIZE_DEFAULT;
+	else if (capacity < 0)
+		capacity = 0;
+
+	sq_ptr_array_init(&map->entries, 8, NULL);
+	map->capacity = capacity;
+	map->tick = 0;
+	map->hits = 0;
+	map->misses = 0;
+	map->evictions = 0;
+}
+
+void  sq_identity_map_final(SqIdentityMap *map)
+{
+	sq_identity_map_clear(map, NULL);
+	sq_ptr_array_final(&map->entries);
+}
+
+void *sq_identity_map_find(SqIdentityMap *map, const char *table_name, int64_t id, const SqType *type)
+{
+	MapEntry **addr;
+	MapKey     key = {table_name, id};
+
+	if (map->capacity == 0)
+		return NULL;
+
+	addr = (MapEntry**)sq_ptr_array_search(&map->entries, &key, map_entry_cmp_key);
+	if (addr == NULL || (type && (*addr)->type != type)) {
+		map->misses++;
+		return NULL;
+	}
+	map->hits++;
+	(*addr)->last_used = ++map->tick;
+	return (*addr)->instance;
+}
+
+bool  sq_identity_map_add(SqIdentityMap *map, const char *table_name, int64_t id,
+                          const SqType *type, void *instance)
+{
+	MapEntry   *entry;
+	MapEntry  **addr;
+	MapKey      key = {table_name, id};
+	unsigned int  index;
+	unsigned int  lru_index = 0;
+
+	if (map->capacity == 0)
+		return false;
+
+	// replace existing instance
+	addr = (MapEntry**)sq_ptr_array_find_sorted(&map->entries, &key,
+	                                            map_entry_cmp_key, &index);
+	if (addr) {
+		entry = *addr;
+		sq_type_final_instance(entry->type, entry->instance, false);
+		free(entry->instance);
+		entry->type = type;
+		entry->instance = instance;
+		entry->last_used = ++map->tick;
+		return true;
+	}
+
+	if (map->entries.length >= map->capacity) {
+		// evict the least recently used instance
+		for (unsigned int i = 1;  i < map->entries.length;  i++) {
+			entry = (MapEntry*)map->entries.data[i];
+			if (((MapEntry*)map->entries.data[lru_index])->last_used > entry->last_used)
+				lru_index = i;
+		}
+		map_entry_free((MapEntry*)map->entries.data[lru_index]);
+		sq_ptr_array_erase(&map->entries, lru_index, 1);
+		map->evictions++;
+		if (index > lru_index)
+			index--;
+	}
+
+	entry = malloc(sizeof(MapEntry));
+	entry->table_name = strdup(table_name);
+	entry->id = id;
+	entry->type = type;
+	entry->instance = instance;
+	entry->last_used = ++map->tick;
+	sq_ptr_array_push_in(&map->entries, index, entry);
+	return true;
+}
+
+void  sq_identity_map_remove(SqIdentityMap *map, const char *table_name, int64_t id)
+{
+	MapEntry **addr;
+	MapKey     key = {table_name, id};
+
+	addr = (MapEntry**)sq_ptr_array_search(&map->entries, &key, map_entry_cmp_key);
+	if (addr) {
+		map_entry_free(*addr);
+		sq_ptr_array_erase_addr(&map->entries, addr, 1);
+	}
+}
+
+void  sq_identity_map_clear(SqIdentityMap *map, const char *table_name)
+{
+	MapEntry     *entry;
+	unsigned int  count = 0;
+
+	// keep entries of other tables. Their order is not changed.
+	for (unsigned int index = 0;  index < map->entries.length;  index++) {
+		entry = (MapEntry*)map->entries.data[index];
+		if (table_name && strcmp(table_name, entry->table_name) != 0) {
+			map->entries.data[count++] = entry;
+			continue;
+		}
+		map_entry_free(entry);
+	}
+	map->entries.length = count;
+}
@@ -0,0 +1,97 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqIdentityMap - LRU cache of instances keyed by table name and primary key.
+	                SqStorage use it to avoid querying the same row repeatedly.
+
+	Instances in map are owned by map. They are freed when they are evicted, removed, or cleared.
+	SqIdentityMap is not thread-safe, caller must lock it if it is shared between threads.
+ */
+
+#ifndef SQ_IDENTITY_MAP_H
+#define SQ_IDENTITY_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sqxc/SqPtrArray.h>
+#include <sqxc/SqType.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqIdentityMap    SqIdentityMap;
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// if 'capacity' is 0, use SQ_CONFIG_IDENTITY_MAP_SIZE_DEFAULT. if 'capacity' is negative, map is disabled.
+void   sq_identity_map_init(SqIdentityMap *map, int capacity);
+void   sq_identity_map_final(SqIdentityMap *map);
+
+// find instance by table name and primary key. return NULL if not found or instance is not 'type'.
+// If 'type' is NULL, type of instance is not checked. returned instance is still owned by map.
+void  *sq_identity_map_find(SqIdentityMap *map, const char *table_name, int64_t id, const SqType *type);
+
+// add or replace instance of 'type'. map takes ownership of 'instance'.
+// It may evict the least recently used instance.
+// return false if instance can't be added. In this case, caller own 'instance'.
+bool   sq_identity_map_add(SqIdentityMap *map, const char *table_name, int64_t id,
+                           const SqType *type, void *instance);
+
+// remove and free instance that has the primary key in table.
+void   sq_identity_map_remove(SqIdentityMap *map, const char *table_name, int64_t id);
+
+// remove and free all instances of table. If 'table_name' is NULL, remove all instances in map.
+void   sq_identity_map_clear(SqIdentityMap *map, const char *table_name);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+struct SqIdentityMap
+{
+	SqPtrArray    entries;      // sorted by table name and primary key
+
+	unsigned int  capacity;     // max number of cached instances. 0 = disabled
+	uint64_t      tick;         // increased each time an instance is used
+
+	// --- statistics ---
+	uint64_t      hits;
+	uint64_t      misses;
+	uint64_t      evictions;
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+typedef struct SqIdentityMap    IdentityMap;
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQ_IDENTITY_MAP_H
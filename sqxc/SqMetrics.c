@@ -0,0 +1,179 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>          // PRIu64
+
+#include <sqxc/SqMetrics.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+typedef struct MetricsKey      MetricsKey;
+
+struct MetricsKey
+{
+	const char    *table_name;
+	int            operation;
+};
+
+static const char *metrics_operation_names[SQ_METRICS_N_OPERATIONS] = {
+	"get", "get_all", "insert", "update", "remove", "query", "get_many",
+};
+
+static int   metrics_entry_cmp_key(const void *key, const void *entryAddr)
+{
+	const MetricsKey     *mkey  = (const MetricsKey*)key;
+	const SqMetricsEntry *entry = *(SqMetricsEntry**)entryAddr;
+	int   result;
+
+	result = strcmp(mkey->table_name, entry->table_name);
+	if (result != 0)
+		return result;
+	return mkey->operation - entry->operation;
+}
+
+static void  metrics_entry_free(SqMetricsEntry *entry)
+{
+	free(entry->table_name);
+	free(entry);
+}
+
+SqMetrics *sq_metrics_new(void)
+{
+	SqMetrics *metrics;
+
+	metrics = malloc(sizeof(SqMetrics));
+	sq_metrics_init(metrics);
+	return metrics;
+}
+
+void  sq_metrics_free(SqMetrics *metrics)
+{
+	sq_metrics_final(metrics);
+	free(metrics);
+}
+
+void  sq_metrics_init(SqMetrics *metrics)
+{
+	sq_mutex_init(&metrics->mutex);
+	sq_ptr_array_init(&metrics->entries, 16, (SqClearFunc)metrics_entry_free);
+	metrics->slow_threshold = 0;
+	metrics->slow_func = NULL;
+	metrics->slow_data = NULL;
+}
+
+void  sq_metrics_final(SqMetrics *metrics)
+{
+	sq_ptr_array_final(&metrics->entries);
+	sq_mutex_final(&metrics->mutex);
+}
+
+void  sq_metrics_set_slow_log(SqMetrics *metrics, uint64_t threshold, SqMetricsSlowFunc func, void *data)
+{
+	metrics->slow_threshold = (func) ? threshold : 0;
+	metrics->slow_func = func;
+	metrics->slow_data = data;
+}
+
+void  sq_metrics_write_slow_log(void *data, const SqMetricsSlow *slow)
+{
+	fprintf((FILE*)data, "slow query: %" PRIu64 " us, %s %s, code %d: %s%s%s\n",
+	        slow->time,
+	        sq_metrics_operation_name(slow->operation),
+	        (slow->table_name) ? slow->table_name : "-",
+	        slow->code,
+	        (slow->sql) ? slow->sql : "",
+	        (slow->params) ? " -- " : "",
+	        (slow->params) ? slow->params : "");
+}
+
+void  sq_metrics_record(SqMetrics *metrics, const char *table_name, int operation, uint64_t time)
+{
+	SqMetricsEntry  *entry;
+	SqMetricsEntry **addr;
+	MetricsKey       key = {table_name, operation};
+	unsigned int     index;
+
+	if (operation < 0 || operation >= SQ_METRICS_N_OPERATIONS)
+		return;
+	if (table_name == NULL)
+		table_name = "";
+
+	sq_mutex_lock(&metrics->mutex);
+	addr = (SqMetricsEntry**)sq_ptr_array_find_sorted(&metrics->entries, &key,
+	                                                  metrics_entry_cmp_key, &index);
+	if (addr)
+		entry = *addr;
+	else {
+		entry = malloc(sizeof(SqMetricsEntry));
+		entry->table_name = strdup(table_name);
+		entry->operation = operation;
+		sq_histogram_init(&entry->histogram);
+		sq_ptr_array_push_in(&metrics->entries, index, entry);
+	}
+	sq_histogram_record(&entry->histogram, time);
+	sq_mutex_unlock(&metrics->mutex);
+}
+
+void  sq_metrics_slow(SqMetrics *metrics, const SqMetricsSlow *slow)
+{
+	SqMetricsSlowFunc  func = metrics->slow_func;
+
+	if (func)
+		func(metrics->slow_data, slow);
+}
+
+SqMetricsEntry *sq_metrics_snapshot(SqMetrics *metrics, int *n_entries)
+{
+	SqMetricsEntry *entries;
+	SqMetricsEntry *entry;
+
+	sq_mutex_lock(&metrics->mutex);
+	*n_entries = metrics->entries.length;
+	entries = malloc(sizeof(SqMetricsEntry) * (metrics->entries.length + 1));
+	for (unsigned int index = 0;  index < metrics->entries.length;  index++) {
+		entry = metrics->entries.data[index];
+		entries[index] = *entry;
+		entries[index].table_name = strdup(entry->table_name);
+	}
+	sq_mutex_unlock(&metrics->mutex);
+	return entries;
+}
+
+void  sq_metrics_free_snapshot(SqMetricsEntry *entries, int n_entries)
+{
+	for (int index = 0;  index < n_entries;  index++)
+		free(entries[index].table_name);
+	free(entries);
+}
+
+void  sq_metrics_reset(SqMetrics *metrics)
+{
+	sq_mutex_lock(&metrics->mutex);
+	sq_ptr_array_erase(&metrics->entries, 0, metrics->entries.length);
+	sq_mutex_unlock(&metrics->mutex);
+}
+
+const char *sq_metrics_operation_name(int operation)
+{
+	if (operation < 0 || operation >= SQ_METRICS_N_OPERATIONS)
+		return "none";
+	return metrics_operation_names[operation];
+}
@@ -0,0 +1,184 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqMetrics - thread-safe latency histograms and slow-query log that can be shared by multiple SqStorage.
+
+	SqStorage records execution time of statements to SqHistogram per table and per operation
+	(get, get_all, insert, update, remove, query). Statements that take longer than threshold are passed
+	to slow-query log with their bound values. Program can take snapshot of histograms at any time.
+ */
+
+#ifndef SQ_METRICS_H
+#define SQ_METRICS_H
+
+#include <stdio.h>             // FILE
+#include <stdint.h>
+
+#include <sqxc/SqThread.h>
+#include <sqxc/SqPtrArray.h>
+#include <sqxc/SqHistogram.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqMetrics          SqMetrics;
+typedef struct SqMetricsEntry     SqMetricsEntry;
+typedef struct SqMetricsSlow      SqMetricsSlow;
+
+/* --- operation of SqStorage --- */
+#define SQ_METRICS_NONE           (-1)     // statement that doesn't belong to operation (e.g. BEGIN, COMMIT)
+#define SQ_METRICS_GET              0
+#define SQ_METRICS_GET_ALL          1
+#define SQ_METRICS_INSERT           2
+#define SQ_METRICS_UPDATE           3
+#define SQ_METRICS_REMOVE           4
+#define SQ_METRICS_QUERY            5
+#define SQ_METRICS_GET_MANY         6      // sq_storage_get_many() finds rows by keys
+#define SQ_METRICS_N_OPERATIONS     7
+
+// slow-query log. It is called without locking SqMetrics.
+typedef void (*SqMetricsSlowFunc)(void *data, const SqMetricsSlow *slow);
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SqMetrics  *sq_metrics_new(void);
+void        sq_metrics_free(SqMetrics *metrics);
+
+void        sq_metrics_init(SqMetrics *metrics);
+void        sq_metrics_final(SqMetrics *metrics);
+
+// set slow-query log. Statements that take 'threshold' microseconds or more are passed to 'func'.
+// If 'threshold' is 0, slow-query log is disabled. Call this before SqMetrics is shared by threads.
+void        sq_metrics_set_slow_log(SqMetrics *metrics, uint64_t threshold, SqMetricsSlowFunc func, void *data);
+
+// SqMetricsSlowFunc that writes a line to FILE. 'data' is pointer to FILE. e.g.
+// sq_metrics_set_slow_log(metrics, 100000, sq_metrics_write_slow_log, stderr);
+void        sq_metrics_write_slow_log(void *data, const SqMetricsSlow *slow);
+
+// add 'time' (microseconds) to histogram of 'table_name' and 'operation'.
+// If 'table_name' is NULL (e.g. sq_storage_query_raw()), it is recorded as empty string.
+void        sq_metrics_record(SqMetrics *metrics, const char *table_name, int operation, uint64_t time);
+
+// pass 'slow' to slow-query log
+void        sq_metrics_slow(SqMetrics *metrics, const SqMetricsSlow *slow);
+
+// bool     sq_metrics_is_slow(SqMetrics *metrics, uint64_t time);
+#define sq_metrics_is_slow(metrics, time)    \
+		((metrics)->slow_threshold > 0 && (time) >= (metrics)->slow_threshold)
+
+// return copy of all histograms. They are sorted by table name and operation.
+// Caller must free it by sq_metrics_free_snapshot().
+SqMetricsEntry *sq_metrics_snapshot(SqMetrics *metrics, int *n_entries);
+void        sq_metrics_free_snapshot(SqMetricsEntry *entries, int n_entries);
+
+// remove all histograms
+void        sq_metrics_reset(SqMetrics *metrics);
+
+// return name of operation. e.g. "get", "get_all"
+const char *sq_metrics_operation_name(int operation);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqMetricsEntry - histogram of a table and an operation
+ */
+struct SqMetricsEntry
+{
+	char         *table_name;
+	int           operation;      // SQ_METRICS_GET, SQ_METRICS_GET_ALL...etc
+	SqHistogram   histogram;      // microseconds
+};
+
+/*	SqMetricsSlow - statement that is passed to slow-query log
+ */
+struct SqMetricsSlow
+{
+	const char   *table_name;     // It can be NULL if 'operation' is SQ_METRICS_NONE.
+	int           operation;
+	const char   *sql;            // It can be NULL.
+	const char   *params;         // bound values of prepared statement, e.g. "?1=15". It is NULL if there is no bound value.
+	int           code;           // result code (SQCODE_xxxx)
+	uint64_t      time;           // microseconds
+};
+
+/*	SqMetrics - thread-safe latency histograms and slow-query log
+
+	'entries' is protected by 'mutex'. Don't access it directly, use sq_metrics_snapshot().
+ */
+
+struct SqMetrics
+{
+	SqMutex            mutex;
+	SqPtrArray         entries;            // sorted by table name and operation
+
+	uint64_t           slow_threshold;     // microseconds. 0 = slow-query log is disabled
+	SqMetricsSlowFunc  slow_func;
+	void              *slow_data;
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+typedef struct SqMetricsEntry     MetricsEntry;
+typedef struct SqMetricsSlow      MetricsSlow;
+
+struct Metrics : SqMetrics
+{
+	// constructor
+	Metrics() {
+		sq_metrics_init((SqMetrics*)this);
+	}
+	// destructor
+	~Metrics() {
+		sq_metrics_final((SqMetrics*)this);
+	}
+
+	void  setSlowLog(uint64_t threshold, SqMetricsSlowFunc func, void *data = NULL) {
+		sq_metrics_set_slow_log((SqMetrics*)this, threshold, func, data);
+	}
+	void  record(const char *tableName, int operation, uint64_t time) {
+		sq_metrics_record((SqMetrics*)this, tableName, operation, time);
+	}
+	SqMetricsEntry *snapshot(int *nEntries) {
+		return sq_metrics_snapshot((SqMetrics*)this, nEntries);
+	}
+	void  freeSnapshot(SqMetricsEntry *entries, int nEntries) {
+		sq_metrics_free_snapshot(entries, nEntries);
+	}
+	void  reset() {
+		sq_metrics_reset((SqMetrics*)this);
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQ_METRICS_H
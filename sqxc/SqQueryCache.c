@@ -0,0 +1,286 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqxc/SqQueryCache.h>
+#include <sqxc/SqxcRecord.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+typedef struct ResultEntry     ResultEntry;
+typedef struct ResultKey       ResultKey;
+
+struct ResultEntry
+{
+	char          *sql;
+	const SqType  *type;
+	const SqType  *container_type;
+	char         **tables;       // names of tables that are used by 'sql'
+	int            n_tables;
+
+	char          *data;         // recorded by SqxcRecord
+	size_t         length;
+	size_t         n_bytes;      // memory that is counted in SqQueryCacheStats::n_bytes
+	uint64_t       expire;       // sq_clock_msec() when result expires. 0 = never
+
+	ResultEntry   *prev;         // LRU list
+	ResultEntry   *next;
+};
+
+struct ResultKey
+{
+	const char    *sql;
+	const SqType  *type;
+	const SqType  *container_type;
+};
+
+static int   result_entry_cmp_key(const void *key, const void *entryAddr)
+{
+	const ResultKey   *rkey  = (const ResultKey*)key;
+	const ResultEntry *entry = *(ResultEntry**)entryAddr;
+	int   result;
+
+	result = strcmp(rkey->sql, entry->sql);
+	if (result != 0)
+		return result;
+	if (rkey->type != entry->type)
+		return ((uintptr_t)rkey->type > (uintptr_t)entry->type) ? 1 : -1;
+	if (rkey->container_type != entry->container_type)
+		return ((uintptr_t)rkey->container_type > (uintptr_t)entry->container_type) ? 1 : -1;
+	return 0;
+}
+
+static void  query_cache_unlink(SqQueryCache *cache, ResultEntry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		cache->lru_head = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		cache->lru_tail = entry->prev;
+	entry->prev = NULL;
+	entry->next = NULL;
+}
+
+static void  query_cache_link_head(SqQueryCache *cache, ResultEntry *entry)
+{
+	entry->prev = NULL;
+	entry->next = cache->lru_head;
+	if (cache->lru_head)
+		((ResultEntry*)cache->lru_head)->prev = entry;
+	else
+		cache->lru_tail = entry;
+	cache->lru_head = entry;
+}
+
+// remove entry from cache and free it
+static void  query_cache_erase(SqQueryCache *cache, ResultEntry **addr)
+{
+	ResultEntry *entry = *addr;
+
+	query_cache_unlink(cache, entry);
+	cache->stats.n_bytes -= entry->n_bytes;
+	cache->stats.n_results--;
+	sq_ptr_array_erase_addr(&cache->entries, addr, 1);
+
+	for (int index = 0;  index < entry->n_tables;  index++)
+		free(entry->tables[index]);
+	free(entry->tables);
+	free(entry->sql);
+	free(entry->data);
+	free(entry);
+}
+
+static bool  result_entry_use_table(ResultEntry *entry, const char *table_name)
+{
+	for (int index = 0;  index < entry->n_tables;  index++) {
+		if (strcmp(entry->tables[index], table_name) == 0)
+			return true;
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------------
+// SqQueryCache functions
+
+SqQueryCache *sq_query_cache_new(const SqQueryCacheConfig *config)
+{
+	SqQueryCache *cache;
+
+	cache = malloc(sizeof(SqQueryCache));
+	sq_query_cache_init(cache, config);
+	return cache;
+}
+
+void  sq_query_cache_free(SqQueryCache *cache)
+{
+	sq_query_cache_final(cache);
+	free(cache);
+}
+
+void  sq_query_cache_init(SqQueryCache *cache, const SqQueryCacheConfig *config)
+{
+	if (config)
+		cache->setting = *config;
+	else
+		memset(&cache->setting, 0, sizeof(SqQueryCacheConfig));
+	if (cache->setting.max_bytes == 0)
+		cache->setting.max_bytes = SQ_CONFIG_QUERY_CACHE_BYTES_DEFAULT;
+
+	sq_mutex_init(&cache->mutex);
+	sq_ptr_array_init(&cache->entries, 16, NULL);
+	cache->lru_head = NULL;
+	cache->lru_tail = NULL;
+	cache->version = 0;
+	memset(&cache->stats, 0, sizeof(SqQueryCacheStats));
+}
+
+void  sq_query_cache_final(SqQueryCache *cache)
+{
+	while (cache->entries.length > 0)
+		query_cache_erase(cache, (ResultEntry**)cache->entries.data + cache->entries.length - 1);
+	sq_ptr_array_final(&cache->entries);
+	sq_mutex_final(&cache->mutex);
+}
+
+void *sq_query_cache_get(SqQueryCache *cache, const char *sql,
+                         const SqType *type, const SqType *container_type, uint64_t *version)
+{
+	ResultEntry **addr;
+	ResultKey     key = {sql, type, container_type};
+	void         *result = NULL;
+
+	sq_mutex_lock(&cache->mutex);
+	addr = (ResultEntry**)sq_ptr_array_search(&cache->entries, &key, result_entry_cmp_key);
+	if (addr && (*addr)->expire && (*addr)->expire <= sq_clock_msec()) {
+		query_cache_erase(cache, addr);
+		cache->stats.expirations++;
+		addr = NULL;
+	}
+	if (addr) {
+		result = sqxc_record_parse_instance((*addr)->data, (*addr)->length, type, container_type);
+		if (result) {
+			query_cache_unlink(cache, *addr);
+			query_cache_link_head(cache, *addr);
+		}
+	}
+	if (result)
+		cache->stats.hits++;
+	else {
+		cache->stats.misses++;
+		// version must be got before result is queried
+		*version = cache->version;
+	}
+	sq_mutex_unlock(&cache->mutex);
+	return result;
+}
+
+void  sq_query_cache_put(SqQueryCache *cache, const char *sql,
+                         const SqType *type, const SqType *container_type, void *result,
+                         const char **table_names, int n_tables, uint64_t version)
+{
+	ResultEntry  *entry;
+	ResultEntry **addr;
+	ResultKey     key = {sql, type, container_type};
+	char         *data;
+	size_t        length;
+	unsigned int  index;
+
+	// SqTypeJoint and other types that can't write instance are not cached
+	if (result == NULL || type->write == NULL || (container_type && container_type->write == NULL))
+		return;
+	data = sqxc_record_write_instance(type, container_type, result, &length);
+
+	sq_mutex_lock(&cache->mutex);
+	// result may be out of date if table has been changed while it was queried
+	if (cache->version != version) {
+		sq_mutex_unlock(&cache->mutex);
+		free(data);
+		return;
+	}
+
+	addr = (ResultEntry**)sq_ptr_array_find_sorted(&cache->entries, &key,
+	                                               result_entry_cmp_key, &index);
+	if (addr) {
+		query_cache_erase(cache, addr);
+		index = (unsigned int)((void**)addr - cache->entries.data);
+	}
+
+	entry = malloc(sizeof(ResultEntry));
+	entry->sql = strdup(sql);
+	entry->type = type;
+	entry->container_type = container_type;
+	entry->n_tables = n_tables;
+	entry->tables = malloc(sizeof(char*) * (n_tables + 1));
+	entry->n_bytes = sizeof(ResultEntry) + strlen(sql) + 1 + length;
+	for (int i = 0;  i < n_tables;  i++) {
+		entry->tables[i] = strdup(table_names[i]);
+		entry->n_bytes += sizeof(char*) + strlen(table_names[i]) + 1;
+	}
+	entry->data = data;
+	entry->length = length;
+	entry->expire = (cache->setting.ttl > 0) ? sq_clock_msec() + cache->setting.ttl : 0;
+	entry->prev = NULL;
+	entry->next = NULL;
+
+	sq_ptr_array_push_in(&cache->entries, index, entry);
+	query_cache_link_head(cache, entry);
+	cache->stats.n_bytes += entry->n_bytes;
+	cache->stats.n_results++;
+
+	// evict the least recently used results. 'entry' is evicted too if it is larger than 'max_bytes'.
+	while (cache->stats.n_bytes > cache->setting.max_bytes && cache->lru_tail) {
+		entry = cache->lru_tail;
+		key.sql = entry->sql;
+		key.type = entry->type;
+		key.container_type = entry->container_type;
+		addr = (ResultEntry**)sq_ptr_array_search(&cache->entries, &key, result_entry_cmp_key);
+		query_cache_erase(cache, addr);
+		cache->stats.evictions++;
+	}
+	sq_mutex_unlock(&cache->mutex);
+}
+
+void  sq_query_cache_invalidate(SqQueryCache *cache, const char *table_name)
+{
+	ResultEntry *entry;
+
+	sq_mutex_lock(&cache->mutex);
+	// results that are being queried will not be added
+	cache->version++;
+	for (unsigned int index = cache->entries.length;  index > 0;  index--) {
+		entry = cache->entries.data[index - 1];
+		if (table_name && result_entry_use_table(entry, table_name) == false)
+			continue;
+		query_cache_erase(cache, (ResultEntry**)cache->entries.data + index - 1);
+		cache->stats.invalidations++;
+	}
+	sq_mutex_unlock(&cache->mutex);
+}
+
+void  sq_query_cache_get_stats(SqQueryCache *cache, SqQueryCacheStats *stats)
+{
+	sq_mutex_lock(&cache->mutex);
+	*stats = cache->stats;
+	sq_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,160 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqQueryCache - thread-safe cache of query results that can be shared by multiple SqStorage.
+
+	Results are keyed by final SQL statement, type of result, and type of container.
+	They are recorded by SqxcRecord and are parsed to new instance when they are got, so caller owns it.
+	Each result records names of tables in query. It is removed when SqStorage changes any of these tables.
+	The least recently used results are evicted when memory exceeds SqQueryCacheConfig::max_bytes.
+ */
+
+#ifndef SQ_QUERY_CACHE_H
+#define SQ_QUERY_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sqxc/SqConfig.h>
+#include <sqxc/SqThread.h>
+#include <sqxc/SqPtrArray.h>
+#include <sqxc/SqType.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqQueryCache          SqQueryCache;
+typedef struct SqQueryCacheConfig    SqQueryCacheConfig;
+typedef struct SqQueryCacheStats     SqQueryCacheStats;
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// If 'config' is NULL, use default setting.
+SqQueryCache *sq_query_cache_new(const SqQueryCacheConfig *config);
+void          sq_query_cache_free(SqQueryCache *cache);
+
+void          sq_query_cache_init(SqQueryCache *cache, const SqQueryCacheConfig *config);
+void          sq_query_cache_final(SqQueryCache *cache);
+
+// return new instance of cached result. If 'container_type' is not NULL, result is container of 'type'.
+// If result is not cached, return NULL and set 'version'. It must be passed to sq_query_cache_put().
+void         *sq_query_cache_get(SqQueryCache *cache, const char *sql,
+                                 const SqType *type, const SqType *container_type, uint64_t *version);
+
+// record 'result' of 'sql'. 'result' is still owned by caller.
+// 'table_names' is array of 'n_tables' tables that are used by 'sql'.
+// If any table has been changed since 'version' was got, result is not added because it may be out of date.
+// If 'type' or 'container_type' can't write instance (e.g. SqTypeJoint), result is not added.
+void          sq_query_cache_put(SqQueryCache *cache, const char *sql,
+                                 const SqType *type, const SqType *container_type, void *result,
+                                 const char **table_names, int n_tables, uint64_t version);
+
+// remove all results that use table. If 'table_name' is NULL, remove all results in cache.
+void          sq_query_cache_invalidate(SqQueryCache *cache, const char *table_name);
+
+// copy statistics of cache to 'stats'
+void          sq_query_cache_get_stats(SqQueryCache *cache, SqQueryCacheStats *stats);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqQueryCacheConfig - setting of SqQueryCache
+ */
+struct SqQueryCacheConfig
+{
+	size_t  max_bytes;      // memory for recorded results. 0 = SQ_CONFIG_QUERY_CACHE_BYTES_DEFAULT
+	int     ttl;            // milliseconds that result is kept after it is put. 0 = never expire.
+};
+
+/*	SqQueryCacheStats - statistics of SqQueryCache
+ */
+struct SqQueryCacheStats
+{
+	size_t    n_results;
+	size_t    n_bytes;               // memory of recorded results, SQL statements, and table names
+
+	uint64_t  hits;
+	uint64_t  misses;
+	uint64_t  evictions;
+	uint64_t  invalidations;         // number of results that were removed because their tables were changed
+	uint64_t  expirations;           // number of results that were removed because they exceeded 'ttl'
+};
+
+/*	SqQueryCache - thread-safe cache of recorded query results
+
+	All members are protected by 'mutex'. Don't access them directly, use sq_query_cache_get_stats().
+ */
+
+struct SqQueryCache
+{
+	SqQueryCacheConfig  setting;
+
+	SqMutex       mutex;
+	SqPtrArray    entries;          // sorted by SQL statement and types
+	void         *lru_head;         // the most recently used result
+	void         *lru_tail;         // the least recently used result
+	uint64_t      version;          // increased when any table is changed
+	SqQueryCacheStats  stats;
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+typedef struct SqQueryCacheConfig    QueryCacheConfig;
+typedef struct SqQueryCacheStats     QueryCacheStats;
+
+struct QueryCache : SqQueryCache
+{
+	// constructor
+	QueryCache(const SqQueryCacheConfig *config = NULL) {
+		sq_query_cache_init((SqQueryCache*)this, config);
+	}
+	QueryCache(const SqQueryCacheConfig &config) {
+		sq_query_cache_init((SqQueryCache*)this, &config);
+	}
+	// destructor
+	~QueryCache() {
+		sq_query_cache_final((SqQueryCache*)this);
+	}
+
+	void  invalidate(const char *tableName = NULL) {
+		sq_query_cache_invalidate((SqQueryCache*)this, tableName);
+	}
+	void  getStats(SqQueryCacheStats *stats) {
+		sq_query_cache_get_stats((SqQueryCache*)this, stats);
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQ_QUERY_CACHE_H
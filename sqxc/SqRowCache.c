@@ -0,0 +1,480 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqxc/SqError.h>
+#include <sqxc/SqTable.h>
+#include <sqxc/SqRowCache.h>
+#include <sqxc/SqxcRecord.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+typedef struct RowEntry        RowEntry;
+typedef struct RowKey          RowKey;
+typedef struct TableVersion    TableVersion;
+
+struct RowEntry
+{
+	char      *table_name;
+	int64_t    id;
+	char      *data;         // recorded by SqxcRecord. NULL if row is being loaded.
+	size_t     length;
+	size_t     n_bytes;      // memory that is counted in SqRowCacheShard::n_bytes
+	uint64_t   expire;       // sq_clock_msec() when row expires. 0 = never
+	RowEntry  *prev;         // LRU list
+	RowEntry  *next;
+};
+
+struct RowKey
+{
+	const char  *table_name;
+	int64_t      id;
+};
+
+struct TableVersion
+{
+	char      *name;
+	uint64_t   version;
+};
+
+static int   row_entry_cmp_key(const void *key, const void *entryAddr)
+{
+	const RowKey   *rkey  = (const RowKey*)key;
+	const RowEntry *entry = *(RowEntry**)entryAddr;
+	int   result;
+
+	result = strcmp(rkey->table_name, entry->table_name);
+	if (result != 0)
+		return result;
+	return (rkey->id > entry->id) - (rkey->id < entry->id);
+}
+
+static int   table_version_cmp_str__name(const void *name, const void *tableAddr)
+{
+	return strcmp((const char*)name, (*(TableVersion**)tableAddr)->name);
+}
+
+static void  table_version_free(TableVersion *table)
+{
+	free(table->name);
+	free(table);
+}
+
+// FNV-1a hash of table name and primary key
+static SqRowCacheShard *row_cache_shard(SqRowCache *cache, const char *table_name, int64_t id)
+{
+	uint64_t  hash = 14695981039346656037ULL;
+
+	for (;  *table_name;  table_name++) {
+		hash ^= (unsigned char)*table_name;
+		hash *= 1099511628211ULL;
+	}
+	hash ^= (uint64_t)id;
+	hash *= 1099511628211ULL;
+	hash ^= hash >> 32;
+	return &cache->shards[hash % (unsigned int)cache->setting.n_shards];
+}
+
+// --- LRU list of shard ---
+
+static void  row_cache_unlink(SqRowCacheShard *shard, RowEntry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		shard->lru_head = entry->next;
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		shard->lru_tail = entry->prev;
+	entry->prev = NULL;
+	entry->next = NULL;
+}
+
+static void  row_cache_link_head(SqRowCacheShard *shard, RowEntry *entry)
+{
+	entry->prev = NULL;
+	entry->next = shard->lru_head;
+	if (shard->lru_head)
+		((RowEntry*)shard->lru_head)->prev = entry;
+	else
+		shard->lru_tail = entry;
+	shard->lru_head = entry;
+}
+
+// remove entry from shard and free it
+static void  row_cache_erase(SqRowCacheShard *shard, RowEntry **addr)
+{
+	RowEntry *entry = *addr;
+
+	if (entry->data) {
+		row_cache_unlink(shard, entry);
+		shard->n_bytes -= entry->n_bytes;
+		shard->stats.n_rows--;
+		free(entry->data);
+	}
+	sq_ptr_array_erase_addr(&shard->entries, addr, 1);
+	free(entry->table_name);
+	free(entry);
+}
+
+// add recorded 'data' to cache. cache takes ownership of 'data'. 'data' can be NULL.
+static void  row_cache_store(SqRowCache *cache, const char *table_name, int64_t id,
+                             char *data, size_t length, uint64_t version)
+{
+	SqRowCacheShard *shard;
+	RowEntry  *entry;
+	RowEntry **addr;
+	RowKey     key = {table_name, id};
+	size_t     max_bytes;
+	unsigned int  index;
+
+	shard = row_cache_shard(cache, table_name, id);
+	max_bytes = cache->setting.max_bytes / cache->setting.n_shards;
+
+	sq_mutex_lock(&shard->mutex);
+	addr = (RowEntry**)sq_ptr_array_find_sorted(&shard->entries, &key,
+	                                            row_entry_cmp_key, &index);
+	// row may be out of date if table has been changed while row was loaded
+	if (data && sq_row_cache_version(cache, table_name) != version) {
+		free(data);
+		data = NULL;
+	}
+
+	if (data == NULL) {
+		// remove entry of loading row
+		if (addr && (*addr)->data == NULL)
+			row_cache_erase(shard, addr);
+	}
+	else {
+		if (addr == NULL) {
+			entry = calloc(1, sizeof(RowEntry));
+			entry->table_name = strdup(table_name);
+			entry->id = id;
+			sq_ptr_array_push_in(&shard->entries, index, entry);
+		}
+		else {
+			entry = *addr;
+			// replace recorded data
+			if (entry->data) {
+				row_cache_unlink(shard, entry);
+				shard->n_bytes -= entry->n_bytes;
+				shard->stats.n_rows--;
+				free(entry->data);
+			}
+		}
+		entry->data = data;
+		entry->length = length;
+		entry->n_bytes = sizeof(RowEntry) + strlen(table_name) + 1 + length;
+		entry->expire = (cache->setting.ttl > 0) ? sq_clock_msec() + cache->setting.ttl : 0;
+		row_cache_link_head(shard, entry);
+		shard->n_bytes += entry->n_bytes;
+		shard->stats.n_rows++;
+
+		// evict the least recently used rows. 'entry' is evicted too if it is larger than memory of shard.
+		while (shard->n_bytes > max_bytes && shard->lru_tail) {
+			entry = shard->lru_tail;
+			key.table_name = entry->table_name;
+			key.id = entry->id;
+			addr = (RowEntry**)sq_ptr_array_search(&shard->entries, &key, row_entry_cmp_key);
+			row_cache_erase(shard, addr);
+			shard->stats.evictions++;
+		}
+	}
+
+	// wake up threads that are waiting for this row
+	sq_cond_broadcast(&shard->cond);
+	sq_mutex_unlock(&shard->mutex);
+}
+
+// increase version of table. If 'table_name' is NULL, increase version of all tables.
+static void  row_cache_change(SqRowCache *cache, const char *table_name)
+{
+	TableVersion  *table;
+	unsigned int   index;
+
+	sq_mutex_lock(&cache->mutex);
+	if (table_name == NULL)
+		cache->version++;
+	else if (sq_ptr_array_find_sorted(&cache->tables, table_name,
+	                                  table_version_cmp_str__name, &index) == NULL)
+	{
+		table = malloc(sizeof(TableVersion));
+		table->name = strdup(table_name);
+		table->version = 1;
+		sq_ptr_array_push_in(&cache->tables, index, table);
+	}
+	else
+		((TableVersion*)cache->tables.data[index])->version++;
+	sq_mutex_unlock(&cache->mutex);
+}
+
+// ----------------------------------------------------------------------------
+// SqRowCache functions
+
+SqRowCache *sq_row_cache_new(const SqRowCacheConfig *config)
+{
+	SqRowCache *cache;
+
+	cache = malloc(sizeof(SqRowCache));
+	sq_row_cache_init(cache, config);
+	return cache;
+}
+
+void  sq_row_cache_free(SqRowCache *cache)
+{
+	sq_row_cache_final(cache);
+	free(cache);
+}
+
+void  sq_row_cache_init(SqRowCache *cache, const SqRowCacheConfig *config)
+{
+	SqRowCacheShard *shard;
+
+	if (config)
+		cache->setting = *config;
+	else
+		memset(&cache->setting, 0, sizeof(SqRowCacheConfig));
+	if (cache->setting.max_bytes == 0)
+		cache->setting.max_bytes = SQ_CONFIG_ROW_CACHE_BYTES_DEFAULT;
+	if (cache->setting.n_shards <= 0)
+		cache->setting.n_shards = SQ_CONFIG_ROW_CACHE_SHARDS_DEFAULT;
+
+	cache->shards = calloc(cache->setting.n_shards, sizeof(SqRowCacheShard));
+	for (int index = 0;  index < cache->setting.n_shards;  index++) {
+		shard = cache->shards + index;
+		sq_mutex_init(&shard->mutex);
+		sq_cond_init(&shard->cond);
+		sq_ptr_array_init(&shard->entries, 16, NULL);
+	}
+	sq_mutex_init(&cache->mutex);
+	sq_ptr_array_init(&cache->tables, 8, (SqClearFunc)table_version_free);
+	cache->version = 0;
+}
+
+void  sq_row_cache_final(SqRowCache *cache)
+{
+	SqRowCacheShard *shard;
+
+	for (int index = 0;  index < cache->setting.n_shards;  index++) {
+		shard = cache->shards + index;
+		while (shard->entries.length > 0)
+			row_cache_erase(shard, (RowEntry**)shard->entries.data + shard->entries.length - 1);
+		sq_ptr_array_final(&shard->entries);
+		sq_cond_final(&shard->cond);
+		sq_mutex_final(&shard->mutex);
+	}
+	free(cache->shards);
+	sq_ptr_array_final(&cache->tables);
+	sq_mutex_final(&cache->mutex);
+}
+
+void *sq_row_cache_get(SqRowCache *cache, const char *table_name, int64_t id,
+                       const SqType *type, uint64_t *version)
+{
+	SqRowCacheShard *shard;
+	RowEntry  *entry;
+	RowEntry **addr;
+	RowKey     key = {table_name, id};
+	void      *instance = NULL;
+	unsigned int  index;
+
+	shard = row_cache_shard(cache, table_name, id);
+
+	sq_mutex_lock(&shard->mutex);
+	for (;;) {
+		addr = (RowEntry**)sq_ptr_array_find_sorted(&shard->entries, &key,
+		                                            row_entry_cmp_key, &index);
+		if (addr == NULL) {
+			// current thread loads row. other threads wait for it.
+			entry = calloc(1, sizeof(RowEntry));
+			entry->table_name = strdup(table_name);
+			entry->id = id;
+			sq_ptr_array_push_in(&shard->entries, index, entry);
+			shard->stats.misses++;
+			break;
+		}
+		entry = *addr;
+		// other thread is loading row
+		if (entry->data == NULL) {
+			shard->stats.waits++;
+			sq_cond_wait(&shard->cond, &shard->mutex);
+			continue;
+		}
+		if (entry->expire && entry->expire <= sq_clock_msec()) {
+			row_cache_erase(shard, addr);
+			shard->stats.expirations++;
+			continue;
+		}
+		instance = sqxc_record_parse_instance(entry->data, entry->length, type, NULL);
+		if (instance == NULL) {
+			// recorded data doesn't match 'type'
+			row_cache_erase(shard, addr);
+			continue;
+		}
+		row_cache_unlink(shard, entry);
+		row_cache_link_head(shard, entry);
+		shard->stats.hits++;
+		break;
+	}
+	sq_mutex_unlock(&shard->mutex);
+
+	// version must be got before row is loaded
+	if (instance == NULL)
+		*version = sq_row_cache_version(cache, table_name);
+	return instance;
+}
+
+void  sq_row_cache_put(SqRowCache *cache, const char *table_name, int64_t id,
+                       const SqType *type, void *instance, uint64_t version)
+{
+	char   *data = NULL;
+	size_t  length = 0;
+
+	if (instance)
+		data = sqxc_record_write_instance(type, NULL, instance, &length);
+	row_cache_store(cache, table_name, id, data, length, version);
+}
+
+void  sq_row_cache_put_all(SqRowCache *cache, const char *table_name, const SqType *type,
+                           const SqType *container_type, void *container, uint64_t version)
+{
+	Sqxc        xcrecord;
+	SqColumn   *primary;
+	char       *data;
+	size_t      length, n, beg = 0;
+	int64_t     id = 0;
+	int         depth = 0;
+	bool        has_id = false;
+
+	primary = sq_table_get_primary(NULL, type);
+	if (primary == NULL || primary->name == NULL)
+		return;
+	// record all rows in one pass
+	data = sqxc_record_write_instance(type, container_type, container, &length);
+
+	// split recorded data by objects in array. 'xcrecord' holds arguments of record.
+	for (size_t cur = 0;  cur < length;  cur += n) {
+		n = sqxc_record_read(data + cur, length - cur, &xcrecord);
+		if (n == 0)
+			break;
+		if (xcrecord.type & SQXC_TYPE_END) {
+			depth--;
+			if (depth == 1 && xcrecord.type == SQXC_TYPE_OBJECT_END && has_id) {
+				row_cache_store(cache, table_name, id,
+				                memcpy(malloc(cur + n - beg), data + beg, cur + n - beg),
+				                cur + n - beg, version);
+			}
+		}
+		else if (xcrecord.type & SQXC_TYPE_NESTED) {
+			if (depth == 1 && xcrecord.type == SQXC_TYPE_OBJECT) {
+				beg = cur;
+				has_id = false;
+			}
+			depth++;
+		}
+		else if (depth == 2 && xcrecord.name && strcmp(xcrecord.name, primary->name) == 0) {
+			has_id = true;
+			if (xcrecord.type == SQXC_TYPE_INT)
+				id = xcrecord.value.integer;
+			else if (xcrecord.type == SQXC_TYPE_UINT)
+				id = xcrecord.value.uinteger;
+			else if (xcrecord.type & (SQXC_TYPE_INT64 | SQXC_TYPE_UINT64))
+				id = xcrecord.value.int64;
+			else
+				has_id = false;
+		}
+	}
+	free(data);
+}
+
+uint64_t  sq_row_cache_version(SqRowCache *cache, const char *table_name)
+{
+	TableVersion **addr;
+	uint64_t       version;
+
+	sq_mutex_lock(&cache->mutex);
+	addr = (TableVersion**)sq_ptr_array_search(&cache->tables, table_name,
+	                                           table_version_cmp_str__name);
+	version = cache->version + ((addr) ? (*addr)->version : 0);
+	sq_mutex_unlock(&cache->mutex);
+	return version;
+}
+
+void  sq_row_cache_remove(SqRowCache *cache, const char *table_name, int64_t id)
+{
+	SqRowCacheShard *shard;
+	RowEntry **addr;
+	RowKey     key = {table_name, id};
+
+	// rows that are being loaded will not be added
+	row_cache_change(cache, table_name);
+
+	shard = row_cache_shard(cache, table_name, id);
+	sq_mutex_lock(&shard->mutex);
+	addr = (RowEntry**)sq_ptr_array_search(&shard->entries, &key, row_entry_cmp_key);
+	// keep entry of loading row, other threads are waiting for it.
+	if (addr && (*addr)->data)
+		row_cache_erase(shard, addr);
+	sq_mutex_unlock(&shard->mutex);
+}
+
+void  sq_row_cache_clear(SqRowCache *cache, const char *table_name)
+{
+	SqRowCacheShard *shard;
+	RowEntry        *entry;
+
+	// rows that are being loaded will not be added
+	row_cache_change(cache, table_name);
+
+	for (int index = 0;  index < cache->setting.n_shards;  index++) {
+		shard = cache->shards + index;
+		sq_mutex_lock(&shard->mutex);
+		for (unsigned int i = shard->entries.length;  i > 0;  i--) {
+			entry = shard->entries.data[i - 1];
+			if (entry->data == NULL)
+				continue;
+			if (table_name && strcmp(table_name, entry->table_name) != 0)
+				continue;
+			row_cache_erase(shard, (RowEntry**)shard->entries.data + i - 1);
+		}
+		sq_mutex_unlock(&shard->mutex);
+	}
+}
+
+void  sq_row_cache_get_stats(SqRowCache *cache, SqRowCacheStats *stats)
+{
+	SqRowCacheShard *shard;
+
+	memset(stats, 0, sizeof(SqRowCacheStats));
+	for (int index = 0;  index < cache->setting.n_shards;  index++) {
+		shard = cache->shards + index;
+		sq_mutex_lock(&shard->mutex);
+		stats->n_rows      += shard->stats.n_rows;
+		stats->n_bytes     += shard->n_bytes;
+		stats->hits        += shard->stats.hits;
+		stats->misses      += shard->stats.misses;
+		stats->waits       += shard->stats.waits;
+		stats->evictions   += shard->stats.evictions;
+		stats->expirations += shard->stats.expirations;
+		sq_mutex_unlock(&shard->mutex);
+	}
+}
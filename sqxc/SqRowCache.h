@@ -0,0 +1,187 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqRowCache - thread-safe cache of rows that can be shared by multiple SqStorage.
+
+	Rows are keyed by table name and integer primary key. They are recorded by SqxcRecord and
+	are parsed to new instance by SqType when they are got, so caller owns the returned instance.
+	Rows are spread over shards, each shard has its own lock. The least recently used rows of shard
+	are evicted when memory of shard exceeds its part of SqRowCacheConfig::max_bytes.
+
+	Single-flight loading: If row is not cached, sq_row_cache_get() returns NULL and caller must load
+	row then call sq_row_cache_put(). Other threads that get the same row wait until it is put.
+ */
+
+#ifndef SQ_ROW_CACHE_H
+#define SQ_ROW_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sqxc/SqConfig.h>
+#include <sqxc/SqThread.h>
+#include <sqxc/SqPtrArray.h>
+#include <sqxc/SqType.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqRowCache          SqRowCache;
+typedef struct SqRowCacheConfig    SqRowCacheConfig;
+typedef struct SqRowCacheStats     SqRowCacheStats;
+typedef struct SqRowCacheShard     SqRowCacheShard;
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// If 'config' is NULL, use default setting.
+SqRowCache *sq_row_cache_new(const SqRowCacheConfig *config);
+void        sq_row_cache_free(SqRowCache *cache);
+
+void        sq_row_cache_init(SqRowCache *cache, const SqRowCacheConfig *config);
+void        sq_row_cache_final(SqRowCache *cache);
+
+// return new instance of cached row. It waits if other thread is loading the same row.
+// If row is not cached, return NULL and set 'version' of table. Caller must load row then call sq_row_cache_put().
+void       *sq_row_cache_get(SqRowCache *cache, const char *table_name, int64_t id,
+                             const SqType *type, uint64_t *version);
+
+// record 'instance' and wake up threads that are waiting for it. 'instance' is still owned by caller.
+// If 'instance' is NULL (row can't be loaded), it only wakes up waiting threads.
+// If table has been changed since 'version' was got, row is not added because it may be out of date.
+void        sq_row_cache_put(SqRowCache *cache, const char *table_name, int64_t id,
+                             const SqType *type, void *instance, uint64_t version);
+
+// record all elements in 'container'. Its parameters are the same as sq_row_cache_put().
+void        sq_row_cache_put_all(SqRowCache *cache, const char *table_name, const SqType *type,
+                                 const SqType *container_type, void *container, uint64_t version);
+
+// return version of table. It is increased each time rows of table are removed.
+uint64_t    sq_row_cache_version(SqRowCache *cache, const char *table_name);
+
+// remove row that has the primary key in table.
+void        sq_row_cache_remove(SqRowCache *cache, const char *table_name, int64_t id);
+
+// remove all rows of table. If 'table_name' is NULL, remove all rows in cache.
+void        sq_row_cache_clear(SqRowCache *cache, const char *table_name);
+
+// copy statistics of cache to 'stats'
+void        sq_row_cache_get_stats(SqRowCache *cache, SqRowCacheStats *stats);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqRowCacheConfig - setting of SqRowCache
+ */
+struct SqRowCacheConfig
+{
+	size_t  max_bytes;      // memory for recorded rows. 0 = SQ_CONFIG_ROW_CACHE_BYTES_DEFAULT
+	int     ttl;            // milliseconds that row is kept after it is put. 0 = never expire.
+	int     n_shards;       // number of shards (locks). 0 = SQ_CONFIG_ROW_CACHE_SHARDS_DEFAULT
+};
+
+/*	SqRowCacheStats - statistics of SqRowCache
+ */
+struct SqRowCacheStats
+{
+	size_t    n_rows;
+	size_t    n_bytes;               // memory of recorded rows and their keys
+
+	uint64_t  hits;
+	uint64_t  misses;
+	uint64_t  waits;                 // number of sq_row_cache_get() that waited for other thread to load row
+	uint64_t  evictions;
+	uint64_t  expirations;           // number of rows that were removed because they exceeded 'ttl'
+};
+
+struct SqRowCacheShard
+{
+	SqMutex     mutex;
+	SqCond      cond;                // signaled when row is put
+	SqPtrArray  entries;             // sorted by table name and primary key
+	void       *lru_head;            // the most recently used row
+	void       *lru_tail;            // the least recently used row
+	size_t      n_bytes;
+	SqRowCacheStats  stats;
+};
+
+/*	SqRowCache - thread-safe cache of recorded rows
+
+	Members of shard are protected by mutex of shard. 'tables' and 'version' are protected by 'mutex'.
+	Don't access them directly, use sq_row_cache_get_stats() to get statistics.
+ */
+
+struct SqRowCache
+{
+	SqRowCacheConfig  setting;
+	SqRowCacheShard  *shards;          // array of SqRowCacheConfig::n_shards shards
+
+	// version of tables, sorted by table name
+	SqMutex           mutex;
+	SqPtrArray        tables;
+	uint64_t          version;         // increased when all rows are removed
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+typedef struct SqRowCacheConfig    RowCacheConfig;
+typedef struct SqRowCacheStats     RowCacheStats;
+
+struct RowCache : SqRowCache
+{
+	// constructor
+	RowCache(const SqRowCacheConfig *config = NULL) {
+		sq_row_cache_init((SqRowCache*)this, config);
+	}
+	RowCache(const SqRowCacheConfig &config) {
+		sq_row_cache_init((SqRowCache*)this, &config);
+	}
+	// destructor
+	~RowCache() {
+		sq_row_cache_final((SqRowCache*)this);
+	}
+
+	void  remove(const char *tableName, int64_t id) {
+		sq_row_cache_remove((SqRowCache*)this, tableName, id);
+	}
+	void  clear(const char *tableName = NULL) {
+		sq_row_cache_clear((SqRowCache*)this, tableName);
+	}
+	void  getStats(SqRowCacheStats *stats) {
+		sq_row_cache_get_stats((SqRowCache*)this, stats);
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQ_ROW_CACHE_H
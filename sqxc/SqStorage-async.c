@@ -0,0 +1,541 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdio.h>             // fprintf(), stderr
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqxc/SqError.h>
+#include <sqxc/SqStorage.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+typedef struct SqStorageTask    SqStorageTask;
+
+enum {
+	SQ_STORAGE_TASK_RUN,
+	SQ_STORAGE_TASK_GET,
+	SQ_STORAGE_TASK_GET_ALL,
+	SQ_STORAGE_TASK_INSERT,
+	SQ_STORAGE_TASK_UPDATE,
+	SQ_STORAGE_TASK_REMOVE,
+	SQ_STORAGE_TASK_REMOVE_ALL,
+};
+
+struct SqStorageTask
+{
+	SqStorageTask  *next;
+	int             command;
+
+	char           *table_name;
+	const SqType   *table_type;
+	const SqType   *container_type;
+	char           *sql_where_having;
+	void           *instance;
+	int64_t         id;
+
+	// time when task is pushed. It is used by group commit.
+	uint64_t        time;
+	// result of task. callback is called with them after transaction of group commit is committed.
+	void           *result;
+	int64_t         number;
+
+	union {
+		SqStorageAsyncFunc  callback;    // for SQ_STORAGE_TASK_GET ~ SQ_STORAGE_TASK_REMOVE_ALL
+		SqStorageTaskFunc   func;        // for SQ_STORAGE_TASK_RUN
+	} call;
+	void           *user_data;
+};
+
+struct SqStorageWorkers
+{
+	SqStorage      *storage;
+	SqMutex         mutex;
+	SqCond          cond;
+	SqCond          cond_idle;   // signaled when queue is empty and no task is running
+
+	// queue of tasks
+	SqStorageTask  *head;
+	SqStorageTask  *tail;
+	int             n_running;   // number of workers that are running tasks
+	int             n_flush;     // number of threads that are waiting in sq_storage_flush()
+
+	SqThread       *threads;
+	int             n_threads;
+	bool            quit;
+};
+
+// run task and keep result in 'task'. caller must call sq_storage_task_done() later.
+static void  sq_storage_task_exec(SqStorage *storage, SqStorageTask *task)
+{
+	task->result = NULL;
+	task->number = 0;
+
+	switch (task->command) {
+	case SQ_STORAGE_TASK_RUN:
+		task->call.func(storage, task->user_data);
+		break;
+
+	case SQ_STORAGE_TASK_GET:
+		task->result = sq_storage_get(storage, task->table_name, task->table_type, task->id);
+		break;
+
+	case SQ_STORAGE_TASK_GET_ALL:
+		task->result = sq_storage_get_all(storage, task->table_name, task->table_type,
+		                                  task->container_type, task->sql_where_having);
+		break;
+
+	case SQ_STORAGE_TASK_INSERT:
+		task->number = sq_storage_insert(storage, task->table_name, task->table_type, task->instance);
+		break;
+
+	case SQ_STORAGE_TASK_UPDATE:
+		task->number = sq_storage_update(storage, task->table_name, task->table_type, task->instance);
+		break;
+
+	case SQ_STORAGE_TASK_REMOVE:
+		task->number = sq_storage_remove(storage, task->table_name, task->table_type, task->id);
+		break;
+
+	case SQ_STORAGE_TASK_REMOVE_ALL:
+		task->number = sq_storage_remove_all(storage, task->table_name, task->sql_where_having);
+		break;
+	}
+}
+
+// call callback of task
+static void  sq_storage_task_done(SqStorage *storage, SqStorageTask *task)
+{
+	if (task->command != SQ_STORAGE_TASK_RUN && task->call.callback)
+		task->call.callback(storage, task->result, task->number, task->user_data);
+}
+
+static void  sq_storage_task_run(SqStorage *storage, SqStorageTask *task)
+{
+	sq_storage_task_exec(storage, task);
+	sq_storage_task_done(storage, task);
+}
+
+static void  sq_storage_task_free(SqStorageTask *task)
+{
+	free(task->table_name);
+	free(task->sql_where_having);
+	free(task);
+}
+
+// return true if task writes database. These tasks can be grouped by group commit.
+static bool  sq_storage_task_is_write(SqStorageTask *task)
+{
+	return task->command >= SQ_STORAGE_TASK_INSERT;
+}
+
+// run 'batch' of write tasks in a transaction. callbacks are called after COMMIT.
+// If any task fails, the whole group is rolled back because some databases (e.g. PostgreSQL) abort
+// transaction after error. Then tasks run again one by one, every task gets result of its own write.
+static void  sq_storage_run_batch(SqStorage *storage, SqStorageTask *batch)
+{
+	SqStorageContext *context, local;
+	SqStorageTask    *task;
+	Sqxc  *xcsql = NULL;
+	bool   failed = false;
+
+	if (sq_storage_begin_trans(storage) == SQCODE_OK) {
+		// multi-threaded SqStorage returns context that is pinned to current thread by transaction.
+		// Its SqxcSql keeps code of the last statement.
+		context = sq_storage_acquire(storage, &local);
+		if (context) {
+			xcsql = context->xc_output;
+			sq_storage_release(storage, context);
+		}
+	}
+
+	// stop at the first failed task, all tasks will run again
+	for (task = batch;  task && failed == false;  task = task->next) {
+		if (xcsql)
+			xcsql->code = SQCODE_OK;
+		sq_storage_task_exec(storage, task);
+		if (xcsql && xcsql->code != SQCODE_OK)
+			failed = true;
+	}
+
+	if (xcsql) {
+		if (failed == false && sq_storage_commit_trans(storage) != SQCODE_OK)
+			failed = true;
+		if (failed) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: group of write tasks is rolled back. run them one by one.\n",
+			        "sq_storage_worker()");
+#endif
+			sq_storage_rollback_trans(storage);
+			// run tasks without transaction. failed task doesn't affect others.
+			for (task = batch;  task;  task = task->next)
+				sq_storage_task_exec(storage, task);
+		}
+	}
+
+	while (batch) {
+		task  = batch;
+		batch = task->next;
+		sq_storage_task_done(storage, task);
+		sq_storage_task_free(task);
+	}
+}
+
+// return milliseconds that worker should wait before it runs group of write tasks. return 0 if it can run now.
+static int   sq_storage_worker_delay(SqStorageWorkers *workers)
+{
+	SqStorage     *storage = workers->storage;
+	SqStorageTask *task;
+	uint64_t       now;
+	int            count = 0;
+
+	if (storage->group_rows <= 1 || workers->quit || workers->n_flush > 0)
+		return 0;
+	for (task = workers->head;  task;  task = task->next) {
+		// don't delay task that doesn't write database
+		if (sq_storage_task_is_write(task) == false)
+			return 0;
+		if (++count >= storage->group_rows)
+			return 0;
+	}
+	now = sq_clock_msec();
+	if (now >= workers->head->time + storage->group_delay)
+		return 0;
+	return (int)(workers->head->time + storage->group_delay - now);
+}
+
+static void *sq_storage_worker(void *data)
+{
+	SqStorageWorkers *workers = data;
+	SqStorage        *storage = workers->storage;
+	SqStorageTask    *task;
+	SqStorageTask    *last;
+	bool  group;
+	int   delay;
+	int   count;
+
+	sq_mutex_lock(&workers->mutex);
+	for (;;) {
+		// worker quits after all tasks are done
+		if (workers->head == NULL) {
+			if (workers->n_running == 0)
+				sq_cond_broadcast(&workers->cond_idle);
+			if (workers->quit)
+				break;
+			sq_cond_wait(&workers->cond, &workers->mutex);
+			continue;
+		}
+		task = workers->head;
+		last = task;
+
+		group = (storage->group_rows > 1 && sq_storage_task_is_write(task));
+		if (group) {
+			// group commit: wait for more write tasks until row-count threshold or time deadline
+			delay = sq_storage_worker_delay(workers);
+			if (delay > 0) {
+				sq_cond_wait_timeout(&workers->cond, &workers->mutex, delay);
+				continue;
+			}
+			// take consecutive write tasks from queue
+			for (count = 1;  count < storage->group_rows;  count++) {
+				if (last->next == NULL || sq_storage_task_is_write(last->next) == false)
+					break;
+				last = last->next;
+			}
+		}
+		workers->head = last->next;
+		if (workers->head == NULL)
+			workers->tail = NULL;
+		last->next = NULL;
+		workers->n_running++;
+		sq_mutex_unlock(&workers->mutex);
+
+		if (group)
+			sq_storage_run_batch(storage, task);
+		else {
+			sq_storage_task_run(storage, task);
+			sq_storage_task_free(task);
+		}
+
+		sq_mutex_lock(&workers->mutex);
+		workers->n_running--;
+	}
+	sq_mutex_unlock(&workers->mutex);
+	return NULL;
+}
+
+int   sq_storage_start_workers(SqStorage *storage, int n_workers)
+{
+	SqStorageWorkers *workers;
+	int   code = SQCODE_OK;
+
+	sq_mutex_lock(&storage->mutex);
+	if (storage->workers) {
+		// workers have been started
+		sq_mutex_unlock(&storage->mutex);
+		return SQCODE_OK;
+	}
+
+	// SqStorage without SqdbPool has only one connection
+	if (storage->pool == NULL)
+		n_workers = 1;
+	else if (n_workers <= 0)
+		n_workers = storage->pool->setting.max_size;
+
+	workers = malloc(sizeof(SqStorageWorkers));
+	workers->storage = storage;
+	sq_mutex_init(&workers->mutex);
+	sq_cond_init(&workers->cond);
+	sq_cond_init(&workers->cond_idle);
+	workers->head = NULL;
+	workers->tail = NULL;
+	workers->n_running = 0;
+	workers->n_flush = 0;
+	workers->quit = false;
+	workers->threads = malloc(sizeof(SqThread) * n_workers);
+	workers->n_threads = 0;
+	storage->workers = workers;
+
+	for (int index = 0;  index < n_workers;  index++) {
+		if (sq_thread_create(&workers->threads[index], sq_storage_worker, workers) != 0) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: can't create worker thread.\n",
+			        "sq_storage_start_workers()");
+#endif
+			code = SQCODE_ERROR;
+			break;
+		}
+		workers->n_threads++;
+	}
+	sq_mutex_unlock(&storage->mutex);
+
+	// no thread can run tasks
+	if (workers->n_threads == 0)
+		sq_storage_stop_workers(storage);
+	return code;
+}
+
+void  sq_storage_stop_workers(SqStorage *storage)
+{
+	SqStorageWorkers *workers;
+
+	sq_mutex_lock(&storage->mutex);
+	workers = storage->workers;
+	storage->workers = NULL;
+	sq_mutex_unlock(&storage->mutex);
+	if (workers == NULL)
+		return;
+
+	// wake up all workers. They quit after all queued tasks are done.
+	sq_mutex_lock(&workers->mutex);
+	workers->quit = true;
+	sq_cond_broadcast(&workers->cond);
+	sq_mutex_unlock(&workers->mutex);
+
+	for (int index = 0;  index < workers->n_threads;  index++)
+		sq_thread_join(workers->threads[index]);
+
+	sq_cond_final(&workers->cond);
+	sq_cond_final(&workers->cond_idle);
+	sq_mutex_final(&workers->mutex);
+	free(workers->threads);
+	free(workers);
+}
+
+void  sq_storage_set_group_commit(SqStorage *storage, int max_rows, int max_delay)
+{
+	SqStorageWorkers *workers;
+
+	sq_mutex_lock(&storage->mutex);
+	workers = storage->workers;
+	if (workers)
+		sq_mutex_lock(&workers->mutex);
+	storage->group_rows  = max_rows;
+	storage->group_delay = (max_delay > 0) ? max_delay : 0;
+	// wake up workers that are waiting for more write tasks
+	if (workers) {
+		sq_cond_broadcast(&workers->cond);
+		sq_mutex_unlock(&workers->mutex);
+	}
+	sq_mutex_unlock(&storage->mutex);
+}
+
+void  sq_storage_flush(SqStorage *storage)
+{
+	SqStorageWorkers *workers;
+
+	sq_mutex_lock(&storage->mutex);
+	workers = storage->workers;
+	sq_mutex_unlock(&storage->mutex);
+	if (workers == NULL)
+		return;
+
+	sq_mutex_lock(&workers->mutex);
+	// workers run queued write tasks without waiting for deadline
+	workers->n_flush++;
+	sq_cond_broadcast(&workers->cond);
+	while (workers->head || workers->n_running > 0)
+		sq_cond_wait(&workers->cond_idle, &workers->mutex);
+	workers->n_flush--;
+	sq_mutex_unlock(&workers->mutex);
+}
+
+// push task to queue. If no worker thread is available, run it in current thread.
+static int   sq_storage_push_task(SqStorage *storage, SqStorageTask *task)
+{
+	SqStorageWorkers *workers;
+
+	task->next = NULL;
+	task->time = sq_clock_msec();
+	sq_mutex_lock(&storage->mutex);
+	// start workers when the first task is pushed
+	if (storage->workers == NULL) {
+		sq_mutex_unlock(&storage->mutex);
+		sq_storage_start_workers(storage, 0);
+		sq_mutex_lock(&storage->mutex);
+	}
+	workers = storage->workers;
+	if (workers) {
+		sq_mutex_lock(&workers->mutex);
+		if (workers->tail)
+			workers->tail->next = task;
+		else
+			workers->head = task;
+		workers->tail = task;
+		sq_cond_signal(&workers->cond);
+		sq_mutex_unlock(&workers->mutex);
+	}
+	sq_mutex_unlock(&storage->mutex);
+
+	if (workers == NULL) {
+		sq_storage_task_run(storage, task);
+		sq_storage_task_free(task);
+	}
+	return SQCODE_OK;
+}
+
+static SqStorageTask *sq_storage_task_new(int command, const char *table_name, const SqType *table_type,
+                                          SqStorageAsyncFunc callback, void *user_data)
+{
+	SqStorageTask *task;
+
+	task = calloc(1, sizeof(SqStorageTask));
+	task->command    = command;
+	task->table_name = (table_name) ? strdup(table_name) : NULL;
+	task->table_type = table_type;
+	task->call.callback = callback;
+	task->user_data  = user_data;
+	return task;
+}
+
+int   sq_storage_run_async(SqStorage         *storage,
+                           SqStorageTaskFunc  func,
+                           void              *data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_RUN, NULL, NULL, NULL, data);
+	task->call.func = func;
+	return sq_storage_push_task(storage, task);
+}
+
+int   sq_storage_get_async(SqStorage          *storage,
+                           const char         *table_name,
+                           const SqType       *table_type,
+                           int64_t             id,
+                           SqStorageAsyncFunc  callback,
+                           void               *user_data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_GET, table_name, table_type, callback, user_data);
+	task->id = id;
+	return sq_storage_push_task(storage, task);
+}
+
+int   sq_storage_get_all_async(SqStorage          *storage,
+                               const char         *table_name,
+                               const SqType       *table_type,
+                               const SqType       *container_type,
+                               const char         *sql_where_having,
+                               SqStorageAsyncFunc  callback,
+                               void               *user_data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_GET_ALL, table_name, table_type, callback, user_data);
+	task->container_type = container_type;
+	task->sql_where_having = (sql_where_having) ? strdup(sql_where_having) : NULL;
+	return sq_storage_push_task(storage, task);
+}
+
+int   sq_storage_insert_async(SqStorage          *storage,
+                              const char         *table_name,
+                              const SqType       *table_type,
+                              void               *instance,
+                              SqStorageAsyncFunc  callback,
+                              void               *user_data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_INSERT, table_name, table_type, callback, user_data);
+	task->instance = instance;
+	return sq_storage_push_task(storage, task);
+}
+
+int   sq_storage_update_async(SqStorage          *storage,
+                              const char         *table_name,
+                              const SqType       *table_type,
+                              void               *instance,
+                              SqStorageAsyncFunc  callback,
+                              void               *user_data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_UPDATE, table_name, table_type, callback, user_data);
+	task->instance = instance;
+	return sq_storage_push_task(storage, task);
+}
+
+int   sq_storage_remove_async(SqStorage          *storage,
+                              const char         *table_name,
+                              const SqType       *table_type,
+                              int64_t             id,
+                              SqStorageAsyncFunc  callback,
+                              void               *user_data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_REMOVE, table_name, table_type, callback, user_data);
+	task->id = id;
+	return sq_storage_push_task(storage, task);
+}
+
+int   sq_storage_remove_all_async(SqStorage          *storage,
+                                  const char         *table_name,
+                                  const char         *sql_where_having,
+                                  SqStorageAsyncFunc  callback,
+                                  void               *user_data)
+{
+	SqStorageTask *task;
+
+	task = sq_storage_task_new(SQ_STORAGE_TASK_REMOVE_ALL, table_name, NULL, callback, user_data);
+	task->sql_where_having = (sql_where_having) ? strdup(sql_where_having) : NULL;
+	return sq_storage_push_task(storage, task);
+}
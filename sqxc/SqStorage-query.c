@@ -16,6 +16,8 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif
 #include <stdio.h>             // snprintf(), fprintf(), stderr
+#include <string.h>            // strncasecmp()
+#include <ctype.h>             // isspace()
 
 #include <sqxc/SqError.h>
 #include <sqxc/SqType.h>
@@ -25,6 +27,7 @@
 
 #ifdef _MSC_VER
 #define snprintf     _snprintf
+#define strncasecmp  _strnicmp
 #endif
 
 // used by sq_storage_setup_query()
@@ -98,7 +101,7 @@ SqType* sq_storage_setup_query(SqStorage *storage, SqQuery *query, SqTypeJoint *
 			if (n_table > 1) {
 				// add "SELECT table.column AS table_as_name.column" in query
 				sq_query_select_table_as(query, table, names.data[index+1],
-				                         storage->db->info->quote.identifier);
+				                         sq_storage_db_info(storage)->quote.identifier);
 			}
 #if SQ_CONFIG_QUERY_ONLY_COLUMN
 			// There is single table name in 'query'
@@ -110,14 +113,14 @@ SqType* sq_storage_setup_query(SqStorage *storage, SqQuery *query, SqTypeJoint *
 					// SELECT length(columnName) as "length(columnName)"
 					if (column->bit_field & SQB_COLUMN_QUERY) {
 						sq_query_select(query, column->name);
-						char *temp = to_quoted_str(column->name, storage->db->info->quote.identifier, NULL);
+						char *temp = to_quoted_str(column->name, sq_storage_db_info(storage)->quote.identifier, NULL);
 						sq_query_as(query, temp);
 						free(temp);
 					}
 				}
 				// for MySQL
 				// SELECT `tableName`.*
-				char *temp = to_quoted_str(table->name, storage->db->info->quote.identifier, ".*");
+				char *temp = to_quoted_str(table->name, sq_storage_db_info(storage)->quote.identifier, ".*");
 				sq_query_select(query, temp);
 				free(temp);
 			}
@@ -142,35 +145,102 @@ void *sq_storage_query(SqStorage    *storage,
                        const SqType *table_type,
                        const SqType *container_type)
 {
+	SqStorageContext *context, local;
+	SqPtrArray  tables;
 	Sqxc       *xcvalue;
+	void       *instance;
+	uint64_t    version = 0;
+	bool        use_cache = false;
+	bool        has_tables = false;
 	int         code;
+	int         command;
+
+	// SELECT statement can be executed by read-only connection
+	command = sq_query_get_command(query);
+	if (command == SQ_QUERY_CMD_SELECT || command == SQ_QUERY_CMD_NONE)
+		context = sq_storage_acquire_read(storage, &local);
+	else
+		context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return NULL;
 
 	if (container_type == NULL)
 		container_type = storage->container_default;
 	if (table_type == NULL) {
-		table_type = sq_storage_setup_query(storage, query, storage->joint_default);
-		if (table_type == NULL)
+		table_type = sq_storage_setup_query(storage, query, context->joint);
+		if (table_type == NULL) {
+			sq_storage_release(storage, context);
 			return NULL;
+		}
+	}
+
+	use_cache = storage->query_cache && (command == SQ_QUERY_CMD_SELECT || command == SQ_QUERY_CMD_NONE);
+	// names of tables are used by SqQueryCache and SqMetrics
+	if (use_cache || storage->metrics) {
+		sq_ptr_array_init(&tables, 8, NULL);
+		// keep table names and remove their as names
+		code = sq_query_get_table_as_names(query, &tables);
+		for (int index = 0;  index < code;  index++)
+			tables.data[index] = tables.data[index * 2];
+		tables.length = code;
+		has_tables = true;
+		// SqMetrics records statement with the first table
+		context->table_name = (code > 0) ? tables.data[0] : NULL;
+	}
+	context->operation = SQ_METRICS_QUERY;
+
+	// find result of the same SELECT statement in SqQueryCache
+	if (use_cache) {
+		for (unsigned int index = 0;  index < tables.length;  index++) {
+			if (sq_storage_is_changed(storage, tables.data[index])) {
+				use_cache = false;
+				break;
+			}
+		}
+		if (use_cache) {
+			instance = sq_query_cache_get(storage->query_cache, sq_query_c(query),
+			                              table_type, container_type, &version);
+			if (instance) {
+				sq_ptr_array_final(&tables);
+				sq_storage_release(storage, context);
+				return instance;
+			}
+		}
 	}
 
 	// destination of input
-	xcvalue = (Sqxc*) storage->xc_input;
+	xcvalue = (Sqxc*) context->xc_input;
 	sqxc_value_element(xcvalue)   = table_type;
 	sqxc_value_container(xcvalue) = container_type;
 	sqxc_value_instance(xcvalue)  = NULL;
 
 	// execute SQL statement and get result
 	sqxc_ready(xcvalue, NULL);
-	code = sqdb_exec(storage->db, sq_query_c(query), xcvalue, NULL);
+	code = sqdb_exec(context->db, sq_query_c(query), xcvalue, NULL);
 	sqxc_finish(xcvalue, NULL);
+	instance = sqxc_value_instance(xcvalue);
 	if (code != SQCODE_OK) {
 //		storage->xc_input->code = code;
 		sq_type_final_instance(container_type ? container_type : table_type,
-		                       sqxc_value_instance(xcvalue), false);
-		free(sqxc_value_instance(xcvalue));
-		sqxc_value_instance(xcvalue) = NULL;
+		                       instance, false);
+		free(instance);
+		instance = NULL;
+	}
+	sq_storage_release(storage, context);
+	if (use_cache) {
+		sq_query_cache_put(storage->query_cache, sq_query_c(query), table_type, container_type,
+		                   instance, (const char**)tables.data, tables.length, version);
 	}
-	return sqxc_value_instance(xcvalue);
+	if (has_tables)
+		sq_ptr_array_final(&tables);
+	// tables that are changed by statement are unknown, remove all rows in caches
+	if (command != SQ_QUERY_CMD_SELECT && command != SQ_QUERY_CMD_NONE) {
+		if (storage->row_cache)
+			sq_row_cache_clear(storage->row_cache, NULL);
+		if (storage->query_cache)
+			sq_query_cache_invalidate(storage->query_cache, NULL);
+	}
+	return instance;
 }
 
 void *sq_storage_query_raw(SqStorage    *storage,
@@ -178,7 +248,9 @@ void *sq_storage_query_raw(SqStorage    *storage,
                            const SqType *table_type,
                            const SqType *container_type)
 {
+	SqStorageContext *context, local;
 	Sqxc       *xcvalue;
+	void       *instance;
 	int         code;
 
 #ifndef NDEBUG
@@ -195,22 +267,44 @@ void *sq_storage_query_raw(SqStorage    *storage,
 		return NULL;
 	}
 
+	// SELECT statement can be executed by read-only connection
+	while (isspace((unsigned char)*query_str))
+		query_str++;
+	if (strncasecmp(query_str, "SELECT", 6) == 0)
+		context = sq_storage_acquire_read(storage, &local);
+	else
+		context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return NULL;
+	// SqMetrics records statement without table name
+	context->operation  = SQ_METRICS_QUERY;
+	context->table_name = NULL;
+
 	// destination of input
-	xcvalue = (Sqxc*) storage->xc_input;
+	xcvalue = (Sqxc*) context->xc_input;
 	sqxc_value_element(xcvalue)   = table_type;
 	sqxc_value_container(xcvalue) = container_type;
 	sqxc_value_instance(xcvalue)  = NULL;
 
 	// execute SQL statement and get result
 	sqxc_ready(xcvalue, NULL);
-	code = sqdb_exec(storage->db, query_str, xcvalue, NULL);
+	code = sqdb_exec(context->db, query_str, xcvalue, NULL);
 	sqxc_finish(xcvalue, NULL);
+	instance = sqxc_value_instance(xcvalue);
 	if (code != SQCODE_OK) {
 //		storage->xc_input->code = code;
 		sq_type_final_instance(container_type ? container_type : table_type,
-		                       sqxc_value_instance(xcvalue), false);
-		free(sqxc_value_instance(xcvalue));
-		sqxc_value_instance(xcvalue) = NULL;
+		                       instance, false);
+		free(instance);
+		instance = NULL;
+	}
+	sq_storage_release(storage, context);
+	// tables that are changed by statement are unknown, remove all rows in caches
+	if (strncasecmp(query_str, "SELECT", 6) != 0) {
+		if (storage->row_cache)
+			sq_row_cache_clear(storage->row_cache, NULL);
+		if (storage->query_cache)
+			sq_query_cache_invalidate(storage->query_cache, NULL);
 	}
-	return sqxc_value_instance(xcvalue);
+	return instance;
 }
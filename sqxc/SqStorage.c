@@ -19,6 +19,7 @@
 #include <stdint.h>            // __WORDSIZE  for Apple Developer
 #include <stdarg.h>            // va_list, va_start, va_end, va_arg, etc.
 #include <stdio.h>             // snprintf(), fprintf(), stderr
+#include <string.h>            // strdup()
 #include <inttypes.h>          // PRId64, PRIu64
 
 #include <sqxc/SqError.h>
@@ -27,15 +28,47 @@
 #include <sqxc/SqxcValue.h>
 #if SQ_CONFIG_HAVE_JSON
 #include <sqxc/SqxcJson.h>
+#if SQ_CONFIG_HAVE_MYSQL
+#include <sqxc/SqdbMysql.h>    // SqdbMysql::server_version
+#endif
 #endif
 
 #ifdef _MSC_VER
 #define snprintf     _snprintf
+#define strdup       _strdup
 #endif  // _MSC_VER
 
 #define SQ_STORAGE_SCHEMA_INITIAL_VER        0
 
+// set current operation of context for SqMetrics
+#define sq_storage_set_operation(context, op, table)    \
+		((context)->operation = (op), (context)->table_name = (table))
+
 static int  print_where_column(const SqColumn *column, void *instance, SqBuffer *buf, const char quote[2]);
+static int  sq_storage_exec_id(SqStorageContext *context, const char *sql, int64_t id, Sqxc *xc);
+static int  sq_storage_end_trans(SqStorage *storage, const char *sql);
+static int64_t  sq_storage_update_context(SqStorageContext *context,
+                                          const char       *table_name,
+                                          const SqType     *table_type,
+                                          void             *instance);
+static SqStorageContext *sq_storage_context_new(SqStorage *storage);
+static void sq_storage_context_free(SqStorageContext *context);
+static bool  sq_storage_get_id(const SqColumn *primary, void *instance, int64_t *id);
+static void *sq_storage_map_find(SqStorage *storage, const char *table_name, const SqType *table_type, int64_t id);
+static void  sq_storage_map_add(SqStorage *storage, SqStorageContext *context,
+                                const char *table_name, const SqType *table_type, void *instance, int64_t id);
+static void  sq_storage_map_add_all(SqStorage *storage, SqStorageContext *context, const char *table_name,
+                                    const SqType *table_type, const SqType *container_type, void *container);
+static void  sq_storage_map_remove(SqStorage *storage, const char *table_name, int64_t id);
+static void  sq_storage_map_remove_instance(SqStorage *storage, const char *table_name,
+                                            const SqType *table_type, void *instance);
+static void  sq_storage_map_clear(SqStorage *storage, const char *table_name);
+static SqStrArray *sq_storage_cache_changed(SqStorage *storage);
+static void  sq_storage_cache_remove(SqStorage *storage, const char *table_name, int64_t id);
+static void  sq_storage_cache_clear(SqStorage *storage, const char *table_name);
+static void  sq_storage_cache_end_trans(SqStorage *storage, SqStrArray *changed);
+static void  sq_storage_trace_attach(SqStorage *storage, SqStorageContext *context);
+static void  sq_storage_trace_detach(SqStorageContext *context);
 static int  sqxc_sql_set_columns(SqxcSql      *xcsql,
                                  const SqType *table_type,
                                  const char   *sql_where_having,
@@ -46,6 +79,20 @@ static int  sqxc_sql_set_fields(SqxcSql      *xcsql,
                                 const char   *sql_where_having,
                                 va_list       arg_list);
 #endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
+static bool  sq_storage_write_conflict(Sqdb         *db,
+                                       const SqType *table_type,
+                                       SqBuffer     *buffer,
+                                       va_list       arg_list);
+static int64_t sq_storage_upsert_data(SqStorage    *storage,
+                                      const char   *table_name,
+                                      const SqType *table_type,
+                                      const SqType *container_type,
+                                      void         *data,
+                                      va_list       arg_list);
+static int   sq_storage_unique_ids(const int64_t *ids, int n_ids, int64_t *unique);
+static void  sq_storage_write_ids(SqBuffer *buf, const int64_t *ids, int n_ids);
+static void  sq_storage_write_order(Sqdb *db, SqBuffer *buf, const char *primary_name,
+                                    const int64_t *ids, int n_ids);
 
 void  sq_storage_init(SqStorage *storage, Sqdb *db)
 {
@@ -65,10 +112,31 @@ void  sq_storage_init(SqStorage *storage, Sqdb *db)
 	sqxc_insert(storage->xc_input,  sqxc_new(SQXC_INFO_JSON_PARSER), -1);
 	sqxc_insert(storage->xc_output, sqxc_new(SQXC_INFO_JSON_WRITER), -1);
 #endif
+
+	// multi-threaded SqStorage
+	storage->pool = NULL;
+	storage->pool_read = NULL;
+	storage->workers = NULL;
+	storage->group_rows = 0;
+	storage->group_delay = 0;
+	storage->identity_map = NULL;
+	storage->row_cache = NULL;
+	storage->query_cache = NULL;
+	storage->metrics = NULL;
+	sq_str_array_init(&storage->changed, 8);
+	storage->in_trans = false;
+	sq_mutex_init(&storage->mutex);
+	sq_ptr_array_init(&storage->contexts, 8, NULL);
+	sq_ptr_array_init(&storage->pinned, 8, NULL);
 }
 
 void  sq_storage_final(SqStorage *storage)
 {
+	SqStorageContext *context;
+
+	// wait for asynchronous tasks
+	sq_storage_stop_workers(storage);
+
 	sq_schema_free(storage->schema);
 	sq_ptr_array_final(&storage->tables);
 
@@ -76,6 +144,31 @@ void  sq_storage_final(SqStorage *storage)
 
 	sqxc_free_chain(storage->xc_input);
 	sqxc_free_chain(storage->xc_output);
+
+	// multi-threaded SqStorage
+#ifndef NDEBUG
+	if (storage->pinned.length > 0) {
+		fprintf(stderr, "%s: %d transactions are not finished.\n",
+		        "sq_storage_final()", storage->pinned.length);
+	}
+#endif
+	for (unsigned int index = 0;  index < storage->pinned.length;  index++) {
+		context = storage->pinned.data[index];
+		// connection is in transaction, don't return it to pool.
+		sqdb_pool_discard(context->pool, context->db);
+		sq_storage_context_free(context);
+	}
+	for (unsigned int index = 0;  index < storage->contexts.length;  index++)
+		sq_storage_context_free(storage->contexts.data[index]);
+	sq_ptr_array_final(&storage->pinned);
+	sq_ptr_array_final(&storage->contexts);
+	sq_mutex_final(&storage->mutex);
+
+	if (storage->identity_map) {
+		sq_identity_map_final(storage->identity_map);
+		free(storage->identity_map);
+	}
+	sq_str_array_final(&storage->changed);
 }
 
 SqStorage *sq_storage_new(Sqdb *db)
@@ -94,19 +187,100 @@ void  sq_storage_free(SqStorage *storage)
 	free(storage);
 }
 
+void  sq_storage_init_pool(SqStorage *storage, SqdbPool *pool)
+{
+	sq_storage_init(storage, NULL);
+	storage->pool = pool;
+}
+
+SqStorage *sq_storage_new_pool(SqdbPool *pool)
+{
+	SqStorage *storage;
+
+	storage = malloc(sizeof(SqStorage));
+	sq_storage_init_pool(storage, pool);
+
+	return storage;
+}
+
+void  sq_storage_set_pool_read(SqStorage *storage, SqdbPool *pool_read)
+{
+#ifndef NDEBUG
+	if (storage->pool == NULL) {
+		fprintf(stderr, "%s: 'pool_read' is not used by SqStorage without SqdbPool.\n",
+		        "sq_storage_set_pool_read()");
+	}
+#endif
+	storage->pool_read = pool_read;
+}
+
+void  sq_storage_set_identity_map(SqStorage *storage, int capacity)
+{
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+
+	if (storage->identity_map) {
+		sq_identity_map_final(storage->identity_map);
+		free(storage->identity_map);
+		storage->identity_map = NULL;
+	}
+	if (capacity >= 0) {
+		storage->identity_map = malloc(sizeof(SqIdentityMap));
+		sq_identity_map_init(storage->identity_map, capacity);
+	}
+
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+}
+
+void  sq_storage_set_row_cache(SqStorage *storage, SqRowCache *row_cache)
+{
+	storage->row_cache = row_cache;
+}
+
+void  sq_storage_set_query_cache(SqStorage *storage, SqQueryCache *query_cache)
+{
+	storage->query_cache = query_cache;
+}
+
+void  sq_storage_set_metrics(SqStorage *storage, SqMetrics *metrics)
+{
+	storage->metrics = metrics;
+}
+
 int   sq_storage_open(SqStorage *storage, const char *database_name)
 {
-	return sqdb_open(storage->db, database_name);
+	int   code;
+
+	if (storage->pool == NULL)
+		return sqdb_open(storage->db, database_name);
+	// open writer before readers. e.g. SQLite read-only connection can't create database file.
+	code = sqdb_pool_open(storage->pool, database_name);
+	if (code == SQCODE_OK && storage->pool_read)
+		code = sqdb_pool_open(storage->pool_read, database_name);
+	return code;
 }
 
 int   sq_storage_close(SqStorage *storage)
 {
-	return sqdb_close(storage->db);
+	if (storage->pool == NULL)
+		return sqdb_close(storage->db);
+	if (storage->pool_read)
+		sqdb_pool_close(storage->pool_read);
+	return sqdb_pool_close(storage->pool);
 }
 
 int   sq_storage_migrate(SqStorage *storage, SqSchema *schema)
 {
-	return sqdb_migrate(storage->db, storage->schema, schema);
+	SqStorageContext *context, local;
+	int               code;
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return SQCODE_ERROR;
+	code = sqdb_migrate(context->db, storage->schema, schema);
+	sq_storage_release(storage, context);
+	return code;
 }
 
 void *sq_storage_get(SqStorage    *storage,
@@ -114,9 +288,13 @@ void *sq_storage_get(SqStorage    *storage,
                      const SqType *table_type,
                      int64_t       id)
 {
+	SqStorageContext *context, local;
 	SqBuffer *buf;
 	Sqxc     *xcvalue;
 	SqColumn *primary = NULL;
+	void     *instance;
+	uint64_t  version;
+	bool      use_cache = false;
 	union {
 		SqTable  *table;
 		int       len;
@@ -137,8 +315,31 @@ void *sq_storage_get(SqStorage    *storage,
 		table_type = temp.table->type;
 	}
 
+	// find instance in identity map before querying database
+	if (storage->identity_map) {
+		instance = sq_storage_map_find(storage, table_name, table_type, id);
+		if (instance)
+			return instance;
+	}
+	// find row in SqRowCache. Table that is changed in current transaction doesn't use it.
+	if (storage->row_cache && sq_storage_is_changed(storage, table_name) == false) {
+		instance = sq_row_cache_get(storage->row_cache, table_name, id, table_type, &version);
+		if (instance)
+			return instance;
+		// current thread must put row to SqRowCache, other threads may wait for it.
+		use_cache = true;
+	}
+
+	context = sq_storage_acquire_read(storage, &local);
+	if (context == NULL) {
+		if (use_cache)
+			sq_row_cache_put(storage->row_cache, table_name, id, table_type, NULL, version);
+		return NULL;
+	}
+	sq_storage_set_operation(context, SQ_METRICS_GET, table_name);
+
 	// destination of input
-	xcvalue = storage->xc_input;
+	xcvalue = context->xc_input;
 	sqxc_value_element(xcvalue)   = table_type;
 	sqxc_value_container(xcvalue) = NULL;
 	sqxc_value_instance(xcvalue)  = NULL;
@@ -147,22 +348,35 @@ void *sq_storage_get(SqStorage    *storage,
 	buf = sqxc_get_buffer(xcvalue);
 	buf->writed = 0;
 	// select query-only columns before others if table has query-only column
-	primary = sqdb_sql_select(storage->db, buf, table_name, table_type);
+	primary = sqdb_sql_select(context->db, buf, table_name, table_type);
 	// WHERE primaryKey=...
 	if (primary == NULL)
 		primary = sq_table_get_primary(NULL, table_type);
-	print_where_column(primary, &id, buf, storage->db->info->quote.identifier);
 
 	sqxc_ready(xcvalue, NULL);
-	temp.code = sqdb_exec(storage->db, buf->mem, xcvalue, NULL);
+	if (context->db->info->prepare) {
+		// WHERE primaryKey=?
+		print_where_column(primary, NULL, buf, context->db->info->quote.identifier);
+		temp.code = sq_storage_exec_id(context, buf->mem, id, xcvalue);
+	}
+	else {
+		print_where_column(primary, &id, buf, context->db->info->quote.identifier);
+		temp.code = sqdb_exec(context->db, buf->mem, xcvalue, NULL);
+	}
 	sqxc_finish(xcvalue, NULL);
+	instance = sqxc_value_instance(xcvalue);
 	if (temp.code != SQCODE_OK) {
 //		storage->xc_input->code = temp.code;
-		sq_type_final_instance(table_type, sqxc_value_instance(xcvalue), false);
-		free(sqxc_value_instance(xcvalue));
-		sqxc_value_instance(xcvalue) = NULL;
+		sq_type_final_instance(table_type, instance, false);
+		free(instance);
+		instance = NULL;
 	}
-	return sqxc_value_instance(xcvalue);
+	else if (instance && storage->identity_map)
+		sq_storage_map_add(storage, context, table_name, table_type, instance, id);
+	sq_storage_release(storage, context);
+	if (use_cache)
+		sq_row_cache_put(storage->row_cache, table_name, id, table_type, instance, version);
+	return instance;
 }
 
 void *sq_storage_get_all(SqStorage    *storage,
@@ -171,7 +385,13 @@ void *sq_storage_get_all(SqStorage    *storage,
                          const SqType *container_type,
                          const char   *sql_where_having)
 {
+	SqStorageContext *context, local;
 	Sqxc     *xcvalue;
+	void     *instance;
+	uint64_t  version = 0;
+	uint64_t  query_version;
+	char     *sql = NULL;
+	bool      use_cache;
 	union {
 		SqBuffer *buf;
 		SqTable  *table;
@@ -192,9 +412,18 @@ void *sq_storage_get_all(SqStorage    *storage,
 	}
 	if (container_type == NULL)
 		container_type = (SqType*)storage->container_default;
+	// rows are put to SqRowCache if table is not changed since query starts
+	use_cache = storage->row_cache && sq_storage_is_changed(storage, table_name) == false;
+	if (use_cache)
+		version = sq_row_cache_version(storage->row_cache, table_name);
+
+	context = sq_storage_acquire_read(storage, &local);
+	if (context == NULL)
+		return NULL;
+	sq_storage_set_operation(context, SQ_METRICS_GET_ALL, table_name);
 
 	// destination of input
-	xcvalue = (Sqxc*) storage->xc_input;
+	xcvalue = (Sqxc*) context->xc_input;
 	sqxc_value_element(xcvalue)   = table_type;
 	sqxc_value_container(xcvalue) = container_type;
 	sqxc_value_instance(xcvalue)  = NULL;
@@ -203,70 +432,176 @@ void *sq_storage_get_all(SqStorage    *storage,
 	temp.buf = sqxc_get_buffer(xcvalue);
 	temp.buf->writed = 0;
 	// select query-only columns before others if table has query-only column
-	sqdb_sql_select(storage->db, temp.buf, table_name, table_type);
+	sqdb_sql_select(context->db, temp.buf, table_name, table_type);
 
 	// SQL WHERE ... HAVING ...
 	if (sql_where_having)
 		sq_buffer_write(temp.buf, sql_where_having);
 
+	// find result of the same SQL statement in SqQueryCache
+	if (storage->query_cache && sq_storage_is_changed(storage, table_name) == false) {
+		instance = sq_query_cache_get(storage->query_cache, temp.buf->mem,
+		                              table_type, container_type, &query_version);
+		if (instance) {
+			sq_storage_release(storage, context);
+			return instance;
+		}
+		// buffer may be used by Sqxc chain when result is parsed
+		sql = strdup(temp.buf->mem);
+	}
+
 	sqxc_ready(xcvalue, NULL);
-	temp.code = sqdb_exec(storage->db, temp.buf->mem, xcvalue, NULL);
+	temp.code = sqdb_exec(context->db, temp.buf->mem, xcvalue, NULL);
 	sqxc_finish(xcvalue, NULL);
+	instance = sqxc_value_instance(xcvalue);
 	if (temp.code != SQCODE_OK) {
 //		storage->xc_input->code = temp.code;
-		sq_type_final_instance(container_type, sqxc_value_instance(xcvalue), false);
-		free(sqxc_value_instance(xcvalue));
-		sqxc_value_instance(xcvalue) = NULL;
+		sq_type_final_instance(container_type, instance, false);
+		free(instance);
+		instance = NULL;
 	}
-	return sqxc_value_instance(xcvalue);
+	else if (instance && storage->identity_map)
+		sq_storage_map_add_all(storage, context, table_name, table_type, container_type, instance);
+	sq_storage_release(storage, context);
+	if (instance && use_cache)
+		sq_row_cache_put_all(storage->row_cache, table_name, table_type, container_type, instance, version);
+	if (sql) {
+		sq_query_cache_put(storage->query_cache, sql, table_type, container_type, instance,
+		                   &table_name, 1, query_version);
+		free(sql);
+	}
+	return instance;
 }
 
-int64_t sq_storage_insert(SqStorage    *storage,
-                          const char   *table_name,
-                          const SqType *table_type,
-                          void         *instance)
+void *sq_storage_get_many(SqStorage     *storage,
+                          const char    *table_name,
+                          const SqType  *table_type,
+                          const int64_t *ids,
+                          int            n_ids,
+                          const SqType  *container_type)
 {
-	union {
-		SqTable   *table;
-		Sqxc      *xcsql;
-	} temp;
+	SqStorageContext *context, local;
+	SqColumn *primary = NULL;
+	SqBuffer *buf;
+	Sqxc     *xcvalue;
+	void     *instance = NULL;
+	int64_t  *keys;
+	uint64_t  version = 0;
+	bool      use_cache;
+	int       n_keys;
+	int       count;
+	int       code = SQCODE_OK;
+	SqTable  *table;
 
 	if (table_type == NULL) {
 		// find SqTable by table_name
-		temp.table = sq_schema_find(storage->schema, table_name);
-		if (temp.table == NULL) {
+		table = sq_schema_find(storage->schema, table_name);
+		if (table == NULL) {
 #ifndef NDEBUG
 			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
-			        "sq_storage_insert()", table_name);
+			        "sq_storage_get_many()", table_name);
 #endif
-			return 0;
+			return NULL;
 		}
-		table_type = temp.table->type;
+		primary = table->primary_key;
+		table_type = table->type;
+	}
+	if (primary == NULL)
+		primary = sq_table_get_primary(NULL, table_type);
+	if (primary == NULL) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: table '%s' has no PRIMARY KEY.\n",
+		        "sq_storage_get_many()", table_name);
+#endif
+		return NULL;
 	}
+	if (container_type == NULL)
+		container_type = (SqType*)storage->container_default;
+	// rows are put to SqRowCache if table is not changed since query starts
+	use_cache = storage->row_cache && sq_storage_is_changed(storage, table_name) == false;
+	if (use_cache)
+		version = sq_row_cache_version(storage->row_cache, table_name);
 
-	// destination of output
-	temp.xcsql = storage->xc_output;
-	sqxc_sql_set_db(temp.xcsql, storage->db);
-	sqxc_ctrl(temp.xcsql, SQXC_SQL_CTRL_INSERT, table_name);
+	context = sq_storage_acquire_read(storage, &local);
+	if (context == NULL)
+		return NULL;
+	sq_storage_set_operation(context, SQ_METRICS_GET_MANY, table_name);
 
-	sqxc_ready(temp.xcsql, NULL);
-	table_type->write(instance, table_type, temp.xcsql);
-	sqxc_finish(temp.xcsql, NULL);
+	// every row is returned once even if its id is duplicated in 'ids'
+	keys = malloc(sizeof(int64_t) * (n_ids + 1));
+	n_keys = sq_storage_unique_ids(ids, n_ids, keys);
+
+	// destination of input
+	xcvalue = (Sqxc*) context->xc_input;
+	sqxc_value_element(xcvalue)   = table_type;
+	sqxc_value_container(xcvalue) = container_type;
+
+	// return empty container if there is no id
+	if (n_keys == 0)
+		instance = sq_type_init_instance(container_type, &instance, true);
+	// query SQ_CONFIG_STORAGE_MANY_KEYS ids per statement
+	for (int start = 0;  start < n_keys;  start += count) {
+		count = n_keys - start;
+		if (count > SQ_CONFIG_STORAGE_MANY_KEYS)
+			count = SQ_CONFIG_STORAGE_MANY_KEYS;
+
+		// SQL statement
+		buf = sqxc_get_buffer(xcvalue);
+		buf->writed = 0;
+		// select query-only columns before others if table has query-only column
+		sqdb_sql_select(context->db, buf, table_name, table_type);
+		// WHERE "id" IN (3,1,2)
+		sq_buffer_write(buf, "WHERE");
+		sqdb_sql_write_identifier(context->db, buf, primary->name, false);
+		sq_buffer_write(buf, "IN (");
+		sq_storage_write_ids(buf, keys + start, count);
+		sq_buffer_write_c(buf, ')');
+		// keep order of 'ids'
+		sq_storage_write_order(context->db, buf, primary->name, keys + start, count);
+
+		// rows of this statement are appended to container that is created by previous statement
+		sqxc_value_instance(xcvalue) = instance;
+		sqxc_ready(xcvalue, NULL);
+		code = sqdb_exec(context->db, buf->mem, xcvalue, NULL);
+		sqxc_finish(xcvalue, NULL);
+		instance = sqxc_value_instance(xcvalue);
+		// no row matches ids in this statement
+		if (code == SQCODE_NO_DATA)
+			code = SQCODE_OK;
+		else if (code != SQCODE_OK)
+			break;
+	}
+	free(keys);
 
-	// return the last inserted row id
-	return sqxc_sql_id(temp.xcsql);
+	if (code != SQCODE_OK) {
+		sq_type_final_instance(container_type, instance, false);
+		free(instance);
+		instance = NULL;
+	}
+	else if (instance && storage->identity_map)
+		sq_storage_map_add_all(storage, context, table_name, table_type, container_type, instance);
+	sq_storage_release(storage, context);
+	if (instance && use_cache)
+		sq_row_cache_put_all(storage->row_cache, table_name, table_type, container_type, instance, version);
+	return instance;
 }
 
-int   sq_storage_update(SqStorage    *storage,
-                        const char   *table_name,
-                        const SqType *table_type,
-                        void         *instance)
+void *sq_storage_copy_out(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          const SqType *container_type,
+                          const char   *sql_where_having)
 {
-	Sqxc      *xcsql;
-	SqBuffer  *buf;
+	SqStorageContext *context, local;
+	Sqxc       *xcvalue;
+	SqBuffer   *buf;
+	SqPtrArray  names;
+	SqColumn  **pcur;
+	SqColumn  **pend;
+	void       *instance;
 	union {
-		SqTable   *table;
-		SqColumn  *column;
+		SqTable *table;
+		int      code;
 	} temp;
 
 	if (table_type == NULL) {
@@ -275,48 +610,89 @@ int   sq_storage_update(SqStorage    *storage,
 		if (temp.table == NULL) {
 #ifndef NDEBUG
 			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
-			        "sq_storage_update()", table_name);
+			        "sq_storage_copy_out()", table_name);
 #endif
-			return 0;
+			return NULL;
 		}
 		table_type = temp.table->type;
 	}
+	// Database product doesn't support COPY TO STDOUT
+	if (sq_storage_db_info(storage)->copy_out == NULL)
+		return sq_storage_get_all(storage, table_name, table_type, container_type, sql_where_having);
+	if (container_type == NULL)
+		container_type = (SqType*)storage->container_default;
 
-	// destination of output
-	xcsql = storage->xc_output;
-	sqxc_sql_set_db(xcsql, storage->db);
-	if (sqxc_sql_condition(xcsql) == NULL) {
-		temp.column = sq_table_get_primary(NULL, table_type);
-		// SQL statement. Because input buffer doesn't use here, I use it temporary.
-		buf = sqxc_get_buffer(storage->xc_input);
-		buf->writed = 0;
-		print_where_column(temp.column, (char*)instance + temp.column->offset,
-		             buf, storage->db->info->quote.identifier);
-		sqxc_sql_condition(xcsql) = buf->mem;
+	context = sq_storage_acquire_read(storage, &local);
+	if (context == NULL)
+		return NULL;
+	sq_storage_set_operation(context, SQ_METRICS_GET_ALL, table_name);
+
+	// destination of input
+	xcvalue = (Sqxc*) context->xc_input;
+	sqxc_value_element(xcvalue)   = table_type;
+	sqxc_value_container(xcvalue) = container_type;
+	sqxc_value_instance(xcvalue)  = NULL;
+
+	// SQL statement
+	// COPY "table_name" ("column1","column2") TO STDOUT
+	// COPY (SELECT "column1","column2" FROM "table_name" WHERE ...) TO STDOUT
+	buf = sqxc_get_buffer(xcvalue);
+	buf->writed = 0;
+	if (sql_where_having == NULL) {
+		sq_buffer_write(buf, "COPY");
+		sqdb_sql_write_identifier(context->db, buf, table_name, false);
+		sq_buffer_write_c(buf, '(');
 	}
-	sqxc_ctrl(xcsql, SQXC_SQL_CTRL_UPDATE, table_name);
+	else
+		sq_buffer_write(buf, "COPY (SELECT");
 
-	sqxc_ready(xcsql, NULL);
-	table_type->write(instance, table_type, xcsql);
-	sqxc_finish(xcsql, NULL);
-	// free WHERE condition
-//	sqxc_sql_condition(temp.xcsql) = NULL;    // this has been done in sqxc_finish()
+	sq_ptr_array_init(&names, table_type->n_entry, NULL);
+	for (pcur = (SqColumn**)table_type->entry, pend = pcur + table_type->n_entry;  pcur < pend;  pcur++) {
+		// skip constraint and index
+		if (SQ_TYPE_IS_FAKE(pcur[0]->type))
+			continue;
+#if SQ_CONFIG_QUERY_ONLY_COLUMN
+		// skip query-only columns
+		if (pcur[0]->bit_field & SQB_COLUMN_QUERY)
+			continue;
+#endif
+		if (names.length > 0)
+			sq_buffer_write_c(buf, ',');
+		sqdb_sql_write_identifier(context->db, buf, pcur[0]->name, false);
+		sq_ptr_array_push(&names, (void*)pcur[0]->name);
+	}
 
-	// return number of rows changed
-	return (int)sqxc_sql_changes(xcsql);
+	if (sql_where_having) {
+		sq_buffer_write(buf, "FROM");
+		sqdb_sql_write_identifier(context->db, buf, table_name, false);
+		sq_buffer_write(buf, sql_where_having);
+	}
+	sq_buffer_write(buf, ") TO STDOUT");
+
+	sqxc_ready(xcvalue, NULL);
+	temp.code = sqdb_copy_out(context->db, buf->mem, (const char**)names.data, names.length, xcvalue);
+	sqxc_finish(xcvalue, NULL);
+	sq_ptr_array_final(&names);
+	instance = sqxc_value_instance(xcvalue);
+	if (temp.code != SQCODE_OK) {
+		sq_type_final_instance(container_type, instance, false);
+		free(instance);
+		instance = NULL;
+	}
+	sq_storage_release(storage, context);
+	return instance;
 }
 
-int64_t sq_storage_update_all(SqStorage    *storage,
-                              const char   *table_name,
-                              const SqType *table_type,
-                              void         *instance,
-                              const char   *sql_where_having,
-                              ...)
+int64_t sq_storage_insert(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          void         *instance)
 {
-	va_list  arg_list;
+	SqStorageContext *context, local;
+	int64_t    id;
 	union {
-		SqTable  *table;
-		SqxcSql  *xcsql;
+		SqTable   *table;
+		Sqxc      *xcsql;
 	} temp;
 
 	if (table_type == NULL) {
@@ -325,38 +701,52 @@ int64_t sq_storage_update_all(SqStorage    *storage,
 		if (temp.table == NULL) {
 #ifndef NDEBUG
 			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
-			        "sq_storage_update_all()", table_name);
+			        "sq_storage_insert()", table_name);
 #endif
 			return 0;
 		}
 		table_type = temp.table->type;
 	}
 
-	// set SqxcSql's variable for UPDATE command
-	temp.xcsql = (SqxcSql*)storage->xc_output;
-	va_start(arg_list, sql_where_having);
-	sqxc_sql_set_columns(temp.xcsql, table_type, sql_where_having, arg_list);
-	va_end(arg_list);
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_INSERT, table_name);
 
-	sq_storage_update(storage, table_name, table_type, instance);
-	// return number of rows changed
-	return temp.xcsql->changes;
-}
+	// destination of output
+	temp.xcsql = context->xc_output;
+	sqxc_sql_set_db(temp.xcsql, context->db);
+	sqxc_ctrl(temp.xcsql, SQXC_SQL_CTRL_INSERT, table_name);
 
-#if SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
+	sqxc_ready(temp.xcsql, NULL);
+	table_type->write(instance, table_type, temp.xcsql);
+	sqxc_finish(temp.xcsql, NULL);
 
-int64_t sq_storage_update_field(SqStorage    *storage,
-                                const char   *table_name,
-                                const SqType *table_type,
-                                void         *instance,
-                                const char   *sql_where_having,
-                                ...)
+	// the last inserted row id
+	id = sqxc_sql_id(temp.xcsql);
+	if (id > 0 && storage->identity_map)
+		sq_storage_map_add(storage, context, table_name, table_type, instance, id);
+	sq_storage_release(storage, context);
+	// SqRowCache may have row that was removed by other SqStorage. Results in SqQueryCache are out of date.
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_remove(storage, table_name, id);
+	return id;
+}
+
+int64_t sq_storage_copy_in(SqStorage    *storage,
+                           const char   *table_name,
+                           const SqType *table_type,
+                           const SqType *container_type,
+                           void         *container)
 {
-	va_list  arg_list;
+	SqStorageContext *context, local;
+	SqType    type_temp;
 	union {
-		SqTable  *table;
-		SqxcSql  *xcsql;
+		SqTable   *table;
+		Sqxc      *xc;
 	} temp;
+	Sqxc     *xcsql;
+	int64_t   changes;
 
 	if (table_type == NULL) {
 		// find SqTable by table_name
@@ -364,102 +754,667 @@ int64_t sq_storage_update_field(SqStorage    *storage,
 		if (temp.table == NULL) {
 #ifndef NDEBUG
 			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
-			        "sq_storage_update_field()", table_name);
+			        "sq_storage_copy_in()", table_name);
 #endif
 			return 0;
 		}
 		table_type = temp.table->type;
 	}
+	if (container_type == NULL)
+		container_type = (SqType*)storage->container_default;
+	// container_type->write() gets element type from SqType::entry if SqType::n_entry == -1
+	if (container_type->n_entry != -1 || container_type->entry == NULL) {
+		type_temp = *container_type;
+		type_temp.entry   = (SqEntry**)table_type;
+		type_temp.n_entry = -1;
+		container_type = &type_temp;
+	}
 
-	// set SqxcSql's variable for UPDATE command
-	temp.xcsql = (SqxcSql*)storage->xc_output;
-	va_start(arg_list, sql_where_having);
-	sqxc_sql_set_fields(temp.xcsql, table_type, sql_where_having, arg_list);
-	va_end(arg_list);
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_INSERT, table_name);
 
-	sq_storage_update(storage, table_name, table_type, instance);
-	// return number of rows changed
-	return temp.xcsql->changes;
+	// destination of output
+	xcsql = context->xc_output;
+	sqxc_sql_set_db(xcsql, context->db);
+	if (context->db->info->copy_begin)
+		sqxc_ctrl(xcsql, SQXC_SQL_CTRL_COPY, table_name);
+	else
+		sqxc_ctrl(xcsql, SQXC_SQL_CTRL_INSERT, table_name);
+
+	sqxc_ready(xcsql, NULL);
+	temp.xc = container_type->write(container, container_type, xcsql);
+	// abort COPY if error occurred
+	if (sqxc_finish(xcsql, (temp.xc->code == SQCODE_OK) ? NULL : "sq_storage_copy_in() failed") != SQCODE_OK)
+		changes = 0;
+	else {
+		// number of rows inserted
+		changes = sqxc_sql_changes(xcsql);
+	}
+	sq_storage_release(storage, context);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	return changes;
 }
-#endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 
-void  sq_storage_remove(SqStorage    *storage,
-                        const char   *table_name,
-                        const SqType *table_type,
-                        int64_t       id)
+SqArray *sq_storage_insert_all(SqStorage    *storage,
+                               const char   *table_name,
+                               const SqType *table_type,
+                               const SqType *container_type,
+                               void         *container)
 {
-	SqBuffer  *buf;
-	SqColumn  *primary = NULL;
-	SqTable   *table;
+	SqStorageContext *context, local;
+	SqType    type_temp;
+	SqTable  *table;
+	SqArray  *ids;
+	Sqxc     *xcsql;
 
 	if (table_type == NULL) {
 		// find SqTable by table_name
 		table = sq_schema_find(storage->schema, table_name);
-		if (table) {
-			table_type = table->type;
-			primary = table->primary_key;
-		}
+		if (table == NULL) {
 #ifndef NDEBUG
-		else
 			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
-			        "sq_storage_remove()", table_name);
+			        "sq_storage_insert_all()", table_name);
 #endif
+			return NULL;
+		}
+		table_type = table->type;
+	}
+	if (container_type == NULL)
+		container_type = (SqType*)storage->container_default;
+	// container_type->write() gets element type from SqType::entry if SqType::n_entry == -1
+	if (container_type->n_entry != -1 || container_type->entry == NULL) {
+		type_temp = *container_type;
+		type_temp.entry   = (SqEntry**)table_type;
+		type_temp.n_entry = -1;
+		container_type = &type_temp;
 	}
 
-	if (primary == NULL)
-		primary = table_type ? sq_table_get_primary(NULL, table_type) : NULL;
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return NULL;
+	sq_storage_set_operation(context, SQ_METRICS_INSERT, table_name);
+	ids = sq_array_new(sizeof(int64_t), 16);
 
-	buf = sqxc_get_buffer(storage->xc_output);
-	buf->writed = 0;
-	sqdb_sql_delete(storage->db, buf, table_name);
-	print_where_column(primary, &id, buf, storage->db->info->quote.identifier);
-	sqdb_exec(storage->db, buf->mem, NULL, NULL);
-}
+	// destination of output. SqxcSql appends ids of inserted rows to 'ids'.
+	xcsql = context->xc_output;
+	sqxc_sql_set_db(xcsql, context->db);
+	sqxc_ctrl(xcsql, SQXC_SQL_CTRL_INSERT, table_name);
+	((SqxcSql*)xcsql)->ids = ids;
 
-void  sq_storage_remove_all(SqStorage    *storage,
-                            const char   *table_name,
-                            const char   *sql_where_having)
-{
-	SqBuffer  *buf;
+	sqxc_ready(xcsql, NULL);
+	container_type->write(container, container_type, xcsql);
+	sqxc_finish(xcsql, NULL);
+	((SqxcSql*)xcsql)->ids = NULL;
 
-	buf = sqxc_get_buffer(storage->xc_output);
-	buf->writed = 0;
-	sqdb_sql_delete(storage->db, buf, table_name);
-	if (sql_where_having)
-		sq_buffer_write(buf, sql_where_having);
-	sqdb_exec(storage->db, buf->mem, NULL, NULL);
+	sq_storage_release(storage, context);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	return ids;
 }
 
-int  sq_storage_begin_trans(SqStorage *storage)
+int64_t sq_storage_upsert(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          void         *instance,
+                          ...)
 {
-	return SQ_STORAGE_BEGIN_TRANS(storage);
-}
+	va_list  arg_list;
+	int64_t  changes;
 
-int  sq_storage_commit_trans(SqStorage *storage)
-{
-	return SQ_STORAGE_COMMIT_TRANS(storage);
+	va_start(arg_list, instance);
+	changes = sq_storage_upsert_data(storage, table_name, table_type, NULL, instance, arg_list);
+	va_end(arg_list);
+	return changes;
 }
 
-int  sq_storage_rollback_trans(SqStorage *storage)
+int64_t sq_storage_upsert_all(SqStorage    *storage,
+                              const char   *table_name,
+                              const SqType *table_type,
+                              const SqType *container_type,
+                              void         *container,
+                              ...)
 {
-	return SQ_STORAGE_ROLLBACK_TRANS(storage);
-}
+	va_list  arg_list;
+	int64_t  changes;
 
-// ------------------------------------
+	if (container_type == NULL)
+		container_type = (SqType*)storage->container_default;
+	va_start(arg_list, container);
+	changes = sq_storage_upsert_data(storage, table_name, table_type, container_type, container, arg_list);
+	va_end(arg_list);
+	return changes;
+}
 
-SqTable  *sq_storage_find_by_type(SqStorage *storage, const char *type_name)
+// if 'container_type' is NULL, 'data' is instance. Otherwise 'data' is container.
+static int64_t sq_storage_upsert_data(SqStorage    *storage,
+                                      const char   *table_name,
+                                      const SqType *table_type,
+                                      const SqType *container_type,
+                                      void         *data,
+                                      va_list       arg_list)
 {
-	SqPtrArray *type_tables;      // sorted by SqType::name
-	SqPtrArray *schema_tables;    // sorted by SqTable::name
-	int         count;
-//	SqTable   **addr;
-	void      **addr;
+	SqStorageContext *context, local;
+	SqType    type_temp;
+	SqTable  *table;
+	SqBuffer  conflict;
+	Sqxc     *xcsql;
+	int64_t   changes;
 
-	type_tables = &storage->tables;
-	schema_tables = sq_type_entry_array(storage->schema->type);
-	// if version is not the same
-	if (storage->tables_version != storage->schema->version) {
-		storage->tables_version  = storage->schema->version;
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		table = sq_schema_find(storage->schema, table_name);
+		if (table == NULL) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_upsert()", table_name);
+#endif
+			return 0;
+		}
+		table_type = table->type;
+	}
+	// container_type->write() gets element type from SqType::entry if SqType::n_entry == -1
+	if (container_type && (container_type->n_entry != -1 || container_type->entry == NULL)) {
+		type_temp = *container_type;
+		type_temp.entry   = (SqEntry**)table_type;
+		type_temp.n_entry = -1;
+		container_type = &type_temp;
+	}
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_INSERT, table_name);
+
+	sq_buffer_init(&conflict);
+	if (sq_storage_write_conflict(context->db, table_type, &conflict, arg_list) == false) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: table '%s' has no PRIMARY KEY or UNIQUE constraint.\n",
+		        "sq_storage_upsert()", table_name);
+#endif
+		sq_buffer_final(&conflict);
+		sq_storage_release(storage, context);
+		return 0;
+	}
+
+	// destination of output. SqxcSql appends conflict clause to INSERT statement.
+	xcsql = context->xc_output;
+	sqxc_sql_set_db(xcsql, context->db);
+	sqxc_ctrl(xcsql, SQXC_SQL_CTRL_INSERT, table_name);
+	((SqxcSql*)xcsql)->suffix = conflict.mem;
+
+	sqxc_ready(xcsql, NULL);
+	if (container_type)
+		container_type->write(data, container_type, xcsql);
+	else
+		table_type->write(data, table_type, xcsql);
+	if (sqxc_finish(xcsql, NULL) != SQCODE_OK)
+		changes = 0;
+	else
+		changes = sqxc_sql_changes(xcsql);
+	((SqxcSql*)xcsql)->suffix = NULL;
+	sq_buffer_final(&conflict);
+
+	sq_storage_release(storage, context);
+	// updated rows are unknown, remove all rows of table in identity map
+	if (storage->identity_map)
+		sq_storage_map_clear(storage, table_name);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	return changes;
+}
+
+int   sq_storage_update(SqStorage    *storage,
+                        const char   *table_name,
+                        const SqType *table_type,
+                        void         *instance)
+{
+	SqStorageContext *context, local;
+	SqTable   *table;
+	int64_t    changes;
+	int64_t    id;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		table = sq_schema_find(storage->schema, table_name);
+		if (table == NULL) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_update()", table_name);
+#endif
+			return 0;
+		}
+		table_type = table->type;
+	}
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_UPDATE, table_name);
+	changes = sq_storage_update_context(context, table_name, table_type, instance);
+	sq_storage_release(storage, context);
+	// row in identity map is out of date
+	if (storage->identity_map)
+		sq_storage_map_remove_instance(storage, table_name, table_type, instance);
+	if (storage->row_cache || storage->query_cache) {
+		if (sq_storage_get_id(sq_table_get_primary(NULL, table_type), instance, &id))
+			sq_storage_cache_remove(storage, table_name, id);
+		else
+			sq_storage_cache_clear(storage, table_name);
+	}
+	// return number of rows changed
+	return (int)changes;
+}
+
+int64_t sq_storage_update_all(SqStorage    *storage,
+                              const char   *table_name,
+                              const SqType *table_type,
+                              void         *instance,
+                              const char   *sql_where_having,
+                              ...)
+{
+	SqStorageContext *context, local;
+	va_list  arg_list;
+	int64_t  changes;
+	union {
+		SqTable  *table;
+		SqxcSql  *xcsql;
+	} temp;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		temp.table = sq_schema_find(storage->schema, table_name);
+		if (temp.table == NULL) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_update_all()", table_name);
+#endif
+			return 0;
+		}
+		table_type = temp.table->type;
+	}
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_UPDATE, table_name);
+
+	// set SqxcSql's variable for UPDATE command
+	temp.xcsql = (SqxcSql*)context->xc_output;
+	va_start(arg_list, sql_where_having);
+	sqxc_sql_set_columns(temp.xcsql, table_type, sql_where_having, arg_list);
+	va_end(arg_list);
+
+	changes = sq_storage_update_context(context, table_name, table_type, instance);
+	sq_storage_release(storage, context);
+	// rows that match 'sql_where_having' are unknown, remove all rows of table in identity map
+	if (storage->identity_map)
+		sq_storage_map_clear(storage, table_name);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	// return number of rows changed
+	return changes;
+}
+
+int64_t sq_storage_update_many(SqStorage    *storage,
+                               const char   *table_name,
+                               const SqType *table_type,
+                               const SqType *container_type,
+                               void         *container,
+                               ...)
+{
+	SqStorageContext *context, local;
+	SqType    type_temp;
+	SqTable  *table;
+	Sqxc     *xcsql;
+	va_list   arg_list;
+	int64_t   changes;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		table = sq_schema_find(storage->schema, table_name);
+		if (table == NULL) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_update_many()", table_name);
+#endif
+			return 0;
+		}
+		table_type = table->type;
+	}
+	if (container_type == NULL)
+		container_type = (SqType*)storage->container_default;
+	// container_type->write() gets element type from SqType::entry if SqType::n_entry == -1
+	if (container_type->n_entry != -1 || container_type->entry == NULL) {
+		type_temp = *container_type;
+		type_temp.entry   = (SqEntry**)table_type;
+		type_temp.n_entry = -1;
+		container_type = &type_temp;
+	}
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_UPDATE, table_name);
+
+	// destination of output. set SqxcSql's variable for UPDATE command
+	xcsql = context->xc_output;
+	va_start(arg_list, container);
+	sqxc_sql_set_columns((SqxcSql*)xcsql, table_type, NULL, arg_list);
+	va_end(arg_list);
+	sqxc_sql_set_db(xcsql, context->db);
+	sqxc_ctrl(xcsql, SQXC_SQL_CTRL_UPDATE_MANY, table_name);
+
+	sqxc_ready(xcsql, NULL);
+	container_type->write(container, container_type, xcsql);
+	// number of rows changed by split statements is kept if error occurred
+	sqxc_finish(xcsql, NULL);
+	changes = sqxc_sql_changes(xcsql);
+
+	sq_storage_release(storage, context);
+	// rows in container are unknown here, remove all rows of table in identity map
+	if (storage->identity_map)
+		sq_storage_map_clear(storage, table_name);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	// return number of rows changed
+	return changes;
+}
+
+#if SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
+
+int64_t sq_storage_update_field(SqStorage    *storage,
+                                const char   *table_name,
+                                const SqType *table_type,
+                                void         *instance,
+                                const char   *sql_where_having,
+                                ...)
+{
+	SqStorageContext *context, local;
+	va_list  arg_list;
+	int64_t  changes;
+	union {
+		SqTable  *table;
+		SqxcSql  *xcsql;
+	} temp;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		temp.table = sq_schema_find(storage->schema, table_name);
+		if (temp.table == NULL) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_update_field()", table_name);
+#endif
+			return 0;
+		}
+		table_type = temp.table->type;
+	}
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_UPDATE, table_name);
+
+	// set SqxcSql's variable for UPDATE command
+	temp.xcsql = (SqxcSql*)context->xc_output;
+	va_start(arg_list, sql_where_having);
+	sqxc_sql_set_fields(temp.xcsql, table_type, sql_where_having, arg_list);
+	va_end(arg_list);
+
+	changes = sq_storage_update_context(context, table_name, table_type, instance);
+	sq_storage_release(storage, context);
+	// rows that match 'sql_where_having' are unknown, remove all rows of table in identity map
+	if (storage->identity_map)
+		sq_storage_map_clear(storage, table_name);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	// return number of rows changed
+	return changes;
+}
+#endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
+
+int64_t sq_storage_remove(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          int64_t       id)
+{
+	SqStorageContext *context, local;
+	SqBuffer  *buf;
+	SqColumn  *primary = NULL;
+	SqTable   *table;
+	Sqxc      *xcsql;
+	int64_t    changes;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		table = sq_schema_find(storage->schema, table_name);
+		if (table) {
+			table_type = table->type;
+			primary = table->primary_key;
+		}
+#ifndef NDEBUG
+		else
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_remove()", table_name);
+#endif
+	}
+
+	if (primary == NULL)
+		primary = table_type ? sq_table_get_primary(NULL, table_type) : NULL;
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_REMOVE, table_name);
+
+	// SqxcSql receives number of rows deleted. Its code is used to check error of this statement.
+	xcsql = context->xc_output;
+	sqxc_sql_changes(xcsql) = 0;
+	buf = sqxc_get_buffer(xcsql);
+	buf->writed = 0;
+	sqdb_sql_delete(context->db, buf, table_name);
+	if (context->db->info->prepare) {
+		// WHERE primaryKey=?
+		print_where_column(primary, NULL, buf, context->db->info->quote.identifier);
+		xcsql->code = sq_storage_exec_id(context, buf->mem, id, xcsql);
+	}
+	else {
+		print_where_column(primary, &id, buf, context->db->info->quote.identifier);
+		xcsql->code = sqdb_exec(context->db, buf->mem, xcsql, NULL);
+	}
+	changes = (xcsql->code == SQCODE_OK) ? sqxc_sql_changes(xcsql) : 0;
+	sq_storage_release(storage, context);
+	if (storage->identity_map)
+		sq_storage_map_remove(storage, table_name, id);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_remove(storage, table_name, id);
+	// return number of rows deleted
+	return changes;
+}
+
+int64_t sq_storage_remove_many(SqStorage     *storage,
+                               const char    *table_name,
+                               const SqType  *table_type,
+                               const int64_t *ids,
+                               int            n_ids)
+{
+	SqStorageContext *context, local;
+	SqColumn  *primary = NULL;
+	SqBuffer  *buf;
+	SqTable   *table;
+	Sqxc      *xcsql;
+	int64_t    changes = 0;
+	int        count;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		table = sq_schema_find(storage->schema, table_name);
+		if (table) {
+			table_type = table->type;
+			primary = table->primary_key;
+		}
+#ifndef NDEBUG
+		else
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_remove_many()", table_name);
+#endif
+	}
+
+	if (primary == NULL)
+		primary = table_type ? sq_table_get_primary(NULL, table_type) : NULL;
+	if (primary == NULL || n_ids <= 0)
+		return 0;
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_REMOVE, table_name);
+
+	// delete SQ_CONFIG_STORAGE_MANY_KEYS ids per statement
+	xcsql = context->xc_output;
+	buf = sqxc_get_buffer(xcsql);
+	for (int start = 0;  start < n_ids;  start += count) {
+		count = n_ids - start;
+		if (count > SQ_CONFIG_STORAGE_MANY_KEYS)
+			count = SQ_CONFIG_STORAGE_MANY_KEYS;
+		// DELETE FROM "table" WHERE "id" IN (1,2,3)
+		buf->writed = 0;
+		sqdb_sql_delete(context->db, buf, table_name);
+		sq_buffer_write(buf, "WHERE");
+		sqdb_sql_write_identifier(context->db, buf, primary->name, false);
+		sq_buffer_write(buf, "IN (");
+		sq_storage_write_ids(buf, ids + start, count);
+		sq_buffer_write_c(buf, ')');
+		sq_buffer_write_c(buf, 0);    // null-terminated
+		sqxc_sql_changes(xcsql) = 0;
+		xcsql->code = sqdb_exec(context->db, buf->mem, xcsql, NULL);
+		if (xcsql->code != SQCODE_OK)
+			break;
+		changes += sqxc_sql_changes(xcsql);
+	}
+	sq_storage_release(storage, context);
+
+	for (int index = 0;  index < n_ids;  index++) {
+		if (storage->identity_map)
+			sq_storage_map_remove(storage, table_name, ids[index]);
+		if (storage->row_cache || storage->query_cache)
+			sq_storage_cache_remove(storage, table_name, ids[index]);
+	}
+	// return number of rows deleted
+	return changes;
+}
+
+int64_t sq_storage_remove_all(SqStorage    *storage,
+                              const char   *table_name,
+                              const char   *sql_where_having)
+{
+	SqStorageContext *context, local;
+	SqBuffer  *buf;
+	Sqxc      *xcsql;
+	int64_t    changes;
+
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	sq_storage_set_operation(context, SQ_METRICS_REMOVE, table_name);
+
+	xcsql = context->xc_output;
+	sqxc_sql_changes(xcsql) = 0;
+	buf = sqxc_get_buffer(xcsql);
+	buf->writed = 0;
+	sqdb_sql_delete(context->db, buf, table_name);
+	if (sql_where_having)
+		sq_buffer_write(buf, sql_where_having);
+	xcsql->code = sqdb_exec(context->db, buf->mem, xcsql, NULL);
+	changes = (xcsql->code == SQCODE_OK) ? sqxc_sql_changes(xcsql) : 0;
+	sq_storage_release(storage, context);
+	if (storage->identity_map)
+		sq_storage_map_clear(storage, table_name);
+	if (storage->row_cache || storage->query_cache)
+		sq_storage_cache_clear(storage, table_name);
+	// return number of rows deleted
+	return changes;
+}
+
+int  sq_storage_begin_trans(SqStorage *storage)
+{
+	SqStorageContext *context;
+	int   code;
+
+	if (storage->pool == NULL) {
+		code = SQ_STORAGE_BEGIN_TRANS(storage);
+		if (code == SQCODE_OK)
+			storage->in_trans = true;
+		return code;
+	}
+
+	context = sq_storage_acquire(storage, NULL);
+	if (context == NULL)
+		return SQCODE_ERROR;
+	code = sqdb_exec(context->db, "BEGIN", NULL, NULL);
+	// pin context to current thread until commit or rollback
+	if (code == SQCODE_OK && context->pinned == false) {
+		context->thread = sq_thread_id();
+		context->pinned = true;
+		sq_mutex_lock(&storage->mutex);
+		sq_ptr_array_push(&storage->pinned, context);
+		sq_mutex_unlock(&storage->mutex);
+	}
+	sq_storage_release(storage, context);
+	return code;
+}
+
+int  sq_storage_commit_trans(SqStorage *storage)
+{
+	int   code;
+
+	if (storage->pool == NULL) {
+		code = SQ_STORAGE_COMMIT_TRANS(storage);
+		storage->in_trans = false;
+		sq_storage_cache_end_trans(storage, &storage->changed);
+		return code;
+	}
+	return sq_storage_end_trans(storage, "COMMIT");
+}
+
+int  sq_storage_rollback_trans(SqStorage *storage)
+{
+	// identity map may have rows that are inserted or read in transaction
+	int   code;
+
+	if (storage->identity_map)
+		sq_storage_map_clear(storage, NULL);
+	if (storage->pool == NULL) {
+		code = SQ_STORAGE_ROLLBACK_TRANS(storage);
+		storage->in_trans = false;
+		sq_storage_cache_end_trans(storage, &storage->changed);
+		return code;
+	}
+	return sq_storage_end_trans(storage, "ROLLBACK");
+}
+
+// ------------------------------------
+
+SqTable  *sq_storage_find_by_type(SqStorage *storage, const char *type_name)
+{
+	SqPtrArray *type_tables;      // sorted by SqType::name
+	SqPtrArray *schema_tables;    // sorted by SqTable::name
+	int         count;
+//	SqTable   **addr;
+	void      **addr;
+
+	// 'tables' is shared by threads in multi-threaded SqStorage
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+
+	type_tables = &storage->tables;
+	schema_tables = sq_type_entry_array(storage->schema->type);
+	// if version is not the same
+	if (storage->tables_version != storage->schema->version) {
+		storage->tables_version  = storage->schema->version;
 		count = schema_tables->length - type_tables->length;
 		if (count > 0)
 			sq_ptr_array_alloc(type_tables, count);
@@ -467,13 +1422,345 @@ SqTable  *sq_storage_find_by_type(SqStorage *storage, const char *type_name)
 		// sort storage->tables by SqTable::type::name
 		sq_ptr_array_sort(type_tables, sq_entry_cmp_type_name);
 	}
-	// search storage->tables by SqTable::type::name
-	addr = sq_ptr_array_search(type_tables,
-	                           type_name,
-	                           sq_entry_cmp_str__type_name);
-	if (addr)
-		return *addr;
-	return NULL;
+	// search storage->tables by SqTable::type::name
+	addr = sq_ptr_array_search(type_tables,
+	                           type_name,
+	                           sq_entry_cmp_str__type_name);
+
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+	if (addr)
+		return *addr;
+	return NULL;
+}
+
+bool  sq_storage_is_changed(SqStorage *storage, const char *table_name)
+{
+	SqStrArray *changed;
+
+	changed = sq_storage_cache_changed(storage);
+	if (changed == NULL || changed->length == 0)
+		return false;
+	return sq_str_array_search(changed, &table_name, sq_compare_str) != NULL;
+}
+
+// ------------------------------------
+// SqStorageContext
+
+// used by sq_storage_acquire() and sq_storage_acquire_read()
+static SqStorageContext *sq_storage_acquire_from(SqStorage *storage, SqStorageContext *context, SqdbPool *pool)
+{
+	SqThreadId  thread;
+
+	// single thread: use members of SqStorage
+	if (pool == NULL) {
+		context->db        = storage->db;
+		context->xc_input  = storage->xc_input;
+		context->xc_output = storage->xc_output;
+		context->joint     = storage->joint_default;
+		context->pool      = NULL;
+		context->pinned    = false;
+		context->traced    = false;
+		return context;
+	}
+
+	thread = sq_thread_id();
+	sq_mutex_lock(&storage->mutex);
+	// context that is pinned to current thread by transaction
+	for (unsigned int index = 0;  index < storage->pinned.length;  index++) {
+		context = storage->pinned.data[index];
+		if (sq_thread_id_equal(context->thread, thread)) {
+			sq_mutex_unlock(&storage->mutex);
+			return context;
+		}
+	}
+	// idle context
+	if (storage->contexts.length > 0)
+		context = storage->contexts.data[--storage->contexts.length];
+	else
+		context = NULL;
+	sq_mutex_unlock(&storage->mutex);
+
+	if (context == NULL)
+		context = sq_storage_context_new(storage);
+	context->pool = pool;
+	if (sqdb_pool_acquire(pool, &context->db) != SQCODE_OK) {
+		// return idle context to SqStorage
+		context->pool = NULL;
+		sq_storage_release(storage, context);
+		return NULL;
+	}
+	return context;
+}
+
+SqStorageContext *sq_storage_acquire(SqStorage *storage, SqStorageContext *context)
+{
+	context = sq_storage_acquire_from(storage, context, storage->pool);
+	if (context && storage->metrics)
+		sq_storage_trace_attach(storage, context);
+	return context;
+}
+
+SqStorageContext *sq_storage_acquire_read(SqStorage *storage, SqStorageContext *context)
+{
+	// SqStorage::pool_read is used only by multi-threaded SqStorage
+	if (storage->pool && storage->pool_read)
+		context = sq_storage_acquire_from(storage, context, storage->pool_read);
+	else
+		context = sq_storage_acquire_from(storage, context, storage->pool);
+	if (context && storage->metrics)
+		sq_storage_trace_attach(storage, context);
+	return context;
+}
+
+void  sq_storage_release(SqStorage *storage, SqStorageContext *context)
+{
+	// restore trace hook of connection. pinned context keeps it until transaction ends.
+	if (context->traced && context->pinned == false)
+		sq_storage_trace_detach(context);
+	// context is not pooled or it is pinned to thread by transaction
+	if (storage->pool == NULL || context->pinned)
+		return;
+
+	if (context->pool)
+		sqdb_pool_release(context->pool, context->db);
+	context->db = NULL;
+	context->pool = NULL;
+	sq_mutex_lock(&storage->mutex);
+	sq_ptr_array_push(&storage->contexts, context);
+	sq_mutex_unlock(&storage->mutex);
+}
+
+SqTypeJoint *sq_storage_new_joint(SqStorage *storage)
+{
+	SqTypeJoint *type_joint;
+
+	// SqStorage::joint_default may be replaced by derived type such as SqTypeRow
+	type_joint = sq_type_joint_new();
+	type_joint->size  = storage->joint_default->size;
+	type_joint->init  = storage->joint_default->init;
+	type_joint->final = storage->joint_default->final;
+	type_joint->parse = storage->joint_default->parse;
+	type_joint->write = storage->joint_default->write;
+	type_joint->bit_field |= storage->joint_default->bit_field & SQB_TYPE_PARSE_UNKNOWN;
+	return type_joint;
+}
+
+// ------------------------------------
+// SqStorageCursor
+
+// used by sq_storage_cursor_open() and sq_storage_cursor_open_table()
+static SqStorageCursor *sq_storage_cursor_new(SqStorage *storage)
+{
+	SqStorageCursor *cursor;
+
+	cursor = calloc(1, sizeof(SqStorageCursor));
+	cursor->storage = storage;
+	cursor->context = sq_storage_acquire_read(storage, &cursor->local);
+	if (cursor->context == NULL) {
+		free(cursor);
+		return NULL;
+	}
+	if (cursor->context->db->info->prepare == NULL) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: Sqdb doesn't support prepared statement.\n",
+		        "sq_storage_cursor_open()");
+#endif
+		sq_storage_release(storage, cursor->context);
+		free(cursor);
+		return NULL;
+	}
+	// sqdb_step() is not traced. Restore trace hook of connection because cursor may be kept for a long time.
+	if (cursor->context->traced && cursor->context->pinned == false)
+		sq_storage_trace_detach(cursor->context);
+
+	// cursor has its own Sqxc chain, other operations can use Sqxc chain of context.
+	cursor->xc_input = sqxc_new(SQXC_INFO_VALUE);
+#if SQ_CONFIG_HAVE_JSON
+	// append JSON parser to tail of list
+	sqxc_insert(cursor->xc_input, sqxc_new(SQXC_INFO_JSON_PARSER), -1);
+#endif
+	cursor->code = SQCODE_ROW;
+	return cursor;
+}
+
+// used by sq_storage_cursor_open() and sq_storage_cursor_open_table()
+static SqStorageCursor *sq_storage_cursor_prepare(SqStorageCursor *cursor, const char *sql)
+{
+	int  code;
+
+	code = sqdb_prepare(cursor->context->db, sql, &cursor->stmt);
+	if (code != SQCODE_OK) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: failed to prepare statement. code = %d\n",
+		        "sq_storage_cursor_open()", code);
+#endif
+		cursor->stmt = NULL;
+		sq_storage_cursor_close(cursor);
+		return NULL;
+	}
+	return cursor;
+}
+
+SqStorageCursor *sq_storage_cursor_open(SqStorage     *storage,
+                                        SqQuery       *query,
+                                        const SqType  *table_type)
+{
+	SqStorageCursor *cursor;
+
+	cursor = sq_storage_cursor_new(storage);
+	if (cursor == NULL)
+		return NULL;
+	if (table_type == NULL) {
+		cursor->joint = sq_storage_new_joint(storage);
+		table_type = sq_storage_setup_query(storage, query, cursor->joint);
+		if (table_type == NULL) {
+			sq_storage_cursor_close(cursor);
+			return NULL;
+		}
+	}
+	cursor->type = table_type;
+	return sq_storage_cursor_prepare(cursor, sq_query_c(query));
+}
+
+SqStorageCursor *sq_storage_cursor_open_table(SqStorage     *storage,
+                                              const char    *table_name,
+                                              const SqType  *table_type,
+                                              const char    *sql_where_having)
+{
+	SqStorageCursor *cursor;
+	SqTable  *table;
+	SqBuffer *buf;
+
+	if (table_type == NULL) {
+		// find SqTable by table_name
+		table = sq_schema_find(storage->schema, table_name);
+		if (table == NULL) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: table '%s' not found in SqStorage::schema.\n",
+			        "sq_storage_cursor_open_table()", table_name);
+#endif
+			return NULL;
+		}
+		table_type = table->type;
+	}
+
+	cursor = sq_storage_cursor_new(storage);
+	if (cursor == NULL)
+		return NULL;
+	cursor->type = table_type;
+
+	// SQL statement
+	buf = sqxc_get_buffer(cursor->xc_input);
+	buf->writed = 0;
+	// select query-only columns before others if table has query-only column
+	sqdb_sql_select(cursor->context->db, buf, table_name, table_type);
+	// SQL WHERE ... HAVING ...
+	if (sql_where_having)
+		sq_buffer_write(buf, sql_where_having);
+	return sq_storage_cursor_prepare(cursor, buf->mem);
+}
+
+void  sq_storage_cursor_reuse(SqStorageCursor *cursor, bool reuse)
+{
+	cursor->reuse = reuse;
+}
+
+void *sq_storage_cursor_next(SqStorageCursor *cursor)
+{
+	Sqxc *xcvalue;
+	void *instance;
+
+	if (cursor->code != SQCODE_ROW)
+		return NULL;
+
+	// clear previous row in reused instance
+	if (cursor->reuse && cursor->instance) {
+		sq_type_final_instance(cursor->type, cursor->instance, false);
+		memset(cursor->instance, 0, cursor->type->size);
+		sq_type_init_instance(cursor->type, cursor->instance, false);
+	}
+
+	// destination of input
+	xcvalue = cursor->xc_input;
+	sqxc_value_element(xcvalue)   = cursor->type;
+	sqxc_value_container(xcvalue) = NULL;
+	sqxc_value_instance(xcvalue)  = (cursor->reuse) ? cursor->instance : NULL;
+
+	sqxc_ready(xcvalue, NULL);
+	cursor->code = sqdb_step(cursor->context->db, cursor->stmt, xcvalue);
+	sqxc_finish(xcvalue, NULL);
+	instance = sqxc_value_instance(xcvalue);
+
+	if (cursor->code != SQCODE_ROW) {
+		if (instance != cursor->instance) {
+			sq_type_final_instance(cursor->type, instance, false);
+			free(instance);
+		}
+		return NULL;
+	}
+	if (cursor->reuse)
+		cursor->instance = instance;
+	return instance;
+}
+
+void *sq_storage_cursor_next_batch(SqStorageCursor *cursor, int n_rows, const SqType *container_type)
+{
+	Sqxc *xcvalue, *xc;
+	void *instance;
+	int   count = 0;
+
+	if (cursor->code != SQCODE_ROW || n_rows <= 0)
+		return NULL;
+	if (container_type == NULL)
+		container_type = cursor->storage->container_default;
+
+	// destination of input
+	xcvalue = cursor->xc_input;
+	sqxc_value_element(xcvalue)   = cursor->type;
+	sqxc_value_container(xcvalue) = container_type;
+	sqxc_value_instance(xcvalue)  = NULL;
+
+	sqxc_ready(xcvalue, NULL);
+	// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+	xcvalue->type = SQXC_TYPE_ARRAY;
+	xcvalue->name = NULL;
+	xcvalue->value.pointer = NULL;
+	xc = sqxc_send(xcvalue);
+	while (count < n_rows) {
+		cursor->code = sqdb_step(cursor->context->db, cursor->stmt, xc);
+		if (cursor->code != SQCODE_ROW)
+			break;
+		count++;
+	}
+	xc->type = SQXC_TYPE_ARRAY_END;
+	xc->name = NULL;
+	xc->value.pointer = NULL;
+	sqxc_send(xc);
+	sqxc_finish(xcvalue, NULL);
+	instance = sqxc_value_instance(xcvalue);
+
+	if (count == 0 || (cursor->code != SQCODE_ROW && cursor->code != SQCODE_DONE)) {
+		sq_type_final_instance(container_type, instance, false);
+		free(instance);
+		return NULL;
+	}
+	return instance;
+}
+
+void  sq_storage_cursor_close(SqStorageCursor *cursor)
+{
+	if (cursor->stmt)
+		sqdb_finalize(cursor->context->db, cursor->stmt);
+	if (cursor->instance) {
+		sq_type_final_instance(cursor->type, cursor->instance, false);
+		free(cursor->instance);
+	}
+	sq_storage_release(cursor->storage, cursor->context);
+	sqxc_free_chain(cursor->xc_input);
+	if (cursor->joint)
+		sq_type_joint_free(cursor->joint);
+	free(cursor);
 }
 
 // ----------------------------------------------------------------------------
@@ -568,6 +1855,264 @@ static int  sqxc_sql_set_fields(SqxcSql      *xcsql,
 }
 #endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 
+// return true if 'name' is in NULL-terminated array 'names'
+static bool  sq_storage_has_name(char **names, const char *name)
+{
+	for (;  *names;  names++) {
+		if (strcmp(*names, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+/* write conflict clause of upsert to 'buffer'. return false if table has no PRIMARY KEY or UNIQUE constraint.
+   Conflict target is PRIMARY KEY. If PRIMARY KEY has auto increment attribute, the first UNIQUE constraint is used.
+   'arg_list' is NULL-terminated list of column names that are updated on conflict.
+   If it is empty, all columns except conflict target, PRIMARY KEY, and auto increment column are updated.
+
+   MySQL:  AS new ON DUPLICATE KEY UPDATE `column`=new.`column`    (row alias requires MySQL 8.0.19)
+           ON DUPLICATE KEY UPDATE `column`=VALUES(`column`)       (MariaDB and MySQL before 8.0.19)
+   others: ON CONFLICT ("target") DO UPDATE SET "column"=excluded."column"
+ */
+static bool  sq_storage_write_conflict(Sqdb         *db,
+                                       const SqType *table_type,
+                                       SqBuffer     *buffer,
+                                       va_list       arg_list)
+{
+	SqPtrArray *entries = sq_type_entry_array(table_type);
+	SqColumn   *primary = NULL;
+	SqColumn   *unique  = NULL;
+	SqColumn   *column;
+	char      **target;
+	char       *target_one[2] = {NULL, NULL};
+	const char *quote = db->info->quote.identifier;
+	const char *name;
+	bool        is_mysql = (db->info->product == SQDB_PRODUCT_MYSQL);
+	bool        row_alias = false;
+	bool        all_columns;
+	size_t      clause_offset = 0;
+	int         count = 0;
+
+	for (unsigned int index = 0;  index < entries->length;  index++) {
+		column = entries->data[index];
+		if (column->name == NULL)
+			continue;
+		if (column->bit_field & SQB_COLUMN_PRIMARY && primary == NULL)
+			primary = column;
+		if (column->bit_field & SQB_COLUMN_UNIQUE && unique == NULL)
+			unique = column;
+	}
+	column = primary;
+	if (column == NULL || (unique && column->bit_field & SQB_COLUMN_AUTOINCREMENT))
+		column = unique;
+	if (column == NULL)
+		return false;
+	// composite constraint has column names in SqColumn::composite
+	if (column->type == SQ_TYPE_CONSTRAINT)
+		target = column->composite;
+	else {
+		target_one[0] = (char*)column->name;
+		target = target_one;
+	}
+	if (target == NULL || target[0] == NULL)
+		return false;
+
+#if SQ_CONFIG_HAVE_MYSQL
+	// Sqdb of MySQL product is SqdbMysql
+	if (is_mysql) {
+		SqdbMysql *sqdb = (SqdbMysql*)db;
+		row_alias = (sqdb->is_mariadb == false && sqdb->server_version >= 80019);
+	}
+#endif
+
+	if (is_mysql) {
+		// VALUES(column) is deprecated since MySQL 8.0.20, but MariaDB has no row alias.
+		if (row_alias)
+			sq_buffer_write(buffer, " AS new");
+		sq_buffer_write(buffer, " ON DUPLICATE KEY UPDATE ");
+	}
+	else {
+		sq_buffer_write(buffer, " ON CONFLICT (");
+		for (int index = 0;  target[index];  index++) {
+			if (index > 0)
+				sq_buffer_write_c(buffer, ',');
+			sq_buffer_write_c(buffer, quote[0]);
+			sq_buffer_write(buffer, target[index]);
+			sq_buffer_write_c(buffer, quote[1]);
+		}
+		sq_buffer_write_c(buffer, ')');
+		clause_offset = buffer->writed;
+		sq_buffer_write(buffer, " DO UPDATE SET ");
+	}
+
+	// if caller doesn't specify columns, update all columns that can be updated
+	name = va_arg(arg_list, const char*);
+	all_columns = (name == NULL);
+	for (unsigned int index = 0;  ;  index++) {
+		// columns that are specified by caller
+		if (all_columns == false) {
+			if (index > 0)
+				name = va_arg(arg_list, const char*);
+			if (name == NULL)
+				break;
+		}
+		else {
+			if (index >= entries->length)
+				break;
+			column = entries->data[index];
+			name = column->name;
+			if (name == NULL || SQ_TYPE_IS_FAKE(column->type) || column->type->write == NULL)
+				continue;
+			if (column->bit_field & (SQB_COLUMN_PRIMARY | SQB_COLUMN_AUTOINCREMENT))
+				continue;
+#if SQ_CONFIG_QUERY_ONLY_COLUMN
+			if (column->bit_field & SQB_COLUMN_QUERY)
+				continue;
+#endif
+			// keep time of creation
+			if ((column->bit_field & SQB_COLUMN_CURRENT_ALL) == SQB_COLUMN_CURRENT)
+				continue;
+			if (sq_storage_has_name(target, name))
+				continue;
+		}
+		if (count++ > 0)
+			sq_buffer_write_c(buffer, ',');
+		sq_buffer_write_c(buffer, quote[0]);
+		sq_buffer_write(buffer, name);
+		sq_buffer_write_c(buffer, quote[1]);
+		if (is_mysql == false)
+			sq_buffer_write(buffer, "=excluded.");
+		else if (row_alias)
+			sq_buffer_write(buffer, "=new.");
+		else
+			sq_buffer_write(buffer, "=VALUES(");
+		sq_buffer_write_c(buffer, quote[0]);
+		sq_buffer_write(buffer, name);
+		sq_buffer_write_c(buffer, quote[1]);
+		if (is_mysql && row_alias == false)
+			sq_buffer_write_c(buffer, ')');
+	}
+
+	// nothing to update
+	if (count == 0) {
+		if (is_mysql) {
+			// MySQL doesn't have DO NOTHING. assign target column to itself.
+			sq_buffer_write_c(buffer, quote[0]);
+			sq_buffer_write(buffer, target[0]);
+			sq_buffer_write_c(buffer, quote[1]);
+			sq_buffer_write_c(buffer, '=');
+			sq_buffer_write_c(buffer, quote[0]);
+			sq_buffer_write(buffer, target[0]);
+			sq_buffer_write_c(buffer, quote[1]);
+		}
+		else {
+			// replace " DO UPDATE SET " by " DO NOTHING"
+			buffer->writed = clause_offset;
+			sq_buffer_write(buffer, " DO NOTHING");
+		}
+	}
+	sq_buffer_write_c(buffer, 0);    // null-terminated
+	return true;
+}
+
+// used by sq_storage_unique_ids()
+typedef struct SqStorageKey    SqStorageKey;
+
+struct SqStorageKey
+{
+	int64_t  id;
+	int      index;    // index in array of ids
+};
+
+static int  sq_storage_key_cmp_id(const void *key1, const void *key2)
+{
+	const SqStorageKey *k1 = key1, *k2 = key2;
+
+	if (k1->id != k2->id)
+		return (k1->id > k2->id) ? 1 : -1;
+	return k1->index - k2->index;
+}
+
+static int  sq_storage_key_cmp_index(const void *key1, const void *key2)
+{
+	return ((const SqStorageKey*)key1)->index - ((const SqStorageKey*)key2)->index;
+}
+
+// copy 'ids' to 'unique' without duplicate ids. Order of 'ids' is kept.
+// return number of ids in 'unique'.
+static int  sq_storage_unique_ids(const int64_t *ids, int n_ids, int64_t *unique)
+{
+	SqStorageKey *keys;
+	int           n_unique = 0;
+
+	if (n_ids <= 0)
+		return 0;
+	keys = malloc(sizeof(SqStorageKey) * n_ids);
+	for (int index = 0;  index < n_ids;  index++) {
+		keys[index].id = ids[index];
+		keys[index].index = index;
+	}
+	// the first one of duplicate ids is kept, others are moved to end of array
+	qsort(keys, n_ids, sizeof(SqStorageKey), sq_storage_key_cmp_id);
+	for (int index = n_ids - 1;  index > 0;  index--) {
+		if (keys[index].id == keys[index - 1].id)
+			keys[index].index = n_ids;
+	}
+	qsort(keys, n_ids, sizeof(SqStorageKey), sq_storage_key_cmp_index);
+	while (n_unique < n_ids && keys[n_unique].index < n_ids) {
+		unique[n_unique] = keys[n_unique].id;
+		n_unique++;
+	}
+	free(keys);
+	return n_unique;
+}
+
+// write "id1,id2,id3" to 'buf'
+static void  sq_storage_write_ids(SqBuffer *buf, const int64_t *ids, int n_ids)
+{
+	int  len;
+
+	for (int index = 0;  index < n_ids;  index++) {
+		if (index > 0)
+			sq_buffer_write_c(buf, ',');
+		len = snprintf(NULL, 0, "%" PRId64, ids[index]);
+		snprintf(sq_buffer_alloc(buf, len), len+1, "%" PRId64, ids[index]);
+	}
+}
+
+// write ORDER BY that sorts rows by order of 'ids'. 'buf' is null-terminated.
+// " ORDER BY "id""  or  " ORDER BY CASE "id" WHEN 3 THEN 0 WHEN 1 THEN 1 END"
+static void  sq_storage_write_order(Sqdb *db, SqBuffer *buf, const char *primary_name,
+                                    const int64_t *ids, int n_ids)
+{
+	int  len;
+	int  index;
+
+	sq_buffer_write(buf, " ORDER BY");
+	// use primary key directly if ids are ascending
+	for (index = 1;  index < n_ids;  index++) {
+		if (ids[index - 1] > ids[index])
+			break;
+	}
+	if (index >= n_ids) {
+		sqdb_sql_write_identifier(db, buf, primary_name, false);
+		buf->writed--;    // remove ' ' after identifier
+		sq_buffer_write_c(buf, 0);    // null-terminated
+		return;
+	}
+
+	sq_buffer_write(buf, " CASE");
+	sqdb_sql_write_identifier(db, buf, primary_name, false);
+	for (index = 0;  index < n_ids;  index++) {
+		sq_buffer_write(buf, "WHEN ");
+		sq_storage_write_ids(buf, ids + index, 1);
+		len = snprintf(NULL, 0, " THEN %d ", index);
+		snprintf(sq_buffer_alloc(buf, len), len+1, " THEN %d ", index);
+	}
+	sq_buffer_write(buf, "END");
+	sq_buffer_write_c(buf, 0);    // null-terminated
+}
+
 static int  print_where_column(const SqColumn *column, void *instance, SqBuffer *buf, const char quote[2])
 {
 	const SqType *type;
@@ -590,6 +2135,13 @@ static int  print_where_column(const SqColumn *column, void *instance, SqBuffer
 		name = "id";
 		type = SQ_TYPE_INT64;
 	}
+	// placeholder of prepared statement
+	if (instance == NULL) {
+		temp.len = snprintf(NULL, 0, "%c%s%c=?", quote[0], name, quote[1]);
+		snprintf(sq_buffer_alloc(buf, temp.len), temp.len+1, "%c%s%c=?",
+				quote[0], name, quote[1]);
+		return temp.len;
+	}
 	// integer
 	switch(SQ_TYPE_BUILTIN_INDEX(type)) {
 	case SQ_TYPE_INT_INDEX:
@@ -662,6 +2214,479 @@ static int  print_where_column(const SqColumn *column, void *instance, SqBuffer
 }
 
 
+// execute SQL statement that has a parameter for primary key. It is used if Sqdb supports prepared statement.
+static int  sq_storage_exec_id(SqStorageContext *context, const char *sql, int64_t id, Sqxc *xc)
+{
+	Sqdb     *db = context->db;
+	SqdbStmt *stmt;
+	SqValue   value;
+	int       code;
+
+	code = sqdb_prepare(db, sql, &stmt);
+	if (code != SQCODE_OK)
+		return code;
+	value.int64 = id;
+	code = sqdb_bind(db, stmt, 1, SQXC_TYPE_INT64, &value);
+	if (code == SQCODE_OK) {
+		// pass SQL statement and bound value to trace hook
+		if (db->trace) {
+			context->bound_id = &id;
+			code = sqdb_exec_trace(db, sql, stmt, xc, NULL);
+			context->bound_id = NULL;
+		}
+		else
+			code = sqdb_exec_stmt(db, stmt, xc);
+	}
+	sqdb_finalize(db, stmt);
+	return code;
+}
+
+// used by sq_storage_update(), sq_storage_update_all(), and sq_storage_update_field()
+static int64_t  sq_storage_update_context(SqStorageContext *context,
+                                          const char       *table_name,
+                                          const SqType     *table_type,
+                                          void             *instance)
+{
+	Sqxc      *xcsql;
+	SqBuffer  *buf;
+	SqColumn  *column;
+
+	// destination of output
+	xcsql = context->xc_output;
+	sqxc_sql_set_db(xcsql, context->db);
+	if (sqxc_sql_condition(xcsql) == NULL) {
+		column = sq_table_get_primary(NULL, table_type);
+		// SQL statement. Because input buffer doesn't use here, I use it temporary.
+		buf = sqxc_get_buffer(context->xc_input);
+		buf->writed = 0;
+		print_where_column(column, (char*)instance + column->offset,
+		             buf, context->db->info->quote.identifier);
+		sqxc_sql_condition(xcsql) = buf->mem;
+	}
+	sqxc_ctrl(xcsql, SQXC_SQL_CTRL_UPDATE, table_name);
+
+	sqxc_ready(xcsql, NULL);
+	table_type->write(instance, table_type, xcsql);
+	sqxc_finish(xcsql, NULL);
+	// free WHERE condition
+//	sqxc_sql_condition(xcsql) = NULL;    // this has been done in sqxc_finish()
+
+	// return number of rows changed
+	return sqxc_sql_changes(xcsql);
+}
+
+// used by sq_storage_commit_trans() and sq_storage_rollback_trans() in multi-threaded SqStorage
+static int  sq_storage_end_trans(SqStorage *storage, const char *sql)
+{
+	SqStorageContext *context;
+	int   code;
+
+	context = sq_storage_acquire(storage, NULL);
+	if (context == NULL)
+		return SQCODE_ERROR;
+	code = sqdb_exec(context->db, sql, NULL, NULL);
+	// unpin context from current thread
+	if (context->pinned) {
+		sq_mutex_lock(&storage->mutex);
+		for (unsigned int index = 0;  index < storage->pinned.length;  index++) {
+			if (storage->pinned.data[index] == context) {
+				sq_ptr_array_steal(&storage->pinned, index, 1);
+				break;
+			}
+		}
+		sq_mutex_unlock(&storage->mutex);
+		context->pinned = false;
+	}
+	sq_storage_cache_end_trans(storage, &context->changed);
+	sq_storage_release(storage, context);
+	return code;
+}
+
+// create context for multi-threaded SqStorage. Its Sqxc chain is the same as SqStorage::xc_input and xc_output.
+static SqStorageContext *sq_storage_context_new(SqStorage *storage)
+{
+	SqStorageContext *context;
+
+	context = malloc(sizeof(SqStorageContext));
+	context->db = NULL;
+	context->pool = NULL;
+	context->pinned = false;
+	context->traced = false;
+	sq_str_array_init(&context->changed, 8);
+	context->joint = sq_storage_new_joint(storage);
+	context->xc_input  = sqxc_new(SQXC_INFO_VALUE);
+	context->xc_output = sqxc_new(SQXC_INFO_SQL);
+#if SQ_CONFIG_HAVE_JSON
+	// append JSON parser/writer to tail of list
+	sqxc_insert(context->xc_input,  sqxc_new(SQXC_INFO_JSON_PARSER), -1);
+	sqxc_insert(context->xc_output, sqxc_new(SQXC_INFO_JSON_WRITER), -1);
+#endif
+	return context;
+}
+
+static void sq_storage_context_free(SqStorageContext *context)
+{
+	sqxc_free_chain(context->xc_input);
+	sqxc_free_chain(context->xc_output);
+	sq_type_joint_free(context->joint);
+	sq_str_array_final(&context->changed);
+	free(context);
+}
+
+// ------------------------------------
+// identity map
+
+// get integer primary key of 'instance'. return false if primary key is not integer.
+static bool  sq_storage_get_id(const SqColumn *primary, void *instance, int64_t *id)
+{
+	void *field;
+
+	if (primary == NULL)
+		return false;
+	field = (char*)instance + primary->offset;
+	if (primary->type == SQ_TYPE_INT)
+		*id = *(int*)field;
+	else if (primary->type == SQ_TYPE_UINT)
+		*id = *(unsigned int*)field;
+	else if (primary->type == SQ_TYPE_INT64)
+		*id = *(int64_t*)field;
+	else if (primary->type == SQ_TYPE_UINT64)
+		*id = (int64_t)*(uint64_t*)field;
+	else
+		return false;
+	return true;
+}
+
+// set integer primary key of 'instance'.
+static void  sq_storage_set_id(const SqColumn *primary, void *instance, int64_t id)
+{
+	void *field;
+
+	field = (char*)instance + primary->offset;
+	if (primary->type == SQ_TYPE_INT)
+		*(int*)field = (int)id;
+	else if (primary->type == SQ_TYPE_UINT)
+		*(unsigned int*)field = (unsigned int)id;
+	else if (primary->type == SQ_TYPE_INT64)
+		*(int64_t*)field = id;
+	else if (primary->type == SQ_TYPE_UINT64)
+		*(uint64_t*)field = (uint64_t)id;
+}
+
+// copy 'instance' by writing it to SqxcValue. return NULL if error occurred.
+static void *sq_storage_copy_instance(Sqxc *xcvalue, const SqType *type, void *instance)
+{
+	void *copy;
+
+	sqxc_value_element(xcvalue)   = type;
+	sqxc_value_container(xcvalue) = NULL;
+	sqxc_value_instance(xcvalue)  = NULL;
+
+	sqxc_ready(xcvalue, NULL);
+	xcvalue->name = NULL;
+	type->write(instance, type, xcvalue);
+	sqxc_finish(xcvalue, NULL);
+	copy = sqxc_value_instance(xcvalue);
+	if (xcvalue->code != SQCODE_OK && copy) {
+		sq_type_final_instance(type, copy, false);
+		free(copy);
+		copy = NULL;
+	}
+	return copy;
+}
+
+// get Sqxc chains to copy instance. Unlike sq_storage_acquire(), it doesn't get connection from pool.
+static SqStorageContext *sq_storage_acquire_xc(SqStorage *storage, SqStorageContext *context)
+{
+	if (storage->pool == NULL)
+		return sq_storage_acquire_from(storage, context, NULL);
+
+	sq_mutex_lock(&storage->mutex);
+	if (storage->contexts.length > 0)
+		context = storage->contexts.data[--storage->contexts.length];
+	else
+		context = NULL;
+	sq_mutex_unlock(&storage->mutex);
+
+	if (context == NULL)
+		context = sq_storage_context_new(storage);
+	return context;
+}
+
+// return copy of instance in identity map. return NULL if not found.
+static void *sq_storage_map_find(SqStorage *storage, const char *table_name, const SqType *table_type, int64_t id)
+{
+	SqStorageContext *context, local;
+	void  *instance;
+
+	context = sq_storage_acquire_xc(storage, &local);
+	// identity map is shared by threads in multi-threaded SqStorage
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+	instance = sq_identity_map_find(storage->identity_map, table_name, id, table_type);
+	// copy instance before unlocking because it may be evicted by other thread
+	if (instance)
+		instance = sq_storage_copy_instance(context->xc_input, table_type, instance);
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+	sq_storage_release(storage, context);
+	return instance;
+}
+
+// add copy of 'instance' to identity map. 'id' is used if primary key of 'instance' is 0.
+static void  sq_storage_map_add(SqStorage *storage, SqStorageContext *context,
+                                const char *table_name, const SqType *table_type, void *instance, int64_t id)
+{
+	SqColumn *primary;
+	int64_t   key;
+
+	primary = sq_table_get_primary(NULL, table_type);
+	if (sq_storage_get_id(primary, instance, &key) == false)
+		return;
+	instance = sq_storage_copy_instance(context->xc_input, table_type, instance);
+	if (instance == NULL)
+		return;
+	// primary key of inserted row may be generated by database
+	if (key == 0) {
+		key = id;
+		sq_storage_set_id(primary, instance, key);
+	}
+
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+	if (sq_identity_map_add(storage->identity_map, table_name, key, table_type, instance) == false) {
+		sq_type_final_instance(table_type, instance, false);
+		free(instance);
+	}
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+}
+
+// add copy of all elements in 'container' to identity map.
+static void  sq_storage_map_add_all(SqStorage *storage, SqStorageContext *context, const char *table_name,
+                                    const SqType *table_type, const SqType *container_type, void *container)
+{
+	SqType      type_temp;
+	SqColumn   *primary;
+	SqPtrArray *array;
+	Sqxc       *xcvalue;
+	int64_t     key;
+
+	primary = sq_table_get_primary(NULL, table_type);
+	// primary key must be integer
+	if (primary == NULL || primary->type < SQ_TYPE_INT || primary->type > SQ_TYPE_UINT64)
+		return;
+	// container_type->write() gets element type from SqType::entry if SqType::n_entry == -1
+	if (container_type->n_entry != -1 || container_type->entry == NULL) {
+		type_temp = *container_type;
+		type_temp.entry   = (SqEntry**)table_type;
+		type_temp.n_entry = -1;
+		container_type = &type_temp;
+	}
+
+	// copy elements of 'container' to SqPtrArray
+	xcvalue = context->xc_input;
+	sqxc_value_element(xcvalue)   = table_type;
+	sqxc_value_container(xcvalue) = SQ_TYPE_PTR_ARRAY;
+	sqxc_value_instance(xcvalue)  = NULL;
+
+	sqxc_ready(xcvalue, NULL);
+	xcvalue->name = NULL;
+	container_type->write(container, container_type, xcvalue);
+	sqxc_finish(xcvalue, NULL);
+	array = sqxc_value_instance(xcvalue);
+	if (array == NULL)
+		return;
+
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+	for (unsigned int index = 0;  index < array->length;  index++) {
+		sq_storage_get_id(primary, array->data[index], &key);
+		if (xcvalue->code != SQCODE_OK ||
+		    sq_identity_map_add(storage->identity_map, table_name, key,
+		                        table_type, array->data[index]) == false)
+		{
+			sq_type_final_instance(table_type, array->data[index], false);
+			free(array->data[index]);
+		}
+	}
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+	// elements are owned by identity map or freed
+	array->length = 0;
+	sq_type_final_instance(SQ_TYPE_PTR_ARRAY, array, false);
+	free(array);
+}
+
+static void  sq_storage_map_remove(SqStorage *storage, const char *table_name, int64_t id)
+{
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+	sq_identity_map_remove(storage->identity_map, table_name, id);
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+}
+
+static void  sq_storage_map_remove_instance(SqStorage *storage, const char *table_name,
+                                            const SqType *table_type, void *instance)
+{
+	int64_t  id;
+
+	if (sq_storage_get_id(sq_table_get_primary(NULL, table_type), instance, &id))
+		sq_storage_map_remove(storage, table_name, id);
+	else
+		sq_storage_map_clear(storage, table_name);
+}
+
+static void  sq_storage_map_clear(SqStorage *storage, const char *table_name)
+{
+	if (storage->pool)
+		sq_mutex_lock(&storage->mutex);
+	sq_identity_map_clear(storage->identity_map, table_name);
+	if (storage->pool)
+		sq_mutex_unlock(&storage->mutex);
+}
+
+// ------------------------------------
+// row cache and query cache
+
+// return tables that are changed in transaction of current thread. return NULL if no transaction.
+static SqStrArray *sq_storage_cache_changed(SqStorage *storage)
+{
+	SqStorageContext *context;
+	SqStrArray       *changed = NULL;
+	SqThreadId        thread;
+
+	if (storage->pool == NULL)
+		return (storage->in_trans) ? &storage->changed : NULL;
+
+	thread = sq_thread_id();
+	sq_mutex_lock(&storage->mutex);
+	for (unsigned int index = 0;  index < storage->pinned.length;  index++) {
+		context = storage->pinned.data[index];
+		if (sq_thread_id_equal(context->thread, thread)) {
+			changed = &context->changed;
+			break;
+		}
+	}
+	sq_mutex_unlock(&storage->mutex);
+	return changed;
+}
+
+// add table to sorted array 'changed'
+static void  sq_storage_cache_change(SqStrArray *changed, const char *table_name)
+{
+	unsigned int  index;
+
+	if (sq_str_array_find_sorted(changed, &table_name, sq_compare_str, &index) == NULL)
+		sq_str_array_push_in(changed, index, table_name);
+}
+
+static void  sq_storage_cache_remove(SqStorage *storage, const char *table_name, int64_t id)
+{
+	SqStrArray *changed;
+
+	if (storage->row_cache)
+		sq_row_cache_remove(storage->row_cache, table_name, id);
+	if (storage->query_cache)
+		sq_query_cache_invalidate(storage->query_cache, table_name);
+	// other threads may cache row before transaction is committed
+	changed = sq_storage_cache_changed(storage);
+	if (changed)
+		sq_storage_cache_change(changed, table_name);
+}
+
+static void  sq_storage_cache_clear(SqStorage *storage, const char *table_name)
+{
+	SqStrArray *changed;
+
+	if (storage->row_cache)
+		sq_row_cache_clear(storage->row_cache, table_name);
+	if (storage->query_cache)
+		sq_query_cache_invalidate(storage->query_cache, table_name);
+	// other threads may cache rows before transaction is committed
+	changed = sq_storage_cache_changed(storage);
+	if (changed)
+		sq_storage_cache_change(changed, table_name);
+}
+
+// remove rows and results of tables that are changed in transaction from caches.
+static void  sq_storage_cache_end_trans(SqStorage *storage, SqStrArray *changed)
+{
+	for (unsigned int index = 0;  index < changed->length;  index++) {
+		if (storage->row_cache)
+			sq_row_cache_clear(storage->row_cache, changed->data[index]);
+		if (storage->query_cache)
+			sq_query_cache_invalidate(storage->query_cache, changed->data[index]);
+	}
+	// SqStrArray frees strings when they are erased
+	sq_str_array_erase(changed, 0, changed->length);
+}
+
+// ------------------------------------
+// metrics
+
+static void  sq_storage_trace(void *data, Sqdb *db, const SqdbTrace *trace)
+{
+	SqStorageContext *context = data;
+	SqStorageContext *prev = context;
+	SqMetricsSlow     slow;
+	char              params[32];
+
+	// call trace hook that is set by user. It may be replaced by operation that runs this operation.
+	while (prev->trace == sq_storage_trace)
+		prev = prev->trace_data;
+	if (prev->trace)
+		prev->trace(prev->trace_data, db, trace);
+	if (trace->stage != SQDB_TRACE_END)
+		return;
+
+	sq_metrics_record(context->metrics, context->table_name, context->operation, trace->time);
+	if (sq_metrics_is_slow(context->metrics, trace->time)) {
+		slow.table_name = context->table_name;
+		slow.operation  = context->operation;
+		slow.sql        = trace->sql;
+		slow.params     = NULL;
+		slow.code       = trace->code;
+		slow.time       = trace->time;
+		if (context->bound_id) {
+			snprintf(params, sizeof(params), "?1=%" PRId64, *context->bound_id);
+			slow.params = params;
+		}
+		sq_metrics_slow(context->metrics, &slow);
+	}
+}
+
+// replace trace hook of connection during operation
+static void  sq_storage_trace_attach(SqStorage *storage, SqStorageContext *context)
+{
+	Sqdb *db = context->db;
+
+	context->operation  = SQ_METRICS_NONE;
+	context->table_name = NULL;
+	context->bound_id   = NULL;
+	// context that is pinned by transaction has attached
+	if (context->traced)
+		return;
+	context->traced     = true;
+	context->metrics    = storage->metrics;
+	context->trace      = db->trace;
+	context->trace_data = db->trace_data;
+	db->trace      = sq_storage_trace;
+	db->trace_data = context;
+}
+
+static void  sq_storage_trace_detach(SqStorageContext *context)
+{
+	Sqdb *db = context->db;
+
+	context->traced = false;
+	if (db->trace_data != context)
+		return;
+	db->trace      = context->trace;
+	db->trace_data = context->trace_data;
+}
+
 // ----------------------------------------------------------------------------
 // If C compiler doesn't support C99 inline functions
 
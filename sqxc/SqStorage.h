@@ -17,17 +17,39 @@
 
 #include <sqxc/SqConfig.h>
 #include <sqxc/Sqdb.h>
+#include <sqxc/SqdbPool.h>
+#include <sqxc/SqThread.h>
+#include <sqxc/SqStrArray.h>
+#include <sqxc/SqIdentityMap.h>
+#include <sqxc/SqRowCache.h>
+#include <sqxc/SqQueryCache.h>
+#include <sqxc/SqMetrics.h>
 #include <sqxc/SqSchema.h>
 #include <sqxc/SqJoint.h>
 #include <sqxc/SqQuery.h>
 #ifdef __cplusplus
 #include <sqxc/SqType-stl-cxx.h>
+#include <future>              // std::future, std::packaged_task
+#include <iterator>            // std::input_iterator_tag
+#include <string>
+#include <vector>              // std::vector
 #endif
 
 // ----------------------------------------------------------------------------
 // C/C++ common declarations: declare type, structure, macro, enumeration.
 
 typedef struct SqStorage         SqStorage;
+typedef struct SqStorageContext  SqStorageContext;
+typedef struct SqStorageCursor   SqStorageCursor;
+typedef struct SqStorageWorkers  SqStorageWorkers;
+
+// callback of asynchronous functions. It is called by worker thread.
+// 'result' is instance or container that is returned by sq_storage_get() or sq_storage_get_all(), it is NULL for other functions.
+// 'number' is inserted row id of sq_storage_insert() or number of rows changed of sq_storage_update().
+typedef void (*SqStorageAsyncFunc)(SqStorage *storage, void *result, int64_t number, void *user_data);
+
+// function that is run by worker thread. It is used by sq_storage_run_async().
+typedef void (*SqStorageTaskFunc)(SqStorage *storage, void *data);
 
 /* macro for maintaining C/C++ inline functions easily */
 
@@ -55,6 +77,34 @@ void       sq_storage_free(SqStorage *storage);
 void  sq_storage_init(SqStorage *storage, Sqdb *db);
 void  sq_storage_final(SqStorage *storage);
 
+// multi-threaded SqStorage. Each operation gets a connection from 'pool' and uses its own Sqxc chain.
+// 'pool' must be valid until storage is freed.
+SqStorage *sq_storage_new_pool(SqdbPool *pool);
+void  sq_storage_init_pool(SqStorage *storage, SqdbPool *pool);
+
+// route read-only operations (get, get_all, copy_out, SELECT query) to connections in 'pool_read'.
+// Writes and transactions still use SqStorage::pool. 'pool_read' must be valid until storage is freed.
+// e.g. SQLite in WAL mode: SqStorage::pool has one writer connection, 'pool_read' has read-only connections.
+void  sq_storage_set_pool_read(SqStorage *storage, SqdbPool *pool_read);
+
+// cache rows by table name and primary key. get() returns copy of cached row without querying database.
+// 'capacity' is max number of cached rows. If 'capacity' is 0, use SQ_CONFIG_IDENTITY_MAP_SIZE_DEFAULT.
+// If 'capacity' is negative, identity map is disabled (default).
+void  sq_storage_set_identity_map(SqStorage *storage, int capacity);
+
+// share rows with other SqStorage through 'row_cache'. Rows are invalidated when they are changed by SqStorage.
+// 'row_cache' is not freed by SqStorage and must be valid until storage is freed. NULL to disable it (default).
+void  sq_storage_set_row_cache(SqStorage *storage, SqRowCache *row_cache);
+
+// cache results of get_all() and SELECT query() by SQL statement. Results are invalidated when their tables are
+// changed by SqStorage. 'query_cache' is not freed by SqStorage. NULL to disable it (default).
+void  sq_storage_set_query_cache(SqStorage *storage, SqQueryCache *query_cache);
+
+// record execution time of statements to latency histograms and slow-query log in 'metrics'.
+// 'metrics' is not freed by SqStorage and must be valid until storage is freed. NULL to disable it (default).
+// It uses trace hook of Sqdb during operation, trace hook that is set by user is still called.
+void  sq_storage_set_metrics(SqStorage *storage, SqMetrics *metrics);
+
 // open & close database
 int   sq_storage_open(SqStorage *storage, const char *database_name);
 int   sq_storage_close(SqStorage *storage);
@@ -79,12 +129,73 @@ void *sq_storage_get_all(SqStorage    *storage,
                          const SqType *container_type,
                          const char   *sql_where_having);
 
+// get rows by primary key. It splits 'ids' into statements "SELECT * FROM table_name WHERE id IN (...)".
+// Rows are in the order of 'ids'. Row is returned once if its id is duplicated, and missing id is skipped.
+// Pass sorted 'ids' to get container sorted by primary key, then rows can be found by binary search.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+void *sq_storage_get_many(SqStorage     *storage,
+                          const char    *table_name,
+                          const SqType  *table_type,
+                          const int64_t *ids,
+                          int            n_ids,
+                          const SqType  *container_type);
+
+// parameter 'sql_where_having' is SQL statement that exclude "SELECT * FROM table_name"
+// It streams rows by COPY TO STDOUT if Database product supports it, otherwise it works like sq_storage_get_all().
+// Rows are parsed when they arrive, but returned container has all rows. Use SqStorageCursor to handle rows one by one.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+void *sq_storage_copy_out(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          const SqType *container_type,
+                          const char   *sql_where_having);
+
 // return inserted row id if primary key has auto increment attribute.
 int64_t sq_storage_insert(SqStorage    *storage,
                           const char   *table_name,
                           const SqType *table_type,
                           void         *instance);
 
+// insert all elements of 'container' in bulk and return number of rows inserted.
+// It uses COPY FROM STDIN if Database product supports it, otherwise it uses INSERT with multiple rows.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+int64_t sq_storage_copy_in(SqStorage    *storage,
+                           const char   *table_name,
+                           const SqType *table_type,
+                           const SqType *container_type,
+                           void         *container);
+
+// insert all elements of 'container' by INSERT with multiple rows and return ids of inserted rows.
+// Statement is split automatically if it is too long. see SQ_CONFIG_SQXC_SQL_INSERT_ROWS and SQ_CONFIG_SQXC_SQL_INSERT_SIZE
+// It returns SqArray of int64_t, free it by sq_array_free(). If error occurred, it has ids of rows that have been inserted.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+SqArray *sq_storage_insert_all(SqStorage    *storage,
+                               const char   *table_name,
+                               const SqType *table_type,
+                               const SqType *container_type,
+                               void         *container);
+
+// insert 'instance' or update row if it conflicts with PRIMARY KEY or UNIQUE constraint.
+// Conflict target is PRIMARY KEY. If PRIMARY KEY has auto increment attribute, the first UNIQUE constraint is used.
+// pass column_name list after parameter 'instance' and the last argument must be NULL.
+// These columns are updated on conflict. If no column_name is passed, all columns except keys are updated.
+// return number of rows changed. (MySQL counts updated row as 2)
+int64_t sq_storage_upsert(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          void         *instance,
+                          ...);
+
+// upsert all elements of 'container' by INSERT with multiple rows. It is split like sq_storage_insert_all().
+// pass column_name list after parameter 'container' and the last argument must be NULL.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+int64_t sq_storage_upsert_all(SqStorage    *storage,
+                              const char   *table_name,
+                              const SqType *table_type,
+                              const SqType *container_type,
+                              void         *container,
+                              ...);
+
 // return number of rows changed.
 int   sq_storage_update(SqStorage    *storage,
                         const char   *table_name,
@@ -101,6 +212,20 @@ int64_t sq_storage_update_all(SqStorage    *storage,
                               const char   *sql_where_having,
                               ...);
 
+// update all elements of 'container' by primary key. It uses CASE expression to update multiple rows in a statement.
+// UPDATE "table" SET "column"=CASE "id" WHEN 1 THEN value1 WHEN 2 THEN value2 ELSE "column" END WHERE "id" IN (1,2)
+// Statement is split automatically if it is too long. see SQ_CONFIG_SQXC_SQL_UPDATE_ROWS
+// pass column_name list after parameter 'container' and the last argument must be NULL.
+// If no column_name is passed, all columns except primary key are updated.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+// return number of rows changed.
+int64_t sq_storage_update_many(SqStorage    *storage,
+                               const char   *table_name,
+                               const SqType *table_type,
+                               const SqType *container_type,
+                               void         *container,
+                               ...);
+
 #if SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 // parameter 'sql_where_having' is SQL statement that exclude "UPDATE table_name SET column=value"
 // pass field_offset list after parameter 'sql_where_having' and the last argument must be -1
@@ -113,15 +238,25 @@ int64_t sq_storage_update_field(SqStorage    *storage,
                                 ...);
 #endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 
-void  sq_storage_remove(SqStorage    *storage,
-                        const char   *table_name,
-                        const SqType *table_type,
-                        int64_t       id);
+// return number of rows deleted
+int64_t sq_storage_remove(SqStorage    *storage,
+                          const char   *table_name,
+                          const SqType *table_type,
+                          int64_t       id);
+
+// remove rows by primary key. It splits 'ids' into statements "DELETE FROM table_name WHERE id IN (...)".
+// return number of rows deleted. It stops at the first statement that failed and returns number of rows deleted before it.
+int64_t sq_storage_remove_many(SqStorage     *storage,
+                               const char    *table_name,
+                               const SqType  *table_type,
+                               const int64_t *ids,
+                               int            n_ids);
 
 // parameter 'sql_where_having' is SQL statement that exclude "DELETE FROM table_name"
-void  sq_storage_remove_all(SqStorage    *storage,
-                            const char   *table_name,
-                            const char   *sql_where_having);
+// return number of rows deleted
+int64_t sq_storage_remove_all(SqStorage    *storage,
+                              const char   *table_name,
+                              const char   *sql_where_having);
 
 int   sq_storage_begin_trans(SqStorage *storage);
 int   sq_storage_commit_trans(SqStorage *storage);
@@ -133,8 +268,117 @@ int   sq_storage_rollback_trans(SqStorage *storage);
 // SqTable *sq_storage_find(SqStorage *storage, const char *table_name);
 #define  sq_storage_find(storage, table_name)    sq_schema_find((storage)->schema, table_name)
 
+// get SqdbInfo of connections
+// const SqdbInfo *sq_storage_db_info(SqStorage *storage);
+#define  sq_storage_db_info(storage)    (((storage)->pool) ? (storage)->pool->info : (storage)->db->info)
+
 SqTable *sq_storage_find_by_type(SqStorage *storage, const char *type_name);
 
+// return true if table is changed in transaction of current thread. Its rows may not be committed,
+// so SqRowCache and SqQueryCache are not used for this table until transaction ends.
+bool  sq_storage_is_changed(SqStorage *storage, const char *table_name);
+
+// ------------------------------------
+// SqStorageContext
+
+/* sq_storage_acquire() get connection and Sqxc chains for one operation.
+   If SqStorage doesn't use SqdbPool, it fills 'context' with SqStorage members and returns it.
+   If SqStorage uses SqdbPool, it returns context that is pinned to current thread by sq_storage_begin_trans()
+   or idle context that has a connection from pool. 'context' is not used in this case.
+
+   return NULL if no connection is available.
+ */
+SqStorageContext *sq_storage_acquire(SqStorage *storage, SqStorageContext *context);
+
+// sq_storage_acquire_read() is the same as sq_storage_acquire() but it gets connection from
+// SqStorage::pool_read if it is set. Use this for operations that don't change database.
+SqStorageContext *sq_storage_acquire_read(SqStorage *storage, SqStorageContext *context);
+
+// return 'context' to SqStorage. It does nothing if SqStorage doesn't use SqdbPool.
+void  sq_storage_release(SqStorage *storage, SqStorageContext *context);
+
+// create SqTypeJoint that works like SqStorage::joint_default.
+// multi-threaded SqStorage uses it because SqStorage::joint_default can't be shared between threads.
+SqTypeJoint *sq_storage_new_joint(SqStorage *storage);
+
+// ------------------------------------
+// SqStorage-async.c
+
+/* Asynchronous functions push task to queue and return immediately.
+   Worker threads run tasks with their own connections and call 'callback' when task is completed.
+
+   Workers are started when the first task is pushed. The number of workers is SqdbPoolConfig::max_size.
+   If SqStorage doesn't use SqdbPool, there is only 1 worker and caller must not use synchronous functions
+   at the same time because they share SqStorage::db.
+   'table_name' and 'sql_where_having' are copied. 'instance' must be valid until 'callback' is called.
+ */
+
+// start 'n_workers' worker threads. If 'n_workers' <= 0, use SqdbPoolConfig::max_size.
+int   sq_storage_start_workers(SqStorage *storage, int n_workers);
+
+// wait for all queued tasks and stop worker threads. sq_storage_final() also does this.
+void  sq_storage_stop_workers(SqStorage *storage);
+
+/* Group commit: worker runs consecutive asynchronous writes (insert, update, remove, remove_all)
+   in a single BEGIN/COMMIT. A group is committed when it has 'max_rows' writes, when its first write
+   has waited 'max_delay' milliseconds, when a non-write task follows it, or when sq_storage_flush() is called.
+   'callback' of each write is called after COMMIT. If any write or COMMIT fails, the group is rolled back and
+   its writes run again one by one, so 'number' passed to each callback is result of its own write.
+   'max_rows' <= 1 disables group commit (default).
+ */
+void  sq_storage_set_group_commit(SqStorage *storage, int max_rows, int max_delay);
+
+// wait until all queued tasks are done. Pending writes of group commit are committed immediately.
+// It must not be called by worker thread.
+void  sq_storage_flush(SqStorage *storage);
+
+// run 'func' in worker thread
+int   sq_storage_run_async(SqStorage         *storage,
+                           SqStorageTaskFunc  func,
+                           void              *data);
+
+int   sq_storage_get_async(SqStorage          *storage,
+                           const char         *table_name,
+                           const SqType       *table_type,
+                           int64_t             id,
+                           SqStorageAsyncFunc  callback,
+                           void               *user_data);
+
+int   sq_storage_get_all_async(SqStorage          *storage,
+                               const char         *table_name,
+                               const SqType       *table_type,
+                               const SqType       *container_type,
+                               const char         *sql_where_having,
+                               SqStorageAsyncFunc  callback,
+                               void               *user_data);
+
+int   sq_storage_insert_async(SqStorage          *storage,
+                              const char         *table_name,
+                              const SqType       *table_type,
+                              void               *instance,
+                              SqStorageAsyncFunc  callback,
+                              void               *user_data);
+
+int   sq_storage_update_async(SqStorage          *storage,
+                              const char         *table_name,
+                              const SqType       *table_type,
+                              void               *instance,
+                              SqStorageAsyncFunc  callback,
+                              void               *user_data);
+
+int   sq_storage_remove_async(SqStorage          *storage,
+                              const char         *table_name,
+                              const SqType       *table_type,
+                              int64_t             id,
+                              SqStorageAsyncFunc  callback,
+                              void               *user_data);
+
+int   sq_storage_remove_all_async(SqStorage          *storage,
+                                  const char         *table_name,
+                                  const char         *sql_where_having,
+                                  SqStorageAsyncFunc  callback,
+                                  void               *user_data);
+
 // ------------------------------------
 // SqStorage-query.c
 
@@ -176,6 +420,42 @@ void *sq_storage_query_raw(SqStorage    *storage,
                            const SqType *table_type,
                            const SqType *container_type);
 
+// ------------------------------------
+// SqStorageCursor
+
+/* sq_storage_cursor_open() executes 'query' by prepared statement and return cursor that steps rows.
+   Rows are not put into container, so whole result set doesn't need to be held in memory.
+   If 'table_type' is NULL, it is decided by 'query' like sq_storage_query().
+
+   Cursor holds a connection until sq_storage_cursor_close() is called. MySQL and PostgreSQL can't
+   execute other statements on this connection while cursor is open, use multi-threaded SqStorage if
+   you need to do this. Rows returned by cursor are not added to identity map and caches.
+
+   return NULL if error occurred or Sqdb doesn't support prepared statement.
+ */
+SqStorageCursor *sq_storage_cursor_open(SqStorage     *storage,
+                                        SqQuery       *query,
+                                        const SqType  *table_type);
+
+// open cursor for "SELECT * FROM table_name" + 'sql_where_having'.
+SqStorageCursor *sq_storage_cursor_open_table(SqStorage     *storage,
+                                              const char    *table_name,
+                                              const SqType  *table_type,
+                                              const char    *sql_where_having);
+
+// If 'reuse' is true, sq_storage_cursor_next() parses every row into the same instance that is owned by cursor.
+// Otherwise caller must free instance that is returned by sq_storage_cursor_next().
+void  sq_storage_cursor_reuse(SqStorageCursor *cursor, bool reuse);
+
+// return next row. return NULL if there is no more rows or error occurred (see SqStorageCursor::code).
+void *sq_storage_cursor_next(SqStorageCursor *cursor);
+
+// return container that has at most 'n_rows' rows. return NULL if there is no more rows or error occurred.
+// if 'container_type' is NULL, it use SqStorage::container_default.
+void *sq_storage_cursor_next_batch(SqStorageCursor *cursor, int n_rows, const SqType *container_type);
+
+void  sq_storage_cursor_close(SqStorageCursor *cursor);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -187,6 +467,9 @@ void *sq_storage_query_raw(SqStorage    *storage,
 
 namespace Sq {
 
+template <typename Type>
+class StorageCursor;
+
 /*	StorageMethod is used by SqStorage and it's children.
 
 	It's derived struct/class must be C++11 standard-layout and has SqStorage members.
@@ -202,6 +485,12 @@ struct StorageMethod
 	int   open(const char *databaseName);
 	int   close(void);
 
+	void  setPoolRead(SqdbPool *poolRead);
+	void  setIdentityMap(int capacity);
+	void  setRowCache(SqRowCache *rowCache);
+	void  setQueryCache(SqQueryCache *queryCache);
+	void  setMetrics(SqMetrics *metrics);
+
 	int   migrate(SqSchema *schema);
 
 	Sq::Table  *find(const char *tableName);
@@ -303,6 +592,13 @@ struct StorageMethod
 
 //  --- End of getAll() for QueryProxy & QueryMethod pointer ---
 
+	// getMany<StructType, std::vector<StructType>>(ids)
+	template <typename ElementType, typename StlContainer>
+	StlContainer *getMany(const std::vector<int64_t> &ids);
+	// getMany() without template
+	void *getMany(const char *tableName, const int64_t *ids, int nIds, const SqType *containerType = NULL);
+	void *getMany(const char *tableName, const SqType *tableType, const int64_t *ids, int nIds, const SqType *containerType = NULL);
+
 	Sq::Type *setupQuery(Sq::QueryMethod &query, Sq::TypeJointMethod *jointType);
 	Sq::Type *setupQuery(Sq::QueryMethod *query, Sq::TypeJointMethod *jointType);
 
@@ -334,6 +630,19 @@ struct StorageMethod
 	void *query(Sq::QueryMethod *query, const SqType *tableType, const SqType *containerType);
 	void *query(const char  *query_str, const SqType *tableType, const SqType *containerType);
 
+	// cursor<StructType>(sqlWhereHaving)
+	template <typename StructType>
+	Sq::StorageCursor<StructType> cursor(const char *sqlWhereHaving = NULL);
+	// cursor<StructType>(query)
+	template <typename StructType>
+	Sq::StorageCursor<StructType> cursor(Sq::QueryMethod &query);
+	template <typename StructType>
+	Sq::StorageCursor<StructType> cursor(Sq::QueryProxy &qproxy);
+	// openCursor() without template
+	SqStorageCursor *openCursor(const char *tableName, const char *sqlWhereHaving = NULL);
+	SqStorageCursor *openCursor(const char *tableName, const SqType *tableType, const char *sqlWhereHaving);
+	SqStorageCursor *openCursor(Sq::QueryMethod &query, const SqType *tableType = NULL);
+
 	// insert<StructType>(struct_pointer);
 	template <typename StructType>
 	int64_t  insert(void *instance);
@@ -347,6 +656,36 @@ struct StorageMethod
 	int64_t  insert(const char *tableName, void *instance);
 	int64_t  insert(const char *tableName, const SqType *tableType, void *instance);
 
+	// copyOut<std::vector<StructType>>()
+	template <typename StlContainer>
+	StlContainer *copyOut(const char *sqlWhereHaving = NULL);
+	// copyOut() without template
+	void *copyOut(const char *tableName, const SqType *tableType, const SqType *containerType, const char *sqlWhereHaving = NULL);
+
+	// copyIn(stl_container_reference)
+	template <typename StlContainer>
+	int64_t  copyIn(StlContainer &container);
+	// copyIn() without template
+	int64_t  copyIn(const char *tableName, void *container, const SqType *containerType = NULL);
+	int64_t  copyIn(const char *tableName, const SqType *tableType, void *container, const SqType *containerType = NULL);
+
+	// insertAll(stl_container_reference). It returns ids of inserted rows.
+	template <typename StlContainer>
+	std::vector<int64_t>  insertAll(StlContainer &container);
+	// insertAll() without template
+	std::vector<int64_t>  insertAll(const char *tableName, void *container, const SqType *containerType = NULL);
+	std::vector<int64_t>  insertAll(const char *tableName, const SqType *tableType, void *container, const SqType *containerType = NULL);
+
+	// upsert(struct_pointer, columnName...)
+	template <typename StructType, typename... Args>
+	int64_t  upsert(StructType *instance, const Args... args);
+	// upsert(struct_reference, columnName...)
+	template <typename StructType, typename... Args>
+	int64_t  upsert(StructType &instance, const Args... args);
+	// upsertAll(stl_container_reference, columnName...)
+	template <typename StlContainer, typename... Args>
+	int64_t  upsertAll(StlContainer &container, const Args... args);
+
 	// update<StructType>(struct_pointer)
 	template <typename StructType>
 	int   update(void *instance);
@@ -435,6 +774,10 @@ struct StorageMethod
 
 //  --- End of updateAll() for QueryProxy & QueryMethod pointer ---
 
+	// updateMany(stl_container_reference, columnName...)
+	template <typename StlContainer, typename... Args>
+	int64_t  updateMany(StlContainer &container, const Args... args);
+
 #if SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 	// updateField<StructType>(struct_pointer)
 	template <typename StructType, typename... Args>
@@ -514,21 +857,27 @@ struct StorageMethod
 #endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 
 	template <typename StructType>
-	void  remove(int64_t id);
-	void  remove(const char *tableName, int64_t id);
-	void  remove(const char *tableName, const SqType *tableType, int64_t id);
+	int64_t  remove(int64_t id);
+	int64_t  remove(const char *tableName, int64_t id);
+	int64_t  remove(const char *tableName, const SqType *tableType, int64_t id);
+
+	// removeMany<StructType>(ids)
+	template <typename StructType>
+	int64_t  removeMany(const std::vector<int64_t> &ids);
+	int64_t  removeMany(const char *tableName, const int64_t *ids, int nIds);
+	int64_t  removeMany(const char *tableName, const SqType *tableType, const int64_t *ids, int nIds);
 
 	// removeAll<StructType>()
 	template <typename StructType>
-	void  removeAll(const char *sqlWhereHaving = NULL);
+	int64_t  removeAll(const char *sqlWhereHaving = NULL);
 	template <typename StructType>
-	void  removeAll(QueryMethod &query);
+	int64_t  removeAll(QueryMethod &query);
 	template <typename StructType>
-	void  removeAll(QueryProxy &qproxy);
+	int64_t  removeAll(QueryProxy &qproxy);
 	// removeAll() with tableName
-	void  removeAll(const char *tableName, const char *sqlWhereHaving = NULL);
-	void  removeAll(const char *tableName, QueryMethod &query);
-	void  removeAll(const char *tableName, QueryProxy &qproxy);
+	int64_t  removeAll(const char *tableName, const char *sqlWhereHaving = NULL);
+	int64_t  removeAll(const char *tableName, QueryMethod &query);
+	int64_t  removeAll(const char *tableName, QueryProxy &qproxy);
 
 //  --- removeAll() for QueryProxy & QueryMethod pointer ---
 
@@ -537,19 +886,50 @@ struct StorageMethod
 	          typename std::enable_if<(std::is_base_of<QueryProxy,  QueryType>::value ||
 	                                   std::is_base_of<QueryMethod, QueryType>::value) &&
 	                                  !std::is_same<QueryType, decltype(NULL)>::value >::type * = nullptr>
-	void  removeAll(QueryType *query);
+	int64_t  removeAll(QueryType *query);
 
 	template <typename QueryType,
 	          typename std::enable_if<(std::is_base_of<QueryProxy,  QueryType>::value ||
 	                                   std::is_base_of<QueryMethod, QueryType>::value) &&
 	                                  !std::is_same<QueryType, decltype(NULL)>::value >::type * = nullptr>
-	void  removeAll(const char *tableName, QueryType *query);
+	int64_t  removeAll(const char *tableName, QueryType *query);
 
 //  --- End of removeAll() for QueryProxy & QueryMethod pointer ---
 
 	int   beginTrans();
 	int   commitTrans();
 	int   rollbackTrans();
+
+	// --- asynchronous methods. They return std::future and run in worker thread. ---
+
+	int   startWorkers(int nWorkers = 0);
+	void  stopWorkers();
+	void  setGroupCommit(int maxRows, int maxDelay);
+	void  flush();
+
+	// async([](SqStorage *storage) { return result; })
+	template <typename Function>
+	std::future<decltype(std::declval<Function>()((SqStorage*)NULL))>  async(Function func);
+
+	// getAsync<StructType>(id)
+	template <typename StructType>
+	std::future<StructType*>    getAsync(int64_t id);
+	// getAllAsync<std::vector<StructType>>()
+	template <typename StlContainer>
+	std::future<StlContainer*>  getAllAsync(const char *sqlWhereHaving = NULL);
+	// insertAsync(struct_pointer). 'instance' must be valid until std::future is ready.
+	template <typename StructType>
+	std::future<int64_t>  insertAsync(StructType *instance);
+	// updateAsync(struct_pointer). 'instance' must be valid until std::future is ready.
+	template <typename StructType>
+	std::future<int>      updateAsync(StructType *instance);
+	// removeAsync<StructType>(id). std::future returns number of rows deleted.
+	template <typename StructType>
+	std::future<int64_t>  removeAsync(int64_t id);
+
+	// callback of insertAsync(), updateAsync(), and removeAsync(). 'data' is std::promise<Result>.
+	template <typename Result>
+	static void  asyncDone(SqStorage *storage, void *result, int64_t number, void *data);
 };
 
 };  // namespace Sq
@@ -559,14 +939,71 @@ struct StorageMethod
 // ----------------------------------------------------------------------------
 // C/C++ common definitions: define structure
 
+/*	SqStorageContext - connection and Sqxc chains that are used by one operation.
+ */
+struct SqStorageContext
+{
+	Sqdb        *db;
+	Sqxc        *xc_input;      // SqxcValue
+	Sqxc        *xc_output;     // SqxcSql
+	SqTypeJoint *joint;
+
+	// pool that 'db' comes from
+	SqdbPool    *pool;
+
+	// thread that pins this context by sq_storage_begin_trans()
+	SqThreadId   thread;
+	bool         pinned;
+
+	// tables that are changed in transaction. They are removed from SqRowCache when transaction ends.
+	SqStrArray   changed;
+
+	// SqMetrics: trace hook of 'db' is replaced during operation. 'trace' and 'trace_data' are previous hook.
+	SqMetrics     *metrics;
+	SqdbTraceFunc  trace;
+	void          *trace_data;
+	bool           traced;
+	// current operation
+	int            operation;     // SQ_METRICS_GET, SQ_METRICS_GET_ALL...etc
+	const char    *table_name;
+	const int64_t *bound_id;      // primary key that is bound to prepared statement. It can be NULL.
+};
+
+/*	SqStorageCursor - steps rows of SELECT statement one by one. It is created by sq_storage_cursor_open().
+ */
+struct SqStorageCursor
+{
+	SqStorage        *storage;
+	SqStorageContext *context;
+	SqStorageContext  local;      // context of single thread SqStorage
+
+	// cursor has its own Sqxc chain, so other operations can run while cursor is open.
+	Sqxc             *xc_input;   // SqxcValue
+	SqTypeJoint      *joint;
+	const SqType     *type;       // type of row
+	SqdbStmt         *stmt;
+
+	void             *instance;   // instance that is reused if 'reuse' is true
+	bool              reuse;
+
+	// SQCODE_ROW if cursor may have more rows, SQCODE_DONE if all rows have been returned, or error code.
+	int               code;
+};
+
 /*	SqStorage
 	  SqStorage access database. It using Sqxc to convert data between C language and Sqdb instance.
 
 	Notes about multithreading:
-	1. 'schema', 'tables', 'tables_version' must be shared between threads.
-	   use readers-writer lock to access these data member.
-	2. 'xc_input' and 'xc_output' are NOT shared between threads.
-	   each thread has its Sqxc chain ('xc_input' and 'xc_output').
+	1. SqStorage that is created by sq_storage_new_pool() can be used by multiple threads.
+	   Each operation uses a connection from SqdbPool and an idle SqStorageContext that has its own Sqxc chain.
+	2. 'schema' is shared between threads. It must not be changed (e.g. by sq_storage_migrate())
+	   while other threads are using SqStorage. 'tables' and 'tables_version' are protected by 'mutex'.
+	3. A transaction pins its SqStorageContext to the thread that calls sq_storage_begin_trans(),
+	   other operations in the same thread use the same connection until commit or rollback.
+	4. If 'pool_read' is set, read-only operations use connections in 'pool_read' except in transaction.
+	5. 'identity_map' is shared between threads and protected by 'mutex'.
+	6. 'row_cache' and 'query_cache' have their own locks. They can be shared by multiple SqStorage.
+	7. 'metrics' has its own lock. It can be shared by multiple SqStorage.
  */
 
 #define SQ_STORAGE_MEMBERS               \
@@ -577,7 +1014,21 @@ struct StorageMethod
 	Sqxc      *xc_input;                 \
 	Sqxc      *xc_output;                \
 	SqTypeJoint    *joint_default;       \
-	const SqType   *container_default
+	const SqType   *container_default;   \
+	SqdbPool  *pool;                     \
+	SqdbPool  *pool_read;                \
+	SqMutex    mutex;                    \
+	SqPtrArray contexts;                 \
+	SqPtrArray pinned;                   \
+	SqStorageWorkers *workers;           \
+	int               group_rows;        \
+	int               group_delay;       \
+	SqIdentityMap    *identity_map;      \
+	SqRowCache       *row_cache;         \
+	SqQueryCache     *query_cache;       \
+	SqMetrics        *metrics;           \
+	SqStrArray        changed;           \
+	bool              in_trans
 
 #ifdef __cplusplus
 struct SqStorage : Sq::StorageMethod         // <-- 1. inherit C++ member function(method)
@@ -595,12 +1046,43 @@ struct SqStorage
 	SqPtrArray tables;
 	int        tables_version;
 
-	// each thread has its Sqxc chain
+	// Sqxc chain for single thread
 	Sqxc      *xc_input;    // SqxcValue
 	Sqxc      *xc_output;   // SqxcSql
 
 	SqTypeJoint    *joint_default;
 	const SqType   *container_default;
+
+	// multi-threaded SqStorage. 'db', 'xc_input', and 'xc_output' are not used if 'pool' is not NULL.
+	SqdbPool  *pool;
+	SqdbPool  *pool_read;   // connections for read-only operations. It can be NULL.
+	SqMutex    mutex;
+	SqPtrArray contexts;    // idle SqStorageContext
+	SqPtrArray pinned;      // SqStorageContext that are pinned to threads by transaction
+
+	// worker threads of asynchronous functions
+	SqStorageWorkers *workers;
+
+	// group commit of asynchronous write tasks. It is disabled if 'group_rows' <= 1.
+	int               group_rows;     // maximum number of writes in a transaction
+	int               group_delay;    // maximum milliseconds that a write waits in queue
+
+	// rows cached by table name and primary key. It is NULL if identity map is disabled.
+	SqIdentityMap    *identity_map;
+
+	// rows shared with other SqStorage. It is NULL if row cache is disabled.
+	SqRowCache       *row_cache;
+
+	// results of SELECT statement. It is NULL if query cache is disabled.
+	SqQueryCache     *query_cache;
+
+	// latency histograms and slow-query log. It is NULL if metrics is disabled.
+	SqMetrics        *metrics;
+
+	// single thread: tables that are changed in transaction and whether transaction is running.
+	// multi-threaded SqStorage uses SqStorageContext::changed of pinned context.
+	SqStrArray        changed;
+	bool              in_trans;
  */
 };
 
@@ -622,17 +1104,134 @@ struct SqStorage
 
 namespace Sq {
 
+/*	StorageCursor is input range that steps rows of SqStorageCursor.
+	Every row is parsed into the same instance, copy it if you need to keep it after next row.
+
+	for (auto &user : storage->cursor<User>("WHERE age > 18"))
+		std::cout << user.name << std::endl;
+ */
+template <typename Type>
+class StorageCursor
+{
+	SqStorageCursor *cursor;
+	Type            *current;
+
+public:
+	class iterator
+	{
+		StorageCursor *range;
+
+	public:
+		typedef std::input_iterator_tag  iterator_category;
+		typedef Type                     value_type;
+		typedef std::ptrdiff_t           difference_type;
+		typedef Type                    *pointer;
+		typedef Type                    &reference;
+
+		iterator(StorageCursor *range = NULL) {
+			this->range = (range && range->current) ? range : NULL;
+		}
+		Type &operator*() const {
+			return *range->current;
+		}
+		Type *operator->() const {
+			return range->current;
+		}
+		iterator &operator++() {
+			if (range->next() == NULL)
+				range = NULL;
+			return *this;
+		}
+		bool operator==(const iterator &other) const {
+			return range == other.range;
+		}
+		bool operator!=(const iterator &other) const {
+			return range != other.range;
+		}
+	};
+
+	// constructor
+	StorageCursor(SqStorageCursor *cursor = NULL) {
+		this->cursor  = cursor;
+		this->current = NULL;
+		if (cursor)
+			sq_storage_cursor_reuse(cursor, true);
+	}
+	StorageCursor(StorageCursor &&src) {
+		cursor  = src.cursor;
+		current = src.current;
+		src.cursor  = NULL;
+		src.current = NULL;
+	}
+	StorageCursor(const StorageCursor &src) = delete;
+	StorageCursor &operator=(const StorageCursor &src) = delete;
+	// destructor
+	~StorageCursor() {
+		if (cursor)
+			sq_storage_cursor_close(cursor);
+	}
+
+	// return true if cursor was opened
+	bool      isOpen() const {
+		return cursor != NULL;
+	}
+	// return SQCODE_ROW, SQCODE_DONE, or error code. See SqStorageCursor::code.
+	int       code() const {
+		return (cursor) ? cursor->code : SQCODE_ERROR;
+	}
+	// return next row. It is owned by cursor and is valid until next row is returned.
+	Type     *next() {
+		current = (cursor) ? (Type*)sq_storage_cursor_next(cursor) : NULL;
+		return current;
+	}
+	// return container that has at most 'nRows' rows. Caller must delete it.
+	template <typename StlContainer>
+	StlContainer *nextBatch(int nRows) {
+		if (cursor == NULL)
+			return NULL;
+		Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(cursor->type);
+		StlContainer *instance = (StlContainer*) sq_storage_cursor_next_batch(cursor, nRows, containerType);
+		delete containerType;
+		return instance;
+	}
+
+	// begin() steps the first row. Cursor can only be iterated once.
+	iterator  begin() {
+		next();
+		return iterator(this);
+	}
+	iterator  end() {
+		return iterator();
+	}
+};
+
 /* define StorageMethod functions. */
 
 inline int   StorageMethod::open(const char *databaseName) {
-	return sqdb_open(((SqStorage*)this)->db, databaseName);
+	return sq_storage_open((SqStorage*)this, databaseName);
 }
 inline int   StorageMethod::close(void) {
-	return sqdb_close(((SqStorage*)this)->db);
+	return sq_storage_close((SqStorage*)this);
+}
+
+inline void  StorageMethod::setPoolRead(SqdbPool *poolRead) {
+	sq_storage_set_pool_read((SqStorage*)this, poolRead);
+}
+inline void  StorageMethod::setIdentityMap(int capacity) {
+	sq_storage_set_identity_map((SqStorage*)this, capacity);
+}
+inline void  StorageMethod::setRowCache(SqRowCache *rowCache) {
+	sq_storage_set_row_cache((SqStorage*)this, rowCache);
+}
+inline void  StorageMethod::setQueryCache(SqQueryCache *queryCache) {
+	sq_storage_set_query_cache((SqStorage*)this, queryCache);
+}
+inline void  StorageMethod::setMetrics(SqMetrics *metrics) {
+	sq_storage_set_metrics((SqStorage*)this, metrics);
 }
 
 inline int   StorageMethod::migrate(SqSchema *schema) {
-	return sqdb_migrate(((SqStorage*)this)->db, ((SqStorage*)this)->schema, schema);
+	return sq_storage_migrate((SqStorage*)this, schema);
 }
 
 inline Sq::Table *StorageMethod::find(const char *tableName) {
@@ -642,6 +1241,31 @@ inline Sq::Table *StorageMethod::findByTypeName(const char *typeName) {
 	return (Sq::Table*)sq_storage_find_by_type((SqStorage*)this, typeName);
 }
 
+template <typename StructType>
+inline Sq::StorageCursor<StructType> StorageMethod::cursor(const char *sqlWhereHaving) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
+	if (table == NULL)
+		return Sq::StorageCursor<StructType>();
+	return Sq::StorageCursor<StructType>(sq_storage_cursor_open_table((SqStorage*)this, table->name, table->type, sqlWhereHaving));
+}
+template <typename StructType>
+inline Sq::StorageCursor<StructType> StorageMethod::cursor(Sq::QueryMethod &query) {
+	return Sq::StorageCursor<StructType>(sq_storage_cursor_open((SqStorage*)this, (SqQuery*)&query, NULL));
+}
+template <typename StructType>
+inline Sq::StorageCursor<StructType> StorageMethod::cursor(Sq::QueryProxy &qproxy) {
+	return Sq::StorageCursor<StructType>(sq_storage_cursor_open((SqStorage*)this, qproxy.query(), NULL));
+}
+inline SqStorageCursor *StorageMethod::openCursor(const char *tableName, const char *sqlWhereHaving) {
+	return sq_storage_cursor_open_table((SqStorage*)this, tableName, NULL, sqlWhereHaving);
+}
+inline SqStorageCursor *StorageMethod::openCursor(const char *tableName, const SqType *tableType, const char *sqlWhereHaving) {
+	return sq_storage_cursor_open_table((SqStorage*)this, tableName, tableType, sqlWhereHaving);
+}
+inline SqStorageCursor *StorageMethod::openCursor(Sq::QueryMethod &query, const SqType *tableType) {
+	return sq_storage_cursor_open((SqStorage*)this, (SqQuery*)&query, tableType);
+}
+
 template <typename StructType>
 inline StructType *StorageMethod::get(int64_t id) {
 	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
@@ -821,6 +1445,25 @@ inline void *StorageMethod::getAll(const char *tableName, const SqType *tableTyp
 
 //  --- End of getAll() for QueryProxy & QueryMethod pointer ---
 
+template <typename ElementType, typename StlContainer>
+inline StlContainer *StorageMethod::getMany(const std::vector<int64_t> &ids) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this,
+			typeid(typename std::remove_reference< typename std::remove_pointer<ElementType>::type >::type).name());
+	if (table == NULL)
+		return NULL;
+	Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(table->type);
+	StlContainer *instance = (StlContainer*) sq_storage_get_many((SqStorage*)this, table->name, table->type,
+	                                                             ids.data(), (int)ids.size(), containerType);
+	delete containerType;
+	return instance;
+}
+inline void *StorageMethod::getMany(const char *tableName, const int64_t *ids, int nIds, const SqType *containerType) {
+	return sq_storage_get_many((SqStorage*)this, tableName, NULL, ids, nIds, containerType);
+}
+inline void *StorageMethod::getMany(const char *tableName, const SqType *tableType, const int64_t *ids, int nIds, const SqType *containerType) {
+	return sq_storage_get_many((SqStorage*)this, tableName, tableType, ids, nIds, containerType);
+}
+
 inline Sq::Type *StorageMethod::setupQuery(Sq::QueryMethod &query, Sq::TypeJointMethod *jointType) {
 	return (Sq::Type*)sq_storage_setup_query((SqStorage*)this, (SqQuery*)&query, (SqTypeJoint*)jointType);
 }
@@ -838,13 +1481,19 @@ inline StlContainer *StorageMethod::query(Sq::QueryProxy &qproxy) {
 }
 template <typename StlContainer>
 inline StlContainer *StorageMethod::query(Sq::QueryMethod *query) {
-	void    *instance  = NULL;
-	SqType  *tableType = sq_storage_setup_query((SqStorage*)this, (SqQuery*)query, ((SqStorage*)this)->joint_default);
+	void        *instance  = NULL;
+	SqTypeJoint *typeJoint = ((SqStorage*)this)->joint_default;
+	// multi-threaded SqStorage can't share SqStorage::joint_default
+	if (((SqStorage*)this)->pool)
+		typeJoint = sq_storage_new_joint((SqStorage*)this);
+	SqType  *tableType = sq_storage_setup_query((SqStorage*)this, (SqQuery*)query, typeJoint);
 	if (tableType) {
 		Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(tableType);
 		instance = sq_storage_query((SqStorage*)this, (SqQuery*)query, tableType, containerType);
 		delete containerType;
 	}
+	if (typeJoint != ((SqStorage*)this)->joint_default)
+		sq_type_joint_free(typeJoint);
 	return (StlContainer*)instance;
 }
 template <typename StlContainer>
@@ -915,6 +1564,85 @@ inline int64_t  StorageMethod::insert(const char *tableName, const SqType *table
 	return sq_storage_insert((SqStorage*)this, tableName, tableType, instance);
 }
 
+template <typename StlContainer>
+inline StlContainer *StorageMethod::copyOut(const char *sqlWhereHaving) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this,
+			typeid(typename std::remove_reference< typename std::remove_pointer<typename StlContainer::value_type>::type >::type).name());
+	if (table == NULL)
+		return NULL;
+	Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(table->type);
+	StlContainer *instance = (StlContainer*) sq_storage_copy_out((SqStorage*)this, table->name, table->type, containerType, sqlWhereHaving);
+	delete containerType;
+	return instance;
+}
+inline void *StorageMethod::copyOut(const char *tableName, const SqType *tableType, const SqType *containerType, const char *sqlWhereHaving) {
+	return sq_storage_copy_out((SqStorage*)this, tableName, tableType, containerType, sqlWhereHaving);
+}
+
+template <typename StlContainer>
+inline int64_t  StorageMethod::copyIn(StlContainer &container) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this,
+			typeid(typename std::remove_reference< typename std::remove_pointer<typename StlContainer::value_type>::type >::type).name());
+	if (table == NULL)
+		return 0;
+	Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(table->type);
+	int64_t  n_rows = sq_storage_copy_in((SqStorage*)this, table->name, table->type, containerType, (void*)&container);
+	delete containerType;
+	return n_rows;
+}
+inline int64_t  StorageMethod::copyIn(const char *tableName, void *container, const SqType *containerType) {
+	return sq_storage_copy_in((SqStorage*)this, tableName, NULL, containerType, container);
+}
+inline int64_t  StorageMethod::copyIn(const char *tableName, const SqType *tableType, void *container, const SqType *containerType) {
+	return sq_storage_copy_in((SqStorage*)this, tableName, tableType, containerType, container);
+}
+
+template <typename StructType, typename... Args>
+inline int64_t  StorageMethod::upsert(StructType *instance, const Args... args) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
+	if (table == NULL)
+		return 0;
+	return sq_storage_upsert((SqStorage*)this, table->name, table->type, (void*)instance, args..., NULL);
+}
+template <typename StructType, typename... Args>
+inline int64_t  StorageMethod::upsert(StructType &instance, const Args... args) {
+	return upsert(&instance, args...);
+}
+template <typename StlContainer, typename... Args>
+inline int64_t  StorageMethod::upsertAll(StlContainer &container, const Args... args) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this,
+			typeid(typename std::remove_reference< typename std::remove_pointer<typename StlContainer::value_type>::type >::type).name());
+	if (table == NULL)
+		return 0;
+	Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(table->type);
+	int64_t  changes = sq_storage_upsert_all((SqStorage*)this, table->name, table->type, containerType, (void*)&container, args..., NULL);
+	delete containerType;
+	return changes;
+}
+
+template <typename StlContainer>
+inline std::vector<int64_t>  StorageMethod::insertAll(StlContainer &container) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this,
+			typeid(typename std::remove_reference< typename std::remove_pointer<typename StlContainer::value_type>::type >::type).name());
+	if (table == NULL)
+		return std::vector<int64_t>();
+	Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(table->type);
+	std::vector<int64_t>  ids = insertAll(table->name, table->type, (void*)&container, containerType);
+	delete containerType;
+	return ids;
+}
+inline std::vector<int64_t>  StorageMethod::insertAll(const char *tableName, void *container, const SqType *containerType) {
+	return insertAll(tableName, NULL, container, containerType);
+}
+inline std::vector<int64_t>  StorageMethod::insertAll(const char *tableName, const SqType *tableType, void *container, const SqType *containerType) {
+	SqArray *array = sq_storage_insert_all((SqStorage*)this, tableName, tableType, containerType, container);
+	if (array == NULL)
+		return std::vector<int64_t>();
+	std::vector<int64_t>  ids(sq_array_begin(array, int64_t), sq_array_end(array, int64_t));
+	sq_array_free(array);
+	return ids;
+}
+
 template <typename StructType>
 inline int  StorageMethod::update(void *instance) {
 	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
@@ -1054,6 +1782,18 @@ inline int64_t  StorageMethod::updateAll(const char *tableName, const SqType *ta
 
 //  --- End of updateAll() for QueryProxy & QueryMethod pointer ---
 
+template <typename StlContainer, typename... Args>
+inline int64_t  StorageMethod::updateMany(StlContainer &container, const Args... args) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this,
+			typeid(typename std::remove_reference< typename std::remove_pointer<typename StlContainer::value_type>::type >::type).name());
+	if (table == NULL)
+		return 0;
+	Sq::TypeStl<StlContainer> *containerType = new Sq::TypeStl<StlContainer>(table->type);
+	int64_t  changes = sq_storage_update_many((SqStorage*)this, table->name, table->type, containerType, (void*)&container, args..., NULL);
+	delete containerType;
+	return changes;
+}
+
 #if SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 
 template <typename StructType, typename... Args>
@@ -1176,41 +1916,57 @@ inline int64_t  StorageMethod::updateField(const char *tableName, const SqType *
 #endif  // SQ_CONFIG_HAS_STORAGE_UPDATE_FIELD
 
 template <typename StructType>
-inline void StorageMethod::remove(int64_t id) {
+inline int64_t StorageMethod::remove(int64_t id) {
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
+	if (table)
+		return sq_storage_remove((SqStorage*)this, table->name, table->type, id);
+	return 0;
+}
+inline int64_t StorageMethod::remove(const char *tableName, int64_t id) {
+	return sq_storage_remove((SqStorage*)this, tableName, NULL, id);
+}
+inline int64_t StorageMethod::remove(const char *tableName, const SqType *tableType, int64_t id) {
+	return sq_storage_remove((SqStorage*)this, tableName, tableType, id);
+}
+
+template <typename StructType>
+inline int64_t StorageMethod::removeMany(const std::vector<int64_t> &ids) {
 	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
 	if (table)
-		sq_storage_remove((SqStorage*)this, table->name, table->type, id);
+		return sq_storage_remove_many((SqStorage*)this, table->name, table->type, ids.data(), (int)ids.size());
+	return 0;
 }
-inline void StorageMethod::remove(const char *tableName, int64_t id) {
-	sq_storage_remove((SqStorage*)this, tableName, NULL, id);
+inline int64_t StorageMethod::removeMany(const char *tableName, const int64_t *ids, int nIds) {
+	return sq_storage_remove_many((SqStorage*)this, tableName, NULL, ids, nIds);
 }
-inline void StorageMethod::remove(const char *tableName, const SqType *tableType, int64_t id) {
-	sq_storage_remove((SqStorage*)this, tableName, tableType, id);
+inline int64_t StorageMethod::removeMany(const char *tableName, const SqType *tableType, const int64_t *ids, int nIds) {
+	return sq_storage_remove_many((SqStorage*)this, tableName, tableType, ids, nIds);
 }
 
 template <typename StructType>
-inline void StorageMethod::removeAll(const char *sqlWhereHaving) {
+inline int64_t StorageMethod::removeAll(const char *sqlWhereHaving) {
 	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
 	if (table)
-		sq_storage_remove_all((SqStorage*)this, table->name, sqlWhereHaving);
+		return sq_storage_remove_all((SqStorage*)this, table->name, sqlWhereHaving);
+	return 0;
 }
 template <typename StructType>
-inline void StorageMethod::removeAll(QueryMethod &query) {
-	removeAll<StructType>(query.c());
+inline int64_t StorageMethod::removeAll(QueryMethod &query) {
+	return removeAll<StructType>(query.c());
 }
 template <typename StructType>
-inline void StorageMethod::removeAll(QueryProxy &qproxy) {
-	removeAll<StructType>(qproxy.c());
+inline int64_t StorageMethod::removeAll(QueryProxy &qproxy) {
+	return removeAll<StructType>(qproxy.c());
 }
 
-inline void StorageMethod::removeAll(const char *tableName, const char *sqlWhereHaving) {
-	sq_storage_remove_all((SqStorage*)this, tableName, sqlWhereHaving);
+inline int64_t StorageMethod::removeAll(const char *tableName, const char *sqlWhereHaving) {
+	return sq_storage_remove_all((SqStorage*)this, tableName, sqlWhereHaving);
 }
-inline void StorageMethod::removeAll(const char *tableName, QueryMethod &query) {
-	sq_storage_remove_all((SqStorage*)this, tableName, query.c());
+inline int64_t StorageMethod::removeAll(const char *tableName, QueryMethod &query) {
+	return sq_storage_remove_all((SqStorage*)this, tableName, query.c());
 }
-inline void StorageMethod::removeAll(const char *tableName, QueryProxy &qproxy) {
-	sq_storage_remove_all((SqStorage*)this, tableName, qproxy.c());
+inline int64_t StorageMethod::removeAll(const char *tableName, QueryProxy &qproxy) {
+	return sq_storage_remove_all((SqStorage*)this, tableName, qproxy.c());
 }
 
 //  --- removeAll() for QueryProxy & QueryMethod pointer ---
@@ -1220,16 +1976,16 @@ template <typename StructType,
           typename std::enable_if<(std::is_base_of<QueryProxy,  QueryType>::value ||
                                    std::is_base_of<QueryMethod, QueryType>::value) &&
                                   !std::is_same<QueryType, decltype(NULL)>::value >::type *>
-inline void  StorageMethod::removeAll(QueryType *query) {
-	removeAll<StructType>(query->c());
+inline int64_t StorageMethod::removeAll(QueryType *query) {
+	return removeAll<StructType>(query->c());
 }
 
 template <typename QueryType,
           typename std::enable_if<(std::is_base_of<QueryProxy,  QueryType>::value ||
                                    std::is_base_of<QueryMethod, QueryType>::value) &&
                                   !std::is_same<QueryType, decltype(NULL)>::value >::type *>
-inline void  StorageMethod::removeAll(const char *tableName, QueryType *query) {
-	sq_storage_remove_all((SqStorage*)this, tableName, query->c());
+inline int64_t StorageMethod::removeAll(const char *tableName, QueryType *query) {
+	return sq_storage_remove_all((SqStorage*)this, tableName, query->c());
 }
 
 //  --- End of removeAll() for QueryProxy & QueryMethod pointer ---
@@ -1244,6 +2000,91 @@ inline int  StorageMethod::rollbackTrans() {
 	return sq_storage_rollback_trans((SqStorage*)this);
 }
 
+inline int  StorageMethod::startWorkers(int nWorkers) {
+	return sq_storage_start_workers((SqStorage*)this, nWorkers);
+}
+inline void StorageMethod::stopWorkers() {
+	sq_storage_stop_workers((SqStorage*)this);
+}
+inline void StorageMethod::setGroupCommit(int maxRows, int maxDelay) {
+	sq_storage_set_group_commit((SqStorage*)this, maxRows, maxDelay);
+}
+inline void StorageMethod::flush() {
+	sq_storage_flush((SqStorage*)this);
+}
+
+template <typename Function>
+inline std::future<decltype(std::declval<Function>()((SqStorage*)NULL))>  StorageMethod::async(Function func) {
+	typedef decltype(func((SqStorage*)NULL))      Result;
+	typedef std::packaged_task<Result(SqStorage*)>  Task;
+
+	Task *task = new Task(func);
+	std::future<Result> future = task->get_future();
+	sq_storage_run_async((SqStorage*)this, [](SqStorage *storage, void *data) {
+		Task *task = (Task*)data;
+		(*task)(storage);
+		delete task;
+	}, task);
+	return future;
+}
+
+template <typename StructType>
+inline std::future<StructType*>    StorageMethod::getAsync(int64_t id) {
+	return async([id](SqStorage *storage) {
+		return storage->get<StructType>(id);
+	});
+}
+template <typename StlContainer>
+inline std::future<StlContainer*>  StorageMethod::getAllAsync(const char *sqlWhereHaving) {
+	// copy SQL string because caller may free it before task runs
+	bool        hasWhere = (sqlWhereHaving != NULL);
+	std::string where = (sqlWhereHaving) ? sqlWhereHaving : "";
+	return async([hasWhere, where](SqStorage *storage) {
+		return storage->getAll<StlContainer>(hasWhere ? where.c_str() : NULL);
+	});
+}
+// writes are queued as INSERT, UPDATE, and REMOVE tasks, so they can be grouped by group commit.
+template <typename StructType>
+inline std::future<int64_t>  StorageMethod::insertAsync(StructType *instance) {
+	std::promise<int64_t> *promise = new std::promise<int64_t>();
+	std::future<int64_t>   future  = promise->get_future();
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
+	if (table)
+		sq_storage_insert_async((SqStorage*)this, table->name, table->type, instance, asyncDone<int64_t>, promise);
+	else
+		asyncDone<int64_t>((SqStorage*)this, NULL, 0, promise);
+	return future;
+}
+template <typename StructType>
+inline std::future<int>      StorageMethod::updateAsync(StructType *instance) {
+	std::promise<int> *promise = new std::promise<int>();
+	std::future<int>   future  = promise->get_future();
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
+	if (table)
+		sq_storage_update_async((SqStorage*)this, table->name, table->type, instance, asyncDone<int>, promise);
+	else
+		asyncDone<int>((SqStorage*)this, NULL, 0, promise);
+	return future;
+}
+template <typename StructType>
+inline std::future<int64_t>  StorageMethod::removeAsync(int64_t id) {
+	std::promise<int64_t> *promise = new std::promise<int64_t>();
+	std::future<int64_t>   future  = promise->get_future();
+	SqTable *table = sq_storage_find_by_type((SqStorage*)this, typeid(StructType).name());
+	if (table)
+		sq_storage_remove_async((SqStorage*)this, table->name, table->type, id, asyncDone<int64_t>, promise);
+	else
+		asyncDone<int64_t>((SqStorage*)this, NULL, 0, promise);
+	return future;
+}
+
+template <typename Result>
+inline void  StorageMethod::asyncDone(SqStorage *storage, void *result, int64_t number, void *data) {
+	std::promise<Result> *promise = (std::promise<Result>*)data;
+	promise->set_value((Result)number);
+	delete promise;
+}
+
 /* All derived struct/class must be C++11 standard-layout. */
 
 struct Storage : SqStorage
@@ -1255,6 +2096,9 @@ struct Storage : SqStorage
 	Storage(DbMethod *dbmethod) {
 		sq_storage_init((SqStorage*)this, (Sqdb*)dbmethod);
 	}
+	Storage(SqdbPool *pool) {
+		sq_storage_init_pool((SqStorage*)this, pool);
+	}
 	// destructor
 	~Storage() {
 		sq_storage_final((SqStorage*)this);
@@ -0,0 +1,175 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE    200809L     // clock_gettime(), pthread_condattr_setclock()
+#endif
+
+#include <stdlib.h>            // malloc(), free()
+#include <time.h>              // clock_gettime(), timespec
+#include <errno.h>             // ETIMEDOUT
+
+#include <sqxc/SqThread.h>
+
+// macOS doesn't have pthread_condattr_setclock()
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(__APPLE__) && defined(CLOCK_MONOTONIC)
+#define SQ_COND_USE_MONOTONIC    1
+#else
+#define SQ_COND_USE_MONOTONIC    0
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+typedef struct SqThreadStart    SqThreadStart;
+
+struct SqThreadStart
+{
+	SqThreadFunc  func;
+	void         *data;
+};
+
+static DWORD WINAPI sq_thread_start(LPVOID param)
+{
+	SqThreadStart  start = *(SqThreadStart*)param;
+
+	free(param);
+	start.func(start.data);
+	return 0;
+}
+#endif
+
+int   sq_thread_create(SqThread *thread, SqThreadFunc func, void *data)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	SqThreadStart *start;
+
+	start = malloc(sizeof(SqThreadStart));
+	start->func = func;
+	start->data = data;
+	*thread = CreateThread(NULL, 0, sq_thread_start, start, 0, NULL);
+	if (*thread == NULL) {
+		free(start);
+		return -1;
+	}
+	return 0;
+#else
+	return pthread_create(thread, NULL, func, data);
+#endif
+}
+
+int   sq_thread_join(SqThread thread)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	if (WaitForSingleObject(thread, INFINITE) != WAIT_OBJECT_0)
+		return -1;
+	CloseHandle(thread);
+	return 0;
+#else
+	return pthread_join(thread, NULL);
+#endif
+}
+
+void  sq_cond_init(SqCond *cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	InitializeConditionVariable(cond);
+#elif SQ_COND_USE_MONOTONIC
+	pthread_condattr_t  attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+#else
+	pthread_cond_init(cond, NULL);
+#endif
+}
+
+void  sq_cond_final(SqCond *cond)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	// Windows condition variable doesn't need to be deleted
+#else
+	pthread_cond_destroy(cond);
+#endif
+}
+
+void  sq_cond_wait(SqCond *cond, SqMutex *mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+	pthread_cond_wait(cond, mutex);
+#endif
+}
+
+bool  sq_cond_wait_timeout(SqCond *cond, SqMutex *mutex, int timeout)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return SleepConditionVariableCS(cond, mutex, (DWORD)timeout) ? true : false;
+#else
+	struct timespec  ts;
+
+#if SQ_COND_USE_MONOTONIC
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+	ts.tv_sec  += timeout / 1000;
+	ts.tv_nsec += (long)(timeout % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec  += 1;
+		ts.tv_nsec -= 1000000000L;
+	}
+	return (pthread_cond_timedwait(cond, mutex, &ts) == ETIMEDOUT) ? false : true;
+#endif
+}
+
+uint64_t  sq_clock_msec(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return (uint64_t)GetTickCount64();
+#else
+	struct timespec  ts;
+
+#if defined(CLOCK_MONOTONIC)
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+	return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+uint64_t  sq_clock_usec(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	static LARGE_INTEGER  frequency;
+	LARGE_INTEGER         counter;
+
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000 +
+	       (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+#else
+	struct timespec  ts;
+
+#if defined(CLOCK_MONOTONIC)
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
@@ -0,0 +1,143 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqThread.h - portable thread, mutex, and condition variable.
+	             It uses POSIX threads or Windows synchronization API.
+
+	SqThread   - thread handle.
+	SqThreadId - identifier of thread. It can be compared by sq_thread_id_equal().
+	SqMutex    - mutual exclusion lock.
+	SqCond     - condition variable. It must be used with SqMutex.
+ */
+
+#ifndef SQ_THREAD_H
+#define SQ_THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+#if defined(_WIN32) || defined(_WIN64)
+typedef HANDLE                SqThread;
+typedef DWORD                 SqThreadId;
+typedef CRITICAL_SECTION      SqMutex;
+typedef CONDITION_VARIABLE    SqCond;
+#else
+typedef pthread_t             SqThread;
+typedef pthread_t             SqThreadId;
+typedef pthread_mutex_t       SqMutex;
+typedef pthread_cond_t        SqCond;
+#endif
+
+// thread function
+typedef void *(*SqThreadFunc)(void *data);
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --- SqThread --- */
+
+// create a thread that runs func(data). return 0 if successful.
+int   sq_thread_create(SqThread *thread, SqThreadFunc func, void *data);
+
+// wait for thread to terminate. return 0 if successful.
+int   sq_thread_join(SqThread thread);
+
+#if defined(_WIN32) || defined(_WIN64)
+#define sq_thread_id()                GetCurrentThreadId()
+#define sq_thread_id_equal(id1, id2)  ((id1) == (id2))
+#else
+#define sq_thread_id()                pthread_self()
+#define sq_thread_id_equal(id1, id2)  pthread_equal(id1, id2)
+#endif
+
+/* --- SqMutex --- */
+
+#if defined(_WIN32) || defined(_WIN64)
+#define sq_mutex_init(mutex)        InitializeCriticalSection(mutex)
+#define sq_mutex_final(mutex)       DeleteCriticalSection(mutex)
+#define sq_mutex_lock(mutex)        EnterCriticalSection(mutex)
+#define sq_mutex_unlock(mutex)      LeaveCriticalSection(mutex)
+#else
+#define sq_mutex_init(mutex)        pthread_mutex_init(mutex, NULL)
+#define sq_mutex_final(mutex)       pthread_mutex_destroy(mutex)
+#define sq_mutex_lock(mutex)        pthread_mutex_lock(mutex)
+#define sq_mutex_unlock(mutex)      pthread_mutex_unlock(mutex)
+#endif
+
+/* --- SqCond --- */
+
+void  sq_cond_init(SqCond *cond);
+void  sq_cond_final(SqCond *cond);
+
+// wait until 'cond' is signaled. 'mutex' must be locked by caller.
+void  sq_cond_wait(SqCond *cond, SqMutex *mutex);
+
+// wait until 'cond' is signaled or 'timeout' milliseconds elapsed. 'mutex' must be locked by caller.
+// return false if timeout. It may return true by spurious wakeup, caller should check condition again.
+bool  sq_cond_wait_timeout(SqCond *cond, SqMutex *mutex, int timeout);
+
+#if defined(_WIN32) || defined(_WIN64)
+#define sq_cond_signal(cond)        WakeConditionVariable(cond)
+#define sq_cond_broadcast(cond)     WakeAllConditionVariable(cond)
+#else
+#define sq_cond_signal(cond)        pthread_cond_signal(cond)
+#define sq_cond_broadcast(cond)     pthread_cond_broadcast(cond)
+#endif
+
+/* --- clock --- */
+
+// return milliseconds of monotonic clock. It is used to measure elapsed time.
+uint64_t  sq_clock_msec(void);
+
+// return microseconds of monotonic clock. It is used to measure short elapsed time.
+uint64_t  sq_clock_usec(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+typedef SqThread   Thread;
+typedef SqThreadId ThreadId;
+typedef SqMutex    Mutex;
+typedef SqCond     Cond;
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQ_THREAD_H
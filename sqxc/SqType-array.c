@@ -34,7 +34,7 @@ static void sq_type_array_clear_element(void *array, const SqType *element_type,
 
 	if (element_type == NULL || SQ_TYPE_IS_ARITHMETIC(element_type))
 		return;
-	element_size = element_type->size;
+	element_size = sq_array_element_size(array);    // size of pointer if is_pointer == true
 	cur = sq_array_data(array);
 	end = cur + sq_array_length(array) * element_size;
 
@@ -151,6 +151,7 @@ static Sqxc *sq_type_array_write(void *array, const SqType *type, Sqxc *dest)
 {
 	const SqType *element_type;
 	const char   *array_name = dest->name;
+	unsigned int  element_size;
 	uint8_t *cur, *end;
 
 	// get element type information.
@@ -172,9 +173,11 @@ static Sqxc *sq_type_array_write(void *array, const SqType *type, Sqxc *dest)
 		return dest;
 
 	// output elements
+	// element of SqPtrArray is pointer, its size is different from element_type->size
+	element_size = sq_array_element_size(array);
 	cur = sq_array_data(array);
-	end = cur + sq_array_length(array) * element_type->size;
-	for (;  cur < end;  cur += element_type->size) {
+	end = cur + sq_array_length(array) * element_size;
+	for (;  cur < end;  cur += element_size) {
 		dest->name = NULL;      // set "name" before calling write()
 		if (type->final == sq_type_ptr_array_final)
 			dest = element_type->write(*(void**)cur, element_type, dest);
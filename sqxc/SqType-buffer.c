@@ -29,9 +29,19 @@
 static int   sq_type_buffer_parse(void *instance, const SqType *type, Sqxc *src)
 {
 	SqBuffer *buf = instance;
+	SqBuffer *blob;
+	char     *mem;
 	size_t    len;
 
 	switch (src->type) {
+	// binary data with length. e.g. sqlite3_column_blob()
+	case SQXC_TYPE_BLOB:
+		blob = src->value.pointer;
+		sq_buffer_resize(buf, blob->writed);
+		memcpy(buf->mem, blob->mem, blob->writed);
+		buf->writed = blob->writed;
+		break;
+
 	case SQXC_TYPE_NULL:
 	case SQXC_TYPE_STR:
 //	case SQXC_TYPE_RAW:
@@ -98,6 +108,27 @@ static int   sq_type_buffer_parse(void *instance, const SqType *type, Sqxc *src)
 		}
 		break;
 
+	// convert number and time to text. e.g. binary result of PostgreSQL and prepared statement of MySQL
+	case SQXC_TYPE_BOOL:
+	case SQXC_TYPE_INT:
+	case SQXC_TYPE_UINT:
+	case SQXC_TYPE_INT64:
+	case SQXC_TYPE_UINT64:
+	case SQXC_TYPE_TIME:
+	case SQXC_TYPE_DOUBLE:
+		buf->writed = 0;
+		mem = NULL;
+		sq_type_str_parse(&mem, SQ_TYPE_STR, src);
+		if (mem == NULL)
+			break;
+		len = strlen(mem);
+		sq_buffer_resize(buf, len +1);
+		memcpy(buf->mem, mem, len);
+		buf->writed = len;
+		buf->mem[len] = 0;        // null-terminated
+		free(mem);
+		break;
+
 	default:
 		/* set required type if return SQCODE_TYPE_NOT_MATCHED
 		src->required_type = SQXC_TYPE_BOOL;
@@ -17,6 +17,7 @@
 #endif
 #include <limits.h>            // __WORDSIZE
 #include <stdint.h>            // __WORDSIZE  for Apple Developer
+#include <inttypes.h>          // PRId64, PRIu64
 #include <time.h>              // time_t
 #include <stdio.h>             // sprintf(), fprintf(), stderr
 #include <stdlib.h>            // realloc(), strtol()
@@ -52,6 +53,14 @@ int  sq_type_bool_parse(void *instance, const SqType *entrytype, Sqxc *src)
 		*(bool*)instance = (src->value.integer) ? true : false;
 		break;
 
+	case SQXC_TYPE_INT64:
+		*(bool*)instance = (src->value.int64) ? true : false;
+		break;
+
+	case SQXC_TYPE_DOUBLE:
+		*(bool*)instance = (src->value.double_) ? true : false;
+		break;
+
 	case SQXC_TYPE_STR:
 		if (src->value.str) {
 			ch = src->value.str[0];
@@ -131,6 +140,10 @@ int  sq_type_int_parse(void *instance, const SqType *entrytype, Sqxc *src)
 		*(int*)instance = src->value.boolean;
 		break;
 
+	case SQXC_TYPE_DOUBLE:
+		*(int*)instance = (int)src->value.double_;
+		break;
+
 	case SQXC_TYPE_STR:
 		if (src->value.str)
 			*(int*)instance = strtol(src->value.str, NULL, 10);
@@ -205,6 +218,10 @@ int  sq_type_uint_parse(void *instance, const SqType *entrytype, Sqxc *src)
 		*(unsigned int*)instance = src->value.boolean;
 		break;
 
+	case SQXC_TYPE_DOUBLE:
+		*(unsigned int*)instance = (unsigned int)src->value.double_;
+		break;
+
 	case SQXC_TYPE_STR:
 		if (src->value.str)
 			*(unsigned int*)instance = strtoul(src->value.str, NULL, 10);
@@ -237,11 +254,10 @@ int  sq_type_int64_parse(void *instance, const SqType *entrytype, Sqxc *src)
 {
 	switch (src->type) {
 	case SQXC_TYPE_INT64:
-#if !defined(__WORDSIZE) || (__WORDSIZE != 64)
-		// integer is NOT 64-bit
+		// database products (e.g. SQLite) send 64-bit integer that may exceed range of int
 		*(int64_t*)instance = src->value.int64;
 		break;
-#endif
+
 	case SQXC_TYPE_NULL:
 	case SQXC_TYPE_INT:
 		*(int64_t*)instance = src->value.integer;
@@ -249,16 +265,18 @@ int  sq_type_int64_parse(void *instance, const SqType *entrytype, Sqxc *src)
 
 #if SQ_CONFIG_CONVERT_SIGNED_UNSIGNED_INT
 	case SQXC_TYPE_UINT64:
-#if !defined(__WORDSIZE) || (__WORDSIZE != 64)
-		// integer is NOT 64-bit
 		*(int64_t*)instance = src->value.uint64;
 		break;
-#endif
+
 	case SQXC_TYPE_UINT:
 		*(int64_t*)instance = src->value.uinteger;
 		break;
 #endif  // SQ_CONFIG_CONVERT_SIGNED_UNSIGNED_INT
 
+	case SQXC_TYPE_DOUBLE:
+		*(int64_t*)instance = (int64_t)src->value.double_;
+		break;
+
 	case SQXC_TYPE_STR:
 		if (src->value.str)
 			*(int64_t*)instance = strtoll(src->value.str, NULL, 10);
@@ -291,11 +309,9 @@ int  sq_type_uint64_parse(void *instance, const SqType *entrytype, Sqxc *src)
 {
 	switch (src->type) {
 	case SQXC_TYPE_UINT64:
-#if !defined(__WORDSIZE) || (__WORDSIZE != 64)
-		// integer is NOT 64-bit
 		*(uint64_t*)instance = src->value.uint64;
 		break;
-#endif
+
 	case SQXC_TYPE_NULL:
 	case SQXC_TYPE_UINT:
 		*(uint64_t*)instance = src->value.uinteger;
@@ -303,16 +319,19 @@ int  sq_type_uint64_parse(void *instance, const SqType *entrytype, Sqxc *src)
 
 #if SQ_CONFIG_CONVERT_SIGNED_UNSIGNED_INT
 	case SQXC_TYPE_INT64:
-#if !defined(__WORDSIZE) || (__WORDSIZE != 64)
-		// integer is NOT 64-bit
+		// database products (e.g. SQLite) send 64-bit integer that may exceed range of int
 		*(uint64_t*)instance = src->value.int64;
 		break;
-#endif
+
 	case SQXC_TYPE_INT:
 		*(uint64_t*)instance = src->value.integer;
 		break;
 #endif  // SQ_CONFIG_CONVERT_SIGNED_UNSIGNED_INT
 
+	case SQXC_TYPE_DOUBLE:
+		*(uint64_t*)instance = (uint64_t)src->value.double_;
+		break;
+
 	case SQXC_TYPE_STR:
 		if (src->value.str)
 			*(uint64_t*)instance = strtoull(src->value.str, NULL, 10);
@@ -345,11 +364,9 @@ int  sq_type_double_parse(void *instance, const SqType *entrytype, Sqxc *src)
 {
 	switch (src->type) {
 	case SQXC_TYPE_INT64:
-#if !defined(__WORDSIZE) || (__WORDSIZE != 64)
-		// integer is NOT 64-bit
 		*(double*)instance = (double)src->value.int64;
 		break;
-#endif
+
 	case SQXC_TYPE_NULL:
 	case SQXC_TYPE_INT:
 		*(double*)instance = (double)src->value.integer;
@@ -357,11 +374,9 @@ int  sq_type_double_parse(void *instance, const SqType *entrytype, Sqxc *src)
 
 #if SQ_CONFIG_CONVERT_SIGNED_UNSIGNED_INT
 	case SQXC_TYPE_UINT64:
-#if !defined(__WORDSIZE) || (__WORDSIZE != 64)
-		// integer is NOT 64-bit
 		*(double*)instance = (double)src->value.uint64;
 		break;
-#endif
+
 	case SQXC_TYPE_UINT:
 		*(double*)instance = (double)src->value.uinteger;
 		break;
@@ -452,14 +467,74 @@ void sq_type_str_final(void *instance, const SqType *entrytype)
 	free(*(char**)instance);
 }
 
+// convert SQXC_TYPE_BOOL, SQXC_TYPE_INT, SQXC_TYPE_UINT, SQXC_TYPE_INT64, SQXC_TYPE_UINT64,
+// SQXC_TYPE_TIME, and SQXC_TYPE_DOUBLE to string. Caller must free returned string.
+static char *sq_type_str_from_number(Sqxc *src)
+{
+	char *str;
+	int   len;
+
+	switch (src->type) {
+	case SQXC_TYPE_BOOL:
+		// the same as text of SQLite and MySQL
+		str = strdup((src->value.boolean) ? "1" : "0");
+		break;
+
+	case SQXC_TYPE_INT:
+		len = snprintf(NULL, 0, "%d", src->value.integer) + 1;
+		str = malloc(len);
+		snprintf(str, len, "%d", src->value.integer);
+		break;
+
+	case SQXC_TYPE_UINT:
+		len = snprintf(NULL, 0, "%u", src->value.uinteger) + 1;
+		str = malloc(len);
+		snprintf(str, len, "%u", src->value.uinteger);
+		break;
+
+	case SQXC_TYPE_INT64:
+		len = snprintf(NULL, 0, "%" PRId64, src->value.int64) + 1;
+		str = malloc(len);
+		snprintf(str, len, "%" PRId64, src->value.int64);
+		break;
+
+	case SQXC_TYPE_UINT64:
+		len = snprintf(NULL, 0, "%" PRIu64, src->value.uint64) + 1;
+		str = malloc(len);
+		snprintf(str, len, "%" PRIu64, src->value.uint64);
+		break;
+
+	case SQXC_TYPE_TIME:
+		// output format : "2013-02-05 21:25:15"
+		str = sq_time_to_string(src->value.rawtime, 0);
+		break;
+
+//	case SQXC_TYPE_DOUBLE:
+	default:
+		// the same precision as sqlite3_column_text()
+		len = snprintf(NULL, 0, "%.15g", src->value.double_) + 1;
+		str = malloc(len);
+		snprintf(str, len, "%.15g", src->value.double_);
+		break;
+	}
+	return str;
+}
+
 int  sq_type_str_parse(void *instance, const SqType *entrytype, Sqxc *src)
 {
+	SqBuffer *blob;
+
 	switch (src->type) {
-	/* TODO: convert to string
+	// convert number to string
+	case SQXC_TYPE_BOOL:
 	case SQXC_TYPE_INT:
+	case SQXC_TYPE_UINT:
 	case SQXC_TYPE_INT64:
+	case SQXC_TYPE_UINT64:
+	case SQXC_TYPE_TIME:
+	case SQXC_TYPE_DOUBLE:
+		*(char**)instance = sq_type_str_from_number(src);
 		break;
-	 */
 
 	case SQXC_TYPE_NULL:
 	case SQXC_TYPE_STR:
@@ -475,6 +550,14 @@ int  sq_type_str_parse(void *instance, const SqType *entrytype, Sqxc *src)
 			*(char**)instance = NULL;
 		break;
 
+	// binary data with length. null-terminate it.
+	case SQXC_TYPE_BLOB:
+		blob = src->value.pointer;
+		*(char**)instance = malloc(blob->writed + 1);
+		memcpy(*(char**)instance, blob->mem, blob->writed);
+		(*(char**)instance)[blob->writed] = 0;
+		break;
+
 	default:
 		/* set required type if return SQCODE_TYPE_NOT_MATCHED
 		src->required_type = SQXC_TYPE_STR;
@@ -15,6 +15,8 @@
 #ifdef _MSC_VER
 #define _CRT_SECURE_NO_WARNINGS
 #endif
+#include <stdio.h>             // snprintf()
+#include <stdlib.h>            // free()
 #include <string>
 #include <sqxc/SqError.h>
 #include <sqxc/SqType.h>
@@ -55,14 +57,53 @@ static void sq_type_std_string_final(void *instance, const SqType *type)
 
 static int  sq_type_std_string_parse(void *instance, const SqType *type, Sqxc *src)
 {
-	if (src->type == SQXC_TYPE_STR) {
+	char  buf[32];
+	char *str;
+
+	switch (src->type) {
+	case SQXC_TYPE_NULL:
+	case SQXC_TYPE_STR:
 		if (src->value.str)
 			((std::string*)instance)->assign(src->value.str);
 		else
 			((std::string*)instance)->resize(0);
-	}
-	else {
-		// TODO: convert to string
+		break;
+
+	case SQXC_TYPE_BLOB:
+		((std::string*)instance)->assign(((SqBuffer*)src->value.pointer)->mem,
+		                                 ((SqBuffer*)src->value.pointer)->writed);
+		break;
+
+	// convert number to string
+	case SQXC_TYPE_INT:
+		*(std::string*)instance = std::to_string(src->value.integer);
+		break;
+
+	case SQXC_TYPE_INT64:
+		*(std::string*)instance = std::to_string(src->value.int64);
+		break;
+
+	case SQXC_TYPE_DOUBLE:
+		// the same precision as sqlite3_column_text()
+		snprintf(buf, sizeof(buf), "%.15g", src->value.double_);
+		((std::string*)instance)->assign(buf);
+		break;
+
+	// convert other values to string. e.g. binary result of PostgreSQL and prepared statement of MySQL
+	case SQXC_TYPE_BOOL:
+	case SQXC_TYPE_UINT:
+	case SQXC_TYPE_UINT64:
+	case SQXC_TYPE_TIME:
+		str = NULL;
+		sq_type_str_parse(&str, SQ_TYPE_STR, src);
+		if (str)
+			((std::string*)instance)->assign(str);
+		else
+			((std::string*)instance)->resize(0);
+		free(str);
+		break;
+
+	default:
 		/* set required type if return SQCODE_TYPE_NOT_MATCHED
 		src->required_type = SQXC_TYPE_STR;
 		*/
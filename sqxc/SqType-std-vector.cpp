@@ -56,9 +56,16 @@ static void sq_type_std_vector_final(void *instance, const SqType *type)
 static int  sq_type_std_vector_parse(void *instance, const SqType *type, Sqxc *src)
 {
 	std::vector<char> *vector = (std::vector<char>*)instance;
+	SqBuffer *blob;
 	size_t   len;
 
 	switch (src->type) {
+	// binary data with length. e.g. sqlite3_column_blob()
+	case SQXC_TYPE_BLOB:
+		blob = (SqBuffer*)src->value.pointer;
+		vector->assign(blob->mem, blob->mem + blob->writed);
+		break;
+
 	case SQXC_TYPE_NULL:
 	case SQXC_TYPE_STR:
 //	case SQXC_TYPE_RAW:
@@ -205,6 +212,10 @@ static int  sq_type_std_vector_size_parse(void *instance, const SqType *entrytyp
 		vector->resize(src->value.integer);
 		break;
 
+	case SQXC_TYPE_INT64:
+		vector->resize((size_t)src->value.int64);
+		break;
+
 	case SQXC_TYPE_STR:
 		if (src->value.str)
 			vector->resize((int)strtol(src->value.str, NULL, 10));
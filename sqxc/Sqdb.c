@@ -22,6 +22,9 @@
 #include <sqxc/SqType.h>
 #include <sqxc/SqTypeMapping.h>
 #include <sqxc/Sqdb.h>
+#include <sqxc/SqThread.h>     // sq_clock_usec()
+#include <sqxc/SqxcSql.h>
+#include <sqxc/SqxcValue.h>
 
 #ifdef _MSC_VER
 #define snprintf     _snprintf
@@ -61,6 +64,9 @@ void  sqdb_init(Sqdb *db, const SqdbInfo *info, const SqdbConfig *config)
 		memset(db, 0, info->size);
 		db->info = info;
 	}
+	// trace hook is disabled by default
+	db->trace = NULL;
+	db->trace_data = NULL;
 }
 
 void  sqdb_final(Sqdb *db)
@@ -72,6 +78,120 @@ void  sqdb_final(Sqdb *db)
 		final(db);
 }
 
+// ----------------------------------------------------------------------------
+// trace hook
+
+void  sqdb_set_trace(Sqdb *db, SqdbTraceFunc func, void *data)
+{
+	db->trace = func;
+	db->trace_data = data;
+}
+
+static int  sqdb_exec_stmt_real(Sqdb *db, SqdbStmt *stmt, Sqxc *xc);
+
+int   sqdb_exec_trace(Sqdb *db, const char *sql, SqdbStmt *stmt, Sqxc *xc, void *reserve)
+{
+	SqdbTraceFunc   func = db->trace;
+	SqdbTrace       trace = {0};
+	SqxcValueStats  stats = {0};
+	SqxcValue      *xcvalue = NULL;
+	Sqxc           *cur;
+	uint64_t        begin;
+
+	if (func == NULL) {
+		if (stmt)
+			return sqdb_exec_stmt_real(db, stmt, xc);
+		return db->info->exec(db, sql, xc, reserve);
+	}
+
+	// SqxcValue in input chain collects statistics of parsing
+	for (cur = xc;  cur;  cur = cur->peer) {
+		if (cur->info == SQXC_INFO_VALUE) {
+			xcvalue = (SqxcValue*)cur;
+			// don't replace statistics of outer trace
+			if (xcvalue->stats == NULL)
+				xcvalue->stats = &stats;
+			else
+				xcvalue = NULL;
+			break;
+		}
+	}
+
+	trace.stage = SQDB_TRACE_BEGIN;
+	trace.sql   = sql;
+	func(db->trace_data, db, &trace);
+
+	begin = sq_clock_usec();
+	if (stmt)
+		trace.code = sqdb_exec_stmt_real(db, stmt, xc);
+	else
+		trace.code = db->info->exec(db, sql, xc, reserve);
+	trace.time = sq_clock_usec() - begin;
+
+	if (xcvalue) {
+		xcvalue->stats = NULL;
+		trace.parse_time = stats.time;
+		trace.n_rows  = stats.n_rows;
+		trace.n_bytes = stats.n_bytes;
+	}
+	else if (xc && xc->info == SQXC_INFO_SQL)
+		trace.n_rows = sqxc_sql_changes(xc);
+	// parse time is measured inside of server time
+	if (trace.parse_time > trace.time)
+		trace.parse_time = trace.time;
+	trace.server_time = trace.time - trace.parse_time;
+
+	trace.stage = SQDB_TRACE_END;
+	func(db->trace_data, db, &trace);
+	return trace.code;
+}
+
+// ----------------------------------------------------------------------------
+// execute prepared statement
+
+int  sqdb_exec_stmt(Sqdb *db, SqdbStmt *stmt, Sqxc *xc)
+{
+	if (db->trace)
+		return sqdb_exec_trace(db, NULL, stmt, xc, NULL);
+	return sqdb_exec_stmt_real(db, stmt, xc);
+}
+
+static int  sqdb_exec_stmt_real(Sqdb *db, SqdbStmt *stmt, Sqxc *xc)
+{
+	int   code;
+	bool  has_row = false;
+	bool  has_container;
+
+	has_container = (xc && xc->info == SQXC_INFO_VALUE && sqxc_value_container(xc));
+	// If SqxcValue is prepared to receive multiple rows
+	if (has_container) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	while ((code = db->info->step(db, stmt, xc)) == SQCODE_ROW)
+		has_row = true;
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (has_container) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	if (code != SQCODE_DONE)
+		return code;
+	// if the result set is empty.
+	if (has_row == false && xc && xc->info == SQXC_INFO_VALUE)
+		return SQCODE_NO_DATA;
+	return SQCODE_OK;
+}
+
 // ----------------------------------------------------------------------------
 // execute SQL statement
 
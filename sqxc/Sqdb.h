@@ -29,6 +29,10 @@
 typedef struct Sqdb             Sqdb;
 typedef struct SqdbInfo         SqdbInfo;
 typedef struct SqdbConfig       SqdbConfig;
+typedef struct SqdbTrace        SqdbTrace;
+
+// SqdbStmt is prepared statement. It's actual type is defined by Database product.
+typedef struct SqdbStmt         SqdbStmt;
 
 typedef enum SqdbProduct {
 	SQDB_PRODUCT_UNKNOWN,
@@ -44,6 +48,18 @@ typedef enum SqdbProduct {
 #define SQDB_CONFIG_RESERVE_2       (1 << 1)
 #define SQDB_CONFIG_RESERVE_3       (1 << 2)
 #define SQDB_CONFIG_NO_MIGRATION    (1 << 3)
+#define SQDB_CONFIG_READ_ONLY       (1 << 4)    // open connection in read-only mode (SQLite)
+
+/* --- SqdbTrace::stage --- */
+#define SQDB_TRACE_BEGIN            0           // before statement is executed
+#define SQDB_TRACE_END              1           // after statement is executed
+
+// trace hook. It is called before and after statement is executed.
+typedef void (*SqdbTraceFunc)(void *data, Sqdb *db, const SqdbTrace *trace);
+
+/* --- events of socket that are returned by sqdb_async_socket() --- */
+#define SQDB_WAIT_READ              (1 << 0)
+#define SQDB_WAIT_WRITE             (1 << 1)
 
 // ----------------------------------------------------------------------------
 // C declarations: declare C data, function, and others.
@@ -66,7 +82,68 @@ extern "C" {
 
 // int  sqdb_exec(Sqdb *db, const char *sql, Sqxc *xc, void *reserve);
 #define sqdb_exec(db, sql, xc, reserve)              \
-		(db)->info->exec(db, sql, xc, reserve)
+		( ((db)->trace == NULL) ? (db)->info->exec(db, sql, xc, reserve) : \
+		  sqdb_exec_trace(db, sql, NULL, xc, reserve) )
+
+/* --- prepared statement --- Sqdb may not support these if SqdbInfo::prepare is NULL */
+
+// int  sqdb_prepare(Sqdb *db, const char *sql, SqdbStmt **stmt);
+#define sqdb_prepare(db, sql, stmt)                  \
+		(db)->info->prepare(db, sql, stmt)
+
+// int  sqdb_bind(Sqdb *db, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+#define sqdb_bind(db, stmt, index, type, value)      \
+		(db)->info->bind(db, stmt, index, type, value)
+
+// int  sqdb_step(Sqdb *db, SqdbStmt *stmt, Sqxc *xc);
+#define sqdb_step(db, stmt, xc)                      \
+		(db)->info->step(db, stmt, xc)
+
+// int  sqdb_reset(Sqdb *db, SqdbStmt *stmt);
+#define sqdb_reset(db, stmt)                         \
+		(db)->info->reset(db, stmt)
+
+// int  sqdb_finalize(Sqdb *db, SqdbStmt *stmt);
+#define sqdb_finalize(db, stmt)                      \
+		(db)->info->finalize(db, stmt)
+
+/* --- connection check --- Sqdb may not support this if SqdbInfo::ping is NULL */
+
+// int  sqdb_ping(Sqdb *db);
+#define sqdb_ping(db)                                \
+		(db)->info->ping(db)
+
+/* --- bulk load and export --- Sqdb may not support these if SqdbInfo::copy_begin or SqdbInfo::copy_out is NULL */
+
+// int  sqdb_copy_begin(Sqdb *db, const char *sql);
+#define sqdb_copy_begin(db, sql)                     \
+		(db)->info->copy_begin(db, sql)
+
+// int  sqdb_copy_data(Sqdb *db, const char *data, size_t length);
+#define sqdb_copy_data(db, data, length)             \
+		(db)->info->copy_data(db, data, length)
+
+// int  sqdb_copy_end(Sqdb *db, const char *error_msg, int64_t *n_rows);
+#define sqdb_copy_end(db, error_msg, n_rows)         \
+		(db)->info->copy_end(db, error_msg, n_rows)
+
+// int  sqdb_copy_out(Sqdb *db, const char *sql, const char **column_names, int n_columns, Sqxc *xc);
+#define sqdb_copy_out(db, sql, column_names, n_columns, xc)    \
+		(db)->info->copy_out(db, sql, column_names, n_columns, xc)
+
+/* --- non-blocking execution --- Sqdb may not support these if SqdbInfo::async_send is NULL */
+
+// int  sqdb_async_send(Sqdb *db, const char *sql, Sqxc *xc);
+#define sqdb_async_send(db, sql, xc)                 \
+		(db)->info->async_send(db, sql, xc)
+
+// int  sqdb_async_poll(Sqdb *db);
+#define sqdb_async_poll(db)                          \
+		(db)->info->async_poll(db)
+
+// int  sqdb_async_socket(Sqdb *db, int *events);
+#define sqdb_async_socket(db, events)                \
+		(db)->info->async_socket(db, events)
 
 /* --- C Functions --- */
 
@@ -77,6 +154,23 @@ void    sqdb_free(Sqdb *db);
 void    sqdb_init(Sqdb *db, const SqdbInfo *info, const SqdbConfig *config);
 void    sqdb_final(Sqdb *db);
 
+/* --- trace hook --- */
+
+// set trace hook that is called before and after sqdb_exec() and sqdb_exec_stmt().
+// 'func' can be NULL to disable tracing.
+void    sqdb_set_trace(Sqdb *db, SqdbTraceFunc func, void *data);
+
+// execute SQL statement (or prepared statement if 'stmt' is not NULL) and call trace hook.
+// sqdb_exec() and sqdb_exec_stmt() call this if trace hook is set.
+// If 'stmt' is not NULL, 'sql' is only passed to trace hook and it can be NULL.
+int     sqdb_exec_trace(Sqdb *db, const char *sql, SqdbStmt *stmt, Sqxc *xc, void *reserve);
+
+/* --- execute prepared statement --- */
+
+// call sqdb_step() until statement is done and send all rows to 'xc'.
+// It works like sqdb_exec() and returns SQCODE_NO_DATA if the result set is empty.
+int  sqdb_exec_stmt(Sqdb *db, SqdbStmt *stmt, Sqxc *xc);
+
 /* --- execute SQL statement --- */
 
 int  sqdb_exec_create_index(Sqdb *db, SqBuffer *sql_buf, SqTable *table, SqPtrArray *arranged_columns);
@@ -141,6 +235,30 @@ struct DbMethod
 	int  exec(const char *sql, Sqxc *xc, void *reserve = NULL);
 	int  exec(const char *sql, Sq::XcMethod *xc, void *reserve = NULL);
 	int  migrate(SqSchema *schema_cur, SqSchema *schema_next);
+
+	int  prepare(const char *sql, SqdbStmt **stmt);
+	int  bind(SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+	int  step(SqdbStmt *stmt, Sqxc *xc = NULL);
+	int  step(SqdbStmt *stmt, Sq::XcMethod *xc);
+	int  reset(SqdbStmt *stmt);
+	int  finalize(SqdbStmt *stmt);
+	int  execStmt(SqdbStmt *stmt, Sqxc *xc);
+	int  execStmt(SqdbStmt *stmt, Sq::XcMethod *xc);
+
+	int  copyBegin(const char *sql);
+	int  copyData(const char *data, size_t length);
+	int  copyEnd(const char *errorMsg = NULL, int64_t *nRows = NULL);
+	int  copyOut(const char *sql, const char **columnNames, int nColumns, Sqxc *xc);
+	int  copyOut(const char *sql, const char **columnNames, int nColumns, Sq::XcMethod *xc);
+
+	int  asyncSend(const char *sql, Sqxc *xc = NULL);
+	int  asyncSend(const char *sql, Sq::XcMethod *xc);
+	int  asyncPoll(void);
+	int  asyncSocket(int *events = NULL);
+
+	int  ping(void);
+
+	void setTrace(SqdbTraceFunc func, void *data = NULL);
 };
 
 };  // namespace Sq
@@ -182,11 +300,87 @@ struct SqdbInfo
 	int  (*exec)(Sqdb *db, const char *sql, Sqxc *xc, void *reserve);
 	// migrate schema. It apply changes of 'schema_next' to 'schema_current'
 	int  (*migrate)(Sqdb *db, SqSchema *schema_current, SqSchema *schema_next);
+
+	// --- prepared statement (optional) ---
+	// All of them can be NULL if Database product doesn't support prepared statement.
+	// Placeholder of parameter in SQL statement is '?'. Index of parameter starts from 1.
+
+	// compile SQL statement. It may return cached statement if Database product caches them.
+	int  (*prepare)(Sqdb *db, const char *sql, SqdbStmt **stmt);
+	// bind value to parameter of prepared statement. 'type' can be SQXC_TYPE_NULL, BOOL, INT, UINT, INT64, UINT64, TIME, DOUBLE, and STR.
+	int  (*bind)(Sqdb *db, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+	// send a row to 'xc' and return SQCODE_ROW. return SQCODE_DONE if statement has finished executing.
+	// 'xc' can be NULL. If 'xc' is SqxcSql, it will set SqxcSql::id and SqxcSql::changes when statement is done.
+	int  (*step)(Sqdb *db, SqdbStmt *stmt, Sqxc *xc);
+	// reset statement to its initial state, ready to be re-executed. bound values are kept.
+	int  (*reset)(Sqdb *db, SqdbStmt *stmt);
+	// release statement. Cached statement will be reset and returned to cache.
+	int  (*finalize)(Sqdb *db, SqdbStmt *stmt);
+
+	// --- bulk load (optional) ---
+	// All of them can be NULL if Database product doesn't support COPY FROM STDIN.
+	// Data is COPY text format: columns are separated by '\t', rows end with '\n', and NULL is "\N".
+
+	// start bulk load by SQL statement "COPY table_name (column1,column2) FROM STDIN".
+	int  (*copy_begin)(Sqdb *db, const char *sql);
+	// send data to Database. 'data' can contain multiple rows.
+	int  (*copy_data)(Sqdb *db, const char *data, size_t length);
+	// end bulk load. It aborts bulk load if 'error_msg' is not NULL. 'n_rows' can be NULL.
+	int  (*copy_end)(Sqdb *db, const char *error_msg, int64_t *n_rows);
+
+	// --- export (optional) ---
+	// It can be NULL if Database product doesn't support COPY TO STDOUT.
+
+	// execute SQL statement "COPY table_name (column1,column2) TO STDOUT" and stream rows to 'xc'.
+	// rows are sent as SQXC_TYPE_ARRAY of SQXC_TYPE_OBJECT, 'column_names' are names of columns in COPY data.
+	// values are sent as SQXC_TYPE_STR or SQXC_TYPE_NULL. It returns SQCODE_NO_DATA if there is no row.
+	int  (*copy_out)(Sqdb *db, const char *sql, const char **column_names, int n_columns, Sqxc *xc);
+
+	// --- non-blocking execution (optional) ---
+	// All of them can be NULL if Database product doesn't support non-blocking execution.
+	// Program waits for socket in its event loop (epoll, poll, etc.) and calls 'async_poll' when socket is ready.
+	// Only one statement can be in progress on a connection. Caller calls sqxc_ready() before 'async_send'
+	// and calls sqxc_finish() after 'async_poll' returns code other than SQCODE_AGAIN.
+
+	// send SQL statement without waiting for result. 'xc' works like sqdb_exec() and it must be valid until done.
+	int  (*async_send)(Sqdb *db, const char *sql, Sqxc *xc);
+	// consume available input and send rows that are ready to 'xc'. It doesn't block.
+	// return SQCODE_AGAIN if statement is still in progress. Otherwise return result code like sqdb_exec().
+	int  (*async_poll)(Sqdb *db);
+	// return socket descriptor of connection (-1 if not connected).
+	// 'events' is set to SQDB_WAIT_READ and/or SQDB_WAIT_WRITE that program should wait for. It can be NULL.
+	int  (*async_socket)(Sqdb *db, int *events);
+
+	// --- connection check (optional) ---
+	// It can be NULL if connection can't be broken (e.g. SQLite).
+
+	// check connection to Database server. return SQCODE_OK if connection is alive.
+	int  (*ping)(Sqdb *db);
+};
+
+/*	SqdbTrace - information of statement that is passed to trace hook.
+
+	Members after 'sql' are available only if 'stage' is SQDB_TRACE_END.
+	'parse_time', 'n_rows', and 'n_bytes' are collected by SqxcValue in input chain.
+	If there is no SqxcValue in input chain, 'n_rows' is number of changed rows (SqxcSql) or 0.
+ */
+struct SqdbTrace
+{
+	int             stage;         // SQDB_TRACE_BEGIN or SQDB_TRACE_END
+	const char     *sql;           // SQL statement. It can be NULL if prepared statement is executed.
+
+	int             code;          // result code (SQCODE_xxxx)
+	uint64_t        time;          // total microseconds
+	uint64_t        server_time;   // microseconds spent in Database product (time - parse_time)
+	uint64_t        parse_time;    // microseconds spent in Sqxc (SqType::parse)
+	int64_t         n_rows;        // number of rows produced
+	size_t          n_bytes;       // size of received values
 };
 
 /*	Sqdb - It is a base structure for Database product such as SQLite, MySQL, etc.
 
-	TODO: Sqdb should be thread safe...
+	Sqdb is NOT thread safe. Each thread should use its own Sqdb instance.
+	SqdbPool can share Sqdb instances (connections) between threads.
 
 	The correct way to derive Sqdb:  (conforming C++11 standard-layout)
 	1. Use Sq::DbMethod to inherit member function(method).
@@ -197,7 +391,9 @@ struct SqdbInfo
 
 #define SQDB_MEMBERS           \
 	const SqdbInfo *info;      \
-	int             version
+	int             version;   \
+	SqdbTraceFunc   trace;     \
+	void           *trace_data
 
 #ifdef __cplusplus
 struct Sqdb : Sq::DbMethod                 // <-- 1. inherit member function(method)
@@ -211,6 +407,10 @@ struct Sqdb
 
 	// schema version of the currently opened database
 	int             version;
+
+	// trace hook. It is NULL by default (disabled).
+	SqdbTraceFunc   trace;
+	void           *trace_data;
  */
 };
 
@@ -270,6 +470,68 @@ inline int  DbMethod::migrate(SqSchema *schema_cur, SqSchema *schema_next) {
 	return sqdb_migrate((Sqdb*)this, schema_cur, schema_next);
 }
 
+inline int  DbMethod::prepare(const char *sql, SqdbStmt **stmt) {
+	return sqdb_prepare((Sqdb*)this, sql, stmt);
+}
+inline int  DbMethod::bind(SqdbStmt *stmt, int index, SqxcType type, const SqValue *value) {
+	return sqdb_bind((Sqdb*)this, stmt, index, type, value);
+}
+inline int  DbMethod::step(SqdbStmt *stmt, Sqxc *xc) {
+	return sqdb_step((Sqdb*)this, stmt, xc);
+}
+inline int  DbMethod::step(SqdbStmt *stmt, Sq::XcMethod *xc) {
+	return sqdb_step((Sqdb*)this, stmt, (Sqxc*)xc);
+}
+inline int  DbMethod::reset(SqdbStmt *stmt) {
+	return sqdb_reset((Sqdb*)this, stmt);
+}
+inline int  DbMethod::finalize(SqdbStmt *stmt) {
+	return sqdb_finalize((Sqdb*)this, stmt);
+}
+inline int  DbMethod::execStmt(SqdbStmt *stmt, Sqxc *xc) {
+	return sqdb_exec_stmt((Sqdb*)this, stmt, xc);
+}
+inline int  DbMethod::execStmt(SqdbStmt *stmt, Sq::XcMethod *xc) {
+	return sqdb_exec_stmt((Sqdb*)this, stmt, (Sqxc*)xc);
+}
+
+inline int  DbMethod::copyBegin(const char *sql) {
+	return sqdb_copy_begin((Sqdb*)this, sql);
+}
+inline int  DbMethod::copyData(const char *data, size_t length) {
+	return sqdb_copy_data((Sqdb*)this, data, length);
+}
+inline int  DbMethod::copyEnd(const char *errorMsg, int64_t *nRows) {
+	return sqdb_copy_end((Sqdb*)this, errorMsg, nRows);
+}
+inline int  DbMethod::copyOut(const char *sql, const char **columnNames, int nColumns, Sqxc *xc) {
+	return sqdb_copy_out((Sqdb*)this, sql, columnNames, nColumns, xc);
+}
+inline int  DbMethod::copyOut(const char *sql, const char **columnNames, int nColumns, Sq::XcMethod *xc) {
+	return sqdb_copy_out((Sqdb*)this, sql, columnNames, nColumns, (Sqxc*)xc);
+}
+
+inline int  DbMethod::asyncSend(const char *sql, Sqxc *xc) {
+	return sqdb_async_send((Sqdb*)this, sql, xc);
+}
+inline int  DbMethod::asyncSend(const char *sql, Sq::XcMethod *xc) {
+	return sqdb_async_send((Sqdb*)this, sql, (Sqxc*)xc);
+}
+inline int  DbMethod::asyncPoll(void) {
+	return sqdb_async_poll((Sqdb*)this);
+}
+inline int  DbMethod::asyncSocket(int *events) {
+	return sqdb_async_socket((Sqdb*)this, events);
+}
+
+inline int  DbMethod::ping(void) {
+	return sqdb_ping((Sqdb*)this);
+}
+
+inline void DbMethod::setTrace(SqdbTraceFunc func, void *data) {
+	sqdb_set_trace((Sqdb*)this, func, data);
+}
+
 /* All derived struct/class must be C++11 standard-layout. */
 
 struct Db : Sqdb
@@ -17,9 +17,12 @@
 #endif
 #include <limits.h>            // INT_MAX
 #include <stdio.h>             // snprintf(), fprintf(), stderr
+#include <string.h>            // strstr()
+#include <time.h>              // mktime(), localtime(), gmtime()
 #include <stdbool.h>           // bool, true, false
 
 #include <sqxc/SqError.h>
+#include <sqxc/SqConvert.h>    // sq_time_to_string(), sq_bin_to_hex()
 #include <sqxc/Sqdb-migration.h>
 #include <sqxc/SqdbMysql.h>
 #include <sqxc/SqxcValue.h>
@@ -27,6 +30,7 @@
 
 #ifdef _MSC_VER
 #define snprintf     _snprintf
+#define strdup       _strdup
 #endif
 
 #define MYSQL_DEFAULT_HOST      "localhost"
@@ -34,14 +38,34 @@
 #define MYSQL_DEFAULT_USER      "root"
 #define MYSQL_DEFAULT_PASSWORD  ""
 
+// MariaDB Connector/C has non-blocking API: mysql_real_query_start(), mysql_real_query_cont()...etc
+#if defined(LIBMARIADB) || defined(MARIADB_BASE_VERSION)
+#define SQDB_MYSQL_HAS_NONBLOCK    1
+#else
+#define SQDB_MYSQL_HAS_NONBLOCK    0
+#endif
+
 static void sqdb_mysql_init(SqdbMysql *sqdb, const SqdbConfigMysql *config);
 static void sqdb_mysql_final(SqdbMysql *sqdb);
 static int  sqdb_mysql_open(SqdbMysql *sqdb, const char *database_name);
 static int  sqdb_mysql_close(SqdbMysql *sqdb);
 static int  sqdb_mysql_exec(SqdbMysql *sqdb, const char *sql, Sqxc *xc, void *reserve);
 static int  sqdb_mysql_migrate(SqdbMysql *sqdb, SqSchema *schema, SqSchema *schema_next);
+static int  sqdb_mysql_prepare(SqdbMysql *sqdb, const char *sql, SqdbStmt **stmt);
+static int  sqdb_mysql_bind(SqdbMysql *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+static int  sqdb_mysql_step(SqdbMysql *sqdb, SqdbStmt *stmt, Sqxc *xc);
+static int  sqdb_mysql_reset(SqdbMysql *sqdb, SqdbStmt *stmt);
+static int  sqdb_mysql_finalize(SqdbMysql *sqdb, SqdbStmt *stmt);
+static void sqdb_mysql_destroy_stmt(SqdbMysql *sqdb, SqdbStmt *stmt);
+static int  sqdb_mysql_ping(SqdbMysql *sqdb);
+#if SQDB_MYSQL_HAS_NONBLOCK
+static int  sqdb_mysql_async_send(SqdbMysql *sqdb, const char *sql, Sqxc *xc);
+static int  sqdb_mysql_async_poll(SqdbMysql *sqdb);
+static int  sqdb_mysql_async_socket(SqdbMysql *sqdb, int *events);
+#endif
 
 static int  sqdb_mysql_schema_get_version(SqdbMysql *sqdb);
+static void sqdb_mysql_async_clear(SqdbMysql *sqdb);
 static void sqdb_mysql_schema_set_version(SqdbMysql *sqdb, int version);
 
 static const SqdbConfigMysql db_default = {
@@ -69,6 +93,20 @@ const SqdbInfo sqdbInfo_MySQL = {
 	.close   = (void*)sqdb_mysql_close,
 	.exec    = (void*)sqdb_mysql_exec,
 	.migrate = (void*)sqdb_mysql_migrate,
+
+	.prepare  = (void*)sqdb_mysql_prepare,
+	.bind     = (void*)sqdb_mysql_bind,
+	.step     = (void*)sqdb_mysql_step,
+	.reset    = (void*)sqdb_mysql_reset,
+	.finalize = (void*)sqdb_mysql_finalize,
+
+#if SQDB_MYSQL_HAS_NONBLOCK
+	.async_send   = (void*)sqdb_mysql_async_send,
+	.async_poll   = (void*)sqdb_mysql_async_poll,
+	.async_socket = (void*)sqdb_mysql_async_socket,
+#endif
+
+	.ping     = (void*)sqdb_mysql_ping,
 };
 
 // ----------------------------------------------------------------------------
@@ -89,10 +127,17 @@ static void sqdb_mysql_init(SqdbMysql *sqdb, const SqdbConfigMysql *config_src)
 	sqdb->connection = NULL;
 	sqdb->config = config_src;
 	sqdb->version = 0;
+	memset(&sqdb->async, 0, sizeof(sqdb->async));
+	sqdb_stmt_cache_init(&sqdb->stmt_cache, (Sqdb*)sqdb,
+	                     (config_src) ? config_src->stmt_cache_size : 0,
+	                     (SqdbStmtDestroyFunc)sqdb_mysql_destroy_stmt);
 }
 
 static void sqdb_mysql_final(SqdbMysql *sqdb)
 {
+	// prepared statements must be closed before closing connection
+	sqdb_stmt_cache_final(&sqdb->stmt_cache);
+	sqdb_mysql_async_clear(sqdb);
 //	sqdb_mysql_close() also do this
 	if (sqdb->connection)
 		mysql_close(sqdb->connection);
@@ -115,8 +160,13 @@ static int  sqdb_mysql_open(SqdbMysql *sqdb, const char *database_name)
 		if (database_name == NULL)
 			return SQCODE_OPEN_FAILED;
 	}
-	if (sqdb->connection == NULL)
+	if (sqdb->connection == NULL) {
 		sqdb->connection = mysql_init(NULL);
+#if SQDB_MYSQL_HAS_NONBLOCK
+		// non-blocking API must be enabled before connecting
+		mysql_options(sqdb->connection, MYSQL_OPT_NONBLOCK, 0);
+#endif
+	}
 
 	conres = mysql_real_connect(sqdb->connection, config->host,
 	                            config->user, config->password,
@@ -130,12 +180,18 @@ static int  sqdb_mysql_open(SqdbMysql *sqdb, const char *database_name)
 		sqdb->connection = NULL;
 		return SQCODE_OPEN_FAILED;
 	}
+	sqdb->server_version = mysql_get_server_version(sqdb->connection);
+	sqdb->is_mariadb = (strstr(mysql_get_server_info(sqdb->connection), "MariaDB") != NULL);
 	sqdb->version = sqdb_mysql_schema_get_version(sqdb);
 	return SQCODE_OK;
 }
 
 static int  sqdb_mysql_close(SqdbMysql *sqdb)
 {
+	// prepared statements must be closed before closing connection
+	sqdb_stmt_cache_clear(&sqdb->stmt_cache);
+	// abandon statement that is in progress
+	sqdb_mysql_async_clear(sqdb);
 	if (sqdb->connection) {
 		mysql_close(sqdb->connection);
 		sqdb->connection = NULL;
@@ -143,6 +199,18 @@ static int  sqdb_mysql_close(SqdbMysql *sqdb)
 	return SQCODE_OK;
 }
 
+static int  sqdb_mysql_ping(SqdbMysql *sqdb)
+{
+	if (sqdb->connection == NULL || mysql_ping(sqdb->connection)) {
+#ifndef NDEBUG
+		if (sqdb->connection)
+			fprintf(stderr, "MySQL: %s\n", mysql_error(sqdb->connection));
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+	return SQCODE_OK;
+}
+
 static int  sqdb_mysql_migrate(SqdbMysql *db, SqSchema *schema, SqSchema *schema_next)
 {
 	SqBuffer    sql_buf;
@@ -242,6 +310,59 @@ static int  sqdb_mysql_migrate(SqdbMysql *db, SqSchema *schema, SqSchema *schema
 	return SQCODE_OK;
 }
 
+// used by sqdb_mysql_exec() and sqdb_mysql_async_poll()
+// send a row of result set to Sqxc chain. return current Sqxc element.
+static Sqxc *sqdb_mysql_send_row(Sqxc *xc, MYSQL_ROW row, char **names, unsigned int n_fields)
+{
+	// Special case:
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+//		if (xc->code != SQCODE_OK)
+//			return xc;
+	}
+
+	for (unsigned int i = 0;  i < n_fields;  i++) {
+		xc->type = SQXC_TYPE_STR;
+		xc->name = names[i];
+		xc->value.str = row[i];
+		xc = sqxc_send(xc);
+#ifndef NDEBUG
+		switch (xc->code) {
+		case SQCODE_OK:
+			break;
+
+		case SQCODE_ENTRY_NOT_FOUND:
+			// warning
+			fprintf(stderr, "%s: column '%s' not found.\n",
+			        "sqdb_mysql_send_row()", names[i]);
+			break;
+
+		default:
+			fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
+			        "sqdb_mysql_send_row()", names[i]);
+			break;
+		}
+#endif  // NDEBUG
+	}
+
+	// Special case:
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	return xc;
+}
+
 static int  sqdb_mysql_exec(SqdbMysql *sqdb, const char *sql, Sqxc *xc, void *reserve)
 {
 	MYSQL_RES   *result;
@@ -291,55 +412,8 @@ static int  sqdb_mysql_exec(SqdbMysql *sqdb, const char *sql, Sqxc *xc, void *re
 
 			// get result set
 			xc->code = SQCODE_NO_DATA;
-			while ((row = mysql_fetch_row(result))) {
-				// Special case:
-				// Don't send object if user selects only one column and the column type is built-in types (not object).
-				if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
-					// SQL row corresponds to SQXC_TYPE_OBJECT
-					xc->type = SQXC_TYPE_OBJECT;
-					xc->name = NULL;
-					xc->value.pointer = NULL;
-					xc = sqxc_send(xc);
-//					if (xc->code != SQCODE_OK)
-//						break;
-				}
-
-				xc->type = SQXC_TYPE_STR;
-				for (unsigned int i = 0;  i < n_fields;  i++) {
-					xc->name = names[i];
-					xc->value.str = row[i];
-					xc = sqxc_send(xc);
-#ifndef NDEBUG
-					switch (xc->code) {
-					case SQCODE_OK:
-						break;
-
-					case SQCODE_ENTRY_NOT_FOUND:
-						// warning
-						fprintf(stderr, "%s: column '%s' not found.\n",
-						        "sqdb_mysql_exec()", names[i]);
-						break;
-
-					default:
-						fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
-						        "sqdb_mysql_exec()", names[i]);
-						break;
-					}
-#endif  // NDEBUG
-				}
-
-				// Special case:
-				// Don't send object if user selects only one column and the column type is built-in types (not object).
-				if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
-					// SQL row corresponds to SQXC_TYPE_OBJECT
-					xc->type = SQXC_TYPE_OBJECT_END;
-					xc->name = NULL;
-					xc->value.pointer = NULL;
-					xc = sqxc_send(xc);
-//					if (xc->code != SQCODE_OK)
-//						break;
-				}
-			}
+			while ((row = mysql_fetch_row(result)))
+				xc = sqdb_mysql_send_row(xc, row, names, n_fields);
 			// if the result set is empty.
 			if (xc->code == SQCODE_NO_DATA)
 				code = SQCODE_NO_DATA;
@@ -389,6 +463,666 @@ static int  sqdb_mysql_exec(SqdbMysql *sqdb, const char *sql, Sqxc *xc, void *re
 	return code;
 }
 
+// ----------------------------------------------------------------------------
+// non-blocking execution
+
+// SqdbMysql::async.step
+#define SQDB_MYSQL_ASYNC_IDLE     0
+#define SQDB_MYSQL_ASYNC_QUERY    1
+#define SQDB_MYSQL_ASYNC_FETCH    2
+
+// release resources of non-blocking execution
+static void sqdb_mysql_async_clear(SqdbMysql *sqdb)
+{
+	if (sqdb->async.result)
+		mysql_free_result(sqdb->async.result);
+	free(sqdb->async.names);
+	free(sqdb->async.sql);
+	memset(&sqdb->async, 0, sizeof(sqdb->async));
+}
+
+#if SQDB_MYSQL_HAS_NONBLOCK
+
+static int  sqdb_mysql_async_send(SqdbMysql *sqdb, const char *sql, Sqxc *xc)
+{
+	int   err;
+
+	if (sqdb->async.step != SQDB_MYSQL_ASYNC_IDLE) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: previous statement is still in progress.\n",
+		        "sqdb_mysql_async_send()");
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+
+	sqdb->async.xc   = xc;
+	sqdb->async.code = SQCODE_OK;
+	sqdb->async.sql  = strdup(sql);
+	sqdb->async.step = SQDB_MYSQL_ASYNC_QUERY;
+	sqdb->async.status = mysql_real_query_start(&err, sqdb->connection,
+	                                            sqdb->async.sql, (unsigned long)strlen(sqdb->async.sql));
+	// error will be reported by sqdb_mysql_async_poll()
+	if (sqdb->async.status == 0 && err)
+		sqdb->async.code = SQCODE_EXEC_ERROR;
+	return SQCODE_OK;
+}
+
+// used by sqdb_mysql_async_poll() when query is done
+static int  sqdb_mysql_async_query_done(SqdbMysql *sqdb)
+{
+	MYSQL_FIELD *field;
+	Sqxc        *xc = sqdb->async.xc;
+
+	free(sqdb->async.sql);
+	sqdb->async.sql = NULL;
+
+	if (xc == NULL)
+		return SQCODE_OK;
+	if (xc->info == SQXC_INFO_SQL) {
+		// set the last inserted row id
+		((SqxcSql*)xc)->id = mysql_insert_id(sqdb->connection);
+		// set number of rows changed
+		((SqxcSql*)xc)->changes = mysql_affected_rows(sqdb->connection);
+		return SQCODE_OK;
+	}
+
+	// SELECT command. mysql_use_result() doesn't read rows from server.
+	sqdb->async.result = mysql_use_result(sqdb->connection);
+	if (sqdb->async.result == NULL)
+		return SQCODE_EXEC_ERROR;
+	sqdb->async.n_fields = mysql_num_fields(sqdb->async.result);
+	sqdb->async.names = calloc(1, sizeof(char*) * sqdb->async.n_fields);
+	for (unsigned int i = 0;  (field = mysql_fetch_field(sqdb->async.result));  i++)
+		sqdb->async.names[i] = field->name;
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+	xc->code = SQCODE_NO_DATA;
+	sqdb->async.xc = xc;
+	sqdb->async.step = SQDB_MYSQL_ASYNC_FETCH;
+	return SQCODE_AGAIN;
+}
+
+// used by sqdb_mysql_async_poll() when all rows have been fetched
+static int  sqdb_mysql_async_fetch_done(SqdbMysql *sqdb)
+{
+	Sqxc  *xc = sqdb->async.xc;
+	int    code;
+
+	if (mysql_errno(sqdb->connection)) {
+#ifndef NDEBUG
+		fprintf(stderr, "MySQL: %s\n", mysql_error(sqdb->connection));
+#endif
+		code = SQCODE_EXEC_ERROR;
+	}
+	// if the result set is empty.
+	else if (xc->code == SQCODE_NO_DATA)
+		code = SQCODE_NO_DATA;
+	else
+		code = SQCODE_OK;
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY_END;
+		xc->name = NULL;
+//		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+	return code;
+}
+
+static int  sqdb_mysql_async_poll(SqdbMysql *sqdb)
+{
+	MYSQL_ROW  row;
+	int        err;
+	int        code;
+
+	switch (sqdb->async.step) {
+	case SQDB_MYSQL_ASYNC_QUERY:
+		// continue query with events that it is waiting for
+		if (sqdb->async.status) {
+			sqdb->async.status = mysql_real_query_cont(&err, sqdb->connection, sqdb->async.status);
+			if (sqdb->async.status)
+				return SQCODE_AGAIN;
+			if (err)
+				sqdb->async.code = SQCODE_EXEC_ERROR;
+		}
+		if (sqdb->async.code != SQCODE_OK) {
+#ifndef NDEBUG
+			fprintf(stderr, "MySQL: %s\n", mysql_error(sqdb->connection));
+#endif
+			code = sqdb->async.code;
+			break;
+		}
+		code = sqdb_mysql_async_query_done(sqdb);
+		if (code != SQCODE_AGAIN)
+			break;
+		// Don't break here. fetch rows that are ready.
+//		break;
+
+	case SQDB_MYSQL_ASYNC_FETCH:
+		for (;;) {
+			if (sqdb->async.status)
+				sqdb->async.status = mysql_fetch_row_cont(&row, sqdb->async.result, sqdb->async.status);
+			else
+				sqdb->async.status = mysql_fetch_row_start(&row, sqdb->async.result);
+			if (sqdb->async.status)
+				return SQCODE_AGAIN;
+			if (row == NULL)
+				break;
+			sqdb->async.xc = sqdb_mysql_send_row(sqdb->async.xc, row,
+			                                     sqdb->async.names, sqdb->async.n_fields);
+		}
+		code = sqdb_mysql_async_fetch_done(sqdb);
+		break;
+
+	default:
+		// no statement is in progress
+		return SQCODE_OK;
+	}
+
+	// statement is done
+	sqdb_mysql_async_clear(sqdb);
+	return code;
+}
+
+static int  sqdb_mysql_async_socket(SqdbMysql *sqdb, int *events)
+{
+	if (sqdb->connection == NULL)
+		return -1;
+	if (events) {
+		*events = 0;
+		if (sqdb->async.status & MYSQL_WAIT_READ)
+			*events |= SQDB_WAIT_READ;
+		if (sqdb->async.status & MYSQL_WAIT_WRITE)
+			*events |= SQDB_WAIT_WRITE;
+	}
+	return (int)mysql_get_socket(sqdb->connection);
+}
+
+#endif  // SQDB_MYSQL_HAS_NONBLOCK
+
+// ----------------------------------------------------------------------------
+// prepared statement
+
+// MySQL 8.0 removed my_bool
+#if !defined(MARIADB_BASE_VERSION) && !defined(MARIADB_VERSION_ID) && MYSQL_VERSION_ID >= 80001
+typedef bool   my_bool;
+#endif
+
+#define MYSQL_STMT_FIELD_SIZE_DEFAULT    64
+// character set number of binary string (BINARY, VARBINARY, BLOB)
+#define MYSQL_CHARSET_BINARY             63
+
+#define sqdb_mysql_is_blob(field_type)            \
+		((field_type) == MYSQL_TYPE_TINY_BLOB   || \
+		 (field_type) == MYSQL_TYPE_MEDIUM_BLOB || \
+		 (field_type) == MYSQL_TYPE_LONG_BLOB   || \
+		 (field_type) == MYSQL_TYPE_BLOB        || \
+		 (field_type) == MYSQL_TYPE_VAR_STRING  || \
+		 (field_type) == MYSQL_TYPE_STRING)
+
+typedef struct SqdbStmtMysql     SqdbStmtMysql;
+typedef struct SqdbStmtParam     SqdbStmtParam;
+
+// value of parameter. MYSQL_BIND::buffer points to it
+struct SqdbStmtParam
+{
+	SqValue        value;
+	MYSQL_TIME     time;
+	char          *str;        // string that was duplicated by sqdb_mysql_bind()
+};
+
+struct SqdbStmtMysql
+{
+	MYSQL_STMT    *stmt;
+	MYSQL_RES     *metadata;   // NULL if statement doesn't produce result set
+	bool           executed;
+
+	// parameters
+	unsigned int   n_params;
+	MYSQL_BIND    *params;
+	SqdbStmtParam *param_values;
+
+	// result set. Integer, floating point, and date/time columns are fetched in binary format,
+	// other columns are fetched in text format. MYSQL_BIND::buffer_type decides it.
+	unsigned int   n_fields;
+	MYSQL_BIND    *fields;
+	unsigned long *lengths;
+	my_bool       *is_nulls;
+};
+
+// convert time_t to MYSQL_TIME. It uses the same time zone as sq_time_to_string()
+static void sqdb_mysql_time_from_rawtime(MYSQL_TIME *mytime, time_t rawtime)
+{
+	struct tm  *timeinfo;
+
+#if SQ_CONFIG_CONVERT_TIME_TO_GMT
+	timeinfo = gmtime(&rawtime);
+#else
+	timeinfo = localtime(&rawtime);
+#endif
+	memset(mytime, 0, sizeof(MYSQL_TIME));
+	if (timeinfo == NULL)
+		return;
+	mytime->year   = timeinfo->tm_year + 1900;
+	mytime->month  = timeinfo->tm_mon  + 1;
+	mytime->day    = timeinfo->tm_mday;
+	mytime->hour   = timeinfo->tm_hour;
+	mytime->minute = timeinfo->tm_min;
+	mytime->second = timeinfo->tm_sec;
+	mytime->time_type = MYSQL_TIMESTAMP_DATETIME;
+}
+
+// convert MYSQL_TIME to time_t. It uses the same time zone as sq_time_from_string()
+static time_t sqdb_mysql_time_to_rawtime(const MYSQL_TIME *mytime)
+{
+	struct tm  timeinfo = {0};
+
+	// zero date '0000-00-00'
+	if (mytime->year == 0)
+		return 0;
+	timeinfo.tm_year = mytime->year  - 1900;
+	timeinfo.tm_mon  = mytime->month - 1;
+	timeinfo.tm_mday = mytime->day;
+	timeinfo.tm_hour = mytime->hour;
+	timeinfo.tm_min  = mytime->minute;
+	timeinfo.tm_sec  = mytime->second;
+	return mktime(&timeinfo);
+}
+
+static void sqdb_mysql_clear_params(SqdbStmtMysql *mystmt)
+{
+	for (unsigned int index = 0;  index < mystmt->n_params;  index++) {
+		free(mystmt->param_values[index].str);
+		mystmt->param_values[index].str = NULL;
+		memset(mystmt->params + index, 0, sizeof(MYSQL_BIND));
+		mystmt->params[index].buffer_type = MYSQL_TYPE_NULL;
+	}
+}
+
+static void sqdb_mysql_destroy_stmt(SqdbMysql *sqdb, SqdbStmt *stmt)
+{
+	SqdbStmtMysql *mystmt = (SqdbStmtMysql*)stmt;
+
+	sqdb_mysql_clear_params(mystmt);
+	for (unsigned int index = 0;  index < mystmt->n_fields;  index++)
+		free(mystmt->fields[index].buffer);
+	if (mystmt->metadata)
+		mysql_free_result(mystmt->metadata);
+	mysql_stmt_close(mystmt->stmt);
+	free(mystmt->params);
+	free(mystmt->param_values);
+	free(mystmt->fields);
+	free(mystmt->lengths);
+	free(mystmt->is_nulls);
+	free(mystmt);
+}
+
+static int  sqdb_mysql_prepare(SqdbMysql *sqdb, const char *sql, SqdbStmt **stmt)
+{
+	SqdbStmtMysql *mystmt;
+	MYSQL_STMT    *mysqlstmt;
+	MYSQL_FIELD   *columns;
+
+	// reuse cached statement
+	mystmt = (SqdbStmtMysql*)sqdb_stmt_cache_get(&sqdb->stmt_cache, sql);
+	if (mystmt) {
+		*stmt = (SqdbStmt*)mystmt;
+		return SQCODE_OK;
+	}
+
+	mysqlstmt = mysql_stmt_init(sqdb->connection);
+	if (mysqlstmt == NULL || mysql_stmt_prepare(mysqlstmt, sql, (unsigned long)strlen(sql))) {
+#ifndef NDEBUG
+		fprintf(stderr, "MySQL: %s\n", (mysqlstmt) ? mysql_stmt_error(mysqlstmt) : mysql_error(sqdb->connection));
+#endif
+		if (mysqlstmt)
+			mysql_stmt_close(mysqlstmt);
+		*stmt = NULL;
+		return SQCODE_EXEC_ERROR;
+	}
+
+	mystmt = calloc(1, sizeof(SqdbStmtMysql));
+	mystmt->stmt = mysqlstmt;
+	// parameters
+	mystmt->n_params = mysql_stmt_param_count(mysqlstmt);
+	if (mystmt->n_params > 0) {
+		mystmt->params = calloc(mystmt->n_params, sizeof(MYSQL_BIND));
+		mystmt->param_values = calloc(mystmt->n_params, sizeof(SqdbStmtParam));
+		sqdb_mysql_clear_params(mystmt);
+	}
+	// result set
+	mystmt->metadata = mysql_stmt_result_metadata(mysqlstmt);
+	if (mystmt->metadata) {
+		mystmt->n_fields = mysql_num_fields(mystmt->metadata);
+		mystmt->fields   = calloc(mystmt->n_fields, sizeof(MYSQL_BIND));
+		mystmt->lengths  = calloc(mystmt->n_fields, sizeof(unsigned long));
+		mystmt->is_nulls = calloc(mystmt->n_fields, sizeof(my_bool));
+		columns = mysql_fetch_fields(mystmt->metadata);
+		for (unsigned int index = 0;  index < mystmt->n_fields;  index++) {
+			MYSQL_BIND *field = mystmt->fields + index;
+			field->length        = mystmt->lengths + index;
+			field->is_null       = mystmt->is_nulls + index;
+			// map type of column to type of buffer
+			switch (columns[index].type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				field->buffer_type   = MYSQL_TYPE_LONGLONG;
+				field->buffer        = malloc(sizeof(SqValue));
+				field->is_unsigned   = (columns[index].flags & UNSIGNED_FLAG) ? 1 : 0;
+				break;
+
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				field->buffer_type   = MYSQL_TYPE_DOUBLE;
+				field->buffer        = malloc(sizeof(SqValue));
+				break;
+
+			case MYSQL_TYPE_DATE:
+			case MYSQL_TYPE_DATETIME:
+			case MYSQL_TYPE_TIMESTAMP:
+				field->buffer_type   = MYSQL_TYPE_DATETIME;
+				field->buffer        = malloc(sizeof(MYSQL_TIME));
+				break;
+
+			// DECIMAL, TIME, BIT, string, BLOB, JSON, etc.
+			default:
+				field->buffer_type   = MYSQL_TYPE_STRING;
+				field->buffer        = malloc(MYSQL_STMT_FIELD_SIZE_DEFAULT);
+				// reserve space for null-terminated
+				field->buffer_length = MYSQL_STMT_FIELD_SIZE_DEFAULT -1;
+				break;
+			}
+		}
+	}
+	sqdb_stmt_cache_add(&sqdb->stmt_cache, sql, (SqdbStmt*)mystmt);
+
+	*stmt = (SqdbStmt*)mystmt;
+	return SQCODE_OK;
+}
+
+static int  sqdb_mysql_bind(SqdbMysql *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value)
+{
+	SqdbStmtMysql *mystmt = (SqdbStmtMysql*)stmt;
+	SqdbStmtParam *param;
+	MYSQL_BIND    *bind;
+
+	if (index < 1 || index > (int)mystmt->n_params)
+		return SQCODE_EXEC_ERROR;
+	index--;
+	param = mystmt->param_values + index;
+	bind  = mystmt->params + index;
+	free(param->str);
+	param->str = NULL;
+	memset(bind, 0, sizeof(MYSQL_BIND));
+	bind->buffer = &param->value;
+
+	switch (type) {
+	case SQXC_TYPE_NULL:
+		bind->buffer_type = MYSQL_TYPE_NULL;
+		break;
+
+	case SQXC_TYPE_BOOL:
+		param->value.integer = value->boolean;
+		bind->buffer_type = MYSQL_TYPE_LONG;
+		break;
+
+	case SQXC_TYPE_INT:
+		param->value.integer = value->integer;
+		bind->buffer_type = MYSQL_TYPE_LONG;
+		break;
+
+	case SQXC_TYPE_UINT:
+		param->value.uinteger = value->uinteger;
+		bind->buffer_type = MYSQL_TYPE_LONG;
+		bind->is_unsigned = 1;
+		break;
+
+	case SQXC_TYPE_INT64:
+		param->value.int64 = value->int64;
+		bind->buffer_type = MYSQL_TYPE_LONGLONG;
+		break;
+
+	case SQXC_TYPE_UINT64:
+		param->value.uint64 = value->uint64;
+		bind->buffer_type = MYSQL_TYPE_LONGLONG;
+		bind->is_unsigned = 1;
+		break;
+
+	case SQXC_TYPE_DOUBLE:
+		param->value.double_ = value->double_;
+		bind->buffer_type = MYSQL_TYPE_DOUBLE;
+		break;
+
+	case SQXC_TYPE_TIME:
+		sqdb_mysql_time_from_rawtime(&param->time, value->rawtime);
+		bind->buffer_type = MYSQL_TYPE_DATETIME;
+		bind->buffer = &param->time;
+		break;
+
+	case SQXC_TYPE_STR:
+		if (value->str == NULL) {
+			bind->buffer_type = MYSQL_TYPE_NULL;
+			break;
+		}
+		param->str = strdup(value->str);
+		bind->buffer_type = MYSQL_TYPE_STRING;
+		bind->buffer = param->str;
+		bind->buffer_length = (unsigned long)strlen(param->str);
+		break;
+
+	default:
+		bind->buffer_type = MYSQL_TYPE_NULL;
+		return SQCODE_TYPE_NOT_SUPPORTED;
+	}
+	return SQCODE_OK;
+}
+
+static int  sqdb_mysql_step(SqdbMysql *sqdb, SqdbStmt *stmt, Sqxc *xc)
+{
+	SqdbStmtMysql *mystmt = (SqdbStmtMysql*)stmt;
+	MYSQL_FIELD   *columns;
+	MYSQL_BIND    *field;
+	char *mem;
+	int   rc;
+
+	// execute statement in first step
+	if (mystmt->executed == false) {
+		if (mystmt->n_params > 0 && mysql_stmt_bind_param(mystmt->stmt, mystmt->params))
+			goto step_error;
+		if (mysql_stmt_execute(mystmt->stmt))
+			goto step_error;
+		if (mystmt->metadata && mysql_stmt_bind_result(mystmt->stmt, mystmt->fields))
+			goto step_error;
+		mystmt->executed = true;
+	}
+
+	if (mystmt->metadata == NULL) {
+		if (xc && xc->info == SQXC_INFO_SQL) {
+			// set the last inserted row id
+			((SqxcSql*)xc)->id = mysql_stmt_insert_id(mystmt->stmt);
+			// set number of rows changed
+			((SqxcSql*)xc)->changes = mysql_stmt_affected_rows(mystmt->stmt);
+		}
+		return SQCODE_DONE;
+	}
+
+	rc = mysql_stmt_fetch(mystmt->stmt);
+	if (rc == MYSQL_NO_DATA)
+		return SQCODE_DONE;
+	if (rc == 1)
+		goto step_error;
+	if (rc == MYSQL_DATA_TRUNCATED) {
+		// enlarge buffer and fetch truncated columns again
+		for (unsigned int index = 0;  index < mystmt->n_fields;  index++) {
+			field = mystmt->fields + index;
+			if (field->buffer_type != MYSQL_TYPE_STRING || mystmt->is_nulls[index] ||
+			    mystmt->lengths[index] <= field->buffer_length)
+			{
+				continue;
+			}
+			field->buffer = realloc(field->buffer, mystmt->lengths[index] +1);
+			field->buffer_length = mystmt->lengths[index];
+			if (mysql_stmt_fetch_column(mystmt->stmt, field, index, 0))
+				goto step_error;
+		}
+		// buffer address may be changed
+		if (mysql_stmt_bind_result(mystmt->stmt, mystmt->fields))
+			goto step_error;
+	}
+
+	// discard row if 'xc' is NULL
+	if (xc == NULL)
+		return SQCODE_ROW;
+#ifndef NDEBUG
+	if (xc->info != SQXC_INFO_VALUE) {
+		fprintf(stderr, "%s: SELECT command must use with SqxcValue.\n",
+		        "sqdb_mysql_step()");
+		return SQCODE_EXEC_ERROR;
+	}
+#endif
+
+	// Special case:
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	columns = mysql_fetch_fields(mystmt->metadata);
+	for (unsigned int index = 0;  index < mystmt->n_fields;  index++) {
+		field = mystmt->fields + index;
+		mem = NULL;
+		xc->name = columns[index].name;
+
+		if (mystmt->is_nulls[index]) {
+			xc->type = SQXC_TYPE_NULL;
+			xc->value.int64 = 0;       // clear all bits, parser may read any member of SqValue
+		}
+		else switch (field->buffer_type) {
+		case MYSQL_TYPE_LONGLONG:
+			if (field->is_unsigned && columns[index].type == MYSQL_TYPE_LONGLONG) {
+				xc->type = SQXC_TYPE_UINT64;
+				xc->value.uint64 = ((SqValue*)field->buffer)->uint64;
+			}
+			else {
+				// unsigned value of smaller integer can be hold by int64_t
+				xc->type = SQXC_TYPE_INT64;
+				xc->value.int64 = ((SqValue*)field->buffer)->int64;
+			}
+			break;
+
+		case MYSQL_TYPE_DOUBLE:
+			xc->type = SQXC_TYPE_DOUBLE;
+			xc->value.double_ = ((SqValue*)field->buffer)->double_;
+			break;
+
+		case MYSQL_TYPE_DATETIME:
+			xc->type = SQXC_TYPE_TIME;
+			xc->value.rawtime = sqdb_mysql_time_to_rawtime(field->buffer);
+			break;
+
+//		case MYSQL_TYPE_STRING:
+		default:
+			xc->type = SQXC_TYPE_STR;
+			if (columns[index].charsetnr == MYSQL_CHARSET_BINARY && sqdb_mysql_is_blob(columns[index].type)) {
+				// BLOB -> SQXC_TYPE_STR in hex format \xFF (Sqxc doesn't carry length of data, hex string keeps it).
+				mem = malloc(mystmt->lengths[index] * 2 + 3);    // + \x and null-terminated
+				mem[0] = '\\';
+				mem[1] = 'x';
+				sq_bin_to_hex(mem+2, field->buffer, mystmt->lengths[index]);
+				mem[mystmt->lengths[index] * 2 + 2] = 0;         // null-terminated
+				xc->value.str = mem;
+			}
+			else {
+				// null-terminated
+				((char*)field->buffer)[mystmt->lengths[index]] = 0;
+				xc->value.str = field->buffer;
+			}
+			break;
+		}
+
+		xc = sqxc_send(xc);
+		free(mem);
+#ifndef NDEBUG
+		switch (xc->code) {
+		case SQCODE_OK:
+			break;
+
+		case SQCODE_ENTRY_NOT_FOUND:
+			// warning
+			fprintf(stderr, "%s: column '%s' not found.\n",
+			        "sqdb_mysql_step()", columns[index].name);
+			break;
+
+		default:
+			fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
+			        "sqdb_mysql_step()", columns[index].name);
+			break;
+		}
+#endif  // NDEBUG
+	}
+
+	// Special case:
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	return SQCODE_ROW;
+
+step_error:
+#ifndef NDEBUG
+	fprintf(stderr, "MySQL: %s\n", mysql_stmt_error(mystmt->stmt));
+#endif
+	return SQCODE_EXEC_ERROR;
+}
+
+static int  sqdb_mysql_reset(SqdbMysql *sqdb, SqdbStmt *stmt)
+{
+	SqdbStmtMysql *mystmt = (SqdbStmtMysql*)stmt;
+
+	if (mystmt->executed) {
+		mysql_stmt_free_result(mystmt->stmt);
+		mysql_stmt_reset(mystmt->stmt);
+		mystmt->executed = false;
+	}
+	return SQCODE_OK;
+}
+
+static int  sqdb_mysql_finalize(SqdbMysql *sqdb, SqdbStmt *stmt)
+{
+	if (stmt == NULL)
+		return SQCODE_OK;
+	// return cached statement to cache
+	if (sqdb_stmt_cache_release(&sqdb->stmt_cache, stmt)) {
+		sqdb_mysql_reset(sqdb, stmt);
+		sqdb_mysql_clear_params((SqdbStmtMysql*)stmt);
+	}
+	else
+		sqdb_mysql_destroy_stmt(sqdb, stmt);
+	return SQCODE_OK;
+}
+
 // ----------------------------------------------------------------------------
 // other static functions
 
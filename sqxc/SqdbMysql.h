@@ -23,6 +23,7 @@
 #endif
 
 #include <sqxc/Sqdb.h>
+#include <sqxc/SqdbStmtCache.h>
 
 // ----------------------------------------------------------------------------
 // C/C++ common declarations: declare type, structure, macro, enumeration.
@@ -77,7 +78,28 @@ struct SqdbMysql
 	// ------ SqdbMysql members ------     // <-- 3. Add variable and non-virtual function in derived struct.
 	MYSQL *connection;
 
+	// prepared statements. 'stmt_cache.hits' and 'stmt_cache.misses' are statistics of cache.
+	SqdbStmtCache   stmt_cache;
+
 	const SqdbConfigMysql *config;
+
+	// version of connected server. e.g. 80019 for 8.0.19
+	// 'is_mariadb' is true if server is MariaDB. It doesn't have row alias that is used by upsert.
+	unsigned long   server_version;
+	bool            is_mariadb;
+
+	// state of non-blocking execution. see sqdb_async_send() and sqdb_async_poll()
+	// MariaDB Connector/C supports non-blocking API, MySQL client library doesn't support it.
+	struct {
+		Sqxc         *xc;          // current element of Sqxc chain
+		char         *sql;         // it must be valid until query is sent
+		MYSQL_RES    *result;
+		char        **names;       // names of columns in 'result'
+		unsigned int  n_fields;
+		int           step;        // 0 = idle, 1 = query, 2 = fetch rows
+		int           status;      // MYSQL_WAIT_READ, MYSQL_WAIT_WRITE...etc
+		int           code;
+	} async;
 };
 
 /*	SqdbConfigMysql - SqdbMysql use this to configure database connection
@@ -104,6 +126,9 @@ struct SqdbConfigMysql
 	const char   *user;
 	const char   *password;
 	const char   *db;
+
+	// number of cached prepared statements. 0 = SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT, -1 = disable cache
+	int           stmt_cache_size;
 };
 
 // ----------------------------------------------------------------------------
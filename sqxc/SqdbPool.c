@@ -0,0 +1,357 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdio.h>             // fprintf(), stderr
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqxc/SqdbPool.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+static const SqdbPoolConfig  pool_config_default = {
+	.min_size      = 0,
+	.max_size      = SQ_CONFIG_SQDB_POOL_SIZE_DEFAULT,
+	.timeout       = -1,
+	.idle_timeout  = 0,
+	.validate_idle = -1,
+};
+
+// open a new connection. This doesn't lock mutex.
+static Sqdb *sqdb_pool_connect(SqdbPool *pool, const char *database_name)
+{
+	Sqdb *db;
+
+	db = sqdb_new(pool->info, pool->config);
+	if (sqdb_open(db, database_name) != SQCODE_OK) {
+		sqdb_free(db);
+		return NULL;
+	}
+	return db;
+}
+
+// close and free connection. This doesn't lock mutex.
+static void  sqdb_pool_disconnect(SqdbPool *pool, Sqdb *db)
+{
+	sqdb_close(db);
+	sqdb_free(db);
+}
+
+SqdbPool *sqdb_pool_new(const SqdbInfo *info, const SqdbConfig *config, const SqdbPoolConfig *pool_config)
+{
+	SqdbPool *pool;
+
+	pool = malloc(sizeof(SqdbPool));
+	sqdb_pool_init(pool, info, config, pool_config);
+	return pool;
+}
+
+void  sqdb_pool_free(SqdbPool *pool)
+{
+	sqdb_pool_final(pool);
+	free(pool);
+}
+
+void  sqdb_pool_init(SqdbPool *pool, const SqdbInfo *info, const SqdbConfig *config, const SqdbPoolConfig *pool_config)
+{
+	if (pool_config == NULL)
+		pool_config = &pool_config_default;
+
+	pool->info = info;
+	pool->config = config;
+	pool->database_name = NULL;
+	pool->setting = *pool_config;
+	if (pool->setting.max_size <= 0)
+		pool->setting.max_size = SQ_CONFIG_SQDB_POOL_SIZE_DEFAULT;
+	if (pool->setting.min_size > pool->setting.max_size)
+		pool->setting.min_size = pool->setting.max_size;
+
+	sq_mutex_init(&pool->mutex);
+	sq_cond_init(&pool->cond);
+	pool->idle = malloc(sizeof(SqdbPoolSlot) * pool->setting.max_size);
+	pool->n_idle = 0;
+	memset(&pool->stats, 0, sizeof(SqdbPoolStats));
+	pool->trace = NULL;
+	pool->trace_data = NULL;
+}
+
+void  sqdb_pool_final(SqdbPool *pool)
+{
+	sqdb_pool_close(pool);
+#ifndef NDEBUG
+	if (pool->stats.n_in_use > 0) {
+		fprintf(stderr, "%s: %d connections are still in use.\n",
+		        "sqdb_pool_final()", pool->stats.n_in_use);
+	}
+#endif
+	sq_cond_final(&pool->cond);
+	sq_mutex_final(&pool->mutex);
+	free(pool->idle);
+}
+
+int   sqdb_pool_open(SqdbPool *pool, const char *database_name)
+{
+	Sqdb *db;
+	int   code = SQCODE_OK;
+
+	sq_mutex_lock(&pool->mutex);
+	free(pool->database_name);
+	pool->database_name = strdup(database_name);
+	sq_mutex_unlock(&pool->mutex);
+
+	// open 'min_size' connections
+	for (int index = 0;  index < pool->setting.min_size;  index++) {
+		db = sqdb_pool_connect(pool, database_name);
+
+		sq_mutex_lock(&pool->mutex);
+		if (db == NULL || pool->stats.n_connections >= pool->setting.max_size) {
+			if (db == NULL) {
+				pool->stats.n_open_failed++;
+				code = SQCODE_OPEN_FAILED;
+			}
+			sq_mutex_unlock(&pool->mutex);
+			if (db)
+				sqdb_pool_disconnect(pool, db);
+			break;
+		}
+		pool->idle[pool->n_idle].db = db;
+		pool->idle[pool->n_idle].idle_since = sq_clock_msec();
+		pool->n_idle++;
+		pool->stats.n_connections++;
+		pool->stats.n_opened++;
+		sq_cond_signal(&pool->cond);
+		sq_mutex_unlock(&pool->mutex);
+	}
+	return code;
+}
+
+int   sqdb_pool_close(SqdbPool *pool)
+{
+	SqdbPoolSlot *slots;
+	int           n_slots;
+
+	sq_mutex_lock(&pool->mutex);
+	free(pool->database_name);
+	pool->database_name = NULL;
+	// take all idle connections
+	n_slots = pool->n_idle;
+	slots = NULL;
+	if (n_slots > 0) {
+		slots = malloc(sizeof(SqdbPoolSlot) * n_slots);
+		memcpy(slots, pool->idle, sizeof(SqdbPoolSlot) * n_slots);
+		pool->n_idle = 0;
+		pool->stats.n_connections -= n_slots;
+	}
+	// wake up threads that are waiting in sqdb_pool_acquire()
+	sq_cond_broadcast(&pool->cond);
+	sq_mutex_unlock(&pool->mutex);
+
+	// close connections without locking
+	for (int index = 0;  index < n_slots;  index++)
+		sqdb_pool_disconnect(pool, slots[index].db);
+	free(slots);
+	return SQCODE_OK;
+}
+
+int   sqdb_pool_acquire(SqdbPool *pool, Sqdb **db)
+{
+	Sqdb     *conn;
+	char     *database_name;
+	uint64_t  wait_begin = 0;
+	uint64_t  now;
+	int       remaining;
+	bool      validate;
+
+	sq_mutex_lock(&pool->mutex);
+	for (;;) {
+		if (pool->database_name == NULL) {
+			// pool is not opened or it has been closed
+			sq_mutex_unlock(&pool->mutex);
+			*db = NULL;
+			return SQCODE_OPEN_FAILED;
+		}
+
+		// --- use idle connection ---
+		if (pool->n_idle > 0) {
+			pool->n_idle--;
+			conn = pool->idle[pool->n_idle].db;
+			now  = sq_clock_msec();
+			validate = pool->info->ping && pool->setting.validate_idle >= 0 &&
+			           now - pool->idle[pool->n_idle].idle_since >= (uint64_t)pool->setting.validate_idle;
+			pool->stats.n_in_use++;
+			sq_mutex_unlock(&pool->mutex);
+
+			if (validate && sqdb_ping(conn) != SQCODE_OK) {
+				// connection is broken, close it and try again.
+				sqdb_pool_disconnect(pool, conn);
+				sq_mutex_lock(&pool->mutex);
+				pool->stats.n_in_use--;
+				pool->stats.n_connections--;
+				pool->stats.n_validation_failed++;
+				continue;
+			}
+			break;
+		}
+
+		// --- open new connection ---
+		if (pool->stats.n_connections < pool->setting.max_size) {
+			// reserve a place for new connection
+			pool->stats.n_connections++;
+			pool->stats.n_in_use++;
+			database_name = strdup(pool->database_name);
+			sq_mutex_unlock(&pool->mutex);
+
+			// connect without locking. It may take a long time.
+			conn = sqdb_pool_connect(pool, database_name);
+			free(database_name);
+
+			sq_mutex_lock(&pool->mutex);
+			if (conn == NULL) {
+				pool->stats.n_connections--;
+				pool->stats.n_in_use--;
+				pool->stats.n_open_failed++;
+				// other waiting thread can try to open connection
+				sq_cond_signal(&pool->cond);
+				sq_mutex_unlock(&pool->mutex);
+				*db = NULL;
+				return SQCODE_OPEN_FAILED;
+			}
+			pool->stats.n_opened++;
+			sq_mutex_unlock(&pool->mutex);
+			break;
+		}
+
+		// --- wait for released connection ---
+		now = sq_clock_msec();
+		if (wait_begin == 0) {
+			wait_begin = now;
+			pool->stats.n_waited++;
+		}
+		remaining = pool->setting.timeout - (int)(now - wait_begin);
+		if (pool->setting.timeout >= 0 && remaining <= 0) {
+			pool->stats.n_timeouts++;
+			pool->stats.wait_time += now - wait_begin;
+			if (pool->stats.wait_time_max < now - wait_begin)
+				pool->stats.wait_time_max = now - wait_begin;
+			sq_mutex_unlock(&pool->mutex);
+			*db = NULL;
+			return SQCODE_TIMEOUT;
+		}
+		pool->stats.n_waiting++;
+		if (pool->setting.timeout < 0)
+			sq_cond_wait(&pool->cond, &pool->mutex);
+		else
+			sq_cond_wait_timeout(&pool->cond, &pool->mutex, remaining);
+		pool->stats.n_waiting--;
+	}
+
+	// --- update statistics ---
+	sq_mutex_lock(&pool->mutex);
+	pool->stats.n_acquired++;
+	if (pool->stats.n_in_use_peak < pool->stats.n_in_use)
+		pool->stats.n_in_use_peak = pool->stats.n_in_use;
+	if (wait_begin) {
+		now = sq_clock_msec() - wait_begin;
+		pool->stats.wait_time += now;
+		if (pool->stats.wait_time_max < now)
+			pool->stats.wait_time_max = now;
+	}
+	conn->trace = pool->trace;
+	conn->trace_data = pool->trace_data;
+	sq_mutex_unlock(&pool->mutex);
+
+	*db = conn;
+	return SQCODE_OK;
+}
+
+void  sqdb_pool_release(SqdbPool *pool, Sqdb *db)
+{
+	SqdbPoolSlot *slot;
+	Sqdb         *expired[8];
+	int           n_expired = 0;
+	uint64_t      now;
+
+	if (db == NULL)
+		return;
+
+	sq_mutex_lock(&pool->mutex);
+	pool->stats.n_in_use--;
+	if (pool->database_name == NULL) {
+		// pool has been closed
+		pool->stats.n_connections--;
+		sq_mutex_unlock(&pool->mutex);
+		sqdb_pool_disconnect(pool, db);
+		return;
+	}
+
+	now = sq_clock_msec();
+	// close connections that exceed 'min_size' and have been idle too long.
+	// the first slot is the least recently used.
+	if (pool->setting.idle_timeout > 0) {
+		while (pool->n_idle > 0 && n_expired < (int)(sizeof(expired) / sizeof(Sqdb*)) &&
+		       pool->stats.n_connections > pool->setting.min_size &&
+		       now - pool->idle[0].idle_since >= (uint64_t)pool->setting.idle_timeout)
+		{
+			expired[n_expired++] = pool->idle[0].db;
+			pool->n_idle--;
+			memmove(pool->idle, pool->idle + 1, sizeof(SqdbPoolSlot) * pool->n_idle);
+			pool->stats.n_connections--;
+		}
+	}
+
+	slot = pool->idle + pool->n_idle++;
+	slot->db = db;
+	slot->idle_since = now;
+	sq_cond_signal(&pool->cond);
+	sq_mutex_unlock(&pool->mutex);
+
+	for (int index = 0;  index < n_expired;  index++)
+		sqdb_pool_disconnect(pool, expired[index]);
+}
+
+void  sqdb_pool_discard(SqdbPool *pool, Sqdb *db)
+{
+	if (db == NULL)
+		return;
+
+	sq_mutex_lock(&pool->mutex);
+	pool->stats.n_in_use--;
+	pool->stats.n_connections--;
+	// other waiting thread can open new connection
+	sq_cond_signal(&pool->cond);
+	sq_mutex_unlock(&pool->mutex);
+
+	sqdb_pool_disconnect(pool, db);
+}
+
+void  sqdb_pool_get_stats(SqdbPool *pool, SqdbPoolStats *stats)
+{
+	sq_mutex_lock(&pool->mutex);
+	*stats = pool->stats;
+	stats->n_idle = pool->n_idle;
+	sq_mutex_unlock(&pool->mutex);
+}
+
+void  sqdb_pool_set_trace(SqdbPool *pool, SqdbTraceFunc func, void *data)
+{
+	sq_mutex_lock(&pool->mutex);
+	pool->trace = func;
+	pool->trace_data = data;
+	sq_mutex_unlock(&pool->mutex);
+}
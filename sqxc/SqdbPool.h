@@ -0,0 +1,268 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqdbPool - thread-safe pool of database connections (Sqdb instances).
+	           It works with any SqdbInfo such as SQDB_INFO_SQLITE, SQDB_INFO_MYSQL, SQDB_INFO_POSTGRE.
+
+	Connections are created by sqdb_new() and opened by sqdb_open() when they are needed (lazy connect).
+	Each thread acquires a connection, uses it with sqdb_exec(), sqdb_prepare()...etc, then releases it.
+ */
+
+#ifndef SQDB_POOL_H
+#define SQDB_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sqxc/SqConfig.h>
+#include <sqxc/SqError.h>
+#include <sqxc/SqThread.h>
+#include <sqxc/Sqdb.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqdbPool          SqdbPool;
+typedef struct SqdbPoolConfig    SqdbPoolConfig;
+typedef struct SqdbPoolStats     SqdbPoolStats;
+typedef struct SqdbPoolSlot      SqdbPoolSlot;
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* SqdbPool C Functions */
+
+// 'config' is configuration of connections. It must be valid until pool is freed. It can be NULL.
+// If 'pool_config' is NULL, use default setting.
+SqdbPool *sqdb_pool_new(const SqdbInfo *info, const SqdbConfig *config, const SqdbPoolConfig *pool_config);
+void      sqdb_pool_free(SqdbPool *pool);
+
+void      sqdb_pool_init(SqdbPool *pool, const SqdbInfo *info, const SqdbConfig *config, const SqdbPoolConfig *pool_config);
+void      sqdb_pool_final(SqdbPool *pool);
+
+// set name of database and open 'min_size' connections.
+// Other connections are opened by sqdb_pool_acquire() when they are needed.
+int       sqdb_pool_open(SqdbPool *pool, const char *database_name);
+
+// close idle connections. Connections in use will be closed when they are released.
+int       sqdb_pool_close(SqdbPool *pool);
+
+// get a connection from pool. It waits SqdbPoolConfig::timeout milliseconds if all connections are in use.
+// return SQCODE_OK, SQCODE_TIMEOUT, or SQCODE_OPEN_FAILED.
+int       sqdb_pool_acquire(SqdbPool *pool, Sqdb **db);
+
+// return connection to pool.
+void      sqdb_pool_release(SqdbPool *pool, Sqdb *db);
+
+// close connection instead of returning it to pool. Use this if connection is broken.
+void      sqdb_pool_discard(SqdbPool *pool, Sqdb *db);
+
+// copy statistics of pool to 'stats'
+void      sqdb_pool_get_stats(SqdbPool *pool, SqdbPoolStats *stats);
+
+// set trace hook of connections. It is applied to connection when it is acquired.
+void      sqdb_pool_set_trace(SqdbPool *pool, SqdbTraceFunc func, void *data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C++ declarations: declare C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/*	DbPoolMethod is used by SqdbPool and it's children.
+
+	It's derived struct/class must be C++11 standard-layout and has SqdbPool members.
+ */
+struct DbPoolMethod
+{
+	int   open(const char *databaseName);
+	int   close(void);
+
+	int   acquire(Sqdb **db);
+	Sqdb *acquire(void);
+	void  release(Sqdb *db);
+	void  discard(Sqdb *db);
+
+	void  getStats(SqdbPoolStats *stats);
+
+	void  setTrace(SqdbTraceFunc func, void *data = NULL);
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqdbPoolConfig - setting of SqdbPool
+ */
+struct SqdbPoolConfig
+{
+	int   min_size;         // number of connections that are opened by sqdb_pool_open() and are never closed when idle.
+	int   max_size;         // max number of connections. 0 = SQ_CONFIG_SQDB_POOL_SIZE_DEFAULT
+	int   timeout;          // milliseconds that sqdb_pool_acquire() waits. 0 = don't wait, -1 = wait forever.
+	int   idle_timeout;     // milliseconds. connections that exceed 'min_size' are closed after being idle this long. 0 = never.
+	int   validate_idle;    // milliseconds. connection is checked by sqdb_ping() if it has been idle this long. 0 = always, -1 = never.
+};
+
+/*	SqdbPoolStats - statistics of SqdbPool
+ */
+struct SqdbPoolStats
+{
+	int       n_connections;         // number of opened connections (idle + in use)
+	int       n_idle;
+	int       n_in_use;
+	int       n_in_use_peak;
+	int       n_waiting;             // number of threads that are waiting in sqdb_pool_acquire()
+
+	uint64_t  n_acquired;            // number of successful sqdb_pool_acquire()
+	uint64_t  n_waited;              // number of sqdb_pool_acquire() that had to wait
+	uint64_t  n_timeouts;            // number of sqdb_pool_acquire() that timed out
+	uint64_t  n_opened;              // number of connections that have been opened
+	uint64_t  n_open_failed;
+	uint64_t  n_validation_failed;   // number of connections that were closed by failed sqdb_ping()
+
+	uint64_t  wait_time;             // total milliseconds spent waiting in sqdb_pool_acquire()
+	uint64_t  wait_time_max;         // longest wait in milliseconds
+};
+
+struct SqdbPoolSlot
+{
+	Sqdb     *db;
+	uint64_t  idle_since;            // sq_clock_msec() when connection was released
+};
+
+/*	SqdbPool - thread-safe pool of Sqdb instances
+
+	All members are protected by 'mutex'. Don't access them directly, use sqdb_pool_get_stats() to get statistics.
+ */
+
+#define SQDB_POOL_MEMBERS                \
+	const SqdbInfo   *info;              \
+	const SqdbConfig *config;            \
+	char             *database_name;     \
+	SqdbPoolConfig    setting;           \
+	SqMutex           mutex;             \
+	SqCond            cond;              \
+	SqdbPoolSlot     *idle;              \
+	int               n_idle;            \
+	SqdbPoolStats     stats;             \
+	SqdbTraceFunc     trace;             \
+	void             *trace_data
+
+#ifdef __cplusplus
+struct SqdbPool : Sq::DbPoolMethod           // <-- 1. inherit C++ member function(method)
+#else
+struct SqdbPool
+#endif
+{
+	SQDB_POOL_MEMBERS;                       // <-- 2. inherit member variable
+/*	// ------ SqdbPool members ------
+	const SqdbInfo   *info;            // interface of connections
+	const SqdbConfig *config;          // configuration of connections
+	char             *database_name;   // NULL if pool is not opened
+
+	SqdbPoolConfig    setting;
+
+	SqMutex           mutex;
+	SqCond            cond;            // signaled when connection is released or closed
+
+	// stack of idle connections. The last one is the most recently used.
+	SqdbPoolSlot     *idle;
+	int               n_idle;
+
+	SqdbPoolStats     stats;
+
+	// trace hook of connections
+	SqdbTraceFunc     trace;
+	void             *trace_data;
+ */
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* define DbPoolMethod functions. */
+
+inline int   DbPoolMethod::open(const char *databaseName) {
+	return sqdb_pool_open((SqdbPool*)this, databaseName);
+}
+inline int   DbPoolMethod::close(void) {
+	return sqdb_pool_close((SqdbPool*)this);
+}
+
+inline int   DbPoolMethod::acquire(Sqdb **db) {
+	return sqdb_pool_acquire((SqdbPool*)this, db);
+}
+inline Sqdb *DbPoolMethod::acquire(void) {
+	Sqdb *db;
+	if (sqdb_pool_acquire((SqdbPool*)this, &db) != SQCODE_OK)
+		return NULL;
+	return db;
+}
+inline void  DbPoolMethod::release(Sqdb *db) {
+	sqdb_pool_release((SqdbPool*)this, db);
+}
+inline void  DbPoolMethod::discard(Sqdb *db) {
+	sqdb_pool_discard((SqdbPool*)this, db);
+}
+
+inline void  DbPoolMethod::getStats(SqdbPoolStats *stats) {
+	sqdb_pool_get_stats((SqdbPool*)this, stats);
+}
+
+inline void  DbPoolMethod::setTrace(SqdbTraceFunc func, void *data) {
+	sqdb_pool_set_trace((SqdbPool*)this, func, data);
+}
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+typedef struct SqdbPoolConfig    DbPoolConfig;
+typedef struct SqdbPoolStats     DbPoolStats;
+
+struct DbPool : SqdbPool
+{
+	// constructor
+	DbPool(const SqdbInfo *info, const SqdbConfig *config = NULL, const SqdbPoolConfig *poolConfig = NULL) {
+		sqdb_pool_init((SqdbPool*)this, info, config, poolConfig);
+	}
+	DbPool(const SqdbInfo *info, const SqdbConfig &config, const SqdbPoolConfig &poolConfig) {
+		sqdb_pool_init((SqdbPool*)this, info, &config, &poolConfig);
+	}
+	// destructor
+	~DbPool() {
+		sqdb_pool_final((SqdbPool*)this);
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQDB_POOL_H
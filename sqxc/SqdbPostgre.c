@@ -18,8 +18,11 @@
 #include <limits.h>            // INT_MAX
 #include <stdio.h>             // snprintf(), fprintf(), stderr
 #include <stdbool.h>           // bool, true, false
+#include <inttypes.h>          // PRId64, PRIu64
+#include <time.h>              // gmtime(), mktime()
 
 #include <sqxc/SqError.h>
+#include <sqxc/SqConvert.h>    // sq_time_to_string(), sq_bin_to_hex()
 #include <sqxc/Sqdb-migration.h>
 #include <sqxc/SqdbPostgre.h>
 #include <sqxc/SqxcValue.h>
@@ -29,6 +32,7 @@
 #define snprintf     _snprintf
 #define strtoll      _strtoi64
 #define strcasecmp   _stricmp
+#define strdup       _strdup
 #endif
 
 #define POSTGRE_DEFAULT_HOST      "localhost"
@@ -42,6 +46,20 @@ static int  sqdb_postgre_open(SqdbPostgre *sqdb, const char *database_name);
 static int  sqdb_postgre_close(SqdbPostgre *sqdb);
 static int  sqdb_postgre_exec(SqdbPostgre *sqdb, const char *sql, Sqxc *xc, void *reserve);
 static int  sqdb_postgre_migrate(SqdbPostgre *sqdb, SqSchema *schema, SqSchema *schema_next);
+static int  sqdb_postgre_prepare(SqdbPostgre *sqdb, const char *sql, SqdbStmt **stmt);
+static int  sqdb_postgre_bind(SqdbPostgre *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+static int  sqdb_postgre_step(SqdbPostgre *sqdb, SqdbStmt *stmt, Sqxc *xc);
+static int  sqdb_postgre_reset(SqdbPostgre *sqdb, SqdbStmt *stmt);
+static int  sqdb_postgre_finalize(SqdbPostgre *sqdb, SqdbStmt *stmt);
+static void sqdb_postgre_destroy_stmt(SqdbPostgre *sqdb, SqdbStmt *stmt);
+static int  sqdb_postgre_copy_begin(SqdbPostgre *sqdb, const char *sql);
+static int  sqdb_postgre_copy_data(SqdbPostgre *sqdb, const char *data, size_t length);
+static int  sqdb_postgre_copy_end(SqdbPostgre *sqdb, const char *error_msg, int64_t *n_rows);
+static int  sqdb_postgre_copy_out(SqdbPostgre *sqdb, const char *sql, const char **column_names, int n_columns, Sqxc *xc);
+static int  sqdb_postgre_ping(SqdbPostgre *sqdb);
+static int  sqdb_postgre_async_send(SqdbPostgre *sqdb, const char *sql, Sqxc *xc);
+static int  sqdb_postgre_async_poll(SqdbPostgre *sqdb);
+static int  sqdb_postgre_async_socket(SqdbPostgre *sqdb, int *events);
 
 static void sqdb_postgre_create_table_dep(SqdbPostgre *db, SqBuffer *sql_buf, SqTable *table);
 static void sqdb_postgre_create_trigger(SqdbPostgre *db, SqBuffer *sql_buf, const char *table_name, const char *column_name);
@@ -51,6 +69,8 @@ static void sqdb_postgre_alter_table(SqdbPostgre *sqdb, SqBuffer *sql_buf, SqTab
 static int  sqdb_postgre_schema_get_version(SqdbPostgre *sqdb);
 static void sqdb_postgre_schema_set_version(SqdbPostgre *sqdb, int version);
 static bool sqdb_postgre_handle_result(SqdbPostgre *sqdb, PGresult *result);
+static int  sqdb_postgre_exec_stream(SqdbPostgre *sqdb, const char *sql, Sqxc *xc);
+static void sqdb_postgre_cancel(SqdbPostgre *sqdb);
 #if SQ_CONFIG_TABLE_COLUMN_COMMENTS
 static void sqdb_postgre_comment(SqdbPostgre *sqdb, SqBuffer *sql_buf, SqTable *table, SqColumn *column);
 #endif
@@ -80,8 +100,425 @@ const SqdbInfo sqdbInfo_Postgres = {
 	.close   = (void*)sqdb_postgre_close,
 	.exec    = (void*)sqdb_postgre_exec,
 	.migrate = (void*)sqdb_postgre_migrate,
+
+	.prepare  = (void*)sqdb_postgre_prepare,
+	.bind     = (void*)sqdb_postgre_bind,
+	.step     = (void*)sqdb_postgre_step,
+	.reset    = (void*)sqdb_postgre_reset,
+	.finalize = (void*)sqdb_postgre_finalize,
+
+	.copy_begin = (void*)sqdb_postgre_copy_begin,
+	.copy_data  = (void*)sqdb_postgre_copy_data,
+	.copy_end   = (void*)sqdb_postgre_copy_end,
+	.copy_out   = (void*)sqdb_postgre_copy_out,
+
+	.async_send   = (void*)sqdb_postgre_async_send,
+	.async_poll   = (void*)sqdb_postgre_async_poll,
+	.async_socket = (void*)sqdb_postgre_async_socket,
+
+	.ping       = (void*)sqdb_postgre_ping,
 };
 
+// ----------------------------------------------------------------------------
+// result values
+
+// OID of built-in data types. They are defined in server header catalog/pg_type_d.h
+#define POSTGRE_BOOLOID             16
+#define POSTGRE_BYTEAOID            17
+#define POSTGRE_CHAROID             18
+#define POSTGRE_NAMEOID             19
+#define POSTGRE_INT8OID             20
+#define POSTGRE_INT2OID             21
+#define POSTGRE_INT4OID             23
+#define POSTGRE_TEXTOID             25
+#define POSTGRE_OIDOID              26
+#define POSTGRE_JSONOID            114
+#define POSTGRE_XMLOID             142
+#define POSTGRE_FLOAT4OID          700
+#define POSTGRE_FLOAT8OID          701
+#define POSTGRE_BPCHAROID         1042
+#define POSTGRE_VARCHAROID        1043
+#define POSTGRE_DATEOID           1082
+#define POSTGRE_TIMEOID           1083
+#define POSTGRE_TIMESTAMPOID      1114
+#define POSTGRE_TIMESTAMPTZOID    1184
+#define POSTGRE_NUMERICOID        1700
+#define POSTGRE_UUIDOID           2950
+#define POSTGRE_JSONBOID          3802
+
+// seconds from 1970-01-01 (Unix epoch) to 2000-01-01 (PostgreSQL epoch)
+#define POSTGRE_EPOCH_OFFSET      946684800
+
+// binary values are in network byte order (big-endian)
+static uint16_t sq_postgre_uint16(const char *mem)
+{
+	const uint8_t *bytes = (const uint8_t*)mem;
+
+	return (uint16_t)(bytes[0] << 8 | bytes[1]);
+}
+
+static uint32_t sq_postgre_uint32(const char *mem)
+{
+	const uint8_t *bytes = (const uint8_t*)mem;
+
+	return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 |
+	       (uint32_t)bytes[2] << 8  | (uint32_t)bytes[3];
+}
+
+static uint64_t sq_postgre_uint64(const char *mem)
+{
+	return (uint64_t)sq_postgre_uint32(mem) << 32 | sq_postgre_uint32(mem + 4);
+}
+
+// convert wall-clock seconds since PostgreSQL epoch to time_t.
+// It uses local time zone like sq_time_from_string() does with text format.
+static time_t   sq_postgre_local_time(int64_t seconds)
+{
+	struct tm *timeinfo;
+	time_t     rawtime;
+
+	rawtime  = (time_t)(seconds + POSTGRE_EPOCH_OFFSET);
+	timeinfo = gmtime(&rawtime);
+	if (timeinfo == NULL)
+		return 0;
+	timeinfo->tm_isdst = 0;
+	return mktime(timeinfo);
+}
+
+// convert binary NUMERIC to string. Caller must free returned string.
+static char    *sq_postgre_numeric_to_string(const char *mem)
+{
+	int    ndigits = (int16_t)sq_postgre_uint16(mem);
+	int    weight  = (int16_t)sq_postgre_uint16(mem + 2);
+	int    sign    = sq_postgre_uint16(mem + 4);
+	int    dscale  = sq_postgre_uint16(mem + 6);
+	int    digit, len;
+	char  *str, *cur;
+
+	// special values
+	if (sign == 0xC000)
+		return strdup("NaN");
+	if (sign == 0xD000)
+		return strdup("Infinity");
+	if (sign == 0xF000)
+		return strdup("-Infinity");
+
+	// digits are in base 10000
+	len = (weight >= 0) ? (weight + 1) * 4 : 1;
+	// fractional part is written in groups of 4 digits by sprintf(), then truncated to 'dscale'.
+	len += (dscale + 3) / 4 * 4;
+	str = malloc(len + 3);    // + sign, decimal point, and null-terminated
+	cur = str;
+	if (sign == 0x4000)
+		*cur++ = '-';
+
+	// integer part
+	if (weight < 0)
+		*cur++ = '0';
+	for (int index = 0;  index <= weight;  index++) {
+		digit = (index < ndigits) ? sq_postgre_uint16(mem + 8 + index * 2) : 0;
+		if (index == 0)
+			cur += sprintf(cur, "%d", digit);
+		else
+			cur += sprintf(cur, "%04d", digit);
+	}
+
+	// fractional part
+	if (dscale > 0) {
+		*cur++ = '.';
+		for (int index = weight + 1, n = 0;  n < dscale;  index++, n += 4) {
+			digit = (index >= 0 && index < ndigits) ? sq_postgre_uint16(mem + 8 + index * 2) : 0;
+			len = sprintf(cur, "%04d", digit);
+			cur += (dscale - n < len) ? dscale - n : len;
+		}
+	}
+
+	*cur = 0;    // null-terminated
+	return str;
+}
+
+// decode binary value and set type and value of 'xc'. If value is allocated in '*mem', caller must free it.
+// return false if binary format of data type is not supported.
+static bool sqdb_postgre_binary_value(PGresult *results, int row, int col, Sqxc *xc, char **mem)
+{
+	const char *value  = PQgetvalue(results, row, col);
+	int         length = PQgetlength(results, row, col);
+	int64_t     usec;
+	union {
+		uint32_t  uint32;
+		float     float32;
+		uint64_t  uint64;
+		double    float64;
+	} bits;
+
+	switch (PQftype(results, col)) {
+	case POSTGRE_BOOLOID:
+		xc->type = SQXC_TYPE_BOOL;
+		xc->value.boolean = (value[0] != 0);
+		break;
+
+	case POSTGRE_INT2OID:
+		xc->type = SQXC_TYPE_INT;
+		xc->value.integer = (int16_t)sq_postgre_uint16(value);
+		break;
+
+	case POSTGRE_INT4OID:
+		xc->type = SQXC_TYPE_INT;
+		xc->value.integer = (int32_t)sq_postgre_uint32(value);
+		break;
+
+	case POSTGRE_OIDOID:
+		xc->type = SQXC_TYPE_UINT;
+		xc->value.uinteger = sq_postgre_uint32(value);
+		break;
+
+	case POSTGRE_INT8OID:
+		xc->type = SQXC_TYPE_INT64;
+		xc->value.int64 = (int64_t)sq_postgre_uint64(value);
+		break;
+
+	case POSTGRE_FLOAT4OID:
+		bits.uint32 = sq_postgre_uint32(value);
+		xc->type = SQXC_TYPE_DOUBLE;
+		xc->value.double_ = bits.float32;
+		break;
+
+	case POSTGRE_FLOAT8OID:
+		bits.uint64 = sq_postgre_uint64(value);
+		xc->type = SQXC_TYPE_DOUBLE;
+		xc->value.double_ = bits.float64;
+		break;
+
+	case POSTGRE_NUMERICOID:
+		*mem = sq_postgre_numeric_to_string(value);
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = *mem;
+		break;
+
+	case POSTGRE_DATEOID:
+		// days since 2000-01-01
+		xc->type = SQXC_TYPE_TIME;
+		xc->value.rawtime = sq_postgre_local_time((int64_t)(int32_t)sq_postgre_uint32(value) * 86400);
+		break;
+
+	case POSTGRE_TIMEOID:
+		// microseconds since midnight
+		usec = (int64_t)sq_postgre_uint64(value) / 1000000;
+		*mem = malloc(16);
+		snprintf(*mem, 16, "%.2d:%.2d:%.2d",
+		         (int)(usec / 3600), (int)(usec / 60 % 60), (int)(usec % 60));
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = *mem;
+		break;
+
+	case POSTGRE_TIMESTAMPOID:
+	case POSTGRE_TIMESTAMPTZOID:
+		// microseconds since 2000-01-01
+		usec = (int64_t)sq_postgre_uint64(value);
+		usec = (usec < 0 && usec % 1000000) ? usec / 1000000 - 1 : usec / 1000000;
+		xc->type = SQXC_TYPE_TIME;
+		if (PQftype(results, col) == POSTGRE_TIMESTAMPTZOID)
+			xc->value.rawtime = (time_t)(usec + POSTGRE_EPOCH_OFFSET);
+		else
+			xc->value.rawtime = sq_postgre_local_time(usec);
+		break;
+
+	case POSTGRE_UUIDOID:
+		*mem = malloc(37);
+		for (int index = 0, pos = 0;  index < 16;  index++) {
+			if (index == 4 || index == 6 || index == 8 || index == 10)
+				(*mem)[pos++] = '-';
+			sq_bin_to_hex(*mem + pos, value + index, 1);
+			pos += 2;
+		}
+		(*mem)[36] = 0;        // null-terminated
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = *mem;
+		break;
+
+	case POSTGRE_BYTEAOID:
+		// Sqxc doesn't carry length of data, send it in hex format \xFF like text format.
+		*mem = malloc(length * 2 + 3);    // + \x and null-terminated
+		(*mem)[0] = '\\';
+		(*mem)[1] = 'x';
+		sq_bin_to_hex(*mem + 2, value, length);
+		(*mem)[length * 2 + 2] = 0;       // null-terminated
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = *mem;
+		break;
+
+	case POSTGRE_JSONBOID:
+		// skip version number of JSONB
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = value + 1;
+		break;
+
+	// binary format of these types is the same as text format
+	case POSTGRE_CHAROID:
+	case POSTGRE_NAMEOID:
+	case POSTGRE_TEXTOID:
+	case POSTGRE_JSONOID:
+	case POSTGRE_XMLOID:
+	case POSTGRE_BPCHAROID:
+	case POSTGRE_VARCHAROID:
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = value;
+		break;
+
+	default:
+		return false;
+	}
+	return true;
+}
+
+// return true if sqdb_postgre_binary_value() can decode all columns of 'results'.
+// libpq requests the same format for all columns, so statement must be executed in text format if it returns false.
+static bool sqdb_postgre_binary_supported(PGresult *results)
+{
+	int  n_fields = PQnfields(results);
+
+	for (int j = 0;  j < n_fields;  j++) {
+		// these types are decoded by sqdb_postgre_binary_value()
+		switch (PQftype(results, j)) {
+		case POSTGRE_BOOLOID:
+		case POSTGRE_BYTEAOID:
+		case POSTGRE_CHAROID:
+		case POSTGRE_NAMEOID:
+		case POSTGRE_INT8OID:
+		case POSTGRE_INT2OID:
+		case POSTGRE_INT4OID:
+		case POSTGRE_TEXTOID:
+		case POSTGRE_OIDOID:
+		case POSTGRE_JSONOID:
+		case POSTGRE_XMLOID:
+		case POSTGRE_FLOAT4OID:
+		case POSTGRE_FLOAT8OID:
+		case POSTGRE_BPCHAROID:
+		case POSTGRE_VARCHAROID:
+		case POSTGRE_DATEOID:
+		case POSTGRE_TIMEOID:
+		case POSTGRE_TIMESTAMPOID:
+		case POSTGRE_TIMESTAMPTZOID:
+		case POSTGRE_NUMERICOID:
+		case POSTGRE_UUIDOID:
+		case POSTGRE_JSONBOID:
+			break;
+
+		default:
+#ifndef NDEBUG
+			fprintf(stderr, "%s: binary format of column '%s' (type OID %u) is not supported. use text format.\n",
+			        "SqdbPostgre", PQfname(results, j), (unsigned int)PQftype(results, j));
+#endif
+			return false;
+		}
+	}
+	return true;
+}
+
+// used by sqdb_postgre_exec() and sqdb_postgre_step()
+// send a row of 'results' to Sqxc chain. return current Sqxc element.
+static Sqxc *sqdb_postgre_send_row(PGresult *results, int row, Sqxc *xc)
+{
+	char *mem;
+	int   n_fields;
+
+	// Special case:
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+//		if (xc->code != SQCODE_OK)
+//			return xc;
+	}
+
+	n_fields = PQnfields(results);
+	for (int j = 0;  j < n_fields;  j++) {
+		mem = NULL;
+		xc->name = PQfname(results, j);
+		if (PQgetisnull(results, row, j)) {
+			xc->type = SQXC_TYPE_NULL;
+			xc->value.int64 = 0;       // clear all bits, parser may read any member of SqValue
+		}
+		else if (PQfformat(results, j) == 0) {
+			// text format
+			xc->type = SQXC_TYPE_STR;
+			xc->value.str = PQgetvalue(results, row, j);
+		}
+		else if (sqdb_postgre_binary_value(results, row, j, xc, &mem) == false) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: binary format of column '%s' (type OID %u) is not supported.\n",
+			        "sqdb_postgre_send_row()", xc->name, (unsigned int)PQftype(results, j));
+#endif
+			continue;
+		}
+
+		xc = sqxc_send(xc);
+		free(mem);
+#ifndef NDEBUG
+		switch (xc->code) {
+		case SQCODE_OK:
+			break;
+
+		case SQCODE_ENTRY_NOT_FOUND:
+			// warning
+			fprintf(stderr, "%s: column '%s' not found.\n",
+			        "sqdb_postgre_send_row()", PQfname(results, j));
+			break;
+
+		default:
+			fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
+			        "sqdb_postgre_send_row()", PQfname(results, j));
+			break;
+		}
+#endif  // NDEBUG
+	}
+
+	// Special case:
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	return xc;
+}
+
+// get integer value (e.g. id returned by INSERT) in text or binary format
+static int64_t sqdb_postgre_get_int64(PGresult *results, int row, int col)
+{
+	const char *value = PQgetvalue(results, row, col);
+
+	if (PQfformat(results, col) == 0)
+		return (int64_t)strtoll(value, NULL, 10);
+	switch (PQgetlength(results, row, col)) {
+	case 8:
+		return (int64_t)sq_postgre_uint64(value);
+	case 4:
+		return (int32_t)sq_postgre_uint32(value);
+	case 2:
+		return (int16_t)sq_postgre_uint16(value);
+	}
+	return 0;
+}
+
+// set the last inserted row id. ids of all rows returned by " RETURNING id" are appended to SqxcSql::ids
+static void sqdb_postgre_set_ids(SqxcSql *xcsql, PGresult *results)
+{
+	int   n_tuples = PQntuples(results);
+
+	xcsql->id = (n_tuples > 0) ? sqdb_postgre_get_int64(results, 0, 0) : 0;
+	if (xcsql->ids) {
+		for (int row = 0;  row < n_tuples;  row++)
+			sq_array_push(xcsql->ids, int64_t, sqdb_postgre_get_int64(results, row, 0));
+	}
+}
+
 // ----------------------------------------------------------------------------
 // SqdbInfo functions
 
@@ -90,15 +527,25 @@ static void sqdb_postgre_init(SqdbPostgre *sqdb, const SqdbConfigPostgre *config
 	sqdb->conn = NULL;
 	sqdb->config = config;
 	sqdb->version = 0;
+	sqdb->async.xc = NULL;
+	sqdb->async.busy = false;
+	sqdb->async.retry = false;
+	sqdb->async.sql = NULL;
 	if (config == NULL)
 		sqdb->config = &db_default;
+	sqdb_stmt_cache_init(&sqdb->stmt_cache, (Sqdb*)sqdb,
+	                     sqdb->config->stmt_cache_size,
+	                     (SqdbStmtDestroyFunc)sqdb_postgre_destroy_stmt);
 }
 
 static void sqdb_postgre_final(SqdbPostgre *sqdb)
 {
+	// prepared statements must be deallocated before closing connection
+	sqdb_stmt_cache_final(&sqdb->stmt_cache);
 	// sqdb_postgre_close() also do this
 	if (sqdb->conn)
 		PQfinish(sqdb->conn);
+	free(sqdb->async.sql);
 }
 
 static int  sqdb_postgre_open(SqdbPostgre *sqdb, const char *database_name)
@@ -130,13 +577,39 @@ static int  sqdb_postgre_open(SqdbPostgre *sqdb, const char *database_name)
 
 static int  sqdb_postgre_close(SqdbPostgre *sqdb)
 {
+	// prepared statements must be deallocated before closing connection
+	sqdb_stmt_cache_clear(&sqdb->stmt_cache);
 	if (sqdb->conn) {
 		PQfinish(sqdb->conn);
 		sqdb->conn = NULL;
 	}
+	// abandon statement that is in progress
+	sqdb->async.busy = false;
+	sqdb->async.xc = NULL;
+	free(sqdb->async.sql);
+	sqdb->async.sql = NULL;
 	return SQCODE_OK;
 }
 
+static int  sqdb_postgre_ping(SqdbPostgre *sqdb)
+{
+	PGresult  *result;
+	int        code = SQCODE_OK;
+
+	if (sqdb->conn == NULL || PQstatus(sqdb->conn) != CONNECTION_OK)
+		return SQCODE_EXEC_ERROR;
+	// send empty query to check connection. server replies PGRES_EMPTY_QUERY.
+	result = PQexec(sqdb->conn, "");
+	if (PQresultStatus(result) != PGRES_EMPTY_QUERY) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		code = SQCODE_EXEC_ERROR;
+	}
+	PQclear(result);
+	return code;
+}
+
 static int  sqdb_postgre_exec(SqdbPostgre *sqdb, const char *sql, Sqxc *xc, void *reserve)
 {
 	PGresult  *results;
@@ -164,7 +637,20 @@ static int  sqdb_postgre_exec(SqdbPostgre *sqdb, const char *sql, Sqxc *xc, void
 				return SQCODE_EXEC_ERROR;
 			}
 #endif
-			results = PQexec(sqdb->conn, sql);
+			// stream rows to Sqxc chain
+			if (sqdb->config->fetch_size > 0)
+				return sqdb_postgre_exec_stream(sqdb, sql, xc);
+
+			if (sqdb->config->result_format == SQDB_POSTGRE_RESULT_BINARY) {
+				results = PQexecParams(sqdb->conn, sql, 0, NULL, NULL, NULL, NULL, 1);
+				// execute again in text format if binary format of any column is not supported
+				if (PQresultStatus(results) == PGRES_TUPLES_OK && sqdb_postgre_binary_supported(results) == false) {
+					PQclear(results);
+					results = PQexec(sqdb->conn, sql);
+				}
+			}
+			else
+				results = PQexec(sqdb->conn, sql);
 			if (PQresultStatus(results) != PGRES_TUPLES_OK)
 				break;
 
@@ -186,55 +672,8 @@ static int  sqdb_postgre_exec(SqdbPostgre *sqdb, const char *sql, Sqxc *xc, void
 				xc = sqxc_send(xc);
 			}
 
-			for (int i = 0;  i < n_tuples;  i++) {
-				// Special case:
-				// Don't send object if user selects only one column and the column type is built-in types (not object).
-				if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
-					// SQL row corresponds to SQXC_TYPE_OBJECT
-					xc->type = SQXC_TYPE_OBJECT;
-					xc->name = NULL;
-					xc->value.pointer = NULL;
-					xc = sqxc_send(xc);
-//					if (xc->code != SQCODE_OK)
-//						break;
-				}
-
-				for (int j = 0;  j < n_fields;  j++) {
-					xc->type = SQXC_TYPE_STR;
-					xc->name = PQfname(results, j);
-					xc->value.str = PQgetvalue(results, i, j);
-					xc = sqxc_send(xc);
-#ifndef NDEBUG
-					switch (xc->code) {
-					case SQCODE_OK:
-						break;
-
-					case SQCODE_ENTRY_NOT_FOUND:
-						// warning
-						fprintf(stderr, "%s: column '%s' not found.\n",
-						        "sqdb_postgre_exec()", xc->name);
-						break;
-
-					default:
-						fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
-						        "sqdb_postgre_exec()", xc->name);
-						break;
-					}
-#endif  // NDEBUG
-				}
-
-				// Special case:
-				// Don't send object if user selects only one column and the column type is built-in types (not object).
-				if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
-					// SQL row corresponds to SQXC_TYPE_OBJECT
-					xc->type = SQXC_TYPE_OBJECT_END;
-					xc->name = NULL;
-					xc->value.pointer = NULL;
-					xc = sqxc_send(xc);
-//					if (xc->code != SQCODE_OK)
-//						break;
-				}
-			}
+			for (int i = 0;  i < n_tuples;  i++)
+				xc = sqdb_postgre_send_row(results, i, xc);
 
 			// If SqxcValue is prepared to receive multiple rows
 			if (sqxc_value_container(xc)) {
@@ -273,10 +712,7 @@ static int  sqdb_postgre_exec(SqdbPostgre *sqdb, const char *sql, Sqxc *xc, void
 			results = PQexec(sqdb->conn, sql);
 			// set the last inserted row id
 			if (sql_new) {
-				if (PQntuples(results) > 0)
-					((SqxcSql*)xc)->id = (int64_t)strtoll(PQgetvalue(results, 0, 0), NULL, 10);
-				else
-					((SqxcSql*)xc)->id = 0;
+				sqdb_postgre_set_ids((SqxcSql*)xc, results);
 				free(sql_new);
 			}
 			// set number of rows changed
@@ -297,6 +733,23 @@ static int  sqdb_postgre_exec(SqdbPostgre *sqdb, const char *sql, Sqxc *xc, void
 	return code;
 }
 
+// used by sqdb_postgre_reset() and sqdb_postgre_exec_stream()
+// cancel statement that is in progress and discard rows that have not been received
+static void sqdb_postgre_cancel(SqdbPostgre *sqdb)
+{
+	PGresult *results;
+	PGcancel *cancel;
+	char      errbuf[256];
+
+	cancel = PQgetCancel(sqdb->conn);
+	if (cancel) {
+		PQcancel(cancel, errbuf, sizeof(errbuf));
+		PQfreeCancel(cancel);
+	}
+	while ((results = PQgetResult(sqdb->conn)) != NULL)
+		PQclear(results);
+}
+
 // used by sqdb_postgre_migrate()
 static bool sqdb_postgre_handle_result(SqdbPostgre *sqdb, PGresult *result)
 {
@@ -315,6 +768,97 @@ static bool sqdb_postgre_handle_result(SqdbPostgre *sqdb, PGresult *result)
 	return has_error;
 }
 
+// used by sqdb_postgre_exec_stream()
+// send SELECT statement and receive rows in chunks. return false if error occurred.
+static bool sqdb_postgre_send_stream(SqdbPostgre *sqdb, const char *sql, int format)
+{
+	if (PQsendQueryParams(sqdb->conn, sql, 0, NULL, NULL, NULL, NULL, format) == 0) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		return false;
+	}
+	// If it failed to switch mode, PQgetResult() will return whole result set.
+#ifdef LIBPQ_HAS_CHUNK_MODE
+	PQsetChunkedRowsMode(sqdb->conn, sqdb->config->fetch_size);
+#else
+	PQsetSingleRowMode(sqdb->conn);
+#endif
+	return true;
+}
+
+// used by sqdb_postgre_exec()
+// send rows to Sqxc chain while they arrive. Only one chunk of rows is in client memory at a time.
+static int  sqdb_postgre_exec_stream(SqdbPostgre *sqdb, const char *sql, Sqxc *xc)
+{
+	PGresult  *results;
+	int        n_tuples;
+	int        format = sqdb->config->result_format;
+	int        code = SQCODE_NO_DATA;
+
+	if (sqdb_postgre_send_stream(sqdb, sql, format) == false)
+		return SQCODE_EXEC_ERROR;
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	// PQgetResult() must be called until it returns NULL
+	while ((results = PQgetResult(sqdb->conn)) != NULL) {
+		switch (PQresultStatus(results)) {
+		case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+		case PGRES_TUPLES_CHUNK:
+#endif
+		case PGRES_TUPLES_OK:
+			n_tuples = PQntuples(results);
+			// no row has been sent. execute again in text format if binary format of any column is not supported.
+			if (n_tuples > 0 && format != 0 && code == SQCODE_NO_DATA &&
+			    sqdb_postgre_binary_supported(results) == false)
+			{
+				PQclear(results);
+				sqdb_postgre_cancel(sqdb);
+				format = 0;
+				if (sqdb_postgre_send_stream(sqdb, sql, format) == false)
+					code = SQCODE_EXEC_ERROR;
+				continue;
+			}
+			if (n_tuples > 0 && PQnfields(results) > 0 && code == SQCODE_NO_DATA)
+				code = SQCODE_OK;
+			for (int i = 0;  i < n_tuples && code == SQCODE_OK;  i++)
+				xc = sqdb_postgre_send_row(results, i, xc);
+			break;
+
+		default:
+#ifndef NDEBUG
+			fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+			code = SQCODE_EXEC_ERROR;
+			break;
+		}
+		PQclear(results);
+	}
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	// if the result set is empty.
+	if (code == SQCODE_NO_DATA)
+		xc->code = SQCODE_NO_DATA;
+	return code;
+}
+
 static int  sqdb_postgre_migrate(SqdbPostgre *sqdb, SqSchema *schema, SqSchema *schema_next)
 {
 	SqBuffer    sql_buf;
@@ -412,6 +956,769 @@ static int  sqdb_postgre_migrate(SqdbPostgre *sqdb, SqSchema *schema, SqSchema *
 	return SQCODE_OK;
 }
 
+// ----------------------------------------------------------------------------
+// prepared statement
+
+typedef struct SqdbStmtPostgre    SqdbStmtPostgre;
+
+struct SqdbStmtPostgre
+{
+	char        name[32];      // name of prepared statement in server
+	int         n_params;
+	char      **params;        // parameter values in text format. NULL is SQL NULL.
+	PGresult   *result;
+	int         row;           // index of next row in 'result'
+	int         format;        // result format. It is text format if binary format of any column is not supported.
+	bool        returning;     // INSERT statement with " RETURNING id"
+	bool        select;        // SELECT statement
+	bool        streaming;     // rows of SELECT statement are being received by PQgetResult()
+};
+
+static void sqdb_postgre_destroy_stmt(SqdbPostgre *sqdb, SqdbStmt *stmt)
+{
+	SqdbStmtPostgre *pgstmt = (SqdbStmtPostgre*)stmt;
+	char  sql[48];
+
+	// connection must be idle before DEALLOCATE
+	sqdb_postgre_reset(sqdb, stmt);
+	if (sqdb->conn) {
+		snprintf(sql, sizeof(sql), "DEALLOCATE %s", pgstmt->name);
+		PQclear(PQexec(sqdb->conn, sql));
+	}
+	PQclear(pgstmt->result);
+	for (int index = 0;  index < pgstmt->n_params;  index++)
+		free(pgstmt->params[index]);
+	free(pgstmt->params);
+	free(pgstmt);
+}
+
+static int  sqdb_postgre_prepare(SqdbPostgre *sqdb, const char *sql, SqdbStmt **stmt)
+{
+	SqdbStmtPostgre *pgstmt;
+	PGresult  *results;
+	SqBuffer   buf;
+	char       quote = 0;
+	int        n_params = 0;
+	int        len;
+
+	// reuse cached statement
+	pgstmt = (SqdbStmtPostgre*)sqdb_stmt_cache_get(&sqdb->stmt_cache, sql);
+	if (pgstmt) {
+		*stmt = (SqdbStmt*)pgstmt;
+		return SQCODE_OK;
+	}
+
+	// convert placeholder '?' to '$1', '$2', '$3'...etc
+	sq_buffer_init(&buf);
+	for (const char *cur = sql;  *cur;  cur++) {
+		if (quote) {
+			if (*cur == quote)
+				quote = 0;
+		}
+		else if (*cur == '\'' || *cur == '"')
+			quote = *cur;
+		else if (*cur == '?') {
+			n_params++;
+			len = snprintf(NULL, 0, "$%d", n_params);
+			snprintf(sq_buffer_alloc(&buf, len), len+1, "$%d", n_params);
+			continue;
+		}
+		sq_buffer_write_c(&buf, *cur);
+	}
+
+	pgstmt = calloc(1, sizeof(SqdbStmtPostgre));
+	// for last inserted row id
+	if (sql[0] == 'I' || sql[0] == 'i') {
+		sq_buffer_write(&buf, " RETURNING id");
+		pgstmt->returning = true;
+	}
+	else if (sql[0] == 'S' || sql[0] == 's')
+		pgstmt->select = true;
+	sq_buffer_write_c(&buf, 0);    // null-terminated
+
+	snprintf(pgstmt->name, sizeof(pgstmt->name), "sqxc_stmt_%p", (void*)pgstmt);
+	results = PQprepare(sqdb->conn, pgstmt->name, buf.mem, 0, NULL);
+	sq_buffer_final(&buf);
+	if (PQresultStatus(results) != PGRES_COMMAND_OK) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		PQclear(results);
+		free(pgstmt);
+		*stmt = NULL;
+		return SQCODE_EXEC_ERROR;
+	}
+	PQclear(results);
+
+	pgstmt->format = sqdb->config->result_format;
+	// get types of result columns before executing SELECT statement
+	if (pgstmt->select && pgstmt->format != 0) {
+		results = PQdescribePrepared(sqdb->conn, pgstmt->name);
+		if (PQresultStatus(results) != PGRES_COMMAND_OK || sqdb_postgre_binary_supported(results) == false)
+			pgstmt->format = 0;
+		PQclear(results);
+	}
+
+	pgstmt->n_params = n_params;
+	if (n_params > 0)
+		pgstmt->params = calloc(n_params, sizeof(char*));
+	sqdb_stmt_cache_add(&sqdb->stmt_cache, sql, (SqdbStmt*)pgstmt);
+
+	*stmt = (SqdbStmt*)pgstmt;
+	return SQCODE_OK;
+}
+
+static int  sqdb_postgre_bind(SqdbPostgre *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value)
+{
+	SqdbStmtPostgre *pgstmt = (SqdbStmtPostgre*)stmt;
+	char  **param;
+	char    str[32];
+
+	if (index < 1 || index > pgstmt->n_params)
+		return SQCODE_EXEC_ERROR;
+	param = pgstmt->params + index -1;
+	free(*param);
+	*param = NULL;
+
+	// PostgreSQL parameter values are in text format
+	switch (type) {
+	case SQXC_TYPE_NULL:
+		return SQCODE_OK;
+
+	case SQXC_TYPE_BOOL:
+		*param = strdup(value->boolean ? "t" : "f");
+		return SQCODE_OK;
+
+	case SQXC_TYPE_INT:
+		snprintf(str, sizeof(str), "%d", value->integer);
+		break;
+
+	case SQXC_TYPE_UINT:
+		snprintf(str, sizeof(str), "%u", value->uinteger);
+		break;
+
+	case SQXC_TYPE_INT64:
+		snprintf(str, sizeof(str), "%" PRId64, value->int64);
+		break;
+
+	case SQXC_TYPE_UINT64:
+		snprintf(str, sizeof(str), "%" PRIu64, value->uint64);
+		break;
+
+	case SQXC_TYPE_TIME:
+		*param = sq_time_to_string(value->rawtime, 0);
+		return SQCODE_OK;
+
+	case SQXC_TYPE_DOUBLE:
+		snprintf(str, sizeof(str), "%.17g", value->double_);
+		break;
+
+	case SQXC_TYPE_STR:
+		if (value->str)
+			*param = strdup(value->str);
+		return SQCODE_OK;
+
+	default:
+		return SQCODE_TYPE_NOT_SUPPORTED;
+	}
+
+	*param = strdup(str);
+	return SQCODE_OK;
+}
+
+static int  sqdb_postgre_step(SqdbPostgre *sqdb, SqdbStmt *stmt, Sqxc *xc)
+{
+	SqdbStmtPostgre *pgstmt = (SqdbStmtPostgre*)stmt;
+	PGresult  *results;
+
+	// execute statement in first step
+	if (pgstmt->result == NULL && pgstmt->streaming == false) {
+		// stream rows of SELECT statement if 'fetch_size' > 0
+		if (pgstmt->select && sqdb->config->fetch_size > 0) {
+			if (PQsendQueryPrepared(sqdb->conn, pgstmt->name, pgstmt->n_params,
+			                        (const char * const *)pgstmt->params, NULL, NULL,
+			                        pgstmt->format) == 0)
+			{
+#ifndef NDEBUG
+				fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+				return SQCODE_EXEC_ERROR;
+			}
+			// If it failed to switch mode, PQgetResult() will return whole result set.
+#ifdef LIBPQ_HAS_CHUNK_MODE
+			PQsetChunkedRowsMode(sqdb->conn, sqdb->config->fetch_size);
+#else
+			PQsetSingleRowMode(sqdb->conn);
+#endif
+			pgstmt->streaming = true;
+		}
+		else {
+			results = PQexecPrepared(sqdb->conn, pgstmt->name, pgstmt->n_params,
+			                         (const char * const *)pgstmt->params, NULL, NULL,
+			                         pgstmt->format);
+			if (PQresultStatus(results) != PGRES_COMMAND_OK && PQresultStatus(results) != PGRES_TUPLES_OK) {
+#ifndef NDEBUG
+				fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+				PQclear(results);
+				return SQCODE_EXEC_ERROR;
+			}
+			pgstmt->result = results;
+			pgstmt->row = 0;
+		}
+	}
+
+	// receive next chunk of rows if all rows in 'result' have been sent
+	while (pgstmt->streaming && (pgstmt->result == NULL || pgstmt->row >= PQntuples(pgstmt->result))) {
+		PQclear(pgstmt->result);
+		pgstmt->result = PQgetResult(sqdb->conn);
+		pgstmt->row = 0;
+		switch (PQresultStatus(pgstmt->result)) {
+		case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+		case PGRES_TUPLES_CHUNK:
+#endif
+			break;
+
+		case PGRES_TUPLES_OK:
+			// the last result. PQgetResult() must be called until it returns NULL
+			while ((results = PQgetResult(sqdb->conn)) != NULL)
+				PQclear(results);
+			pgstmt->streaming = false;
+			break;
+
+		default:
+#ifndef NDEBUG
+			fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+			sqdb_postgre_reset(sqdb, stmt);
+			return SQCODE_EXEC_ERROR;
+		}
+	}
+	results = pgstmt->result;
+
+	if (pgstmt->returning || pgstmt->row >= PQntuples(results)) {
+		if (xc && xc->info == SQXC_INFO_SQL) {
+			// set the last inserted row id
+			if (pgstmt->returning)
+				sqdb_postgre_set_ids((SqxcSql*)xc, results);
+			else
+				((SqxcSql*)xc)->id = 0;
+			// set number of rows changed
+			((SqxcSql*)xc)->changes = (int64_t)strtoll(PQcmdTuples(results), NULL, 10);
+		}
+		return SQCODE_DONE;
+	}
+
+	// discard row if 'xc' is NULL
+	if (xc == NULL) {
+		pgstmt->row++;
+		return SQCODE_ROW;
+	}
+#ifndef NDEBUG
+	if (xc->info != SQXC_INFO_VALUE) {
+		fprintf(stderr, "%s: SELECT command must use with SqxcValue.\n",
+		        "sqdb_postgre_step()");
+		return SQCODE_EXEC_ERROR;
+	}
+#endif
+
+	sqdb_postgre_send_row(results, pgstmt->row, xc);
+
+	pgstmt->row++;
+	return SQCODE_ROW;
+}
+
+static int  sqdb_postgre_reset(SqdbPostgre *sqdb, SqdbStmt *stmt)
+{
+	SqdbStmtPostgre *pgstmt = (SqdbStmtPostgre*)stmt;
+
+	// cancel statement and discard rows that have not been received
+	if (pgstmt->streaming) {
+		sqdb_postgre_cancel(sqdb);
+		pgstmt->streaming = false;
+	}
+	PQclear(pgstmt->result);
+	pgstmt->result = NULL;
+	pgstmt->row = 0;
+	return SQCODE_OK;
+}
+
+static int  sqdb_postgre_finalize(SqdbPostgre *sqdb, SqdbStmt *stmt)
+{
+	SqdbStmtPostgre *pgstmt = (SqdbStmtPostgre*)stmt;
+
+	if (stmt == NULL)
+		return SQCODE_OK;
+	// return cached statement to cache
+	if (sqdb_stmt_cache_release(&sqdb->stmt_cache, stmt)) {
+		sqdb_postgre_reset(sqdb, stmt);
+		// clear bound values
+		for (int index = 0;  index < pgstmt->n_params;  index++) {
+			free(pgstmt->params[index]);
+			pgstmt->params[index] = NULL;
+		}
+	}
+	else
+		sqdb_postgre_destroy_stmt(sqdb, stmt);
+	return SQCODE_OK;
+}
+
+// ----------------------------------------------------------------------------
+// bulk load and export - COPY FROM STDIN, COPY TO STDOUT
+
+static int  sqdb_postgre_copy_begin(SqdbPostgre *sqdb, const char *sql)
+{
+	PGresult *results;
+	int       code = SQCODE_OK;
+
+	results = PQexec(sqdb->conn, sql);
+	if (PQresultStatus(results) != PGRES_COPY_IN) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		code = SQCODE_EXEC_ERROR;
+	}
+	PQclear(results);
+	return code;
+}
+
+static int  sqdb_postgre_copy_data(SqdbPostgre *sqdb, const char *data, size_t length)
+{
+	// PQputCopyData() returns 0 only if connection is in nonblocking mode.
+	if (PQputCopyData(sqdb->conn, data, (int)length) != 1) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+	return SQCODE_OK;
+}
+
+static int  sqdb_postgre_copy_end(SqdbPostgre *sqdb, const char *error_msg, int64_t *n_rows)
+{
+	PGresult *results;
+	int       code = SQCODE_OK;
+
+	if (PQputCopyEnd(sqdb->conn, error_msg) != 1)
+		code = SQCODE_EXEC_ERROR;
+	// get result of COPY command
+	while ((results = PQgetResult(sqdb->conn)) != NULL) {
+		if (PQresultStatus(results) == PGRES_COMMAND_OK) {
+			if (n_rows)
+				*n_rows = (int64_t)strtoll(PQcmdTuples(results), NULL, 10);
+		}
+		else {
+#ifndef NDEBUG
+			if (error_msg == NULL)
+				fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+			code = SQCODE_EXEC_ERROR;
+		}
+		PQclear(results);
+	}
+	return code;
+}
+
+static int  sq_postgre_hex_digit(char ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	return -1;
+}
+
+// decode a row of COPY text format in place and send it to 'xc'.
+// 'row' must be null-terminated, PQgetCopyData() does it.
+static Sqxc *sqdb_postgre_send_copy_row(char *row, int length, const char **column_names, int n_columns, Sqxc *xc)
+{
+	char *cur, *end, *dest;
+	int   digit;
+
+	// COPY row corresponds to SQXC_TYPE_OBJECT
+	xc->type = SQXC_TYPE_OBJECT;
+	xc->name = NULL;
+	xc->value.pointer = NULL;
+	xc = sqxc_send(xc);
+
+	end = row + length;
+	if (end > row && end[-1] == '\n')
+		end--;
+
+	cur = row;
+	for (int index = 0;  index < n_columns && cur <= end;  index++) {
+		xc->name = column_names[index];
+		// "\N" is NULL
+		if (cur[0] == '\\' && cur[1] == 'N' && (cur+2 == end || cur[2] == '\t')) {
+			xc->type = SQXC_TYPE_NULL;
+			xc->value.int64 = 0;       // clear all bits, parser may read any member of SqValue
+			cur += 2;
+		}
+		else {
+			xc->type = SQXC_TYPE_STR;
+			xc->value.str = dest = cur;
+			for (;  cur < end && *cur != '\t';  cur++) {
+				if (*cur != '\\' || cur+1 == end) {
+					*dest++ = *cur;
+					continue;
+				}
+				switch (*++cur) {
+				case 'b':
+					*dest++ = '\b';
+					break;
+				case 'f':
+					*dest++ = '\f';
+					break;
+				case 'n':
+					*dest++ = '\n';
+					break;
+				case 'r':
+					*dest++ = '\r';
+					break;
+				case 't':
+					*dest++ = '\t';
+					break;
+				case 'v':
+					*dest++ = '\v';
+					break;
+				case 'x':
+					// \xhh - 1 or 2 hex digits
+					if ((digit = sq_postgre_hex_digit(cur[1])) < 0) {
+						*dest++ = 'x';
+						break;
+					}
+					*dest = (char)digit;
+					cur++;
+					if (cur+1 < end && (digit = sq_postgre_hex_digit(cur[1])) >= 0) {
+						*dest = (char)((*dest << 4) | digit);
+						cur++;
+					}
+					dest++;
+					break;
+				case '0': case '1': case '2': case '3':
+				case '4': case '5': case '6': case '7':
+					// \ooo - 1 to 3 octal digits
+					*dest = *cur - '0';
+					for (digit = 1;  digit < 3 && cur+1 < end && cur[1] >= '0' && cur[1] <= '7';  digit++)
+						*dest = (char)((*dest << 3) | (*++cur - '0'));
+					dest++;
+					break;
+				default:
+					// "\\" and others
+					*dest++ = *cur;
+					break;
+				}
+			}
+		}
+		// skip delimiter. 'dest' may be at delimiter, so move 'cur' before writing null-terminated.
+		cur++;
+		if (xc->type == SQXC_TYPE_STR)
+			*dest = 0;
+
+		xc = sqxc_send(xc);
+#ifndef NDEBUG
+		switch (xc->code) {
+		case SQCODE_OK:
+			break;
+
+		case SQCODE_ENTRY_NOT_FOUND:
+			// warning
+			fprintf(stderr, "%s: column '%s' not found.\n",
+			        "sqdb_postgre_send_copy_row()", column_names[index]);
+			break;
+
+		default:
+			fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
+			        "sqdb_postgre_send_copy_row()", column_names[index]);
+			break;
+		}
+#endif  // NDEBUG
+	}
+
+	// COPY row corresponds to SQXC_TYPE_OBJECT
+	xc->type = SQXC_TYPE_OBJECT_END;
+	xc->name = NULL;
+	xc->value.pointer = NULL;
+	xc = sqxc_send(xc);
+	return xc;
+}
+
+static int  sqdb_postgre_copy_out(SqdbPostgre *sqdb, const char *sql, const char **column_names, int n_columns, Sqxc *xc)
+{
+	PGresult *results;
+	char     *row;
+	int       length;
+	int       code = SQCODE_NO_DATA;
+
+	results = PQexec(sqdb->conn, sql);
+	if (PQresultStatus(results) != PGRES_COPY_OUT) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		PQclear(results);
+		return SQCODE_EXEC_ERROR;
+	}
+	PQclear(results);
+
+	// COPY rows corresponds to SQXC_TYPE_ARRAY
+	xc->type = SQXC_TYPE_ARRAY;
+	xc->name = NULL;
+	xc->value.pointer = NULL;
+	xc = sqxc_send(xc);
+
+	// PQgetCopyData() returns one row at a time, the result set is not buffered.
+	while ((length = PQgetCopyData(sqdb->conn, &row, 0)) > 0) {
+		if (code == SQCODE_NO_DATA)
+			code = SQCODE_OK;
+		xc = sqdb_postgre_send_copy_row(row, length, column_names, n_columns, xc);
+		PQfreemem(row);
+	}
+	if (length == -2) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		code = SQCODE_EXEC_ERROR;
+	}
+
+	// COPY rows corresponds to SQXC_TYPE_ARRAY
+	xc->type = SQXC_TYPE_ARRAY_END;
+	xc->name = NULL;
+	xc->value.pointer = NULL;
+	xc = sqxc_send(xc);
+
+	// get result of COPY command
+	while ((results = PQgetResult(sqdb->conn)) != NULL) {
+		if (PQresultStatus(results) != PGRES_COMMAND_OK) {
+#ifndef NDEBUG
+			fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+			code = SQCODE_EXEC_ERROR;
+		}
+		PQclear(results);
+	}
+
+	// if the result set is empty.
+	if (code == SQCODE_NO_DATA)
+		xc->code = SQCODE_NO_DATA;
+	return code;
+}
+
+// ----------------------------------------------------------------------------
+// non-blocking execution
+
+static int  sqdb_postgre_async_send(SqdbPostgre *sqdb, const char *sql, Sqxc *xc)
+{
+	char *sql_new = NULL;
+	bool  is_select;
+	int   rc;
+
+	if (sqdb->async.busy) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: previous statement is still in progress.\n",
+		        "sqdb_postgre_async_send()");
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+
+	// Determines command based on the first character in SQL statement.
+	is_select = (xc && (sql[0] == 'S' || sql[0] == 's'));
+	sqdb->async.insert = (xc && (sql[0] == 'I' || sql[0] == 'i'));
+	if (sqdb->async.insert) {
+		// for last inserted row id
+		sql_new = malloc(strlen(sql) + 14);    // + " RETURNING id" "\0"
+		strcpy(sql_new, sql);
+		strcat(sql_new, " RETURNING id");
+		sql = sql_new;
+	}
+
+	PQsetnonblocking(sqdb->conn, 1);
+	rc = PQsendQueryParams(sqdb->conn, sql, 0, NULL, NULL, NULL, NULL,
+	                       (is_select) ? sqdb->config->result_format : 0);
+	free(sql_new);
+	if (rc == 0) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+	// rows are sent to Sqxc chain as soon as they arrive
+	if (is_select)
+		PQsetSingleRowMode(sqdb->conn);
+	// SELECT statement is sent again in text format if binary format of any column is not supported
+	sqdb->async.format = (is_select) ? sqdb->config->result_format : 0;
+	sqdb->async.sql    = (sqdb->async.format != 0) ? strdup(sql) : NULL;
+	sqdb->async.retry  = false;
+
+	sqdb->async.xc    = xc;
+	sqdb->async.code  = (is_select) ? SQCODE_NO_DATA : SQCODE_OK;
+	sqdb->async.busy  = true;
+	sqdb->async.flush = (PQflush(sqdb->conn) == 1);
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (is_select && sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		sqdb->async.xc = sqxc_send(xc);
+	}
+	return SQCODE_OK;
+}
+
+// used by sqdb_postgre_async_poll()
+static void sqdb_postgre_async_result(SqdbPostgre *sqdb, PGresult *results)
+{
+	Sqxc *xc = sqdb->async.xc;
+	int   n_tuples;
+
+	switch (PQresultStatus(results)) {
+	case PGRES_SINGLE_TUPLE:
+	case PGRES_TUPLES_OK:
+		n_tuples = PQntuples(results);
+		if (xc == NULL)
+			break;
+		if (xc->info == SQXC_INFO_SQL) {
+			// set the last inserted row id
+			if (sqdb->async.insert)
+				sqdb_postgre_set_ids((SqxcSql*)xc, results);
+			((SqxcSql*)xc)->changes = (int64_t)strtoll(PQcmdTuples(results), NULL, 10);
+			break;
+		}
+		// discard rows. statement will be sent again in text format when it is done.
+		if (sqdb->async.retry)
+			break;
+		if (n_tuples > 0 && sqdb->async.format != 0 && sqdb->async.code == SQCODE_NO_DATA &&
+		    sqdb_postgre_binary_supported(results) == false)
+		{
+			sqdb->async.retry = true;
+			break;
+		}
+		if (n_tuples > 0 && PQnfields(results) > 0 && sqdb->async.code == SQCODE_NO_DATA)
+			sqdb->async.code = SQCODE_OK;
+		for (int i = 0;  i < n_tuples && sqdb->async.code == SQCODE_OK;  i++)
+			xc = sqdb_postgre_send_row(results, i, xc);
+		sqdb->async.xc = xc;
+		break;
+
+	case PGRES_COMMAND_OK:
+		// set number of rows changed
+		if (xc && xc->info == SQXC_INFO_SQL)
+			((SqxcSql*)xc)->changes = (int64_t)strtoll(PQcmdTuples(results), NULL, 10);
+		break;
+
+	default:
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		sqdb->async.code = SQCODE_EXEC_ERROR;
+		break;
+	}
+}
+
+// used by sqdb_postgre_async_poll() when statement is done or connection is broken
+static int  sqdb_postgre_async_done(SqdbPostgre *sqdb)
+{
+	Sqxc  *xc = sqdb->async.xc;
+
+	sqdb->async.busy  = false;
+	sqdb->async.flush = false;
+	sqdb->async.xc    = NULL;
+	sqdb->async.retry = false;
+	free(sqdb->async.sql);
+	sqdb->async.sql   = NULL;
+	// other functions use connection in blocking mode
+	PQsetnonblocking(sqdb->conn, 0);
+	if (xc == NULL || xc->info != SQXC_INFO_VALUE)
+		return sqdb->async.code;
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+	// if the result set is empty.
+	if (sqdb->async.code == SQCODE_NO_DATA)
+		xc->code = SQCODE_NO_DATA;
+	return sqdb->async.code;
+}
+
+static int  sqdb_postgre_async_poll(SqdbPostgre *sqdb)
+{
+	PGresult  *results;
+
+	if (sqdb->async.busy == false)
+		return SQCODE_OK;
+
+	// send remaining data of statement
+	if (sqdb->async.flush) {
+		switch (PQflush(sqdb->conn)) {
+		case 1:
+			return SQCODE_AGAIN;
+		case 0:
+			sqdb->async.flush = false;
+			break;
+		default:
+#ifndef NDEBUG
+			fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+			sqdb->async.code = SQCODE_EXEC_ERROR;
+			return sqdb_postgre_async_done(sqdb);
+		}
+	}
+
+	if (PQconsumeInput(sqdb->conn) == 0) {
+#ifndef NDEBUG
+		fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+		sqdb->async.code = SQCODE_EXEC_ERROR;
+		return sqdb_postgre_async_done(sqdb);
+	}
+
+	// PQgetResult() doesn't block if PQisBusy() returns 0
+	while (PQisBusy(sqdb->conn) == 0) {
+		results = PQgetResult(sqdb->conn);
+		// PQgetResult() returns NULL when statement is done
+		if (results == NULL) {
+			if (sqdb->async.retry == false)
+				return sqdb_postgre_async_done(sqdb);
+			// send SELECT statement again in text format
+			sqdb->async.retry  = false;
+			sqdb->async.format = 0;
+			if (PQsendQueryParams(sqdb->conn, sqdb->async.sql, 0, NULL, NULL, NULL, NULL, 0) == 0) {
+#ifndef NDEBUG
+				fprintf(stderr, "PostgreSQL: %s\n", PQerrorMessage(sqdb->conn));
+#endif
+				sqdb->async.code = SQCODE_EXEC_ERROR;
+				return sqdb_postgre_async_done(sqdb);
+			}
+			PQsetSingleRowMode(sqdb->conn);
+			sqdb->async.flush = (PQflush(sqdb->conn) == 1);
+			return SQCODE_AGAIN;
+		}
+		sqdb_postgre_async_result(sqdb, results);
+		PQclear(results);
+	}
+	return SQCODE_AGAIN;
+}
+
+static int  sqdb_postgre_async_socket(SqdbPostgre *sqdb, int *events)
+{
+	if (sqdb->conn == NULL)
+		return -1;
+	if (events) {
+		*events = SQDB_WAIT_READ;
+		if (sqdb->async.flush)
+			*events |= SQDB_WAIT_WRITE;
+	}
+	return PQsocket(sqdb->conn);
+}
+
 // ----------------------------------------------------------------------------
 // other static functions
 
@@ -18,6 +18,7 @@
 #include <libpq-fe.h>
 
 #include <sqxc/Sqdb.h>
+#include <sqxc/SqdbStmtCache.h>
 
 // ----------------------------------------------------------------------------
 // C/C++ common declarations: declare type, structure, macro, enumeration.
@@ -25,6 +26,13 @@
 typedef struct SqdbPostgre          SqdbPostgre;
 typedef struct SqdbConfigPostgre    SqdbConfigPostgre;
 
+/* --- SqdbConfigPostgre::result_format --- */
+// It is the same as 'resultFormat' of PQexecParams().
+// In binary format, values of bool, integer, float, numeric, date/time, uuid, and bytea columns
+// are decoded by SqdbPostgre and sent to Sqxc chain in native SQXC_TYPE_xxx.
+#define SQDB_POSTGRE_RESULT_TEXT      0
+#define SQDB_POSTGRE_RESULT_BINARY    1
+
 // ----------------------------------------------------------------------------
 // C declarations: declare C data, function, and others.
 
@@ -72,7 +80,22 @@ struct SqdbPostgre
 	// ------ SqdbPostgre members ------   // <-- 3. Add variable and non-virtual function in derived struct.
 	PGconn         *conn;
 
+	// prepared statements. 'stmt_cache.hits' and 'stmt_cache.misses' are statistics of cache.
+	SqdbStmtCache   stmt_cache;
+
 	const SqdbConfigPostgre *config;
+
+	// state of non-blocking execution. see sqdb_async_send() and sqdb_async_poll()
+	struct {
+		Sqxc       *xc;            // current element of Sqxc chain
+		int         code;
+		bool        busy;          // statement is in progress
+		bool        flush;         // outgoing data hasn't been sent completely
+		bool        insert;        // get inserted row id by "RETURNING id"
+		bool        retry;         // SELECT will be sent again in text format when current one is done
+		int         format;        // result format of SELECT
+		char       *sql;           // SELECT that is sent in binary format. It is NULL in text format.
+	} async;
 };
 
 /*	SqdbConfigPostgre - SqdbPostgre use this to configure database connection
@@ -99,6 +122,19 @@ struct SqdbConfigPostgre
 	const char   *user;
 	const char   *password;
 	const char   *db;
+
+	// number of cached prepared statements. 0 = SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT, -1 = disable cache
+	int           stmt_cache_size;
+
+	// format of SELECT results. SQDB_POSTGRE_RESULT_TEXT (default) or SQDB_POSTGRE_RESULT_BINARY
+	int           result_format;
+
+	// If 'fetch_size' > 0, SELECT results are streamed to Sqxc chain in chunks of 'fetch_size' rows,
+	// so whole result set is not buffered in client memory.
+	// libpq older than 17 doesn't support chunked rows mode, it streams one row at a time.
+	// Prepared SELECT statement receives rows in sqdb_step() too. Other statements can't be executed
+	// on the same connection until it is done or reset.
+	int           fetch_size;
 };
 
 // ----------------------------------------------------------------------------
@@ -17,9 +17,12 @@
 #endif
 #include <limits.h>            // INT_MAX
 #include <stdio.h>             // snprintf(), fprintf(), stderr
+#include <stdlib.h>            // malloc(), free()
+#include <stdarg.h>            // va_list, va_start(), va_end()
 #include <stdbool.h>           // bool, true, false
 
 #include <sqxc/SqError.h>
+#include <sqxc/SqConvert.h>          // sq_time_to_string()
 #include <sqxc/SqdbSqlite.h>
 #include <sqxc/SqxcValue.h>
 #include <sqxc/SqxcSql.h>
@@ -40,6 +43,11 @@ static int  sqdb_sqlite_open(SqdbSqlite *sqdb, const char *database_name);
 static int  sqdb_sqlite_close(SqdbSqlite *sqdb);
 static int  sqdb_sqlite_exec(SqdbSqlite *sqdb, const char *sql, Sqxc *xc, void *reserve);
 static int  sqdb_sqlite_migrate(SqdbSqlite *sqdb, SqSchema *schema, SqSchema *schema_next);
+static int  sqdb_sqlite_prepare(SqdbSqlite *sqdb, const char *sql, SqdbStmt **stmt);
+static int  sqdb_sqlite_bind(SqdbSqlite *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+static int  sqdb_sqlite_step(SqdbSqlite *sqdb, SqdbStmt *stmt, Sqxc *xc);
+static int  sqdb_sqlite_reset(SqdbSqlite *sqdb, SqdbStmt *stmt);
+static int  sqdb_sqlite_finalize(SqdbSqlite *sqdb, SqdbStmt *stmt);
 
 const SqdbInfo sqdbInfo_SQLite = {
 	.size    = sizeof(SqdbSqlite),
@@ -59,6 +67,12 @@ const SqdbInfo sqdbInfo_SQLite = {
 	.close   = (void*)sqdb_sqlite_close,
 	.exec    = (void*)sqdb_sqlite_exec,
 	.migrate = (void*)sqdb_sqlite_migrate,
+
+	.prepare  = (void*)sqdb_sqlite_prepare,
+	.bind     = (void*)sqdb_sqlite_bind,
+	.step     = (void*)sqdb_sqlite_step,
+	.reset    = (void*)sqdb_sqlite_reset,
+	.finalize = (void*)sqdb_sqlite_finalize,
 };
 
 // ----------------------------------------------------------------------------
@@ -68,6 +82,7 @@ static void sqdb_sqlite_recreate_table(SqdbSqlite *db, SqBuffer *sql_buf, SqTabl
 static void sqdb_sqlite_create_dependent(SqdbSqlite *db, SqBuffer *sql_buf, SqTable *table);
 static void sqdb_sqlite_create_trigger(SqdbSqlite *db, SqBuffer *sql_buf, SqTable *table, SqColumn *column);
 static bool sqdb_sqlite_alter_table(SqdbSqlite *db, SqBuffer *sql_buf, SqTable *table);
+static void sqdb_sqlite_destroy_stmt(SqdbSqlite *sqdb, SqdbStmt *stmt);
 #ifndef NDEBUG
 static int  debug_callback(void *user_data, int argc, char **argv, char **columnName);
 #endif
@@ -77,10 +92,15 @@ static void sqdb_sqlite_init(SqdbSqlite *sqdb, const SqdbConfigSqlite *config_sr
 	sqdb->config = config_src;
 	sqdb->version = 0;
 	sqdb->litedb = NULL;
+	sqdb_stmt_cache_init(&sqdb->stmt_cache, (Sqdb*)sqdb,
+	                     (config_src) ? config_src->stmt_cache_size : 0,
+	                     (SqdbStmtDestroyFunc)sqdb_sqlite_destroy_stmt);
 }
 
 static void sqdb_sqlite_final(SqdbSqlite *sqdb)
 {
+	// prepared statements must be finalized before closing database
+	sqdb_stmt_cache_final(&sqdb->stmt_cache);
 	// sqdb_sqlite_close() also do this
 	if (sqdb->litedb)
 		sqlite3_close(sqdb->litedb);
@@ -92,10 +112,32 @@ static int int_callback(void *user_data, int argc, char **argv, char **columnNam
 	return 0;
 }
 
+static void sqdb_sqlite_pragma(SqdbSqlite *sqdb, const char *name, const char *format, ...)
+{
+	va_list  arg_list;
+	char    *value;
+	char    *sql;
+	char    *errorMsg = NULL;
+
+	va_start(arg_list, format);
+	value = sqlite3_vmprintf(format, arg_list);
+	va_end(arg_list);
+	sql = sqlite3_mprintf("PRAGMA %s = %s;", name, value);
+	if (sqlite3_exec(sqdb->litedb, sql, NULL, NULL, &errorMsg) != SQLITE_OK) {
+#ifndef NDEBUG
+		fprintf(stderr, "SQLite: PRAGMA %s: %s\n", name, errorMsg);
+#endif
+		sqlite3_free(errorMsg);
+	}
+	sqlite3_free(sql);
+	sqlite3_free(value);
+}
+
 static int  sqdb_sqlite_open(SqdbSqlite *sqdb, const char *database_name)
 {
-	const char *ext = sqdb->config->extension;
-	const char *folder = sqdb->config->folder;
+	const SqdbConfigSqlite *config = sqdb->config;
+	const char *ext = config->extension;
+	const char *folder = config->folder;
 	char *buf;
 	int   len;
 	int   rc;
@@ -108,13 +150,35 @@ static int  sqdb_sqlite_open(SqdbSqlite *sqdb, const char *database_name)
 	buf = malloc(len);
 	snprintf(buf, len, "%s/%s.%s", folder, database_name, ext);
 
-	rc = sqlite3_open(buf, &sqdb->litedb);
+	if (config->bit_field & SQDB_CONFIG_READ_ONLY)
+		rc = sqlite3_open_v2(buf, &sqdb->litedb, SQLITE_OPEN_READONLY, NULL);
+	else
+		rc = sqlite3_open(buf, &sqdb->litedb);
 	free(buf);
 
-	if (rc != SQLITE_OK)
+	if (rc != SQLITE_OK) {
+		// sqlite3_open() returns handle even if error occurred
+		sqlite3_close(sqdb->litedb);
+		sqdb->litedb = NULL;
 		return SQCODE_OPEN_FAILED;
+	}
 
-	if (sqdb->config->bit_field & SQDB_CONFIG_NO_MIGRATION) {
+	// PRAGMA settings
+	if (config->busy_timeout > 0)
+		sqlite3_busy_timeout(sqdb->litedb, config->busy_timeout);
+	// read-only connection can't change journal mode. WAL mode is persistent in database file.
+	if (config->journal_mode && (config->bit_field & SQDB_CONFIG_READ_ONLY) == 0)
+		sqdb_sqlite_pragma(sqdb, "journal_mode", "%s", config->journal_mode);
+	if (config->synchronous)
+		sqdb_sqlite_pragma(sqdb, "synchronous", "%s", config->synchronous);
+	if (config->temp_store)
+		sqdb_sqlite_pragma(sqdb, "temp_store", "%s", config->temp_store);
+	if (config->cache_size)
+		sqdb_sqlite_pragma(sqdb, "cache_size", "%d", config->cache_size);
+	if (config->mmap_size)
+		sqdb_sqlite_pragma(sqdb, "mmap_size", "%lld", (long long)config->mmap_size);
+
+	if (config->bit_field & SQDB_CONFIG_NO_MIGRATION) {
 		// No migration
 		sqdb->version = INT_MAX;
 	}
@@ -127,6 +191,8 @@ static int  sqdb_sqlite_open(SqdbSqlite *sqdb, const char *database_name)
 
 static int  sqdb_sqlite_close(SqdbSqlite *sqdb)
 {
+	// prepared statements must be finalized before closing database
+	sqdb_stmt_cache_clear(&sqdb->stmt_cache);
 	if (sqdb->litedb) {
 		sqlite3_close(sqdb->litedb);
 		sqdb->litedb = NULL;
@@ -312,10 +378,15 @@ static int  sqdb_sqlite_migrate(SqdbSqlite *sqdb, SqSchema *schema, SqSchema *sc
 	return SQCODE_OK;
 }
 
-static int query_callback(void *user_data, int argc, char **argv, char **columnName)
+// used by sqdb_sqlite_exec() and sqdb_sqlite_step()
+// send current row of 'litestmt' to Sqxc chain. Column values are sent by their storage class:
+// INTEGER -> SQXC_TYPE_INT64, REAL -> SQXC_TYPE_DOUBLE, NULL -> SQXC_TYPE_NULL, TEXT -> SQXC_TYPE_STR,
+// BLOB -> SQXC_TYPE_STR in hex format \xFF (Sqxc doesn't carry length of data, hex string keeps it).
+static int  sqdb_sqlite_send_row(sqlite3_stmt *litestmt, Sqxc **xcAddr)
 {
-	Sqxc *xc = *(Sqxc**)user_data;
-	int   index;
+	Sqxc *xc = *xcAddr;
+	SqBuffer blob;
+	int   n_columns;
 
 	// Special case:
 	// Don't send object if user selects only one column and the column type is built-in types (not object).
@@ -325,15 +396,49 @@ static int query_callback(void *user_data, int argc, char **argv, char **columnN
 		xc->name = NULL;
 		xc->value.pointer = NULL;
 		xc = sqxc_send(xc);
-		// returns non-zero, the sqlite3_exec() routine returns SQLITE_ABORT
-		if (xc->code != SQCODE_OK)
-			return 1;
+		if (xc->code != SQCODE_OK) {
+			*xcAddr = xc;
+			return xc->code;
+		}
 	}
 
-	for (index = 0;  index < argc;  index++) {
-		xc->type = SQXC_TYPE_STR;
-		xc->name = columnName[index];
-		xc->value.str = argv[index];
+	n_columns = sqlite3_column_count(litestmt);
+	for (int index = 0;  index < n_columns;  index++) {
+		xc->name = sqlite3_column_name(litestmt, index);
+
+		switch (sqlite3_column_type(litestmt, index)) {
+		case SQLITE_INTEGER:
+			xc->type = SQXC_TYPE_INT64;
+			xc->value.int64 = sqlite3_column_int64(litestmt, index);
+			break;
+
+		case SQLITE_FLOAT:
+			xc->type = SQXC_TYPE_DOUBLE;
+			xc->value.double_ = sqlite3_column_double(litestmt, index);
+			break;
+
+		case SQLITE_NULL:
+			xc->type = SQXC_TYPE_NULL;
+			xc->value.int64 = 0;       // clear all bits, parser may read any member of SqValue
+			break;
+
+		case SQLITE_BLOB:
+			// send data of SQLite with its length, parser copies it.
+			// call sqlite3_column_blob() before sqlite3_column_bytes()
+			blob.mem    = (char*)sqlite3_column_blob(litestmt, index);
+			blob.writed = sqlite3_column_bytes(litestmt, index);
+			blob.size   = blob.writed;
+			xc->type = SQXC_TYPE_BLOB;
+			xc->value.pointer = &blob;
+			break;
+
+//		case SQLITE_TEXT:
+		default:
+			xc->type = SQXC_TYPE_STR;
+			xc->value.str = (const char*)sqlite3_column_text(litestmt, index);
+			break;
+		}
+
 		xc = sqxc_send(xc);
 
 #ifndef NDEBUG
@@ -344,14 +449,12 @@ static int query_callback(void *user_data, int argc, char **argv, char **columnN
 		case SQCODE_ENTRY_NOT_FOUND:
 			// warning
 			fprintf(stderr, "%s: column '%s' not found.\n",
-			        "sqdb_sqlite_exec()", columnName[index]);
+			        "sqdb_sqlite_send_row()", sqlite3_column_name(litestmt, index));
 			break;
 
 		default:
 			fprintf(stderr, "%s: error occurred during parsing column '%s'.\n",
-			        "sqdb_sqlite_exec()", columnName[index]);
-			// returns non-zero, the sqlite3_exec() routine returns SQLITE_ABORT
-//			return 1;
+			        "sqdb_sqlite_send_row()", sqlite3_column_name(litestmt, index));
 			break;
 		}
 #endif  // NDEBUG
@@ -365,17 +468,15 @@ static int query_callback(void *user_data, int argc, char **argv, char **columnN
 		xc->name = NULL;
 		xc->value.pointer = NULL;
 		xc = sqxc_send(xc);
-#ifndef NDEBUG
-		// returns non-zero, the sqlite3_exec() routine returns SQLITE_ABORT
-		if (xc->code != SQCODE_OK)
-			return 1;
-#endif  // NDEBUG
 	}
 
 	// xc may be changed by sqxc_send()
-	*(Sqxc**)user_data = xc;
-
-	return 0;
+	*xcAddr = xc;
+#ifndef NDEBUG
+	return xc->code;
+#else
+	return SQCODE_OK;
+#endif  // NDEBUG
 }
 
 #ifndef NDEBUG
@@ -392,6 +493,7 @@ static int  debug_callback(void *user_data, int argc, char **argv, char **column
 
 static int  sqdb_sqlite_exec(SqdbSqlite *sqdb, const char *sql, Sqxc *xc, void *reserve)
 {
+	sqlite3_stmt *litestmt;
 	int   rc;
 	int   code = SQCODE_OK;
 	char *errorMsg = NULL;
@@ -428,12 +530,25 @@ static int  sqdb_sqlite_exec(SqdbSqlite *sqdb, const char *sql, Sqxc *xc, void *
 				xc = sqxc_send(xc);
 			}
 
-			// set xc->code and call sqlite3_exec()
-			xc->code = SQCODE_NO_DATA;
-			rc = sqlite3_exec(sqdb->litedb, sql, query_callback, &xc, &errorMsg);
 			// if the result set is empty.
-			if(xc->code == SQCODE_NO_DATA)
-				code = SQCODE_NO_DATA;
+			code = SQCODE_NO_DATA;
+			rc = sqlite3_prepare_v2(sqdb->litedb, sql, -1, &litestmt, NULL);
+			if (rc == SQLITE_OK) {
+				while ((rc = sqlite3_step(litestmt)) == SQLITE_ROW) {
+					code = SQCODE_OK;
+					if (sqdb_sqlite_send_row(litestmt, &xc) != SQCODE_OK) {
+						rc = SQLITE_ABORT;
+						break;
+					}
+				}
+				if (rc == SQLITE_DONE)
+					rc = SQLITE_OK;
+				else
+					errorMsg = sqlite3_mprintf("%s", sqlite3_errmsg(sqdb->litedb));
+				sqlite3_finalize(litestmt);
+			}
+			else
+				errorMsg = sqlite3_mprintf("%s", sqlite3_errmsg(sqdb->litedb));
 
 			// If SqxcValue is prepared to receive multiple rows
 			if (sqxc_value_container(xc)) {
@@ -474,6 +589,155 @@ static int  sqdb_sqlite_exec(SqdbSqlite *sqdb, const char *sql, Sqxc *xc, void *
 	return code;
 }
 
+// ----------------------------------------------------------------------------
+// prepared statement
+
+static void sqdb_sqlite_destroy_stmt(SqdbSqlite *sqdb, SqdbStmt *stmt)
+{
+	sqlite3_finalize((sqlite3_stmt*)stmt);
+}
+
+static int  sqdb_sqlite_prepare(SqdbSqlite *sqdb, const char *sql, SqdbStmt **stmt)
+{
+	sqlite3_stmt *litestmt;
+	int   rc;
+
+	// reuse cached statement
+	litestmt = (sqlite3_stmt*)sqdb_stmt_cache_get(&sqdb->stmt_cache, sql);
+	if (litestmt == NULL) {
+		rc = sqlite3_prepare_v2(sqdb->litedb, sql, -1, &litestmt, NULL);
+		if (rc != SQLITE_OK) {
+#ifndef NDEBUG
+			fprintf(stderr, "SQLite: %s\n", sqlite3_errmsg(sqdb->litedb));
+#endif
+			*stmt = NULL;
+			return SQCODE_EXEC_ERROR;
+		}
+		sqdb_stmt_cache_add(&sqdb->stmt_cache, sql, (SqdbStmt*)litestmt);
+	}
+
+	*stmt = (SqdbStmt*)litestmt;
+	return SQCODE_OK;
+}
+
+static int  sqdb_sqlite_bind(SqdbSqlite *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value)
+{
+	sqlite3_stmt *litestmt = (sqlite3_stmt*)stmt;
+	int   rc;
+
+	switch (type) {
+	case SQXC_TYPE_NULL:
+		rc = sqlite3_bind_null(litestmt, index);
+		break;
+
+	case SQXC_TYPE_BOOL:
+		rc = sqlite3_bind_int(litestmt, index, value->boolean);
+		break;
+
+	case SQXC_TYPE_INT:
+		rc = sqlite3_bind_int(litestmt, index, value->integer);
+		break;
+
+	case SQXC_TYPE_UINT:
+		rc = sqlite3_bind_int64(litestmt, index, value->uinteger);
+		break;
+
+	case SQXC_TYPE_INT64:
+		rc = sqlite3_bind_int64(litestmt, index, value->int64);
+		break;
+
+	case SQXC_TYPE_UINT64:
+		rc = sqlite3_bind_int64(litestmt, index, (sqlite3_int64)value->uint64);
+		break;
+
+	case SQXC_TYPE_TIME:
+		// SQLite will call free() to release string
+		rc = sqlite3_bind_text(litestmt, index,
+		                       sq_time_to_string(value->rawtime, 0), -1, free);
+		break;
+
+	case SQXC_TYPE_DOUBLE:
+		rc = sqlite3_bind_double(litestmt, index, value->double_);
+		break;
+
+	case SQXC_TYPE_STR:
+		if (value->str == NULL)
+			rc = sqlite3_bind_null(litestmt, index);
+		else
+			rc = sqlite3_bind_text(litestmt, index, value->str, -1, SQLITE_TRANSIENT);
+		break;
+
+	default:
+		return SQCODE_TYPE_NOT_SUPPORTED;
+	}
+
+	if (rc != SQLITE_OK) {
+#ifndef NDEBUG
+		fprintf(stderr, "SQLite: %s\n", sqlite3_errmsg(sqdb->litedb));
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+	return SQCODE_OK;
+}
+
+static int  sqdb_sqlite_step(SqdbSqlite *sqdb, SqdbStmt *stmt, Sqxc *xc)
+{
+	sqlite3_stmt *litestmt = (sqlite3_stmt*)stmt;
+	int   rc;
+
+	rc = sqlite3_step(litestmt);
+	if (rc == SQLITE_DONE) {
+		if (xc && xc->info == SQXC_INFO_SQL) {
+			// set the last inserted row id
+			((SqxcSql*)xc)->id = sqlite3_last_insert_rowid(sqdb->litedb);
+			// set number of rows changed
+			((SqxcSql*)xc)->changes = sqlite3_changes64(sqdb->litedb);
+		}
+		return SQCODE_DONE;
+	}
+	if (rc != SQLITE_ROW) {
+#ifndef NDEBUG
+		fprintf(stderr, "SQLite: %s\n", sqlite3_errmsg(sqdb->litedb));
+#endif
+		return SQCODE_EXEC_ERROR;
+	}
+
+	// discard row if 'xc' is NULL
+	if (xc == NULL)
+		return SQCODE_ROW;
+#ifndef NDEBUG
+	if (xc->info != SQXC_INFO_VALUE) {
+		fprintf(stderr, "%s: SELECT command must use with SqxcValue.\n",
+		        "sqdb_sqlite_step()");
+		return SQCODE_EXEC_ERROR;
+	}
+#endif
+
+	if (sqdb_sqlite_send_row(litestmt, &xc) != SQCODE_OK)
+		return SQCODE_EXEC_ERROR;
+	return SQCODE_ROW;
+}
+
+static int  sqdb_sqlite_reset(SqdbSqlite *sqdb, SqdbStmt *stmt)
+{
+	sqlite3_reset((sqlite3_stmt*)stmt);
+	return SQCODE_OK;
+}
+
+static int  sqdb_sqlite_finalize(SqdbSqlite *sqdb, SqdbStmt *stmt)
+{
+	if (stmt == NULL)
+		return SQCODE_OK;
+	// return cached statement to cache
+	if (sqdb_stmt_cache_release(&sqdb->stmt_cache, stmt)) {
+		sqlite3_reset((sqlite3_stmt*)stmt);
+		sqlite3_clear_bindings((sqlite3_stmt*)stmt);
+	}
+	else
+		sqlite3_finalize((sqlite3_stmt*)stmt);
+	return SQCODE_OK;
+}
+
 // ----------------------------------------------------------------------------
 
 // write exist columns
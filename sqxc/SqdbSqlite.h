@@ -18,6 +18,7 @@
 #include <sqlite3.h>
 
 #include <sqxc/Sqdb.h>
+#include <sqxc/SqdbStmtCache.h>
 
 // ----------------------------------------------------------------------------
 // C/C++ common declarations: declare type, structure, macro, enumeration.
@@ -72,6 +73,9 @@ struct SqdbSqlite
 	// ------ SqdbSqlite members ------    // <-- 3. Add variable and non-virtual function in derived struct.
 	sqlite3        *litedb;
 
+	// prepared statements. 'stmt_cache.hits' and 'stmt_cache.misses' are statistics of cache.
+	SqdbStmtCache   stmt_cache;
+
 	const SqdbConfigSqlite *config;
 };
 
@@ -96,6 +100,17 @@ struct SqdbConfigSqlite
 	// ------ SqdbConfigSqlite members ------
 	const char     *folder;
 	const char     *extension;   // optional
+
+	// number of cached prepared statements. 0 = SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT, -1 = disable cache
+	int             stmt_cache_size;
+
+	// PRAGMA settings. They are applied after connection is opened. NULL or 0 = SQLite default.
+	const char     *journal_mode;   // "WAL", "DELETE", "TRUNCATE", "MEMORY"...
+	const char     *synchronous;    // "OFF", "NORMAL", "FULL", "EXTRA"
+	const char     *temp_store;     // "DEFAULT", "FILE", "MEMORY"
+	int             cache_size;     // number of pages if > 0, kibibytes if < 0
+	int64_t         mmap_size;      // maximum number of bytes for memory-mapped I/O
+	int             busy_timeout;   // milliseconds to wait when database is locked
 };
 
 // ----------------------------------------------------------------------------
@@ -0,0 +1,206 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#include <ctype.h>             // isspace()
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqxc/SqConfig.h>
+#include <sqxc/SqdbStmtCache.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+typedef struct StmtEntry    StmtEntry;
+
+struct StmtEntry
+{
+	char      *sql;          // normalized SQL
+	SqdbStmt  *stmt;
+	uint64_t   last_used;
+	bool       in_use;
+};
+
+static void  stmt_entry_free(StmtEntry *entry, SqdbStmtCache *cache)
+{
+	cache->destroy(cache->db, entry->stmt);
+	free(entry->sql);
+	free(entry);
+}
+
+static int   stmt_entry_cmp_str__sql(const void *sql, const void *entryAddr)
+{
+	return strcmp((const char*)sql, (*(StmtEntry**)entryAddr)->sql);
+}
+
+void  sqdb_stmt_cache_init(SqdbStmtCache *cache, Sqdb *db, int capacity, SqdbStmtDestroyFunc destroy)
+{
+	if (capacity == 0)
+		capacity = SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT;
+	else if (capacity < 0)
+		capacity = 0;
+
+	sq_ptr_array_init(&cache->entries, (capacity) ? capacity : 1, NULL);
+	sq_buffer_init(&cache->key);
+	cache->db = db;
+	cache->destroy = destroy;
+	cache->capacity = capacity;
+	cache->tick = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+}
+
+void  sqdb_stmt_cache_final(SqdbStmtCache *cache)
+{
+	sqdb_stmt_cache_clear(cache);
+	sq_ptr_array_final(&cache->entries);
+	sq_buffer_final(&cache->key);
+}
+
+void  sqdb_stmt_cache_clear(SqdbStmtCache *cache)
+{
+	StmtEntry  *entry;
+
+	for (unsigned int index = 0;  index < cache->entries.length;  index++) {
+		entry = (StmtEntry*)cache->entries.data[index];
+		stmt_entry_free(entry, cache);
+	}
+	cache->entries.length = 0;
+}
+
+SqdbStmt *sqdb_stmt_cache_get(SqdbStmtCache *cache, const char *sql)
+{
+	StmtEntry **addr;
+
+	if (cache->capacity == 0)
+		return NULL;
+
+	sqdb_stmt_cache_normalize(&cache->key, sql);
+	addr = (StmtEntry**)sq_ptr_array_search(&cache->entries, cache->key.mem,
+	                                        stmt_entry_cmp_str__sql);
+	if (addr == NULL || (*addr)->in_use) {
+		cache->misses++;
+		return NULL;
+	}
+	cache->hits++;
+	(*addr)->in_use = true;
+	(*addr)->last_used = ++cache->tick;
+	return (*addr)->stmt;
+}
+
+bool  sqdb_stmt_cache_add(SqdbStmtCache *cache, const char *sql, SqdbStmt *stmt)
+{
+	StmtEntry  *entry;
+	StmtEntry  *lru = NULL;
+	unsigned int  index;
+	unsigned int  lru_index = 0;
+
+	if (cache->capacity == 0)
+		return false;
+
+	sqdb_stmt_cache_normalize(&cache->key, sql);
+	// the same SQL statement is in use, caller own 'stmt'
+	if (sq_ptr_array_find_sorted(&cache->entries, cache->key.mem,
+	                             stmt_entry_cmp_str__sql, &index))
+	{
+		return false;
+	}
+
+	if (cache->entries.length >= cache->capacity) {
+		// evict the least recently used statement that is not in use
+		for (unsigned int i = 0;  i < cache->entries.length;  i++) {
+			entry = (StmtEntry*)cache->entries.data[i];
+			if (entry->in_use)
+				continue;
+			if (lru == NULL || lru->last_used > entry->last_used) {
+				lru = entry;
+				lru_index = i;
+			}
+		}
+		// all statements are in use
+		if (lru == NULL)
+			return false;
+		sq_ptr_array_erase(&cache->entries, lru_index, 1);
+		stmt_entry_free(lru, cache);
+		cache->evictions++;
+		if (index > lru_index)
+			index--;
+	}
+
+	entry = malloc(sizeof(StmtEntry));
+	entry->sql = strdup(cache->key.mem);
+	entry->stmt = stmt;
+	entry->in_use = true;
+	entry->last_used = ++cache->tick;
+	sq_ptr_array_push_in(&cache->entries, index, entry);
+	return true;
+}
+
+bool  sqdb_stmt_cache_release(SqdbStmtCache *cache, SqdbStmt *stmt)
+{
+	StmtEntry  *entry;
+
+	for (unsigned int index = 0;  index < cache->entries.length;  index++) {
+		entry = (StmtEntry*)cache->entries.data[index];
+		if (entry->stmt == stmt) {
+			entry->in_use = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+int   sqdb_stmt_cache_normalize(SqBuffer *buf, const char *sql)
+{
+	char  quote = 0;
+	bool  space = false;
+	int   length;
+
+	buf->writed = 0;
+	// skip leading whitespace
+	while (isspace((unsigned char)*sql))
+		sql++;
+
+	for (;  *sql;  sql++) {
+		if (quote) {
+			if (*sql == quote)
+				quote = 0;
+		}
+		else if (isspace((unsigned char)*sql)) {
+			space = true;
+			continue;
+		}
+		else if (*sql == '\'' || *sql == '"' || *sql == '`')
+			quote = *sql;
+
+		// collapse whitespace to a space
+		if (space) {
+			sq_buffer_write_c(buf, ' ');
+			space = false;
+		}
+		sq_buffer_write_c(buf, *sql);
+	}
+
+	// remove trailing semicolons and spaces
+	while (buf->writed > 0 && (buf->mem[buf->writed -1] == ';' || buf->mem[buf->writed -1] == ' '))
+		buf->writed--;
+
+	// null-terminated
+	length = (int)buf->writed;
+	sq_buffer_write_c(buf, 0);
+	buf->writed = length;
+	return length;
+}
@@ -0,0 +1,107 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+/* ----------------------------------------------------------------------------
+	SqdbStmtCache - LRU cache of prepared statements for a database connection.
+	                It is used by SqdbSqlite, SqdbMysql, SqdbPostgre, etc.
+
+	Statements are keyed by normalized SQL (whitespace outside of quotes is collapsed,
+	trailing spaces and semicolons are removed).
+ */
+
+#ifndef SQDB_STMT_CACHE_H
+#define SQDB_STMT_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <sqxc/SqPtrArray.h>
+#include <sqxc/SqBuffer.h>
+#include <sqxc/Sqdb.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqdbStmtCache    SqdbStmtCache;
+
+// SqdbStmtCache use this to destroy (really finalize) statement that is evicted or cleared.
+typedef void (*SqdbStmtDestroyFunc)(Sqdb *db, SqdbStmt *stmt);
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// if 'capacity' is 0, use SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT. if 'capacity' is negative, cache is disabled.
+void      sqdb_stmt_cache_init(SqdbStmtCache *cache, Sqdb *db, int capacity, SqdbStmtDestroyFunc destroy);
+void      sqdb_stmt_cache_final(SqdbStmtCache *cache);
+
+// destroy all cached statements. Database product must call this before closing connection.
+void      sqdb_stmt_cache_clear(SqdbStmtCache *cache);
+
+// find statement by SQL and mark it in use. return NULL if not found or the statement is in use.
+SqdbStmt *sqdb_stmt_cache_get(SqdbStmtCache *cache, const char *sql);
+
+// add statement that was prepared from 'sql' and mark it in use.
+// It may evict the least recently used statement that is not in use.
+// return false if statement can't be added. In this case, caller own the statement.
+bool      sqdb_stmt_cache_add(SqdbStmtCache *cache, const char *sql, SqdbStmt *stmt);
+
+// mark statement not in use.
+// return true if statement is in cache. caller should reset statement instead of destroying it.
+bool      sqdb_stmt_cache_release(SqdbStmtCache *cache, SqdbStmt *stmt);
+
+// write normalized 'sql' to 'buf' (null-terminated). return length of normalized SQL.
+int       sqdb_stmt_cache_normalize(SqBuffer *buf, const char *sql);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+struct SqdbStmtCache
+{
+	SqPtrArray    entries;      // sorted by normalized SQL
+	SqBuffer      key;          // buffer for normalized SQL
+
+	Sqdb         *db;
+	SqdbStmtDestroyFunc destroy;
+
+	unsigned int  capacity;     // max number of cached statements. 0 = disabled
+	uint64_t      tick;         // increased each time a statement is used
+
+	// --- statistics ---
+	uint64_t      hits;
+	uint64_t      misses;
+	uint64_t      evictions;
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+typedef struct SqdbStmtCache    DbStmtCache;
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+#endif  // SQDB_STMT_CACHE_H
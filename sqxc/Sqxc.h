@@ -94,7 +94,7 @@ typedef enum {
 
 	SQXC_TYPE_RAW      = (1 << 9),    // 0x0200    // mainly for SQL data types
 
-	SQXC_TYPE_RESERVE1 = (1 << 10),   // 0x0400    // reserve Sqxc type
+	SQXC_TYPE_BLOB     = (1 << 10),   // 0x0400    // Sqxc::value.pointer = (SqBuffer*), data isn't null-terminated
 	SQXC_TYPE_RESERVE2 = (1 << 11),   // 0x0800    // reserve Sqxc type
 	SQXC_TYPE_RESERVE3 = (1 << 12),   // 0x1000    // reserve Sqxc type
 
@@ -128,7 +128,7 @@ typedef enum {
 	                     SQXC_TYPE_OBJECT     |
 	                     SQXC_TYPE_ARRAY,
 
-	// Sqxc all types bitmask         // 0x63FF    // exclude reserve Sqxc types
+	// Sqxc all types bitmask         // 0x63FF    // exclude blob and reserve Sqxc types
 	SQXC_TYPE_ALL      = SQXC_TYPE_ARITHMETIC |
 	                     SQXC_TYPE_STR        |
 	                     SQXC_TYPE_RAW        |
@@ -146,6 +146,8 @@ typedef enum {
 	// SqxcSql
 	SQXC_SQL_CTRL_INSERT,     // const char *table_name
 	SQXC_SQL_CTRL_UPDATE,     // const char *table_name
+	SQXC_SQL_CTRL_COPY,       // const char *table_name. pass error message to SQXC_CTRL_FINISH to abort COPY.
+	SQXC_SQL_CTRL_UPDATE_MANY,  // const char *table_name. UPDATE multiple rows by primary key.
 
 	SQXC_USER = 100,
 } SqxcCtrlId;
@@ -133,6 +133,16 @@ static int  sqxc_cjson_send_in(SqxcCjson *xcjson, Sqxc *src)
 	}
 #endif
 
+	// NULL column (e.g. SqIntArray is NULL). keep default value of entry.
+	if (src->type == SQXC_TYPE_NULL || src->value.str == NULL) {
+#if SQ_CONFIG_SQXC_NESTED_FAST_TYPE_MATCH
+		// parser of entry (e.g. array) has pushed SqxcNested to do type match
+		if (SQXC_IS_DOING_TYPE_MATCH(src))
+			sqxc_pop_nested(src);
+#endif
+		return (src->code = SQCODE_OK);
+	}
+
 	xcjson->jRoot = cJSON_Parse(src->value.str);
 	if (xcjson->jRoot == NULL)
 		return (src->code = SQCODE_JSON_ERROR);
@@ -166,7 +176,7 @@ static int  sqxc_cjson_ctrl_in(SqxcCjson *xcjson, int id, void *data)
 static void  sqxc_cjson_init_in(SqxcCjson *xcjson)
 {
 //	memset(xcjson, 0, sizeof(SqxcCjson));
-	xcjson->supported_type = SQXC_TYPE_STR;
+	xcjson->supported_type = SQXC_TYPE_STR | SQXC_TYPE_NULL;
 
 	// cJSON: initial the root object
 	xcjson->jRoot = NULL;
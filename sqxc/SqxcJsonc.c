@@ -136,6 +136,16 @@ static int  sqxc_jsonc_send_in(SqxcJsonc *xcjson, Sqxc *src)
 	}
 #endif
 
+	// NULL column (e.g. SqIntArray is NULL). keep default value of entry.
+	if (src->type == SQXC_TYPE_NULL || src->value.str == NULL) {
+#if SQ_CONFIG_SQXC_NESTED_FAST_TYPE_MATCH
+		// parser of entry (e.g. array) has pushed SqxcNested to do type match
+		if (SQXC_IS_DOING_TYPE_MATCH(src))
+			sqxc_pop_nested(src);
+#endif
+		return (src->code = SQCODE_OK);
+	}
+
 	// json-c: If the parsing is incomplete, json_tokener_parse_ex() return NULL.
 	jObject = json_tokener_parse_ex(xcjson->jTokener, src->value.str, -1);
 	if (jObject == NULL) {
@@ -181,7 +191,7 @@ static int  sqxc_jsonc_ctrl_in(SqxcJsonc *xcjson, int id, void *data)
 static void  sqxc_jsonc_init_in(SqxcJsonc *xcjson)
 {
 //	memset(xcjson, 0, sizeof(SqxcJsonc));
-	xcjson->supported_type = SQXC_TYPE_STR;
+	xcjson->supported_type = SQXC_TYPE_STR | SQXC_TYPE_NULL;
 
 	// json-c: create parser.
 	xcjson->jTokener = json_tokener_new();
@@ -0,0 +1,307 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>            // realloc(), free()
+#include <string.h>
+
+#include <sqxc/SqError.h>
+#include <sqxc/SqBuffer.h>
+#include <sqxc/SqxcRecord.h>
+#include <sqxc/SqxcValue.h>
+
+/* ----------------------------------------------------------------------------
+	record format:
+
+	uint16_t  type;            // SqxcType
+	uint32_t  name_length;     // 0 if name is NULL, otherwise strlen(name) + 1
+	char      name[];          // null-terminated
+	          value;           // depend on type:
+	                           // bool: uint8_t, INT/UINT: 4 bytes, INT64/UINT64/TIME/DOUBLE: 8 bytes
+	                           // STR/RAW: uint32_t length (0 if NULL) + null-terminated string
+ */
+
+static void  record_write(SqBuffer *buf, const void *data, size_t length)
+{
+	memcpy(sq_buffer_alloc(buf, length), data, length);
+}
+
+static void  record_write_str(SqBuffer *buf, const char *str)
+{
+	uint32_t  length = (str) ? (uint32_t)strlen(str) + 1 : 0;
+
+	record_write(buf, &length, sizeof(length));
+	if (length)
+		record_write(buf, str, length);
+}
+
+// return false if data is truncated
+static bool  record_read(const char **cur, const char *end, void *data, size_t length)
+{
+	if ((size_t)(end - *cur) < length)
+		return false;
+	memcpy(data, *cur, length);
+	*cur += length;
+	return true;
+}
+
+static bool  record_read_str(const char **cur, const char *end, const char **str)
+{
+	uint32_t  length;
+
+	*str = NULL;
+	if (record_read(cur, end, &length, sizeof(length)) == false)
+		return false;
+	if ((size_t)(end - *cur) < length)
+		return false;
+	if (length)
+		*str = *cur;
+	*cur += length;
+	return true;
+}
+
+/* ----------------------------------------------------------------------------
+	SqxcInfo functions - destination of output chain
+
+	SqType::write() ---> SQXC_TYPE_xxx ---> SqxcRecord
+ */
+
+static int  sqxc_record_send(SqxcRecord *xcrecord, Sqxc *src)
+{
+	SqBuffer *buf = sqxc_get_buffer(xcrecord);
+	uint16_t  type = src->type;
+	union {
+		uint8_t   u8;
+		int32_t   i32;
+		int64_t   i64;
+		double    dbl;
+	} value;
+
+	record_write(buf, &type, sizeof(type));
+	record_write_str(buf, src->name);
+
+	switch (type) {
+	case SQXC_TYPE_BOOL:
+		value.u8 = src->value.boolean;
+		record_write(buf, &value.u8, sizeof(value.u8));
+		break;
+
+	case SQXC_TYPE_INT:
+	case SQXC_TYPE_UINT:
+		value.i32 = src->value.integer;
+		record_write(buf, &value.i32, sizeof(value.i32));
+		break;
+
+	case SQXC_TYPE_INT64:
+	case SQXC_TYPE_UINT64:
+		value.i64 = src->value.int64;
+		record_write(buf, &value.i64, sizeof(value.i64));
+		break;
+
+	case SQXC_TYPE_TIME:
+		value.i64 = (int64_t)src->value.rawtime;
+		record_write(buf, &value.i64, sizeof(value.i64));
+		break;
+
+	case SQXC_TYPE_DOUBLE:
+		value.dbl = src->value.double_;
+		record_write(buf, &value.dbl, sizeof(value.dbl));
+		break;
+
+	case SQXC_TYPE_STR:
+	case SQXC_TYPE_RAW:
+		record_write_str(buf, src->value.str);
+		break;
+
+	default:
+		// SQXC_TYPE_NULL, object, array, and end of them don't have value
+		break;
+	}
+	return (src->code = SQCODE_OK);
+}
+
+static int  sqxc_record_ctrl(SqxcRecord *xcrecord, int id, void *data)
+{
+	switch (id) {
+	case SQXC_CTRL_READY:
+		xcrecord->buf_writed = 0;
+		break;
+
+	case SQXC_CTRL_FINISH:
+	default:
+		break;
+	}
+	return SQCODE_OK;
+}
+
+static void  sqxc_record_init(SqxcRecord *xcrecord)
+{
+//	memset(xcrecord, 0, sizeof(SqxcRecord));
+	xcrecord->supported_type = SQXC_TYPE_ALL;
+}
+
+// ----------------------------------------------------------------------------
+// replay
+
+size_t  sqxc_record_read(const char *data, size_t length, Sqxc *xc)
+{
+	const char *cur = data;
+	const char *end = data + length;
+	uint16_t    type = 0;
+	bool        ok;
+	union {
+		uint8_t   u8;
+		int32_t   i32;
+		int64_t   i64;
+		double    dbl;
+	} value;
+
+	ok = record_read(&cur, end, &type, sizeof(type)) &&
+	     record_read_str(&cur, end, &xc->name);
+	xc->type = type;
+	xc->entry = NULL;
+	xc->value.pointer = NULL;
+
+	switch (type) {
+	case SQXC_TYPE_BOOL:
+		ok = ok && record_read(&cur, end, &value.u8, sizeof(value.u8));
+		xc->value.boolean = value.u8;
+		break;
+
+	case SQXC_TYPE_INT:
+	case SQXC_TYPE_UINT:
+		ok = ok && record_read(&cur, end, &value.i32, sizeof(value.i32));
+		xc->value.integer = value.i32;
+		break;
+
+	case SQXC_TYPE_INT64:
+	case SQXC_TYPE_UINT64:
+		ok = ok && record_read(&cur, end, &value.i64, sizeof(value.i64));
+		xc->value.int64 = value.i64;
+		break;
+
+	case SQXC_TYPE_TIME:
+		ok = ok && record_read(&cur, end, &value.i64, sizeof(value.i64));
+		xc->value.rawtime = (time_t)value.i64;
+		break;
+
+	case SQXC_TYPE_DOUBLE:
+		ok = ok && record_read(&cur, end, &value.dbl, sizeof(value.dbl));
+		xc->value.double_ = value.dbl;
+		break;
+
+	case SQXC_TYPE_STR:
+	case SQXC_TYPE_RAW:
+		ok = ok && record_read_str(&cur, end, &xc->value.str);
+		break;
+
+	default:
+		break;
+	}
+
+	// record is truncated
+	if (ok == false)
+		return 0;
+	return cur - data;
+}
+
+int   sqxc_record_replay(const char *data, size_t length, Sqxc *dest)
+{
+	Sqxc   *xc = dest;
+	size_t  n;
+
+	while (length > 0) {
+		n = sqxc_record_read(data, length, xc);
+		if (n == 0)
+			return SQCODE_ERROR;
+		data   += n;
+		length -= n;
+
+		xc = sqxc_send(xc);
+		if (xc->code != SQCODE_OK && xc->code != SQCODE_ENTRY_NOT_FOUND)
+			return xc->code;
+	}
+	return SQCODE_OK;
+}
+
+char *sqxc_record_write_instance(const SqType *type, const SqType *container_type,
+                                 void *instance, size_t *length)
+{
+	SqxcRecord  xcrecord;
+	SqType      type_temp;
+	char       *data;
+
+	if (container_type) {
+		// container_type->write() gets element type from SqType::entry if SqType::n_entry == -1
+		if (container_type->n_entry != -1 || container_type->entry == NULL) {
+			type_temp = *container_type;
+			type_temp.entry   = (SqEntry**)type;
+			type_temp.n_entry = -1;
+			container_type = &type_temp;
+		}
+		type = container_type;
+	}
+
+	sqxc_init((Sqxc*)&xcrecord, SQXC_INFO_RECORD);
+	sqxc_ready((Sqxc*)&xcrecord, NULL);
+	xcrecord.name = NULL;
+	type->write(instance, type, (Sqxc*)&xcrecord);
+	sqxc_finish((Sqxc*)&xcrecord, NULL);
+
+	// steal recorded data from SqxcRecord
+	*length = xcrecord.buf_writed;
+	data = realloc(xcrecord.buf, (*length) ? *length : 1);
+	xcrecord.buf = NULL;
+	sqxc_final((Sqxc*)&xcrecord);
+	return data;
+}
+
+void *sqxc_record_parse_instance(const char *data, size_t length,
+                                 const SqType *type, const SqType *container_type)
+{
+	SqxcValue  xcvalue;
+	void      *instance;
+	int        code;
+
+	sqxc_init((Sqxc*)&xcvalue, SQXC_INFO_VALUE);
+	xcvalue.element   = type;
+	xcvalue.container = container_type;
+	xcvalue.instance  = NULL;
+
+	sqxc_ready((Sqxc*)&xcvalue, NULL);
+	code = sqxc_record_replay(data, length, (Sqxc*)&xcvalue);
+	sqxc_finish((Sqxc*)&xcvalue, NULL);
+	instance = xcvalue.instance;
+	sqxc_final((Sqxc*)&xcvalue);
+
+	if (code != SQCODE_OK && instance) {
+		sq_type_final_instance((container_type) ? container_type : type, instance, false);
+		free(instance);
+		instance = NULL;
+	}
+	return instance;
+}
+
+// ----------------------------------------------------------------------------
+// SqxcInfo
+
+const SqxcInfo sqxcInfo_Record =
+{
+	sizeof(SqxcRecord),
+	(SqInitFunc)sqxc_record_init,
+	NULL,
+	(SqxcCtrlFunc)sqxc_record_ctrl,
+	(SqxcSendFunc)sqxc_record_send,
+};
@@ -0,0 +1,174 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifndef SQXC_RECORD_H
+#define SQXC_RECORD_H
+
+#include <sqxc/Sqxc.h>
+#include <sqxc/SqType.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqxcRecord       SqxcRecord;
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const SqxcInfo        sqxcInfo_Record;
+#define SQXC_INFO_RECORD   (&sqxcInfo_Record)
+
+//Sqxc* sqxc_record_new();
+#define sqxc_record_new()        sqxc_new(SQXC_INFO_RECORD)
+
+// macro for accessing recorded data of SqxcRecord
+
+// const char *sqxc_record_data(Sqxc *xcrecord);
+#define sqxc_record_data(xcrecord)        ( ((SqxcRecord*)xcrecord)->buf )
+// size_t sqxc_record_length(Sqxc *xcrecord);
+#define sqxc_record_length(xcrecord)      ( ((SqxcRecord*)xcrecord)->buf_writed )
+
+// read a record from 'data' to arguments of 'xc' (type, name, and value). 'name' and string value point to 'data'.
+// return length of the record, or 0 if 'data' is truncated.
+size_t  sqxc_record_read(const char *data, size_t length, Sqxc *xc);
+
+// send 'data' that was recorded by SqxcRecord to 'dest' (e.g. SqxcValue).
+// return SQCODE_OK or error code of Sqxc chain.
+int     sqxc_record_replay(const char *data, size_t length, Sqxc *dest);
+
+// record 'instance' of 'type'. If 'container_type' is not NULL, 'instance' is container of 'type' elements.
+// return recorded data that must be freed by caller and set 'length'. Unlike pointers, it can be shared by threads.
+char   *sqxc_record_write_instance(const SqType *type, const SqType *container_type,
+                                   void *instance, size_t *length);
+
+// create new instance (or container if 'container_type' is not NULL) from data that was recorded by
+// sqxc_record_write_instance(). return NULL if data doesn't match 'type'.
+void   *sqxc_record_parse_instance(const char *data, size_t length,
+                                   const SqType *type, const SqType *container_type);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqxcRecord - record data that it receives to compact binary form. (destination of output chain)
+
+	Sqxc
+	|
+	`--- SqxcRecord
+
+	( output )                       ( input )
+	SqType::write() ---> SqxcRecord  ...  sqxc_record_replay() ---> SqxcValue ---> SqType::parse()
+
+	Recorded data is stored in Sqxc::buf and it is cleared by sqxc_ready().
+	It doesn't have pointer, so it can be copied, saved to file, and replayed to other Sqxc later.
+	Each record has type, name, and value. Integers are stored in native byte order.
+ */
+
+#ifdef __cplusplus
+struct SqxcRecord : Sq::XcMethod         // <-- 1. inherit C++ member function(method)
+#else
+struct SqxcRecord
+#endif
+{
+	SQXC_MEMBERS;                        // <-- 2. inherit member variable
+/*	// ------ Sqxc members ------
+	const SqxcInfo  *info;
+
+	// Sqxc chain
+	Sqxc        *peer;     // pointer to other Sqxc elements (single linked list)
+	Sqxc        *dest;     // pointer to current destination in Sqxc chain (data flow)
+
+	// stack of SqxcNested
+	SqxcNested  *nested;          // current nested object/array
+	int          nested_count;
+
+	// ------------------------------------------
+	// Buffer - recorded data. To resize this buf:
+	// buf = realloc(buf, buf_size);
+
+//	SQ_BUFFER_MEMBERS(buf, buf_size, buf_writed);
+	char        *buf;
+	size_t       buf_size;
+	size_t       buf_writed;
+
+	// ------------------------------------------
+	// properties
+
+	uint16_t     supported_type;  // supported SqxcType (bit field) for inputting, it can change at runtime.
+//	uint16_t     outputable_type; // supported SqxcType (bit field) for outputting, it can change at runtime.
+
+	// ------------------------------------------
+	// arguments that used by SqxcInfo::send()
+
+	// output arguments
+//	uint16_t     required_type;   // required SqxcType (bit field) if 'code' == SQCODE_TYPE_NOT_MATCHED
+	uint16_t     code;            // error code (SQCODE_xxxx)
+
+	// input arguments
+	uint16_t     type;            // input SqxcType
+	const char  *name;
+	SqValue      value;           // union SqValue defined in SqDefine.h
+
+	// special input arguments
+	SqEntry     *entry;           // SqxcJson and SqxcSql use it to decide output. this can be NULL (optional).
+
+	// input / output arguments
+	void       **error;
+ */
+};
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+struct XcRecord : SqxcRecord
+{
+	// constructor
+	XcRecord() {
+		sqxc_init((Sqxc*)this, SQXC_INFO_RECORD);
+	}
+	// destructor
+	~XcRecord() {
+		sqxc_final((Sqxc*)this);
+	}
+
+	const char *data() {
+		return this->buf;
+	}
+	size_t      length() {
+		return this->buf_writed;
+	}
+
+	int   replay(Sqxc *dest) {
+		return sqxc_record_replay(this->buf, this->buf_writed, dest);
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+
+#endif  // SQXC_RECORD_H
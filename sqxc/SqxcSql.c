@@ -18,6 +18,8 @@
 #include <limits.h>            // __WORDSIZE
 #include <stdint.h>            // __WORDSIZE  for Apple Developer
 #include <stdio.h>             // snprintf()
+#include <stdlib.h>            // malloc(), free()
+#include <string.h>            // strcmp(), strlen()
 #include <inttypes.h>          // PRId64, PRIu64
 
 #include <sqxc/SqError.h>
@@ -45,7 +47,56 @@
 
 static void sqxc_sql_use_insert_command(SqxcSql *xcsql, const char *table_name);
 static void sqxc_sql_use_update_command(SqxcSql *xcsql, const char *table_name);
+static void sqxc_sql_use_copy_command(SqxcSql *xcsql, const char *table_name);
 static int  sqxc_sql_write_value(SqxcSql *xcsql, Sqxc *src, SqBuffer *buffer);
+static int  sqxc_sql_write_copy_value(SqxcSql *xcsql, Sqxc *src, SqBuffer *buffer);
+static int  sqxc_sql_flush_copy_data(SqxcSql *xcsql);
+static int  sqxc_sql_exec_insert(SqxcSql *xcsql);
+static void sqxc_sql_add_update_row(SqxcSql *xcsql);
+static int  sqxc_sql_exec_update_many(SqxcSql *xcsql);
+
+typedef struct SqxcSqlCase    SqxcSqlCase;
+
+// CASE expression of column in UPDATE multiple rows
+struct SqxcSqlCase
+{
+	const char  *name;    // column name
+	SqBuffer     buf;     // " WHEN key THEN value" of rows. It is list of keys if column is primary key.
+};
+
+static SqxcSqlCase *sqxc_sql_case_new(const char *name)
+{
+	SqxcSqlCase *xccase;
+
+	xccase = malloc(sizeof(SqxcSqlCase));
+	xccase->name = name;
+	sq_buffer_init(&xccase->buf);
+	return xccase;
+}
+
+static void  sqxc_sql_case_free(SqxcSqlCase *xccase)
+{
+	sq_buffer_final(&xccase->buf);
+	free(xccase);
+}
+
+// return true if Database generates value of column. (AUTO INCREMENT or DEFAULT CURRENT_XXXX and value is 0)
+static bool sqxc_sql_is_generated(Sqxc *src, SqEntry *entry)
+{
+	// column that has AUTO INCREMENT and value.integer is 0
+	if (entry->bit_field & SQB_COLUMN_AUTOINCREMENT) {
+		if (src->value.int64 == 0)    //  && (entry->type == SQ_TYPE_INT64 || entry->type == SQ_TYPE_UINT64)
+			return true;
+		if (src->value.int_  == 0 && (entry->type == SQ_TYPE_INT   || entry->type == SQ_TYPE_UINT))
+			return true;
+	}
+	// column that has DEFAULT CURRENT_XXXX and value.rawtime is 0
+	if (entry->type == SQ_TYPE_TIME && src->type == SQXC_TYPE_TIME && src->value.rawtime == 0) {
+		if (entry->bit_field & SQB_COLUMN_CURRENT)
+			return true;
+	}
+	return false;
+}
 
 /* ----------------------------------------------------------------------------
 	SqxcInfo functions - destination of output chain
@@ -83,7 +134,8 @@ static int  sqxc_sql_send_insert_command(SqxcSql *xcsql, Sqxc *src)
 		xcsql->supported_type &= ~(SQXC_TYPE_OBJECT | SQXC_TYPE_ARRAY);
 		xcsql->supported_type |= SQXC_TYPE_END;
 		// --- Begin of row ---
-		if (xcsql->row_count)
+		// values_buf is empty after split statement is executed
+		if (values_buf->writed)
 			sq_buffer_write_c(values_buf, ',');
 		sq_buffer_write_c(values_buf, '(');
 		xcsql->row_count++;
@@ -101,6 +153,14 @@ static int  sqxc_sql_send_insert_command(SqxcSql *xcsql, Sqxc *src)
 			sq_buffer_write_c(values_buf, 0);    // null-terminated
 			// SQL INSERT VALUES has written in xcsql->values_buf
 		}
+		// split INSERT with multiple rows if it is too long
+		else if (xcsql->db && (xcsql->row_count - xcsql->row_sent >= SQ_CONFIG_SQXC_SQL_INSERT_ROWS ||
+		                       names_buf->writed + values_buf->writed >= SQ_CONFIG_SQXC_SQL_INSERT_SIZE))
+		{
+			sq_buffer_write_c(values_buf, 0);    // null-terminated
+			if (sqxc_sql_exec_insert(xcsql) != SQCODE_OK)
+				return (src->code = SQCODE_EXEC_ERROR);
+		}
 		return (src->code = SQCODE_OK);
 
 	case SQXC_TYPE_ARRAY_END:
@@ -124,38 +184,37 @@ static int  sqxc_sql_send_insert_command(SqxcSql *xcsql, Sqxc *src)
 		if (entry->bit_field & SQB_COLUMN_QUERY)
 			return (src->code = SQCODE_OK);
 #endif
-		// Don't output column that has AUTO INCREMENT and value.integer is 0
-		if (entry->bit_field & SQB_COLUMN_AUTOINCREMENT) {
-			if (src->value.int64 == 0)    //  && (entry->type == SQ_TYPE_INT64 || entry->type == SQ_TYPE_UINT64)
-				return (src->code = SQCODE_OK);
-			if (src->value.int_  == 0 && (entry->type == SQ_TYPE_INT   || entry->type == SQ_TYPE_UINT))
-				return (src->code = SQCODE_OK);
-		}
-		// Don't output column that has DEFAULT CURRENT_XXXX and value.rawtime is 0
-		if (entry->type == SQ_TYPE_TIME && src->type == SQXC_TYPE_TIME && src->value.rawtime == 0) {
-			if (entry->bit_field & SQB_COLUMN_CURRENT)
-				return (src->code = SQCODE_OK);
-		}
+		// Don't output column that has AUTO INCREMENT or DEFAULT CURRENT_XXXX and value is 0
+		if (sqxc_sql_is_generated(src, entry))
+			return (src->code = SQCODE_OK);
 	}
 
+	// column names have been written in the first row if it is multiple row
+	if (xcsql->row_count > 1)
+		names_buf = NULL;
+
 	// SQL statement multiple columns
 	if (xcsql->col_count) {
-		sq_buffer_write_c(names_buf, ',');
+		if (names_buf)
+			sq_buffer_write_c(names_buf, ',');
 		sq_buffer_write_c(values_buf, ',');
 	}
 
 	// value
 	if (sqxc_sql_write_value(xcsql, src, values_buf) != SQCODE_OK) {
 		if (xcsql->col_count) {
-			names_buf->writed--;     // remove ',' from names_buf
+			if (names_buf)
+				names_buf->writed--;     // remove ',' from names_buf
 			values_buf->writed--;    // remove ',' form values_buf
 		}
 	}
 	// "name"
 	else {
-		sq_buffer_write_c(names_buf, xcsql->quote[0]);
-		sq_buffer_write(names_buf, src->name);
-		sq_buffer_write_c(names_buf, xcsql->quote[1]);
+		if (names_buf) {
+			sq_buffer_write_c(names_buf, xcsql->quote[0]);
+			sq_buffer_write(names_buf, src->name);
+			sq_buffer_write_c(names_buf, xcsql->quote[1]);
+		}
 
 		xcsql->col_count++;
 	}
@@ -255,11 +314,236 @@ static int  sqxc_sql_send_update_command(SqxcSql *xcsql, Sqxc *src)
 	return src->code;
 }
 
+static int  sqxc_sql_send_copy_command(SqxcSql *xcsql, Sqxc *src)
+{
+	SqBuffer *values_buf = &xcsql->values_buf;
+	SqBuffer *names_buf = sqxc_get_buffer(xcsql);
+	SqEntry  *entry;
+
+	switch (src->type) {
+	case SQXC_TYPE_ARRAY:
+		if (xcsql->outer_type & (SQXC_TYPE_ARRAY | SQXC_TYPE_OBJECT))
+			return (src->code = SQCODE_TYPE_NOT_MATCHED);
+		xcsql->outer_type |= SQXC_TYPE_ARRAY;
+		xcsql->supported_type &= ~SQXC_TYPE_ARRAY;
+		xcsql->supported_type |= SQXC_TYPE_END;
+		return (src->code = SQCODE_OK);
+
+	case SQXC_TYPE_OBJECT:
+		if (xcsql->outer_type & SQXC_TYPE_OBJECT)
+			return (src->code = SQCODE_TYPE_NOT_MATCHED);
+		xcsql->outer_type |= SQXC_TYPE_OBJECT;
+		xcsql->supported_type &= ~(SQXC_TYPE_OBJECT | SQXC_TYPE_ARRAY);
+		xcsql->supported_type |= SQXC_TYPE_END;
+		// --- Begin of row ---
+		xcsql->row_count++;
+		xcsql->col_count = 0;
+		return (src->code = SQCODE_OK);
+
+	case SQXC_TYPE_OBJECT_END:
+		if ((xcsql->outer_type & SQXC_TYPE_OBJECT) == 0)
+			return (src->code = SQCODE_TYPE_END_ERROR);
+		xcsql->outer_type &= ~SQXC_TYPE_OBJECT;
+		xcsql->supported_type |= SQXC_TYPE_OBJECT;
+		// --- End of row ---
+		sq_buffer_write_c(values_buf, '\n');
+		// the first row decides columns of COPY statement
+		if (xcsql->copy_cols == 0) {
+			sq_buffer_write(names_buf, ") FROM STDIN");
+			sq_buffer_write_c(names_buf, 0);    // null-terminated
+			if (xcsql->col_count == 0 || sqdb_copy_begin(xcsql->db, names_buf->mem) != SQCODE_OK)
+				return (src->code = SQCODE_EXEC_ERROR);
+			xcsql->copy_cols = xcsql->col_count;
+		}
+		else if (xcsql->col_count != xcsql->copy_cols) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: row %d has %d columns, but COPY statement has %d columns.\n",
+			        "SqxcSql", xcsql->row_count, xcsql->col_count, xcsql->copy_cols);
+#endif
+			return (src->code = SQCODE_EXEC_ERROR);
+		}
+		// send buffered data to Sqdb
+		if (values_buf->writed >= SQ_CONFIG_SQXC_SQL_COPY_SIZE)
+			return (src->code = sqxc_sql_flush_copy_data(xcsql));
+		return (src->code = SQCODE_OK);
+
+	case SQXC_TYPE_ARRAY_END:
+		if ((xcsql->outer_type & SQXC_TYPE_ARRAY) == 0)
+			return (src->code = SQCODE_TYPE_END_ERROR);
+		xcsql->outer_type &= ~SQXC_TYPE_ARRAY;
+		xcsql->supported_type |= SQXC_TYPE_ARRAY;
+		return (src->code = SQCODE_OK);
+
+	default:
+		break;
+	}
+
+	entry = src->entry;
+	if (entry) {
+#if SQ_CONFIG_QUERY_ONLY_COLUMN
+		// Don't output query-only columns
+		if (entry->bit_field & SQB_COLUMN_QUERY)
+			return (src->code = SQCODE_OK);
+#endif
+		// Every row must output the same columns, the first row decides which generated columns are skipped.
+		if (xcsql->copy_cols == 0) {
+			if (sqxc_sql_is_generated(src, entry)) {
+				sq_ptr_array_push(&xcsql->columns, entry);
+				return (src->code = SQCODE_OK);
+			}
+		}
+		else {
+			for (unsigned int index = 0;  index < xcsql->columns.length;  index++) {
+				if (xcsql->columns.data[index] == entry)
+					return (src->code = SQCODE_OK);
+			}
+		}
+	}
+
+	// COPY data multiple columns
+	if (xcsql->col_count)
+		sq_buffer_write_c(values_buf, '\t');
+
+	// value
+	if (sqxc_sql_write_copy_value(xcsql, src, values_buf) != SQCODE_OK) {
+		if (xcsql->col_count)
+			values_buf->writed--;    // remove '\t' form values_buf
+		return src->code;
+	}
+	xcsql->col_count++;
+
+	// "name" of the first row
+	if (xcsql->copy_cols == 0) {
+		if (xcsql->col_count > 1)
+			sq_buffer_write_c(names_buf, ',');
+		sq_buffer_write_c(names_buf, xcsql->quote[0]);
+		sq_buffer_write(names_buf, src->name);
+		sq_buffer_write_c(names_buf, xcsql->quote[1]);
+	}
+
+	return src->code;
+}
+
+static int  sqxc_sql_send_update_many_command(SqxcSql *xcsql, Sqxc *src)
+{
+	SqBuffer     *values_buf = &xcsql->values_buf;
+	SqxcSqlCase  *xccase;
+	SqEntry      *entry;
+	unsigned int  index;
+	size_t        len;
+
+	switch (src->type) {
+	case SQXC_TYPE_ARRAY:
+		if (xcsql->outer_type & (SQXC_TYPE_ARRAY | SQXC_TYPE_OBJECT))
+			return (src->code = SQCODE_TYPE_NOT_MATCHED);
+		xcsql->outer_type |= SQXC_TYPE_ARRAY;
+		xcsql->supported_type &= ~SQXC_TYPE_ARRAY;
+		xcsql->supported_type |= SQXC_TYPE_END;
+		return (src->code = SQCODE_OK);
+
+	case SQXC_TYPE_OBJECT:
+		if (xcsql->outer_type & SQXC_TYPE_OBJECT)
+			return (src->code = SQCODE_TYPE_NOT_MATCHED);
+		xcsql->outer_type |= SQXC_TYPE_OBJECT;
+		xcsql->supported_type &= ~(SQXC_TYPE_OBJECT | SQXC_TYPE_ARRAY);
+		xcsql->supported_type |= SQXC_TYPE_END;
+		// --- Begin of row ---
+		values_buf->writed = 0;
+		xcsql->row_count++;
+		return (src->code = SQCODE_OK);
+
+	case SQXC_TYPE_OBJECT_END:
+		if ((xcsql->outer_type & SQXC_TYPE_OBJECT) == 0)
+			return (src->code = SQCODE_TYPE_END_ERROR);
+		xcsql->outer_type &= ~SQXC_TYPE_OBJECT;
+		xcsql->supported_type |= SQXC_TYPE_OBJECT;
+		// --- End of row ---
+		sqxc_sql_add_update_row(xcsql);
+		// split UPDATE with multiple rows if it is too long
+		if ((xcsql->outer_type & SQXC_TYPE_ARRAY) && xcsql->db) {
+			len = 0;
+			for (index = 0;  index < xcsql->cases.length;  index++)
+				len += ((SqxcSqlCase*)xcsql->cases.data[index])->buf.writed;
+			if (xcsql->row_count - xcsql->row_sent >= SQ_CONFIG_SQXC_SQL_UPDATE_ROWS ||
+			    len >= SQ_CONFIG_SQXC_SQL_INSERT_SIZE)
+			{
+				if (sqxc_sql_exec_update_many(xcsql) != SQCODE_OK)
+					return (src->code = SQCODE_EXEC_ERROR);
+			}
+		}
+		return (src->code = SQCODE_OK);
+
+	case SQXC_TYPE_ARRAY_END:
+		if ((xcsql->outer_type & SQXC_TYPE_ARRAY) == 0)
+			return (src->code = SQCODE_TYPE_END_ERROR);
+		xcsql->outer_type &= ~SQXC_TYPE_ARRAY;
+		xcsql->supported_type |= SQXC_TYPE_ARRAY;
+		return (src->code = SQCODE_OK);
+
+	default:
+		break;
+	}
+
+	entry = src->entry;
+	if (entry && entry->bit_field & SQB_COLUMN_PRIMARY) {
+		// the first CASE is primary key
+		index = 0;
+		xccase = xcsql->cases.data[0];
+		xccase->name = src->name;
+	}
+	else {
+		if (entry) {
+			// output specified columns
+			if (xcsql->columns.length > 0) {
+				if (xcsql->columns_sorted == false) {
+					xcsql->columns_sorted =  true;
+					sq_ptr_array_sort(&xcsql->columns, sq_compare_ptr);
+				}
+				// skip unspecified columns
+				if (sq_ptr_array_search(&xcsql->columns, &entry, sq_compare_ptr) == NULL)
+					return (src->code = SQCODE_OK);
+			}
+#if SQ_CONFIG_QUERY_ONLY_COLUMN
+			// Don't output query-only columns
+			if (entry->bit_field & SQB_COLUMN_QUERY)
+				return (src->code = SQCODE_OK);
+#endif
+			// Don't output column that has DEFAULT CURRENT_XXXX and value.rawtime is 0
+			if (entry->type == SQ_TYPE_TIME && src->type == SQXC_TYPE_TIME && src->value.rawtime == 0) {
+				if (entry->bit_field & SQB_COLUMN_CURRENT_ALL)
+					return (src->code = SQCODE_OK);
+			}
+		}
+		// find CASE of column. Every row has the same columns in most cases.
+		for (index = 1;  index < xcsql->cases.length;  index++) {
+			xccase = xcsql->cases.data[index];
+			if (strcmp(xccase->name, src->name) == 0)
+				break;
+		}
+		if (index == xcsql->cases.length)
+			sq_ptr_array_push(&xcsql->cases, sqxc_sql_case_new(src->name));
+	}
+
+	// values of row are kept in values_buf until primary key is known. format: index of CASE + value + '\0'
+	len = values_buf->writed;
+	memcpy(sq_buffer_alloc(values_buf, sizeof(unsigned int)), &index, sizeof(unsigned int));
+	if (sqxc_sql_write_value(xcsql, src, values_buf) != SQCODE_OK)
+		values_buf->writed = len;
+	else
+		sq_buffer_write_c(values_buf, 0);    // null-terminated
+
+	return src->code;
+}
+
 static int  sqxc_sql_send(SqxcSql *xcsql, Sqxc *src)
 {
-	// 1 == INSERT, 0 == UPDATE
+	// 1 == INSERT, 0 == UPDATE, 2 == COPY, 3 == UPDATE multiple rows
 	if (xcsql->mode == 1)
 		return sqxc_sql_send_insert_command(xcsql, src);
+	else if (xcsql->mode == 2)
+		return sqxc_sql_send_copy_command(xcsql, src);
+	else if (xcsql->mode == 3)
+		return sqxc_sql_send_update_many_command(xcsql, src);
 	else
 		return sqxc_sql_send_update_command(xcsql, src);
 }
@@ -278,41 +562,90 @@ static int  sqxc_sql_ctrl(SqxcSql *xcsql, int id, void *data)
 		break;
 
 	case SQXC_CTRL_FINISH:
-		// write INSERT VALUES to xcsql->buf
-		if (xcsql->mode == 1) {
-			SqBuffer *buffer = sqxc_get_buffer(xcsql);
-			SqBuffer *values = &xcsql->values_buf;
-	
-			// length of ") VALUES " is 9
-			sq_buffer_resize(buffer, buffer->writed + 9 + values->writed + 1);
-			sq_buffer_write(buffer, ") VALUES ");
-			sq_buffer_write_len(buffer, values->mem, values->writed);
-			// reset values buffer
-			values->writed = 0;
+		code = SQCODE_OK;
+		// send remaining COPY data and end COPY. 'data' is error message to abort COPY.
+		if (xcsql->mode == 2) {
+			if (xcsql->copy_cols > 0) {
+				if (data == NULL && sqxc_sql_flush_copy_data(xcsql) != SQCODE_OK)
+					data = "SqxcSql: failed to send COPY data";
+				code = sqdb_copy_end(xcsql->db, data, &xcsql->changes);
+				if (data)
+					code = SQCODE_EXEC_ERROR;
+			}
+			xcsql->copy_cols = 0;
+			// COPY doesn't execute xcsql->buf
+			xcsql->buf_writed = 0;
+		}
+		// nothing to insert if it received empty array or all rows have been inserted by split statements
+		else if (xcsql->mode == 1 && xcsql->values_buf.writed == 0)
+			xcsql->buf_writed = 0;
+		// write INSERT VALUES to xcsql->buf and execute it
+		else if (xcsql->mode == 1) {
+			code = sqxc_sql_exec_insert(xcsql);
+			// don't execute xcsql->buf again
+			if (xcsql->db)
+				xcsql->buf_writed = 0;
+		}
+		// write UPDATE with CASE expressions to xcsql->buf and execute it
+		else if (xcsql->mode == 3) {
+			code = sqxc_sql_exec_update_many(xcsql);
+			sq_ptr_array_erase(&xcsql->cases, 0, xcsql->cases.length);
+			// don't execute xcsql->buf again
+			if (xcsql->db)
+				xcsql->buf_writed = 0;
 		}
 		// SQL statement has written in xcsql->buf
-		if (xcsql->db && xcsql->buf_writed > 0) {
-			code = sqdb_exec(xcsql->db, xcsql->buf, (Sqxc*)xcsql, NULL);
-			if (code != SQCODE_OK)
-				return (xcsql->code = SQCODE_EXEC_ERROR);
+		if (code == SQCODE_OK && xcsql->db && xcsql->buf_writed > 0) {
+			if (sqdb_exec(xcsql->db, xcsql->buf, (Sqxc*)xcsql, NULL) != SQCODE_OK)
+				code = SQCODE_EXEC_ERROR;
 		}
+		// reset on every path because SqxcSql is reused by next operation even if this one failed.
 		// clear SqxcNested if problem occurred during processing
 		sqxc_clear_nested((Sqxc*)xcsql);
 		// reset buffer
 		xcsql->buf_writed = 0;
+		xcsql->values_buf.writed = 0;
 		// reset UPDATE command variable
 		xcsql->condition = NULL;
 		xcsql->columns.length = 0;
 		xcsql->columns_sorted = false;
+		if (code != SQCODE_OK)
+			return (xcsql->code = code);
 		break;
 
 	case SQXC_SQL_CTRL_INSERT:
 		xcsql->mode = 1;
 		xcsql->row_count = 0;
+		xcsql->row_sent = 0;
 //		xcsql->col_count = 0;
 		sqxc_sql_use_insert_command(xcsql, data);
 		break;
 
+	case SQXC_SQL_CTRL_COPY:
+		xcsql->mode = 2;
+		xcsql->row_count = 0;
+		xcsql->copy_cols = 0;
+		// SqxcSql::columns stores generated columns that COPY skips
+		if (xcsql->columns.data == NULL)
+			sq_ptr_array_init(&xcsql->columns, 0, NULL);
+		xcsql->columns.length = 0;
+		xcsql->values_buf.writed = 0;
+		sqxc_sql_use_copy_command(xcsql, data);
+		break;
+
+	case SQXC_SQL_CTRL_UPDATE_MANY:
+		xcsql->mode = 3;
+		xcsql->row_count = 0;
+		xcsql->row_sent = 0;
+		if (xcsql->cases.data == NULL)
+			sq_ptr_array_init(&xcsql->cases, 8, (SqClearFunc)sqxc_sql_case_free);
+		sq_ptr_array_erase(&xcsql->cases, 0, xcsql->cases.length);
+		// name of primary key is set when it is received
+		sq_ptr_array_push(&xcsql->cases, sqxc_sql_case_new(NULL));
+		xcsql->values_buf.writed = 0;
+		sqxc_sql_use_update_command(xcsql, data);
+		break;
+
 	case SQXC_SQL_CTRL_UPDATE:
 		xcsql->mode = 0;
 //		xcsql->row_count = 0;
@@ -343,15 +676,20 @@ static void  sqxc_sql_init(SqxcSql *xcsql)
 //	xcsql->condition = NULL;
 	xcsql->columns.data = NULL;
 	xcsql->columns_sorted = false;
+	xcsql->cases.data = NULL;
+	xcsql->copy_cols = 0;
 	// Sqdb result variable
 	xcsql->id = 0;
 	xcsql->changes = 0;
+	xcsql->ids = NULL;
+	xcsql->suffix = NULL;
 }
 
 static void  sqxc_sql_final(SqxcSql *xcsql)
 {
 	sq_buffer_final(&xcsql->values_buf);
 	sq_ptr_array_final(&xcsql->columns);
+	sq_ptr_array_final(&xcsql->cases);
 }
 
 // ----------------------------------------------------------------------------
@@ -396,6 +734,276 @@ static void sqxc_sql_use_update_command(SqxcSql *xcsql, const char *table_name)
 	xcsql->buf_reuse = xcsql->buf_writed;
 }
 
+static void sqxc_sql_use_copy_command(SqxcSql *xcsql, const char *table_name)
+{
+	SqBuffer  *buffer;
+
+	buffer = sqxc_get_buffer(xcsql);
+	buffer->writed = 0;
+	// "COPY "table_name" ("column1","column2") FROM STDIN"
+	sq_buffer_write(buffer, "COPY");
+	sq_buffer_alloc(buffer, 2);
+	sq_buffer_r_at(buffer, 1) = ' ';
+	sq_buffer_r_at(buffer, 0) = xcsql->quote[0];
+	sq_buffer_write(buffer, table_name);
+	sq_buffer_alloc(buffer, 3);
+	sq_buffer_r_at(buffer, 2) = xcsql->quote[1];
+	sq_buffer_r_at(buffer, 1) = ' ';
+	sq_buffer_r_at(buffer, 0) = '(';
+}
+
+// write INSERT VALUES to xcsql->buf and execute it. names of columns in xcsql->buf are kept for next split statement.
+static int  sqxc_sql_exec_insert(SqxcSql *xcsql)
+{
+	SqBuffer *buffer = sqxc_get_buffer(xcsql);
+	SqBuffer *values = &xcsql->values_buf;
+	size_t    names_len = buffer->writed;
+	int64_t   changes = xcsql->changes;
+	int64_t   first;
+	unsigned int  n_ids;
+	int       n_rows;
+	int       code = SQCODE_OK;
+
+	// length of ") VALUES " is 9
+	sq_buffer_resize(buffer, buffer->writed + 9 + values->writed + 1);
+	sq_buffer_write(buffer, ") VALUES ");
+	sq_buffer_write_len(buffer, values->mem, values->writed);
+	// append clause to INSERT statement. e.g. ON CONFLICT DO UPDATE
+	if (xcsql->suffix) {
+		buffer->writed--;    // remove null-terminated
+		sq_buffer_write_len(buffer, xcsql->suffix, strlen(xcsql->suffix) + 1);
+	}
+	// reset values buffer
+	values->writed = 0;
+	n_rows = xcsql->row_count - xcsql->row_sent;
+	xcsql->row_sent = xcsql->row_count;
+
+	// SQL statement has written in xcsql->buf
+	if (xcsql->db == NULL)
+		return SQCODE_OK;
+	n_ids = (xcsql->ids) ? xcsql->ids->length : 0;
+	code = sqdb_exec(xcsql->db, xcsql->buf, (Sqxc*)xcsql, NULL);
+	buffer->writed = names_len;
+	if (code != SQCODE_OK)
+		return SQCODE_EXEC_ERROR;
+	// number of rows inserted by all split statements
+	xcsql->changes += changes;
+
+	// PostgreSQL appends ids of all rows returned by " RETURNING id" to xcsql->ids.
+	// They may not be consecutive if other sessions insert rows at the same time.
+	if (xcsql->ids && xcsql->ids->length == n_ids && xcsql->id > 0) {
+		// MySQL returns id of the first row, others return id of the last row.
+		// ids are consecutive in a statement of SQLite and MySQL.
+		if (xcsql->db->info->product == SQDB_PRODUCT_MYSQL)
+			first = xcsql->id;
+		else
+			first = xcsql->id - n_rows + 1;
+		for (int index = 0;  index < n_rows;  index++)
+			sq_array_push(xcsql->ids, int64_t, first + index);
+	}
+	return SQCODE_OK;
+}
+
+// append values of current row to CASE expressions. values of row are in xcsql->values_buf.
+static void sqxc_sql_add_update_row(SqxcSql *xcsql)
+{
+	SqBuffer     *values_buf = &xcsql->values_buf;
+	SqxcSqlCase  *xccase;
+	const char   *key = NULL;
+	const char   *value;
+	unsigned int  index;
+	size_t        cur;
+
+	// find value of primary key
+	for (cur = 0;  cur < values_buf->writed;  cur += strlen(value) + 1) {
+		memcpy(&index, values_buf->mem + cur, sizeof(unsigned int));
+		cur  += sizeof(unsigned int);
+		value = values_buf->mem + cur;
+		if (index == 0)
+			key = value;
+	}
+	if (key == NULL) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: row %d doesn't have primary key. It can't be updated.\n",
+		        "SqxcSql", xcsql->row_count);
+#endif
+		return;
+	}
+
+	// list of keys for WHERE "id" IN (key1,key2)
+	xccase = xcsql->cases.data[0];
+	if (xccase->buf.writed)
+		sq_buffer_write_c(&xccase->buf, ',');
+	sq_buffer_write(&xccase->buf, key);
+
+	// " WHEN key THEN value"
+	for (cur = 0;  cur < values_buf->writed;  cur += strlen(value) + 1) {
+		memcpy(&index, values_buf->mem + cur, sizeof(unsigned int));
+		cur  += sizeof(unsigned int);
+		value = values_buf->mem + cur;
+		if (index == 0)
+			continue;
+		xccase = xcsql->cases.data[index];
+		sq_buffer_write(&xccase->buf, " WHEN ");
+		sq_buffer_write(&xccase->buf, key);
+		sq_buffer_write(&xccase->buf, " THEN ");
+		sq_buffer_write(&xccase->buf, value);
+	}
+	values_buf->writed = 0;
+}
+
+static void sqxc_sql_write_name(SqxcSql *xcsql, SqBuffer *buffer, const char *name)
+{
+	sq_buffer_write_c(buffer, xcsql->quote[0]);
+	sq_buffer_write(buffer, name);
+	sq_buffer_write_c(buffer, xcsql->quote[1]);
+}
+
+// write UPDATE with CASE expressions to xcsql->buf and execute it.
+// "UPDATE" + table name + "SET" in xcsql->buf are kept for next split statement.
+// UPDATE "table" SET "column"=CASE "id" WHEN 1 THEN value1 WHEN 2 THEN value2 ELSE "column" END WHERE "id" IN (1,2)
+static int  sqxc_sql_exec_update_many(SqxcSql *xcsql)
+{
+	SqBuffer     *buffer = sqxc_get_buffer(xcsql);
+	SqxcSqlCase  *primary = xcsql->cases.data[0];
+	SqxcSqlCase  *xccase;
+	int64_t       changes = xcsql->changes;
+	int           n_columns = 0;
+	int           code;
+
+	for (unsigned int index = 1;  index < xcsql->cases.length && primary->buf.writed;  index++) {
+		xccase = xcsql->cases.data[index];
+		if (xccase->buf.writed == 0)
+			continue;
+		if (n_columns++)
+			sq_buffer_write_c(buffer, ',');
+		sqxc_sql_write_name(xcsql, buffer, xccase->name);
+		sq_buffer_write(buffer, "=CASE ");
+		sqxc_sql_write_name(xcsql, buffer, primary->name);
+		sq_buffer_write_len(buffer, xccase->buf.mem, xccase->buf.writed);
+		// rows that are not in this CASE keep original value
+		sq_buffer_write(buffer, " ELSE ");
+		sqxc_sql_write_name(xcsql, buffer, xccase->name);
+		sq_buffer_write(buffer, " END");
+		xccase->buf.writed = 0;
+	}
+	if (n_columns > 0) {
+		sq_buffer_write(buffer, " WHERE ");
+		sqxc_sql_write_name(xcsql, buffer, primary->name);
+		sq_buffer_write(buffer, " IN (");
+		sq_buffer_write_len(buffer, primary->buf.mem, primary->buf.writed);
+		sq_buffer_write_c(buffer, ')');
+		sq_buffer_write_c(buffer, 0);    // null-terminated
+	}
+	primary->buf.writed = 0;
+	xcsql->row_sent = xcsql->row_count;
+
+	// nothing to update
+	if (n_columns == 0) {
+		buffer->writed = xcsql->buf_reuse;
+		return SQCODE_OK;
+	}
+	// SQL statement has written in xcsql->buf
+	if (xcsql->db == NULL)
+		return SQCODE_OK;
+	code = sqdb_exec(xcsql->db, xcsql->buf, (Sqxc*)xcsql, NULL);
+	buffer->writed = xcsql->buf_reuse;
+	if (code != SQCODE_OK)
+		return SQCODE_EXEC_ERROR;
+	// number of rows changed by all split statements
+	xcsql->changes += changes;
+	return SQCODE_OK;
+}
+
+static int  sqxc_sql_flush_copy_data(SqxcSql *xcsql)
+{
+	SqBuffer *values_buf = &xcsql->values_buf;
+	int       code = SQCODE_OK;
+
+	if (values_buf->writed > 0) {
+		code = sqdb_copy_data(xcsql->db, values_buf->mem, values_buf->writed);
+		values_buf->writed = 0;
+	}
+	return code;
+}
+
+// write value in COPY text format
+static int  sqxc_sql_write_copy_value(SqxcSql *xcsql, Sqxc *src, SqBuffer *buffer)
+{
+	size_t  pos;
+	size_t  len;
+	union {
+		char        ch;
+		char       *str;
+		const char *constr;
+	} temp;
+
+	switch (src->type) {
+	case SQXC_TYPE_NULL:
+		sq_buffer_write(buffer, "\\N");
+		break;
+
+	case SQXC_TYPE_BOOL:
+		if (src->value.boolean)
+			temp.ch = 't';
+		else
+			temp.ch = 'f';
+		sq_buffer_write_c(buffer, temp.ch);
+		break;
+
+	case SQXC_TYPE_TIME:
+		temp.str = sq_time_to_string(src->value.rawtime, 0);
+		sq_buffer_write(buffer, temp.str);
+		free(temp.str);
+		break;
+
+	case SQXC_TYPE_STR:
+	case SQXC_TYPE_RAW:
+		if (src->value.str == NULL) {
+			sq_buffer_write(buffer, "\\N");
+			break;
+		}
+		// calculate the length of COPY string by counting characters that must be escaped
+		for (len = 0, temp.constr = src->value.str;  *temp.constr;  temp.constr++, len++) {
+			if (*temp.constr == '\\' || *temp.constr == '\t' || *temp.constr == '\n' || *temp.constr == '\r')
+				len++;
+		}
+		pos = buffer->writed;
+		sq_buffer_alloc(buffer, len);
+		// copy and convert original string to COPY string
+		for (temp.constr = src->value.str;  *temp.constr;  temp.constr++) {
+			switch (*temp.constr) {
+			case '\\':
+				buffer->mem[pos++] = '\\';
+				buffer->mem[pos++] = '\\';
+				break;
+			case '\t':
+				buffer->mem[pos++] = '\\';
+				buffer->mem[pos++] = 't';
+				break;
+			case '\n':
+				buffer->mem[pos++] = '\\';
+				buffer->mem[pos++] = 'n';
+				break;
+			case '\r':
+				buffer->mem[pos++] = '\\';
+				buffer->mem[pos++] = 'r';
+				break;
+			default:
+				buffer->mem[pos++] = *temp.constr;
+				break;
+			}
+		}
+		break;
+
+	default:
+		// number doesn't need to escape
+		return sqxc_sql_write_value(xcsql, src, buffer);
+	}
+
+	return (src->code = SQCODE_OK);
+}
+
 static int  sqxc_sql_write_value(SqxcSql *xcsql, Sqxc *src, SqBuffer *buffer)
 {
 	size_t  pos;
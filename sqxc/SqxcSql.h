@@ -66,6 +66,8 @@ extern const SqxcInfo      sqxcInfo_SQL;
 	                  +-> SqxcJsonWriter --+
 	( output )        |                    |       (SQL statement)
 	SqType::write() --+--------------------+-> SqxcSql   ---> sqdb_exec()
+	                                                     |
+	                                                     +--> sqdb_copy_data()  (COPY text format)
 
    The correct way to derive Sqxc:  (conforming C++11 standard-layout)
    1. Use Sq::XcMethod to inherit member function(method).
@@ -134,24 +136,33 @@ struct SqxcSql
 	char         quote[2];
 
 	// controlled variable
-	int          mode;        // 1 == INSERT, 0 == UPDATE
+	int          mode;        // 1 == INSERT, 0 == UPDATE, 2 == COPY, 3 == UPDATE multiple rows by primary key
 
 	// variable for UPDATE command
 	const char  *condition;   // WHERE condition.
-	SqPtrArray   columns;     // UPDATE column list
+	SqPtrArray   columns;     // UPDATE column list. COPY uses it to store skipped columns.
 	bool         columns_sorted;
 
+	// variable for INSERT command
+	const char  *suffix;      // it is appended to INSERT statement if it is not NULL. e.g. ON CONFLICT clause
+
+	// variable for UPDATE multiple rows
+	SqPtrArray   cases;       // CASE expression of each column. The first one is primary key.
+
 	// Sqdb result variable
 	int64_t      id;          // the last inserted row id.
 	int64_t      changes;     // number of rows changed, deleted, or inserted.
+	SqArray     *ids;         // ids (int64_t) of inserted rows are appended to it if it is not NULL.
 
 	// runtime variable
 	uint16_t     outer_type;  // SQXC_TYPE_OBJECT, SQXC_TYPE_ARRAY or SQXC_TYPE_UNKNOWN
-	int          row_count;   // used by INSERT
-	int          col_count;   // used by INSERT and UPDATE
+	int          row_count;   // used by INSERT, COPY, and UPDATE multiple rows
+	int          col_count;   // used by INSERT, UPDATE, and COPY
+	int          copy_cols;   // used by COPY. number of columns in COPY statement, 0 if COPY doesn't start.
+	int          row_sent;    // used by INSERT and UPDATE multiple rows. number of rows that have been executed by split statements.
 	size_t       buf_reuse;   // used by INSERT and UPDATE
 
-	SqBuffer     values_buf;  // used by INSERT INTO VALUES
+	SqBuffer     values_buf;  // used by INSERT INTO VALUES, COPY data, and values of row in UPDATE multiple rows
 };
 
 // ----------------------------------------------------------------------------
@@ -12,7 +12,10 @@
  * See the Mulan PSL v2 for more details.
  */
 
+#include <string.h>            // strlen()
+
 #include <sqxc/SqError.h>
+#include <sqxc/SqThread.h>     // sq_clock_usec()
 #include <sqxc/SqType.h>
 #include <sqxc/SqxcValue.h>
 
@@ -22,7 +25,7 @@
 	SQXC_TYPE_xxx ---> SqxcValue ---> SqType::parse()
  */
 
-static int  sqxc_value_send(SqxcValue *xcvalue, Sqxc *src)
+static int  sqxc_value_send_parse(SqxcValue *xcvalue, Sqxc *src)
 {
 	const SqType *type;
 	SqxcNested   *nested;
@@ -57,6 +60,54 @@ static int  sqxc_value_send(SqxcValue *xcvalue, Sqxc *src)
 	return src->code;
 }
 
+// size of value in 'src'. It is used by statistics of parsing.
+static size_t  sqxc_value_size(Sqxc *src)
+{
+	switch (src->type) {
+	case SQXC_TYPE_BOOL:
+		return sizeof(bool);
+	case SQXC_TYPE_INT:
+	case SQXC_TYPE_UINT:
+		return sizeof(int);
+	case SQXC_TYPE_INT64:
+	case SQXC_TYPE_UINT64:
+	case SQXC_TYPE_TIME:
+		return sizeof(int64_t);
+	case SQXC_TYPE_DOUBLE:
+		return sizeof(double);
+	case SQXC_TYPE_STR:
+	case SQXC_TYPE_RAW:
+		return (src->value.str) ? strlen(src->value.str) : 0;
+	case SQXC_TYPE_BLOB:
+		return ((SqBuffer*)src->value.pointer)->writed;
+	default:
+		return 0;
+	}
+}
+
+static int  sqxc_value_send(SqxcValue *xcvalue, Sqxc *src)
+{
+	SqxcValueStats *stats = xcvalue->stats;
+	uint64_t        begin;
+	int             code;
+
+	if (stats == NULL)
+		return sqxc_value_send_parse(xcvalue, src);
+
+	// row is value at top level of container (or top level if no container)
+	if ((src->type & SQXC_TYPE_END) == 0 &&
+	    xcvalue->nested_count == ((xcvalue->container) ? 1 : 0))
+	{
+		stats->n_rows++;
+	}
+	stats->n_bytes += sqxc_value_size(src);
+
+	begin = sq_clock_usec();
+	code  = sqxc_value_send_parse(xcvalue, src);
+	stats->time += sq_clock_usec() - begin;
+	return code;
+}
+
 static int  sqxc_value_ctrl(SqxcValue *xcvalue, int id, void *data)
 {
 	const SqType *type;
@@ -90,7 +141,8 @@ static int  sqxc_value_ctrl(SqxcValue *xcvalue, int id, void *data)
 static void  sqxc_value_init(SqxcValue *xcvalue)
 {
 //	memset(xcvalue, 0, sizeof(SqxcValue));
-	xcvalue->supported_type = SQXC_TYPE_ALL;
+	// SqdbSqlite sends BLOB with its length
+	xcvalue->supported_type = SQXC_TYPE_ALL | SQXC_TYPE_BLOB;
 	// SqTypeParseFunc like sq_type_object_parse(), sq_type_xxx_array_parse() need this line
 	xcvalue->dest = (Sqxc*)xcvalue;
 }
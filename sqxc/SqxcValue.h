@@ -22,6 +22,7 @@
 // C/C++ common declarations: declare type, structure, macro, enumeration.
 
 typedef struct SqxcValue        SqxcValue;
+typedef struct SqxcValueStats   SqxcValueStats;
 
 // ----------------------------------------------------------------------------
 // C declarations: declare C data, function, and others.
@@ -49,6 +50,11 @@ extern const SqxcInfo        sqxcInfo_Value;
 // instance of container (or element)
 #define sqxc_value_instance(xcvalue)      ( ((SqxcValue*)xcvalue)->instance )
 
+// SqxcValue::stats
+// ------
+// If it is not NULL, SqxcValue accumulates parsing statistics to it. It is used by trace hook of Sqdb.
+#define sqxc_value_stats(xcvalue)         ( ((SqxcValue*)xcvalue)->stats )
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -56,6 +62,15 @@ extern const SqxcInfo        sqxcInfo_Value;
 // ----------------------------------------------------------------------------
 // C/C++ common definitions: define structure
 
+/*	SqxcValueStats - statistics of parsing that SqxcValue accumulates if SqxcValue::stats is not NULL.
+ */
+struct SqxcValueStats
+{
+	uint64_t     time;        // microseconds spent in SqType::parse()
+	int64_t      n_rows;      // number of rows (elements of container, or element if no container)
+	size_t       n_bytes;     // size of received values. string is counted by its length.
+};
+
 /*	SqxcValue - convert data to C language Value. (destination of input chain)
 
 	Sqxc
@@ -133,6 +148,9 @@ struct SqxcValue
 	// instance type = element when calling get(id)
 	const SqType *element;    // type of table (or entry)
 	const SqType *container;  // type of array (or list)
+
+	// statistics of parsing. It is NULL by default (disabled).
+	SqxcValueStats *stats;
 };
 
 // ----------------------------------------------------------------------------
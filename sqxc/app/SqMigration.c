@@ -70,15 +70,20 @@ int  sq_migration_install(Sqdb *db)
 
 int  sq_migration_get_last(SqStorage *storage, int *batch)
 {
+	SqStorageContext *context, local;
 	SqMigrationTable  mtable = {-1, NULL, 0};
 
-	sqxc_value_container(storage->xc_input) = NULL;
-	sqxc_value_element(storage->xc_input)   = &sqType_MigrationTable;
-	sqxc_value_instance(storage->xc_input)  = &mtable;
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return -1;
+	sqxc_value_container(context->xc_input) = NULL;
+	sqxc_value_element(context->xc_input)   = &sqType_MigrationTable;
+	sqxc_value_instance(context->xc_input)  = &mtable;
 
-	sqdb_exec(storage->db,
+	sqdb_exec(context->db,
 	          "SELECT id, batch FROM migrations WHERE id=(SELECT MAX(id) FROM migrations)",
-	          storage->xc_input, NULL);
+	          context->xc_input, NULL);
+	sq_storage_release(storage, context);
 
 	if (batch)
 		*batch = mtable.batch;
@@ -87,10 +92,15 @@ int  sq_migration_get_last(SqStorage *storage, int *batch)
 
 int  sq_migration_count_batch(SqStorage *storage, int batch)
 {
+	SqStorageContext *context, local;
 	SqBuffer  *buf;
 	SqxcValue *xc_value;
+	int        count;
 
-	xc_value = (SqxcValue*)storage->xc_input;
+	context = sq_storage_acquire(storage, &local);
+	if (context == NULL)
+		return 0;
+	xc_value = (SqxcValue*)context->xc_input;
 	buf = sqxc_get_buffer(xc_value);
 	buf->writed = 0;
 	sq_buffer_write(buf, "SELECT COUNT(batch) FROM migrations WHERE batch=");
@@ -102,8 +112,10 @@ int  sq_migration_count_batch(SqStorage *storage, int batch)
 	xc_value->instance  = &xc_value->value.integer;
 	// execute SQL statement and get result
 	xc_value->value.integer = 0;
-	sqdb_exec(storage->db, buf->mem, (Sqxc*)xc_value, NULL);
-	return xc_value->value.integer;
+	sqdb_exec(context->db, buf->mem, (Sqxc*)xc_value, NULL);
+	count = xc_value->value.integer;
+	sq_storage_release(storage, context);
+	return count;
 }
 
 int  sq_migration_insert(SqStorage *storage, SqMigration **migrations, int index, int n, int batch)
@@ -112,7 +124,7 @@ int  sq_migration_insert(SqStorage *storage, SqMigration **migrations, int index
 	int  code = SQCODE_OK;
 
 	// begin transaction to improve SQLite performance
-	if (storage->db->info->product == SQDB_PRODUCT_SQLITE && n > 1)
+	if (sq_storage_db_info(storage)->product == SQDB_PRODUCT_SQLITE && n > 1)
 		code = sq_storage_begin_trans(storage);
 
 	for (int end = index + n;  index < end;  index++) {
@@ -126,7 +138,7 @@ int  sq_migration_insert(SqStorage *storage, SqMigration **migrations, int index
 	}
 
 	// commit transaction to improve SQLite performance
-	if (storage->db->info->product == SQDB_PRODUCT_SQLITE && n > 1)
+	if (sq_storage_db_info(storage)->product == SQDB_PRODUCT_SQLITE && n > 1)
 		code = sq_storage_commit_trans(storage);    // SQLite performance
 
 	return code;
@@ -30,11 +30,18 @@
 #include <sqxc/SqTable.h>
 #include <sqxc/SqSchema.h>
 #include <sqxc/SqStorage.h>
+#include <sqxc/SqIdentityMap.h>
+#include <sqxc/SqRowCache.h>
+#include <sqxc/SqQueryCache.h>
+#include <sqxc/SqHistogram.h>
+#include <sqxc/SqMetrics.h>
 #include <sqxc/SqQuery.h>
 #include <sqxc/SqJoint.h>
 
 // ------------------------------------
 #include <sqxc/Sqdb.h>
+#include <sqxc/SqdbStmtCache.h>
+#include <sqxc/SqdbPool.h>
 
 #if SQ_CONFIG_HAVE_SQLITE
 #include <sqxc/SqdbSqlite.h>
@@ -53,6 +60,7 @@
 
 #include <sqxc/SqxcSql.h>
 #include <sqxc/SqxcValue.h>
+#include <sqxc/SqxcRecord.h>
 
 #if SQ_CONFIG_HAVE_JSON
 #include <sqxc/SqxcJson.h>
@@ -21,6 +21,7 @@
 
 #include <sqxc/SqConfig.h>
 #include <sqxc/SqError.h>
+#include <sqxc/SqConvert.h>    // sq_bin_to_hex()
 #include <sqxc/SqxcValue.h>
 #include <sqxc/support/SqRow.h>
 
@@ -163,6 +164,8 @@ static void  sq_type_row_parse_unknown(void *instance, Sqxc *src)
 {
 	const SqType *type;
 	SqRow        *row = instance;
+	SqBuffer     *blob;
+	char         *mem;
 	union {
 		SqRowColumn  *col;
 		SqValue      *val;
@@ -212,6 +215,18 @@ static void  sq_type_row_parse_unknown(void *instance, Sqxc *src)
 		sq_row_alloc(row, 1)->str = strdup(src->value.str);
 		return;
 
+	case SQXC_TYPE_BLOB:
+		// binary data is kept in hex format \xFF
+		temp.col->type = SQ_TYPE_STR;
+		blob = src->value.pointer;
+		mem = malloc(blob->writed * 2 + 3);    // + \x and null-terminated
+		mem[0] = '\\';
+		mem[1] = 'x';
+		sq_bin_to_hex(mem+2, blob->mem, blob->writed);
+		mem[blob->writed * 2 + 2] = 0;         // null-terminated
+		sq_row_alloc(row, 1)->str = mem;
+		return;
+
 	default:
 		temp.col->type = SQ_TYPE_UNKNOWN;
 	}
@@ -0,0 +1,2564 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdio.h>             // fprintf(), stderr, snprintf()
+#include <stdlib.h>            // malloc(), free(), strtoll(), strtod()
+#include <string.h>            // strcmp(), strcasecmp(), memmove()
+#include <ctype.h>             // isspace(), isdigit(), isalpha(), tolower()
+#include <inttypes.h>          // PRId64
+#include <time.h>              // time()
+
+#include <sqxc/SqError.h>
+#include <sqxc/SqConvert.h>    // sq_time_to_string()
+#include <sqxc/Sqdb-migration.h>
+#include <sqxc/SqxcValue.h>
+#include <sqxc/SqxcSql.h>
+#include <sqxc/support/SqdbMemory.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#define strcasecmp   _stricmp
+#endif
+
+#define SQDB_MEMORY_CAPACITY    16
+
+typedef struct MemValue      MemValue;
+typedef struct MemColumn     MemColumn;
+typedef struct MemTable      MemTable;
+typedef struct MemToken      MemToken;
+typedef struct MemExpr       MemExpr;
+typedef struct MemOrder      MemOrder;
+typedef struct MemItem       MemItem;
+typedef struct MemParser     MemParser;
+typedef struct MemSelect     MemSelect;
+typedef struct MemStmt       MemStmt;
+
+// type of value
+enum {
+	MEM_NULL,
+	MEM_INT,
+	MEM_DOUBLE,
+	MEM_TEXT,
+};
+
+struct MemValue
+{
+	int       type;
+	SqValue   value;      // int64, double_, or str
+};
+
+// column stores values in typed vector
+struct MemColumn
+{
+	char         *name;
+	int           type;           // MEM_INT, MEM_DOUBLE, or MEM_TEXT
+	unsigned int  bit_field;      // SqColumn::bit_field
+
+	// default value. MemValue::value.str is owned by column.
+	MemValue      default_value;
+
+	// nulls[row] is 1 if value is NULL.
+	uint8_t      *nulls;
+	union {
+		void     *mem;
+		int64_t  *int64;
+		double   *double_;
+		char    **str;        // NULL if value is NULL
+	} data;
+};
+
+struct MemTable
+{
+	char         *name;
+	SqPtrArray    columns;        // MemColumn in order of creation
+	int           primary;        // index of integer primary key in 'columns'. -1 if it doesn't exist.
+	int64_t       last_id;        // the largest value of primary key that has been inserted
+
+	unsigned int  n_rows;
+	unsigned int  capacity;
+};
+
+// ------------------------------------
+// SQL parser
+
+enum {
+	TOKEN_END,
+	TOKEN_NAME,       // keyword or identifier
+	TOKEN_QUOTED,     // quoted identifier
+	TOKEN_STRING,     // string literal
+	TOKEN_NUMBER,
+	TOKEN_SYMBOL,
+};
+
+struct MemToken
+{
+	int        type;
+	char      *str;           // null-terminated. string literal has been unescaped.
+};
+
+enum {
+	EXPR_COLUMN,
+	EXPR_VALUE,
+	EXPR_AND,
+	EXPR_OR,
+	EXPR_NOT,
+	EXPR_IS_NULL,
+	EXPR_IN,
+	EXPR_LIKE,
+	EXPR_BETWEEN,
+	EXPR_EQ,
+	EXPR_NE,
+	EXPR_LT,
+	EXPR_LE,
+	EXPR_GT,
+	EXPR_GE,
+};
+
+struct MemExpr
+{
+	int        op;
+	MemExpr   *left;
+	MemExpr   *right;         // first item of list if 'op' is EXPR_IN or EXPR_BETWEEN
+	MemExpr   *next;          // next item in list
+	MemExpr   *chain;         // all expressions are chained in MemParser::exprs
+
+	int        column;        // EXPR_COLUMN: index of column
+	MemValue   value;         // EXPR_VALUE
+};
+
+struct MemOrder
+{
+	int        column;        // index of column
+	bool       desc;
+	MemExpr   *cases;         // CASE column WHEN value THEN value ... END. NULL if it orders by column.
+};
+
+enum {
+	AGGREGATE_NONE,
+	AGGREGATE_COUNT,
+	AGGREGATE_MIN,
+	AGGREGATE_MAX,
+	AGGREGATE_SUM,
+	AGGREGATE_AVG,
+};
+
+// item in select list
+struct MemItem
+{
+	const char *name;         // column name. NULL if it is * or COUNT(*)
+	const char *alias;        // name of result column
+	int         aggregate;
+};
+
+struct MemParser
+{
+	const char *sql;          // current position in SQL statement
+	char       *text;         // tokens are copied here
+	char       *text_cur;
+	MemToken    token;        // current token
+
+	MemTable   *table;        // table that is used to resolve column name
+	MemExpr    *exprs;
+	char       *timestr;      // value of CURRENT_TIMESTAMP
+	bool        error;
+};
+
+// result of SELECT statement. It is used by sqdb_memory_exec() and sqdb_memory_step().
+struct MemSelect
+{
+	MemTable     *table;
+	MemItem      *items;
+	MemValue     *values;         // values of current row
+	const char  **names;          // names of result columns
+	int          *columns;        // index of result columns
+	int           n_columns;
+	int           n_aggregates;
+
+	unsigned int *rows;           // index of result rows in 'table'
+	unsigned int  cur;            // index of next row in 'rows'
+	unsigned int  end;
+};
+
+// state of MemStmt
+enum {
+	MEM_STMT_READY,
+	MEM_STMT_SELECT,              // SELECT statement is stepping rows
+	MEM_STMT_DONE,
+};
+
+// prepared statement. Placeholders are replaced by literals of bound values when it is executed.
+struct MemStmt
+{
+	char        *sql;
+	int          n_params;
+	char       **params;          // literals of bound values. NULL is SQL NULL.
+
+	int          state;
+	SqBuffer     buf;             // SQL statement that has been executed
+	MemParser    parser;
+	MemSelect    select;
+};
+
+static void sqdb_memory_init(SqdbMemory *sqdb, const SqdbConfigMemory *config);
+static void sqdb_memory_final(SqdbMemory *sqdb);
+static int  sqdb_memory_open(SqdbMemory *sqdb, const char *database_name);
+static int  sqdb_memory_close(SqdbMemory *sqdb);
+static int  sqdb_memory_exec(SqdbMemory *sqdb, const char *sql, Sqxc *xc, void *reserve);
+static int  sqdb_memory_migrate(SqdbMemory *sqdb, SqSchema *schema, SqSchema *schema_next);
+static int  sqdb_memory_prepare(SqdbMemory *sqdb, const char *sql, SqdbStmt **stmt);
+static int  sqdb_memory_bind(SqdbMemory *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value);
+static int  sqdb_memory_step(SqdbMemory *sqdb, SqdbStmt *stmt, Sqxc *xc);
+static int  sqdb_memory_reset(SqdbMemory *sqdb, SqdbStmt *stmt);
+static int  sqdb_memory_finalize(SqdbMemory *sqdb, SqdbStmt *stmt);
+static void sqdb_memory_destroy_stmt(SqdbMemory *sqdb, SqdbStmt *stmt);
+
+const SqdbInfo sqdbInfo_Memory = {
+	.size    = sizeof(SqdbMemory),
+	.product = SQDB_PRODUCT_UNKNOWN,
+	.column  = {
+		.use_alter  = 1,
+		.use_modify = 0,
+	},
+	.quote = {
+		.identifier = {'"', '"'}
+	},
+
+	.init    = (void*)sqdb_memory_init,
+	.final   = (void*)sqdb_memory_final,
+	.open    = (void*)sqdb_memory_open,
+	.close   = (void*)sqdb_memory_close,
+	.exec    = (void*)sqdb_memory_exec,
+	.migrate = (void*)sqdb_memory_migrate,
+
+	.prepare  = (void*)sqdb_memory_prepare,
+	.bind     = (void*)sqdb_memory_bind,
+	.step     = (void*)sqdb_memory_step,
+	.reset    = (void*)sqdb_memory_reset,
+	.finalize = (void*)sqdb_memory_finalize,
+};
+
+// ----------------------------------------------------------------------------
+// MemValue
+
+static int64_t mem_value_int64(const MemValue *value)
+{
+	switch (value->type) {
+	case MEM_INT:
+		return value->value.int64;
+	case MEM_DOUBLE:
+		return (int64_t)value->value.double_;
+	case MEM_TEXT:
+		return strtoll(value->value.str, NULL, 10);
+	default:
+		return 0;
+	}
+}
+
+static double  mem_value_double(const MemValue *value)
+{
+	switch (value->type) {
+	case MEM_INT:
+		return (double)value->value.int64;
+	case MEM_DOUBLE:
+		return value->value.double_;
+	case MEM_TEXT:
+		return strtod(value->value.str, NULL);
+	default:
+		return 0.0;
+	}
+}
+
+// 'buf' must have 32 bytes at least
+static const char *mem_value_text(const MemValue *value, char *buf)
+{
+	switch (value->type) {
+	case MEM_INT:
+		snprintf(buf, 32, "%" PRId64, value->value.int64);
+		return buf;
+	case MEM_DOUBLE:
+		snprintf(buf, 32, "%.15g", value->value.double_);
+		return buf;
+	case MEM_TEXT:
+		return value->value.str;
+	default:
+		return "";
+	}
+}
+
+// compare values that are not NULL. Text is converted to number if it is compared with number.
+static int  mem_value_compare(const MemValue *value1, const MemValue *value2)
+{
+	double  d1, d2;
+
+	if (value1->type == MEM_TEXT && value2->type == MEM_TEXT)
+		return strcmp(value1->value.str, value2->value.str);
+	if (value1->type == MEM_INT && value2->type == MEM_INT)
+		return (value1->value.int64 > value2->value.int64) - (value1->value.int64 < value2->value.int64);
+	d1 = mem_value_double(value1);
+	d2 = mem_value_double(value2);
+	return (d1 > d2) - (d1 < d2);
+}
+
+// ----------------------------------------------------------------------------
+// MemColumn
+
+static int  mem_type_from_sqtype(const SqType *type)
+{
+	// SQ_TYPE_TIME is stored as text like SQLite
+	if (type == SQ_TYPE_TIME)
+		return MEM_TEXT;
+	if (SQ_TYPE_IS_INT(type))
+		return MEM_INT;
+	if (type == SQ_TYPE_DOUBLE)
+		return MEM_DOUBLE;
+	return MEM_TEXT;
+}
+
+static size_t mem_type_size(int type)
+{
+	switch (type) {
+	case MEM_INT:
+		return sizeof(int64_t);
+	case MEM_DOUBLE:
+		return sizeof(double);
+	default:
+		return sizeof(char*);
+	}
+}
+
+static MemColumn *mem_column_new(const char *name, int type, unsigned int capacity)
+{
+	MemColumn *column;
+
+	column = malloc(sizeof(MemColumn));
+	column->name = strdup(name);
+	column->type = type;
+	column->bit_field = 0;
+	column->default_value.type = MEM_NULL;
+	column->nulls = calloc(capacity, 1);
+	column->data.mem = calloc(capacity, mem_type_size(type));
+	return column;
+}
+
+static void mem_column_free(MemColumn *column, unsigned int n_rows)
+{
+	if (column->type == MEM_TEXT) {
+		for (unsigned int row = 0;  row < n_rows;  row++)
+			free(column->data.str[row]);
+	}
+	if (column->default_value.type == MEM_TEXT)
+		free((char*)column->default_value.value.str);
+	free(column->data.mem);
+	free(column->nulls);
+	free(column->name);
+	free(column);
+}
+
+static void mem_column_get(MemColumn *column, unsigned int row, MemValue *value)
+{
+	if (column->nulls[row]) {
+		value->type = MEM_NULL;
+		value->value.int64 = 0;
+		return;
+	}
+	value->type = column->type;
+	switch (column->type) {
+	case MEM_INT:
+		value->value.int64 = column->data.int64[row];
+		break;
+	case MEM_DOUBLE:
+		value->value.double_ = column->data.double_[row];
+		break;
+	default:
+		value->value.str = column->data.str[row];
+		break;
+	}
+}
+
+// set value of cell. value is converted to type of column.
+static void mem_column_set(MemColumn *column, unsigned int row, const MemValue *value)
+{
+	char  buf[32];
+
+	if (column->type == MEM_TEXT) {
+		free(column->data.str[row]);
+		column->data.str[row] = NULL;
+	}
+	column->nulls[row] = (value->type == MEM_NULL);
+	if (value->type == MEM_NULL)
+		return;
+
+	switch (column->type) {
+	case MEM_INT:
+		column->data.int64[row] = mem_value_int64(value);
+		break;
+	case MEM_DOUBLE:
+		column->data.double_[row] = mem_value_double(value);
+		break;
+	default:
+		column->data.str[row] = strdup(mem_value_text(value, buf));
+		break;
+	}
+}
+
+static void mem_column_set_now(MemColumn *column, unsigned int row)
+{
+	MemValue  value;
+	char     *timestr;
+
+	timestr = sq_time_to_string(time(NULL), 0);
+	value.type = MEM_TEXT;
+	value.value.str = timestr;
+	mem_column_set(column, row, &value);
+	free(timestr);
+}
+
+static void mem_column_set_default(MemColumn *column, unsigned int row)
+{
+	// DEFAULT CURRENT_TIMESTAMP
+	if (column->bit_field & SQB_COLUMN_CURRENT)
+		mem_column_set_now(column, row);
+	else
+		mem_column_set(column, row, &column->default_value);
+}
+
+// change type of column and convert all values
+static void mem_column_convert(MemColumn *column, int type, unsigned int n_rows, unsigned int capacity)
+{
+	MemColumn *temp;
+	MemValue   value;
+
+	if (column->type == type)
+		return;
+	temp = mem_column_new(column->name, type, capacity);
+	for (unsigned int row = 0;  row < n_rows;  row++) {
+		mem_column_get(column, row, &value);
+		mem_column_set(temp, row, &value);
+	}
+	// swap data and free old data
+	temp->type = column->type;
+	column->type = type;
+	value.value.pointer = temp->data.mem;
+	temp->data.mem = column->data.mem;
+	column->data.mem = value.value.pointer;
+	value.value.pointer = temp->nulls;
+	temp->nulls = column->nulls;
+	column->nulls = value.value.pointer;
+	mem_column_free(temp, n_rows);
+}
+
+// ----------------------------------------------------------------------------
+// MemTable
+
+static MemTable *mem_table_new(const char *name, unsigned int capacity)
+{
+	MemTable *table;
+
+	table = malloc(sizeof(MemTable));
+	table->name = strdup(name);
+	sq_ptr_array_init(&table->columns, 8, NULL);
+	table->primary = -1;
+	table->last_id = 0;
+	table->n_rows = 0;
+	table->capacity = capacity;
+	return table;
+}
+
+static void mem_table_free(MemTable *table)
+{
+	for (unsigned int index = 0;  index < table->columns.length;  index++)
+		mem_column_free(table->columns.data[index], table->n_rows);
+	sq_ptr_array_final(&table->columns);
+	free(table->name);
+	free(table);
+}
+
+static int  mem_table_find_column(MemTable *table, const char *name)
+{
+	MemColumn *column;
+
+	for (unsigned int index = 0;  index < table->columns.length;  index++) {
+		column = table->columns.data[index];
+		if (strcasecmp(column->name, name) == 0)
+			return (int)index;
+	}
+	return -1;
+}
+
+static void mem_table_reserve(MemTable *table, unsigned int n_rows)
+{
+	MemColumn *column;
+
+	if (n_rows <= table->capacity)
+		return;
+	table->capacity *= 2;
+	if (table->capacity < n_rows)
+		table->capacity = n_rows;
+	for (unsigned int index = 0;  index < table->columns.length;  index++) {
+		column = table->columns.data[index];
+		column->nulls = realloc(column->nulls, table->capacity);
+		column->data.mem = realloc(column->data.mem, table->capacity * mem_type_size(column->type));
+	}
+}
+
+// insert empty row (all values are NULL) at 'row'
+static void mem_table_insert_row(MemTable *table, unsigned int row)
+{
+	MemColumn *column;
+	size_t     size;
+	char      *mem;
+
+	mem_table_reserve(table, table->n_rows + 1);
+	for (unsigned int index = 0;  index < table->columns.length;  index++) {
+		column = table->columns.data[index];
+		size = mem_type_size(column->type);
+		mem  = column->data.mem;
+		memmove(mem + (row + 1) * size, mem + row * size, (table->n_rows - row) * size);
+		memmove(column->nulls + row + 1, column->nulls + row, table->n_rows - row);
+		column->nulls[row] = 1;
+		if (column->type == MEM_TEXT)
+			column->data.str[row] = NULL;
+	}
+	table->n_rows++;
+}
+
+// erase rows. 'rows' must be sorted in ascending order.
+static void mem_table_erase_rows(MemTable *table, const unsigned int *rows, unsigned int n_erase)
+{
+	MemColumn   *column;
+	size_t       size;
+	char        *mem;
+	unsigned int dest, src, cur;
+
+	if (n_erase == 0)
+		return;
+	for (unsigned int index = 0;  index < table->columns.length;  index++) {
+		column = table->columns.data[index];
+		size = mem_type_size(column->type);
+		mem  = column->data.mem;
+		dest = rows[0];
+		cur  = 0;
+		// move remaining rows forward in one pass
+		for (src = rows[0];  src < table->n_rows;  src++) {
+			if (cur < n_erase && rows[cur] == src) {
+				if (column->type == MEM_TEXT)
+					free(column->data.str[src]);
+				cur++;
+				continue;
+			}
+			memcpy(mem + dest * size, mem + src * size, size);
+			column->nulls[dest] = column->nulls[src];
+			dest++;
+		}
+	}
+	table->n_rows -= n_erase;
+}
+
+// reorder rows. new row 'i' is old row 'rows[i]'.
+static void mem_table_reorder(MemTable *table, const unsigned int *rows)
+{
+	MemColumn *column;
+	size_t     size;
+	char      *mem;
+	uint8_t   *nulls;
+
+	for (unsigned int index = 0;  index < table->columns.length;  index++) {
+		column = table->columns.data[index];
+		size  = mem_type_size(column->type);
+		mem   = malloc(table->capacity * size);
+		nulls = malloc(table->capacity);
+		for (unsigned int row = 0;  row < table->n_rows;  row++) {
+			memcpy(mem + row * size, (char*)column->data.mem + rows[row] * size, size);
+			nulls[row] = column->nulls[rows[row]];
+		}
+		free(column->data.mem);
+		free(column->nulls);
+		column->data.mem = mem;
+		column->nulls = nulls;
+	}
+}
+
+// binary search by integer primary key. If it is not found, 'row' is position to insert it.
+static bool mem_table_find_id(MemTable *table, int64_t id, unsigned int *row)
+{
+	int64_t     *ids = ((MemColumn*)table->columns.data[table->primary])->data.int64;
+	unsigned int low = 0, high = table->n_rows, middle;
+
+	while (low < high) {
+		middle = low + (high - low) / 2;
+		if (ids[middle] < id)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	*row = low;
+	return (low < table->n_rows && ids[low] == id);
+}
+
+// get value that is used to sort 'row'
+static void mem_order_value(MemTable *table, const MemOrder *order, unsigned int row, MemValue *value)
+{
+	MemExpr  *expr;
+
+	mem_column_get(table->columns.data[order->column], row, value);
+	if (order->cases == NULL)
+		return;
+	// THEN value of matched WHEN. It is NULL if no WHEN matches.
+	for (expr = order->cases;  expr;  expr = expr->next) {
+		if (mem_value_compare(value, &expr->left->value) == 0) {
+			*value = expr->right->value;
+			return;
+		}
+	}
+	value->type = MEM_NULL;
+}
+
+static int  mem_row_compare(MemTable *table, const MemOrder *orders, int n_orders,
+                            unsigned int row1, unsigned int row2)
+{
+	MemValue  value1, value2;
+	int       result;
+
+	for (int index = 0;  index < n_orders;  index++) {
+		mem_order_value(table, orders + index, row1, &value1);
+		mem_order_value(table, orders + index, row2, &value2);
+		// NULL is smaller than any value
+		if (value1.type == MEM_NULL || value2.type == MEM_NULL)
+			result = (value2.type == MEM_NULL) - (value1.type == MEM_NULL);
+		else
+			result = mem_value_compare(&value1, &value2);
+		if (result != 0)
+			return (orders[index].desc) ? -result : result;
+	}
+	return 0;
+}
+
+// stable merge sort. 'temp' must have 'n_rows' elements.
+static void mem_table_sort(MemTable *table, const MemOrder *orders, int n_orders,
+                           unsigned int *rows, unsigned int n_rows, unsigned int *temp)
+{
+	unsigned int  half, cur1, cur2, dest;
+
+	if (n_rows < 2)
+		return;
+	half = n_rows / 2;
+	mem_table_sort(table, orders, n_orders, rows, half, temp);
+	mem_table_sort(table, orders, n_orders, rows + half, n_rows - half, temp);
+
+	for (cur1 = 0, cur2 = half, dest = 0;  cur1 < half && cur2 < n_rows;  dest++) {
+		if (mem_row_compare(table, orders, n_orders, rows[cur2], rows[cur1]) < 0)
+			temp[dest] = rows[cur2++];
+		else
+			temp[dest] = rows[cur1++];
+	}
+	while (cur1 < half)
+		temp[dest++] = rows[cur1++];
+	while (cur2 < n_rows)
+		temp[dest++] = rows[cur2++];
+	memcpy(rows, temp, sizeof(unsigned int) * n_rows);
+}
+
+// find integer primary key. Rows are sorted by it.
+// Primary key is not used if it has NULL value (after ALTER TABLE).
+static void mem_table_update_primary(MemTable *table)
+{
+	MemColumn    *column;
+	MemOrder      order;
+	unsigned int *rows;
+	int           primary = -1;
+
+	for (unsigned int index = 0;  index < table->columns.length;  index++) {
+		column = table->columns.data[index];
+		if (column->bit_field & SQB_COLUMN_PRIMARY && column->type == MEM_INT &&
+		    memchr(column->nulls, 1, table->n_rows) == NULL)
+		{
+			primary = (int)index;
+			break;
+		}
+	}
+	if (table->primary == primary)
+		return;
+	table->primary = primary;
+	if (primary == -1 || table->n_rows == 0)
+		return;
+
+	// sort rows by primary key
+	order.column = primary;
+	order.desc = false;
+	order.cases = NULL;
+	rows = malloc(sizeof(unsigned int) * table->n_rows * 2);
+	for (unsigned int row = 0;  row < table->n_rows;  row++)
+		rows[row] = row;
+	mem_table_sort(table, &order, 1, rows, table->n_rows, rows + table->n_rows);
+	mem_table_reorder(table, rows);
+	free(rows);
+	table->last_id = ((MemColumn*)table->columns.data[primary])->data.int64[table->n_rows - 1];
+}
+
+static int  mem_table_cmp_name(const void *name, const void *table)
+{
+	return strcasecmp(*(const char**)name, (*(MemTable**)table)->name);
+}
+
+static MemTable *mem_table_find(SqdbMemory *sqdb, const char *name, unsigned int *index)
+{
+	MemTable    **addr;
+	unsigned int  temp;
+
+	addr = (MemTable**)sq_ptr_array_find_sorted(&sqdb->tables, &name, mem_table_cmp_name,
+	                                            (index) ? index : &temp);
+	return (addr) ? *addr : NULL;
+}
+
+// ----------------------------------------------------------------------------
+// MemParser
+
+static void mem_parser_next(MemParser *p);
+
+static void mem_parser_init(MemParser *p, const char *sql)
+{
+	// every token needs null-terminated character, so it needs double size of SQL at most.
+	p->text = malloc(strlen(sql) * 2 + 2);
+	p->text_cur = p->text;
+	p->sql = sql;
+	p->token.type = TOKEN_NAME;
+	p->table = NULL;
+	p->exprs = NULL;
+	p->timestr = NULL;
+	p->error = false;
+	mem_parser_next(p);
+}
+
+static void mem_parser_final(MemParser *p)
+{
+	MemExpr *expr;
+
+	while (p->exprs) {
+		expr = p->exprs;
+		p->exprs = expr->chain;
+		free(expr);
+	}
+	free(p->timestr);
+	free(p->text);
+}
+
+static void mem_parser_next(MemParser *p)
+{
+	const char *cur = p->sql;
+	char       *out = p->text_cur;
+	char        quote;
+
+	if (p->token.type == TOKEN_END)
+		return;
+	while (isspace((unsigned char)*cur))
+		cur++;
+	p->token.str = out;
+
+	if (*cur == 0)
+		p->token.type = TOKEN_END;
+	else if (*cur == '"' || *cur == '`' || *cur == '[') {
+		quote = (*cur == '[') ? ']' : *cur;
+		for (cur++;  *cur && *cur != quote;  cur++)
+			*out++ = *cur;
+		if (*cur)
+			cur++;
+		p->token.type = TOKEN_QUOTED;
+	}
+	else if (*cur == '\'') {
+		for (cur++;  *cur;  cur++) {
+			if (*cur == '\'') {
+				if (cur[1] != '\'')
+					break;
+				cur++;    // '' is escaped single quote
+			}
+			*out++ = *cur;
+		}
+		if (*cur)
+			cur++;
+		else
+			p->error = true;
+		p->token.type = TOKEN_STRING;
+	}
+	else if (isdigit((unsigned char)*cur) || (*cur == '.' && isdigit((unsigned char)cur[1]))) {
+		do {
+			*out++ = *cur++;
+		} while (isalnum((unsigned char)*cur) || *cur == '.' ||
+		         ((*cur == '+' || *cur == '-') && (cur[-1] == 'e' || cur[-1] == 'E')));
+		p->token.type = TOKEN_NUMBER;
+	}
+	else if (isalpha((unsigned char)*cur) || *cur == '_') {
+		do {
+			*out++ = *cur++;
+		} while (isalnum((unsigned char)*cur) || *cur == '_' || *cur == '$');
+		p->token.type = TOKEN_NAME;
+	}
+	else {
+		*out++ = *cur++;
+		// operators that have two characters: <=, <>, >=, !=, ==
+		if ((out[-1] == '<' && (*cur == '=' || *cur == '>')) ||
+		    ((out[-1] == '>' || out[-1] == '!' || out[-1] == '=') && *cur == '='))
+		{
+			*out++ = *cur++;
+		}
+		p->token.type = TOKEN_SYMBOL;
+	}
+	*out++ = 0;
+	p->text_cur = out;
+	p->sql = cur;
+}
+
+static void mem_parser_error(MemParser *p)
+{
+	if (p->error == false) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: syntax error or unsupported syntax near '%s'.\n",
+		        "SqdbMemory", p->token.str);
+#endif
+		p->error = true;
+	}
+}
+
+// current token is keyword or symbol
+static bool mem_parser_is(MemParser *p, const char *keyword)
+{
+	if (p->token.type == TOKEN_NAME)
+		return strcasecmp(p->token.str, keyword) == 0;
+	if (p->token.type == TOKEN_SYMBOL)
+		return strcmp(p->token.str, keyword) == 0;
+	return false;
+}
+
+static bool mem_parser_accept(MemParser *p, const char *keyword)
+{
+	if (mem_parser_is(p, keyword)) {
+		mem_parser_next(p);
+		return true;
+	}
+	return false;
+}
+
+static bool mem_parser_expect(MemParser *p, const char *keyword)
+{
+	if (mem_parser_accept(p, keyword))
+		return true;
+	mem_parser_error(p);
+	return false;
+}
+
+// parse the end of statement
+static bool mem_parser_end(MemParser *p)
+{
+	mem_parser_accept(p, ";");
+	if (p->token.type != TOKEN_END)
+		mem_parser_error(p);
+	return (p->error == false);
+}
+
+// return NULL if current token is not identifier.
+static const char *mem_parser_identifier(MemParser *p)
+{
+	const char *name;
+
+	if (p->token.type != TOKEN_NAME && p->token.type != TOKEN_QUOTED) {
+		mem_parser_error(p);
+		return NULL;
+	}
+	name = p->token.str;
+	mem_parser_next(p);
+	return name;
+}
+
+static MemTable *mem_parser_table(MemParser *p, SqdbMemory *sqdb)
+{
+	const char *name;
+
+	name = mem_parser_identifier(p);
+	if (name == NULL)
+		return NULL;
+	p->table = mem_table_find(sqdb, name, NULL);
+	if (p->table == NULL) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: table '%s' not found.\n", "SqdbMemory", name);
+#endif
+		p->error = true;
+	}
+	return p->table;
+}
+
+// [table.]column. return index of column or -1.
+static int  mem_parser_column(MemParser *p)
+{
+	const char *name;
+	int         index;
+
+	name = mem_parser_identifier(p);
+	if (name && mem_parser_accept(p, "."))
+		name = mem_parser_identifier(p);
+	if (name == NULL)
+		return -1;
+	index = mem_table_find_column(p->table, name);
+	if (index == -1) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: column '%s' not found.\n", "SqdbMemory", name);
+#endif
+		p->error = true;
+	}
+	return index;
+}
+
+// return false if current token is not literal value.
+static bool mem_parser_literal(MemParser *p, MemValue *value)
+{
+	bool  negative = false;
+
+	if (mem_parser_accept(p, "-"))
+		negative = true;
+	else
+		mem_parser_accept(p, "+");
+
+	switch (p->token.type) {
+	case TOKEN_NUMBER:
+		if (strpbrk(p->token.str, ".eE")) {
+			value->type = MEM_DOUBLE;
+			value->value.double_ = strtod(p->token.str, NULL);
+			if (negative)
+				value->value.double_ = -value->value.double_;
+		}
+		else {
+			value->type = MEM_INT;
+			value->value.int64 = strtoll(p->token.str, NULL, 10);
+			if (negative)
+				value->value.int64 = -value->value.int64;
+		}
+		break;
+
+	case TOKEN_STRING:
+		if (negative)
+			return false;
+		value->type = MEM_TEXT;
+		value->value.str = p->token.str;
+		break;
+
+	case TOKEN_NAME:
+		if (negative)
+			return false;
+		if (strcasecmp(p->token.str, "NULL") == 0) {
+			value->type = MEM_NULL;
+			value->value.int64 = 0;
+		}
+		else if (strcasecmp(p->token.str, "TRUE") == 0 || strcasecmp(p->token.str, "FALSE") == 0) {
+			value->type = MEM_INT;
+			value->value.int64 = (p->token.str[0] == 'T' || p->token.str[0] == 't');
+		}
+		else if (strcasecmp(p->token.str, "CURRENT_TIMESTAMP") == 0) {
+			if (p->timestr == NULL)
+				p->timestr = sq_time_to_string(time(NULL), 0);
+			value->type = MEM_TEXT;
+			value->value.str = p->timestr;
+		}
+		else
+			return false;
+		break;
+
+	default:
+		return false;
+	}
+	mem_parser_next(p);
+	return true;
+}
+
+static MemExpr *mem_expr_new(MemParser *p, int op, MemExpr *left, MemExpr *right)
+{
+	MemExpr *expr;
+
+	expr = calloc(1, sizeof(MemExpr));
+	expr->op = op;
+	expr->left = left;
+	expr->right = right;
+	expr->chain = p->exprs;
+	p->exprs = expr;
+	return expr;
+}
+
+// literal value or column
+static MemExpr *mem_parser_operand(MemParser *p)
+{
+	MemExpr *expr;
+
+	expr = mem_expr_new(p, EXPR_VALUE, NULL, NULL);
+	if (mem_parser_literal(p, &expr->value) == false) {
+		expr->op = EXPR_COLUMN;
+		expr->column = mem_parser_column(p);
+	}
+	return expr;
+}
+
+static MemExpr *mem_parser_or(MemParser *p);
+
+static MemExpr *mem_parser_predicate(MemParser *p)
+{
+	static const char *cmp_ops[]   = {"=", "==", "<>", "!=", "<", "<=", ">", ">="};
+	static const int   cmp_codes[] = {EXPR_EQ, EXPR_EQ, EXPR_NE, EXPR_NE,
+	                                  EXPR_LT, EXPR_LE, EXPR_GT, EXPR_GE};
+	MemExpr  *expr;
+	MemExpr **tail;
+	bool      negative;
+
+	if (mem_parser_accept(p, "(")) {
+		expr = mem_parser_or(p);
+		mem_parser_expect(p, ")");
+		return expr;
+	}
+
+	expr = mem_parser_operand(p);
+	for (int index = 0;  index < (int)(sizeof(cmp_codes) / sizeof(int));  index++) {
+		if (mem_parser_accept(p, cmp_ops[index]))
+			return mem_expr_new(p, cmp_codes[index], expr, mem_parser_operand(p));
+	}
+
+	if (mem_parser_accept(p, "IS")) {
+		negative = mem_parser_accept(p, "NOT");
+		mem_parser_expect(p, "NULL");
+		expr = mem_expr_new(p, EXPR_IS_NULL, expr, NULL);
+		return (negative) ? mem_expr_new(p, EXPR_NOT, expr, NULL) : expr;
+	}
+
+	negative = mem_parser_accept(p, "NOT");
+	if (mem_parser_accept(p, "IN")) {
+		expr = mem_expr_new(p, EXPR_IN, expr, NULL);
+		mem_parser_expect(p, "(");
+		tail = &expr->right;
+		do {
+			*tail = mem_parser_operand(p);
+			tail = &(*tail)->next;
+		} while (p->error == false && mem_parser_accept(p, ","));
+		mem_parser_expect(p, ")");
+	}
+	else if (mem_parser_accept(p, "LIKE"))
+		expr = mem_expr_new(p, EXPR_LIKE, expr, mem_parser_operand(p));
+	else if (mem_parser_accept(p, "BETWEEN")) {
+		expr = mem_expr_new(p, EXPR_BETWEEN, expr, mem_parser_operand(p));
+		mem_parser_expect(p, "AND");
+		expr->right->next = mem_parser_operand(p);
+	}
+	else {
+		// operand is used as boolean value
+		if (negative)
+			mem_parser_error(p);
+		return expr;
+	}
+	return (negative) ? mem_expr_new(p, EXPR_NOT, expr, NULL) : expr;
+}
+
+static MemExpr *mem_parser_not(MemParser *p)
+{
+	if (mem_parser_accept(p, "NOT"))
+		return mem_expr_new(p, EXPR_NOT, mem_parser_not(p), NULL);
+	return mem_parser_predicate(p);
+}
+
+static MemExpr *mem_parser_and(MemParser *p)
+{
+	MemExpr *expr;
+
+	expr = mem_parser_not(p);
+	while (p->error == false && mem_parser_accept(p, "AND"))
+		expr = mem_expr_new(p, EXPR_AND, expr, mem_parser_not(p));
+	return expr;
+}
+
+static MemExpr *mem_parser_or(MemParser *p)
+{
+	MemExpr *expr;
+
+	expr = mem_parser_and(p);
+	while (p->error == false && mem_parser_accept(p, "OR"))
+		expr = mem_expr_new(p, EXPR_OR, expr, mem_parser_and(p));
+	return expr;
+}
+
+// CASE column WHEN value THEN value {WHEN value THEN value}
+// parse after "CASE" and stop before ELSE or END. return list of EXPR_EQ.
+// MemExpr::left is WHEN value, MemExpr::right is THEN value.
+static MemExpr *mem_parser_case(MemParser *p, int *column)
+{
+	MemExpr  *expr;
+	MemExpr  *list = NULL;
+	MemExpr **tail = &list;
+
+	*column = mem_parser_column(p);
+	while (p->error == false && mem_parser_accept(p, "WHEN")) {
+		expr = mem_expr_new(p, EXPR_EQ, mem_expr_new(p, EXPR_VALUE, NULL, NULL),
+		                                mem_expr_new(p, EXPR_VALUE, NULL, NULL));
+		if (mem_parser_literal(p, &expr->left->value) == false ||
+		    mem_parser_expect(p, "THEN") == false ||
+		    mem_parser_literal(p, &expr->right->value) == false)
+		{
+			mem_parser_error(p);
+			break;
+		}
+		*tail = expr;
+		tail = &expr->next;
+	}
+	return list;
+}
+
+// ----------------------------------------------------------------------------
+// MemExpr
+
+static void mem_expr_value(MemTable *table, unsigned int row, MemExpr *expr, MemValue *value)
+{
+	if (expr->op == EXPR_COLUMN)
+		mem_column_get(table->columns.data[expr->column], row, value);
+	else
+		*value = expr->value;
+}
+
+// SQL LIKE. It is case-insensitive for ASCII characters like SQLite.
+static bool mem_like(const char *str, const char *pattern)
+{
+	for (;  *pattern;  pattern++, str++) {
+		if (*pattern == '%') {
+			while (pattern[1] == '%')
+				pattern++;
+			if (pattern[1] == 0)
+				return true;
+			for (;  *str;  str++) {
+				if (mem_like(str, pattern + 1))
+					return true;
+			}
+			return false;
+		}
+		if (*str == 0)
+			return false;
+		if (*pattern != '_' && tolower((unsigned char)*pattern) != tolower((unsigned char)*str))
+			return false;
+	}
+	return (*str == 0);
+}
+
+// return 1 if true, 0 if false, -1 if unknown (NULL).
+static int  mem_expr_eval(MemTable *table, unsigned int row, MemExpr *expr)
+{
+	MemValue  value1, value2, value3;
+	MemExpr  *item;
+	char      buf1[32], buf2[32];
+	int       result1, result2;
+
+	switch (expr->op) {
+	case EXPR_AND:
+		result1 = mem_expr_eval(table, row, expr->left);
+		if (result1 == 0)
+			return 0;
+		result2 = mem_expr_eval(table, row, expr->right);
+		if (result2 == 0)
+			return 0;
+		return (result1 == 1 && result2 == 1) ? 1 : -1;
+
+	case EXPR_OR:
+		result1 = mem_expr_eval(table, row, expr->left);
+		if (result1 == 1)
+			return 1;
+		result2 = mem_expr_eval(table, row, expr->right);
+		if (result2 == 1)
+			return 1;
+		return (result1 == 0 && result2 == 0) ? 0 : -1;
+
+	case EXPR_NOT:
+		result1 = mem_expr_eval(table, row, expr->left);
+		return (result1 == -1) ? -1 : !result1;
+
+	case EXPR_IS_NULL:
+		mem_expr_value(table, row, expr->left, &value1);
+		return (value1.type == MEM_NULL);
+
+	case EXPR_IN:
+		mem_expr_value(table, row, expr->left, &value1);
+		if (value1.type == MEM_NULL)
+			return -1;
+		result1 = 0;
+		for (item = expr->right;  item;  item = item->next) {
+			mem_expr_value(table, row, item, &value2);
+			if (value2.type == MEM_NULL)
+				result1 = -1;
+			else if (mem_value_compare(&value1, &value2) == 0)
+				return 1;
+		}
+		return result1;
+
+	case EXPR_LIKE:
+		mem_expr_value(table, row, expr->left, &value1);
+		mem_expr_value(table, row, expr->right, &value2);
+		if (value1.type == MEM_NULL || value2.type == MEM_NULL)
+			return -1;
+		return mem_like(mem_value_text(&value1, buf1), mem_value_text(&value2, buf2));
+
+	case EXPR_BETWEEN:
+		mem_expr_value(table, row, expr->left, &value1);
+		mem_expr_value(table, row, expr->right, &value2);
+		mem_expr_value(table, row, expr->right->next, &value3);
+		if (value1.type == MEM_NULL || value2.type == MEM_NULL || value3.type == MEM_NULL)
+			return -1;
+		return (mem_value_compare(&value1, &value2) >= 0 && mem_value_compare(&value1, &value3) <= 0);
+
+	case EXPR_COLUMN:
+	case EXPR_VALUE:
+		mem_expr_value(table, row, expr, &value1);
+		if (value1.type == MEM_NULL)
+			return -1;
+		return (mem_value_double(&value1) != 0.0);
+
+	default:
+		mem_expr_value(table, row, expr->left, &value1);
+		mem_expr_value(table, row, expr->right, &value2);
+		if (value1.type == MEM_NULL || value2.type == MEM_NULL)
+			return -1;
+		result1 = mem_value_compare(&value1, &value2);
+		switch (expr->op) {
+		case EXPR_EQ:
+			return (result1 == 0);
+		case EXPR_NE:
+			return (result1 != 0);
+		case EXPR_LT:
+			return (result1 <  0);
+		case EXPR_LE:
+			return (result1 <= 0);
+		case EXPR_GT:
+			return (result1 >  0);
+		default:    // EXPR_GE
+			return (result1 >= 0);
+		}
+	}
+}
+
+// If WHERE condition requires "primary key = integer", get the integer from it.
+static bool mem_expr_get_id(MemTable *table, MemExpr *expr, int64_t *id)
+{
+	MemExpr *column, *value;
+
+	if (expr->op == EXPR_AND)
+		return mem_expr_get_id(table, expr->left, id) || mem_expr_get_id(table, expr->right, id);
+	if (expr->op != EXPR_EQ)
+		return false;
+
+	column = expr->left;
+	value  = expr->right;
+	if (column->op != EXPR_COLUMN) {
+		column = expr->right;
+		value  = expr->left;
+	}
+	if (column->op != EXPR_COLUMN || column->column != table->primary ||
+	    value->op  != EXPR_VALUE  || value->value.type != MEM_INT)
+	{
+		return false;
+	}
+	*id = value->value.value.int64;
+	return true;
+}
+
+// find rows that match 'where'. Rows are in ascending order. Caller must free 'rows'.
+static unsigned int mem_table_select(MemTable *table, MemExpr *where, unsigned int **rows)
+{
+	unsigned int *array;
+	unsigned int  n_rows = 0;
+	unsigned int  row;
+	int64_t       id;
+
+	array = malloc(sizeof(unsigned int) * (table->n_rows + 1));
+	// query by primary key uses binary search
+	if (where && table->primary != -1 && mem_expr_get_id(table, where, &id)) {
+		if (mem_table_find_id(table, id, &row) && mem_expr_eval(table, row, where) == 1)
+			array[n_rows++] = row;
+	}
+	else {
+		for (row = 0;  row < table->n_rows;  row++) {
+			if (where == NULL || mem_expr_eval(table, row, where) == 1)
+				array[n_rows++] = row;
+		}
+	}
+	*rows = array;
+	return n_rows;
+}
+
+// ----------------------------------------------------------------------------
+// SELECT
+
+static int  mem_send_value(Sqxc **xcAddr, const char *name, const MemValue *value)
+{
+	Sqxc *xc = *xcAddr;
+
+	xc->name = name;
+	switch (value->type) {
+	case MEM_INT:
+		xc->type = SQXC_TYPE_INT64;
+		xc->value.int64 = value->value.int64;
+		break;
+
+	case MEM_DOUBLE:
+		xc->type = SQXC_TYPE_DOUBLE;
+		xc->value.double_ = value->value.double_;
+		break;
+
+	case MEM_TEXT:
+		xc->type = SQXC_TYPE_STR;
+		xc->value.str = value->value.str;
+		break;
+
+	default:
+		xc->type = SQXC_TYPE_NULL;
+		xc->value.int64 = 0;       // clear all bits, parser may read any member of SqValue
+		break;
+	}
+	xc = sqxc_send(xc);
+
+#ifndef NDEBUG
+	if (xc->code == SQCODE_ENTRY_NOT_FOUND)
+		fprintf(stderr, "%s: column '%s' not found.\n", "SqdbMemory", name);
+#endif
+	// xc may be changed by sqxc_send()
+	*xcAddr = xc;
+	return (xc->code == SQCODE_ENTRY_NOT_FOUND) ? SQCODE_OK : xc->code;
+}
+
+// send a row. 'values' has 'n_columns' elements.
+static int  mem_send_row(Sqxc **xcAddr, const char **names, const MemValue *values, int n_columns)
+{
+	Sqxc *xc = *xcAddr;
+	int   code = SQCODE_OK;
+
+	// Don't send object if user selects only one column and the column type is built-in types (not object).
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		// SQL row corresponds to SQXC_TYPE_OBJECT
+		xc->type = SQXC_TYPE_OBJECT;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+		if (xc->code != SQCODE_OK) {
+			*xcAddr = xc;
+			return xc->code;
+		}
+	}
+
+	for (int index = 0;  index < n_columns && code == SQCODE_OK;  index++)
+		code = mem_send_value(&xc, names[index], values + index);
+
+	if (SQ_TYPE_NOT_BUILTIN(sqxc_value_element(xc))) {
+		xc->type = SQXC_TYPE_OBJECT_END;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	*xcAddr = xc;
+	return (code == SQCODE_OK) ? xc->code : code;
+}
+
+static const char *mem_aggregate_names[] = {NULL, "COUNT", "MIN", "MAX", "SUM", "AVG"};
+
+// compute aggregate function. 'column' is -1 if it is COUNT(*).
+static void mem_aggregate(MemTable *table, int aggregate, int column,
+                          const unsigned int *rows, unsigned int n_rows, MemValue *result)
+{
+	MemValue      value;
+	unsigned int  count = 0;
+	int64_t       sum_int = 0;
+	double        sum = 0.0;
+	bool          is_int = true;
+
+	result->type = MEM_NULL;
+	result->value.int64 = 0;
+	for (unsigned int cur = 0;  cur < n_rows;  cur++) {
+		if (column == -1) {
+			count++;
+			continue;
+		}
+		mem_column_get(table->columns.data[column], rows[cur], &value);
+		if (value.type == MEM_NULL)
+			continue;
+		count++;
+		switch (aggregate) {
+		case AGGREGATE_MIN:
+			if (result->type == MEM_NULL || mem_value_compare(&value, result) < 0)
+				*result = value;
+			break;
+		case AGGREGATE_MAX:
+			if (result->type == MEM_NULL || mem_value_compare(&value, result) > 0)
+				*result = value;
+			break;
+		default:
+			if (value.type == MEM_INT)
+				sum_int += value.value.int64;
+			else
+				is_int = false;
+			sum += mem_value_double(&value);
+			break;
+		}
+	}
+
+	switch (aggregate) {
+	case AGGREGATE_COUNT:
+		result->type = MEM_INT;
+		result->value.int64 = count;
+		break;
+	case AGGREGATE_SUM:
+		if (count == 0)
+			break;
+		result->type = (is_int) ? MEM_INT : MEM_DOUBLE;
+		if (is_int)
+			result->value.int64 = sum_int;
+		else
+			result->value.double_ = sum;
+		break;
+	case AGGREGATE_AVG:
+		if (count == 0)
+			break;
+		result->type = MEM_DOUBLE;
+		result->value.double_ = sum / count;
+		break;
+	}
+}
+
+// SELECT item {, item} FROM table [WHERE expr] [ORDER BY column [ASC|DESC] {, ...}]
+// ORDER BY can use CASE column WHEN value THEN value ... END
+//        [LIMIT n [OFFSET m] | LIMIT m, n]
+// item: * | table.* | [table.]column [AS alias] | aggregate([table.]column | *) [AS alias]
+// aggregate: COUNT, MIN, MAX, SUM, AVG
+// parse SELECT statement and find result rows. 'select' must be finalized by mem_select_final().
+// return SQCODE_OK, SQCODE_NO_DATA, or SQCODE_EXEC_ERROR.
+static int  mem_select_prepare(SqdbMemory *sqdb, MemParser *p, MemSelect *select)
+{
+	MemTable     *table;
+	MemExpr      *where = NULL;
+	MemOrder     *orders = NULL;
+	MemItem      *items;
+	MemItem      *item;
+	int           n_items = 0, n_orders = 0;
+	unsigned int  n_rows, start;
+	int64_t       limit = -1, offset = 0;
+	MemValue      number;
+	const char   *name;
+
+	memset(select, 0, sizeof(MemSelect));
+
+	// --- select list ---
+	do {
+		select->items = realloc(select->items, sizeof(MemItem) * (n_items + 1));
+		item = select->items + n_items++;
+		item->name  = NULL;
+		item->alias = NULL;
+		item->aggregate = AGGREGATE_NONE;
+		if (mem_parser_accept(p, "*"))
+			continue;
+		name = mem_parser_identifier(p);
+		if (name == NULL)
+			break;
+		if (mem_parser_accept(p, ".")) {
+			if (mem_parser_accept(p, "*"))
+				continue;
+			name = mem_parser_identifier(p);
+		}
+		else if (mem_parser_accept(p, "(")) {
+			for (item->aggregate = AGGREGATE_AVG;  item->aggregate > AGGREGATE_NONE;  item->aggregate--) {
+				if (strcasecmp(name, mem_aggregate_names[item->aggregate]) == 0)
+					break;
+			}
+			// argument of aggregate function
+			if (item->aggregate == AGGREGATE_COUNT && mem_parser_accept(p, "*"))
+				name = NULL;
+			else if ((name = mem_parser_identifier(p)) && mem_parser_accept(p, "."))
+				name = mem_parser_identifier(p);
+			if (item->aggregate == AGGREGATE_NONE)
+				mem_parser_error(p);
+			mem_parser_expect(p, ")");
+			select->n_aggregates++;
+			item->alias = mem_aggregate_names[item->aggregate];
+		}
+		item->name = name;
+		if (mem_parser_accept(p, "AS"))
+			item->alias = mem_parser_identifier(p);
+		else if (item->name)
+			item->alias = item->name;
+	} while (p->error == false && mem_parser_accept(p, ","));
+	items = select->items;
+
+	// aggregate function can't be used with columns because GROUP BY is not supported.
+	if (select->n_aggregates > 0 && select->n_aggregates < n_items)
+		mem_parser_error(p);
+	if (p->error || mem_parser_expect(p, "FROM") == false)
+		return SQCODE_EXEC_ERROR;
+	table = mem_parser_table(p, sqdb);
+	if (table == NULL)
+		return SQCODE_EXEC_ERROR;
+	select->table = table;
+
+	// --- resolve columns ---
+	select->columns = malloc(sizeof(int) * (n_items * (table->columns.length + 1) + 1));
+	select->names   = malloc(sizeof(char*) * (n_items * (table->columns.length + 1) + 1));
+	for (int index = 0;  index < n_items;  index++) {
+		item = items + index;
+		// *
+		if (item->name == NULL && item->aggregate == AGGREGATE_NONE) {
+			for (unsigned int nth = 0;  nth < table->columns.length;  nth++) {
+				select->columns[select->n_columns] = (int)nth;
+				select->names[select->n_columns++] = ((MemColumn*)table->columns.data[nth])->name;
+			}
+			continue;
+		}
+		// COUNT(*)
+		if (item->name == NULL)
+			select->columns[select->n_columns] = -1;
+		else {
+			select->columns[select->n_columns] = mem_table_find_column(table, item->name);
+			if (select->columns[select->n_columns] == -1) {
+#ifndef NDEBUG
+				fprintf(stderr, "%s: column '%s' not found.\n", "SqdbMemory", item->name);
+#endif
+				return SQCODE_EXEC_ERROR;
+			}
+		}
+		select->names[select->n_columns++] = item->alias;
+	}
+
+	// --- WHERE, ORDER BY, LIMIT ---
+	if (mem_parser_accept(p, "WHERE"))
+		where = mem_parser_or(p);
+	if (p->error == false && mem_parser_accept(p, "ORDER")) {
+		mem_parser_expect(p, "BY");
+		do {
+			orders = realloc(orders, sizeof(MemOrder) * (n_orders + 1));
+			orders[n_orders].cases = NULL;
+			// CASE column WHEN value THEN value ... END
+			if (mem_parser_accept(p, "CASE")) {
+				orders[n_orders].cases = mem_parser_case(p, &orders[n_orders].column);
+				mem_parser_expect(p, "END");
+			}
+			else
+				orders[n_orders].column = mem_parser_column(p);
+			orders[n_orders].desc = mem_parser_accept(p, "DESC");
+			if (orders[n_orders].desc == false)
+				mem_parser_accept(p, "ASC");
+			n_orders++;
+		} while (p->error == false && mem_parser_accept(p, ","));
+	}
+	if (p->error == false && mem_parser_accept(p, "LIMIT")) {
+		if (mem_parser_literal(p, &number) == false || number.type != MEM_INT)
+			mem_parser_error(p);
+		limit = number.value.int64;
+		// LIMIT n OFFSET m
+		if (mem_parser_accept(p, "OFFSET")) {
+			if (mem_parser_literal(p, &number) == false || number.type != MEM_INT)
+				mem_parser_error(p);
+			offset = number.value.int64;
+		}
+		// LIMIT m, n
+		else if (mem_parser_accept(p, ",")) {
+			offset = limit;
+			if (mem_parser_literal(p, &number) == false || number.type != MEM_INT)
+				mem_parser_error(p);
+			limit = number.value.int64;
+		}
+	}
+	if (mem_parser_end(p) == false) {
+		free(orders);
+		return SQCODE_EXEC_ERROR;
+	}
+
+	// --- execute ---
+	n_rows = mem_table_select(table, where, &select->rows);
+	select->values = malloc(sizeof(MemValue) * (select->n_columns + 1));
+	if (select->n_aggregates > 0) {
+		// aggregate functions produce one row
+		for (int index = 0;  index < select->n_columns;  index++) {
+			mem_aggregate(table, items[index].aggregate, select->columns[index],
+			              select->rows, n_rows, select->values + index);
+		}
+		n_rows = 1;
+	}
+	else if (n_orders > 0) {
+		unsigned int *temp = malloc(sizeof(unsigned int) * (n_rows + 1));
+		mem_table_sort(table, orders, n_orders, select->rows, n_rows, temp);
+		free(temp);
+	}
+	free(orders);
+	start = (offset < 0 || (uint64_t)offset >= n_rows) ? n_rows : (unsigned int)offset;
+	select->cur = start;
+	select->end = (limit < 0 || (uint64_t)limit >= n_rows - start) ? n_rows : start + (unsigned int)limit;
+
+	return (select->cur < select->end) ? SQCODE_OK : SQCODE_NO_DATA;
+}
+
+// send current row of 'select' to 'xcAddr' and move to next row.
+static int  mem_select_send_row(MemSelect *select, Sqxc **xcAddr)
+{
+	MemTable *table = select->table;
+	unsigned int  row;
+
+	if (select->n_aggregates == 0) {
+		row = select->rows[select->cur];
+		// rows have been erased after statement was executed
+		if (row >= table->n_rows)
+			return SQCODE_EXEC_ERROR;
+		for (int index = 0;  index < select->n_columns;  index++)
+			mem_column_get(table->columns.data[select->columns[index]], row, select->values + index);
+	}
+	select->cur++;
+	return mem_send_row(xcAddr, select->names, select->values, select->n_columns);
+}
+
+static void mem_select_final(MemSelect *select)
+{
+	free(select->rows);
+	free(select->values);
+	free(select->names);
+	free(select->columns);
+	free(select->items);
+}
+
+static int  mem_exec_select(SqdbMemory *sqdb, MemParser *p, Sqxc *xc)
+{
+	MemSelect  select;
+	int        code;
+
+	code = mem_select_prepare(sqdb, p, &select);
+	if (code != SQCODE_OK || xc == NULL)
+		goto exit;
+#ifndef NDEBUG
+	if (xc->info != SQXC_INFO_VALUE) {
+		fprintf(stderr, "%s: SELECT command must use with SqxcValue.\n", "sqdb_memory_exec()");
+		code = SQCODE_EXEC_ERROR;
+		goto exit;
+	}
+#endif
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY;
+		xc->name = NULL;
+		xc->value.pointer = NULL;
+		xc = sqxc_send(xc);
+	}
+
+	while (select.cur < select.end && code == SQCODE_OK)
+		code = mem_select_send_row(&select, &xc);
+
+	// If SqxcValue is prepared to receive multiple rows
+	if (sqxc_value_container(xc)) {
+		// SQL multiple rows corresponds to SQXC_TYPE_ARRAY
+		xc->type = SQXC_TYPE_ARRAY_END;
+		xc->name = NULL;
+		xc = sqxc_send(xc);
+	}
+
+exit:
+	mem_select_final(&select);
+	return code;
+}
+
+// ----------------------------------------------------------------------------
+// INSERT, UPDATE, DELETE
+
+static int  mem_int64_cmp(const void *value1, const void *value2)
+{
+	return (*(int64_t*)value1 > *(int64_t*)value2) - (*(int64_t*)value1 < *(int64_t*)value2);
+}
+
+// update existing 'row' by values of INSERT. It is used by ON CONFLICT DO UPDATE.
+static void mem_exec_insert_update(MemTable *table, unsigned int row, int *updates, int n_updates,
+                                   int *columns, int n_columns, MemValue *values)
+{
+	MemColumn *column;
+	int        index, nth;
+
+	for (index = 0;  index < n_updates;  index++) {
+		column = table->columns.data[updates[index]];
+		for (nth = 0;  nth < n_columns;  nth++) {
+			if (columns[nth] == updates[index])
+				break;
+		}
+		// excluded.column is default value if column isn't in INSERT
+		if (nth < n_columns)
+			mem_column_set(column, row, values + nth);
+		else
+			mem_column_set_default(column, row);
+	}
+
+	// ON UPDATE CURRENT_TIMESTAMP
+	for (unsigned int cur = 0;  cur < table->columns.length;  cur++) {
+		column = table->columns.data[cur];
+		if ((column->bit_field & SQB_COLUMN_CURRENT_ON_UPDATE) == 0)
+			continue;
+		for (index = 0;  index < n_updates;  index++) {
+			if (updates[index] == (int)cur)
+				break;
+		}
+		if (index == n_updates)
+			mem_column_set_now(column, row);
+	}
+}
+
+// INSERT INTO table [(column {, column})] VALUES (value {, value}) {, (...)}
+//        [ON CONFLICT (primary_key) DO NOTHING | DO UPDATE SET column = excluded.column {, ...}]
+static int  mem_exec_insert(SqdbMemory *sqdb, MemParser *p, Sqxc *xc)
+{
+	MemTable     *table = NULL;
+	MemColumn    *column;
+	MemValue     *values = NULL;     // n_rows * n_columns
+	MemValue      value;
+	int          *columns = NULL;    // index of columns in table
+	int           n_columns = 0;
+	int          *updates = NULL;    // index of columns that are updated on conflict
+	int           n_updates = 0;
+	bool          upsert = false;
+	int           id_index = -1;     // index of primary key in 'columns'
+	int64_t      *ids = NULL;
+	int64_t       id;
+	int64_t       changes = 0;
+	unsigned int  n_rows = 0;
+	unsigned int  row, position;
+	int           code = SQCODE_EXEC_ERROR;
+
+#ifndef NDEBUG
+	if (xc && xc->info != SQXC_INFO_SQL) {
+		fprintf(stderr, "%s: INSERT and UPDATE command must use with SqxcSql.\n", "sqdb_memory_exec()");
+		return SQCODE_EXEC_ERROR;
+	}
+#endif
+
+	if (mem_parser_expect(p, "INTO"))
+		table = mem_parser_table(p, sqdb);
+	if (table == NULL)
+		goto exit;
+
+	if (mem_parser_accept(p, "(")) {
+		do {
+			columns = realloc(columns, sizeof(int) * (n_columns + 1));
+			columns[n_columns++] = mem_parser_column(p);
+		} while (p->error == false && mem_parser_accept(p, ","));
+		mem_parser_expect(p, ")");
+	}
+	else {
+		n_columns = (int)table->columns.length;
+		columns = malloc(sizeof(int) * (n_columns + 1));
+		for (int index = 0;  index < n_columns;  index++)
+			columns[index] = index;
+	}
+	if (p->error || mem_parser_expect(p, "VALUES") == false)
+		goto exit;
+
+	// parse all rows before inserting them
+	do {
+		mem_parser_expect(p, "(");
+		values = realloc(values, sizeof(MemValue) * (n_columns * (n_rows + 1) + 1));
+		for (int index = 0;  index < n_columns && p->error == false;  index++) {
+			if (index > 0)
+				mem_parser_expect(p, ",");
+			if (mem_parser_literal(p, values + n_rows * n_columns + index) == false)
+				mem_parser_error(p);
+		}
+		mem_parser_expect(p, ")");
+		n_rows++;
+	} while (p->error == false && mem_parser_accept(p, ","));
+
+	// conflict target must be primary key because SqdbMemory doesn't check other UNIQUE constraints
+	if (p->error == false && mem_parser_accept(p, "ON")) {
+		upsert = true;
+		mem_parser_expect(p, "CONFLICT");
+		mem_parser_expect(p, "(");
+		if (p->error == false && (mem_parser_column(p) != table->primary || table->primary == -1))
+			mem_parser_error(p);
+		mem_parser_expect(p, ")");
+		mem_parser_expect(p, "DO");
+		if (p->error == false && mem_parser_accept(p, "NOTHING") == false) {
+			mem_parser_expect(p, "UPDATE");
+			mem_parser_expect(p, "SET");
+			do {
+				updates = realloc(updates, sizeof(int) * (n_updates + 1));
+				updates[n_updates] = mem_parser_column(p);
+				mem_parser_expect(p, "=");
+				// only excluded.column can be assigned
+				if (p->error == false && mem_parser_column(p) != updates[n_updates])
+					mem_parser_error(p);
+				n_updates++;
+			} while (p->error == false && mem_parser_accept(p, ","));
+		}
+	}
+	if (mem_parser_end(p) == false)
+		goto exit;
+
+	// generate and check values of primary key
+	if (table->primary != -1) {
+		column = table->columns.data[table->primary];
+		for (int index = 0;  index < n_columns;  index++) {
+			if (columns[index] == table->primary)
+				id_index = index;
+		}
+		ids = malloc(sizeof(int64_t) * n_rows * 2);
+		id = table->last_id;
+		for (row = 0;  row < n_rows;  row++) {
+			if (id_index == -1 || values[row * n_columns + id_index].type == MEM_NULL ||
+			    (column->bit_field & SQB_COLUMN_AUTOINCREMENT &&
+			     mem_value_int64(values + row * n_columns + id_index) == 0))
+			{
+				ids[row] = ++id;
+			}
+			else {
+				ids[row] = mem_value_int64(values + row * n_columns + id_index);
+				if (id < ids[row])
+					id = ids[row];
+			}
+		}
+		// sorted copy of ids is used to find duplicate value
+		memcpy(ids + n_rows, ids, sizeof(int64_t) * n_rows);
+		qsort(ids + n_rows, n_rows, sizeof(int64_t), mem_int64_cmp);
+		for (row = 0;  row < n_rows;  row++) {
+			id = ids[n_rows + row];
+			if ((row > 0 && id == ids[n_rows + row - 1]) ||
+			    (upsert == false && mem_table_find_id(table, id, &position)))
+			{
+#ifndef NDEBUG
+				fprintf(stderr, "%s: UNIQUE constraint failed: %s.%s\n",
+				        "SqdbMemory", table->name, column->name);
+#endif
+				goto exit;
+			}
+		}
+	}
+
+	for (unsigned int cur = 0;  cur < n_rows;  cur++) {
+		// rows are sorted by primary key
+		if (table->primary != -1) {
+			// row conflicts with primary key
+			if (mem_table_find_id(table, ids[cur], &row)) {
+				if (n_updates > 0) {
+					mem_exec_insert_update(table, row, updates, n_updates, columns, n_columns, values + cur * n_columns);
+					changes++;
+				}
+				continue;
+			}
+		}
+		else
+			row = table->n_rows;
+		mem_table_insert_row(table, row);
+		changes++;
+
+		for (unsigned int index = 0;  index < table->columns.length;  index++)
+			mem_column_set_default(table->columns.data[index], row);
+		for (int index = 0;  index < n_columns;  index++)
+			mem_column_set(table->columns.data[columns[index]], row, values + cur * n_columns + index);
+		if (table->primary != -1) {
+			value.type = MEM_INT;
+			value.value.int64 = ids[cur];
+			mem_column_set(table->columns.data[table->primary], row, &value);
+			if (table->last_id < ids[cur])
+				table->last_id = ids[cur];
+		}
+	}
+
+	code = SQCODE_OK;
+	if (xc) {
+		// set the last inserted row id
+		((SqxcSql*)xc)->id = (table->primary != -1) ? ids[n_rows - 1] : table->n_rows;
+		// set number of rows changed
+		((SqxcSql*)xc)->changes = changes;
+	}
+
+exit:
+	free(ids);
+	free(values);
+	free(updates);
+	free(columns);
+	return code;
+}
+
+// UPDATE table SET column = value {, column = value} [WHERE expr]
+// value can be CASE expression that is generated by SqxcSql to update multiple rows by primary key.
+static int  mem_exec_update(SqdbMemory *sqdb, MemParser *p, Sqxc *xc)
+{
+	MemTable     *table;
+	MemColumn    *column;
+	MemExpr      *where = NULL;
+	MemExpr     **cases = NULL;      // CASE expression of columns. NULL if value is literal.
+	MemExpr      *expr;
+	MemValue     *values = NULL;
+	MemValue      value;
+	int          *columns = NULL;    // index of columns in table
+	int          *columns_case = NULL;
+	int           n_columns = 0;
+	unsigned int *rows = NULL, n_rows = 0;
+	int           code = SQCODE_EXEC_ERROR;
+	int           index;
+
+#ifndef NDEBUG
+	if (xc && xc->info != SQXC_INFO_SQL) {
+		fprintf(stderr, "%s: INSERT and UPDATE command must use with SqxcSql.\n", "sqdb_memory_exec()");
+		return SQCODE_EXEC_ERROR;
+	}
+#endif
+
+	table = mem_parser_table(p, sqdb);
+	if (table == NULL || mem_parser_expect(p, "SET") == false)
+		goto exit;
+	do {
+		columns = realloc(columns, sizeof(int) * (n_columns + 1));
+		columns_case = realloc(columns_case, sizeof(int) * (n_columns + 1));
+		cases   = realloc(cases, sizeof(MemExpr*) * (n_columns + 1));
+		values  = realloc(values, sizeof(MemValue) * (n_columns + 1));
+		columns[n_columns] = mem_parser_column(p);
+		cases[n_columns] = NULL;
+		mem_parser_expect(p, "=");
+		// literal value or CASE expression can be assigned
+		if (p->error == false && mem_parser_accept(p, "CASE")) {
+			cases[n_columns] = mem_parser_case(p, columns_case + n_columns);
+			// rows that don't match any WHEN keep their value
+			if (mem_parser_expect(p, "ELSE") && mem_parser_column(p) != columns[n_columns])
+				mem_parser_error(p);
+			mem_parser_expect(p, "END");
+		}
+		else if (p->error == false && mem_parser_literal(p, values + n_columns) == false)
+			mem_parser_error(p);
+		n_columns++;
+	} while (p->error == false && mem_parser_accept(p, ","));
+	if (p->error == false && mem_parser_accept(p, "WHERE"))
+		where = mem_parser_or(p);
+	if (mem_parser_end(p) == false)
+		goto exit;
+
+	n_rows = mem_table_select(table, where, &rows);
+
+	// primary key can't be changed because rows are sorted by it
+	for (index = 0;  index < n_columns && table->primary != -1;  index++) {
+		if (columns[index] != table->primary)
+			continue;
+		if (cases[index]) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: primary key of table '%s' can't be changed.\n",
+			        "SqdbMemory", table->name);
+#endif
+			goto exit;
+		}
+		for (unsigned int cur = 0;  cur < n_rows;  cur++) {
+			mem_column_get(table->columns.data[table->primary], rows[cur], &value);
+			if (values[index].type == MEM_NULL || mem_value_compare(&value, values + index) != 0) {
+#ifndef NDEBUG
+				fprintf(stderr, "%s: primary key of table '%s' can't be changed.\n",
+				        "SqdbMemory", table->name);
+#endif
+				goto exit;
+			}
+		}
+	}
+
+	for (unsigned int cur = 0;  cur < n_rows;  cur++) {
+		for (index = 0;  index < n_columns;  index++) {
+			if (cases[index] == NULL) {
+				mem_column_set(table->columns.data[columns[index]], rows[cur], values + index);
+				continue;
+			}
+			mem_column_get(table->columns.data[columns_case[index]], rows[cur], &value);
+			for (expr = cases[index];  expr;  expr = expr->next) {
+				if (mem_value_compare(&value, &expr->left->value) == 0) {
+					mem_column_set(table->columns.data[columns[index]], rows[cur], &expr->right->value);
+					break;
+				}
+			}
+		}
+	}
+
+	// ON UPDATE CURRENT_TIMESTAMP
+	for (unsigned int nth = 0;  nth < table->columns.length;  nth++) {
+		column = table->columns.data[nth];
+		if ((column->bit_field & SQB_COLUMN_CURRENT_ON_UPDATE) == 0)
+			continue;
+		for (index = 0;  index < n_columns;  index++) {
+			if (columns[index] == (int)nth)
+				break;
+		}
+		if (index < n_columns)
+			continue;
+		for (unsigned int cur = 0;  cur < n_rows;  cur++)
+			mem_column_set_now(column, rows[cur]);
+	}
+
+	code = SQCODE_OK;
+	if (xc) {
+		// set number of rows changed
+		((SqxcSql*)xc)->changes = n_rows;
+	}
+
+exit:
+	free(rows);
+	free(values);
+	free(cases);
+	free(columns_case);
+	free(columns);
+	return code;
+}
+
+// DELETE FROM table [WHERE expr]
+static int  mem_exec_delete(SqdbMemory *sqdb, MemParser *p, Sqxc *xc)
+{
+	MemTable     *table = NULL;
+	MemExpr      *where = NULL;
+	unsigned int *rows, n_rows;
+
+	if (mem_parser_expect(p, "FROM"))
+		table = mem_parser_table(p, sqdb);
+	if (table && mem_parser_accept(p, "WHERE"))
+		where = mem_parser_or(p);
+	if (table == NULL || mem_parser_end(p) == false)
+		return SQCODE_EXEC_ERROR;
+
+	n_rows = mem_table_select(table, where, &rows);
+	mem_table_erase_rows(table, rows, n_rows);
+	free(rows);
+
+	if (xc && xc->info == SQXC_INFO_SQL) {
+		// set number of rows changed
+		((SqxcSql*)xc)->changes = n_rows;
+	}
+	return SQCODE_OK;
+}
+
+// ----------------------------------------------------------------------------
+// migration
+
+static bool mem_column_is_stored(SqColumn *column)
+{
+	// skip CONSTRAINT and INDEX
+	if (column->type == SQ_TYPE_CONSTRAINT || column->type == SQ_TYPE_INDEX)
+		return false;
+#if SQ_CONFIG_QUERY_ONLY_COLUMN
+	// skip QUERY ONLY columns
+	if (column->bit_field & SQB_COLUMN_QUERY)
+		return false;
+#endif
+	return true;
+}
+
+// apply attributes of 'sqcolumn' to 'column'
+static void mem_column_apply(MemColumn *column, SqColumn *sqcolumn)
+{
+	MemParser  parser;
+	MemValue   value;
+
+	column->bit_field = sqcolumn->bit_field;
+	if (column->default_value.type == MEM_TEXT)
+		free((char*)column->default_value.value.str);
+	column->default_value.type = MEM_NULL;
+	column->default_value.value.int64 = 0;
+
+	if (sqcolumn->default_value == NULL)
+		return;
+	if (strcasecmp(sqcolumn->default_value, "CURRENT_TIMESTAMP") == 0) {
+		column->bit_field |= SQB_COLUMN_CURRENT;
+		return;
+	}
+	mem_parser_init(&parser, sqcolumn->default_value);
+	if (mem_parser_literal(&parser, &value)) {
+		if (value.type == MEM_TEXT)
+			value.value.str = strdup(value.value.str);
+		column->default_value = value;
+	}
+	mem_parser_final(&parser);
+}
+
+static void mem_table_add_column(MemTable *table, SqColumn *sqcolumn)
+{
+	MemColumn *column;
+
+	column = mem_column_new(sqcolumn->name, mem_type_from_sqtype(sqcolumn->type), table->capacity);
+	mem_column_apply(column, sqcolumn);
+	for (unsigned int row = 0;  row < table->n_rows;  row++)
+		mem_column_set_default(column, row);
+	sq_ptr_array_push(&table->columns, column);
+}
+
+static void mem_create_table(SqdbMemory *sqdb, SqTable *table)
+{
+	MemTable     *memtable;
+	SqPtrArray   *entries;
+	SqColumn     *column;
+	unsigned int  index;
+
+	if (mem_table_find(sqdb, table->name, &index)) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: table '%s' already exists.\n", "SqdbMemory", table->name);
+#endif
+		return;
+	}
+	memtable = mem_table_new(table->name, (sqdb->config && sqdb->config->capacity) ?
+	                                      sqdb->config->capacity : SQDB_MEMORY_CAPACITY);
+	entries = sq_type_entry_array(table->type);
+	for (unsigned int nth = 0;  nth < entries->length;  nth++) {
+		column = entries->data[nth];
+		if (column->name && mem_column_is_stored(column))
+			mem_table_add_column(memtable, column);
+	}
+	mem_table_update_primary(memtable);
+	sq_ptr_array_push_in(&sqdb->tables, index, memtable);
+}
+
+static void mem_alter_table(SqdbMemory *sqdb, SqTable *table)
+{
+	MemTable     *memtable;
+	MemColumn    *memcolumn;
+	SqPtrArray   *entries;
+	SqColumn     *column;
+	int           index;
+
+	memtable = mem_table_find(sqdb, table->name, NULL);
+	if (memtable == NULL) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: table '%s' not found.\n", "SqdbMemory", table->name);
+#endif
+		return;
+	}
+
+	entries = sq_type_entry_array(table->type);
+	for (unsigned int nth = 0;  nth < entries->length;  nth++) {
+		column = entries->data[nth];
+		if (mem_column_is_stored(column) == false)
+			continue;
+
+		if (column->bit_field & SQB_COLUMN_CHANGED) {
+			// ALTER COLUMN
+			index = mem_table_find_column(memtable, column->name);
+			if (index == -1)
+				continue;
+			memcolumn = memtable->columns.data[index];
+			mem_column_convert(memcolumn, mem_type_from_sqtype(column->type),
+			                   memtable->n_rows, memtable->capacity);
+			mem_column_apply(memcolumn, column);
+		}
+		else if (column->name == NULL) {
+			// DROP COLUMN
+			index = mem_table_find_column(memtable, column->old_name);
+			if (index == -1)
+				continue;
+			mem_column_free(memtable->columns.data[index], memtable->n_rows);
+			sq_ptr_array_erase(&memtable->columns, index, 1);
+		}
+		else if (column->old_name && (column->bit_field & SQB_COLUMN_RENAMED) == 0) {
+			// RENAME COLUMN
+			index = mem_table_find_column(memtable, column->old_name);
+			if (index == -1)
+				continue;
+			memcolumn = memtable->columns.data[index];
+			free(memcolumn->name);
+			memcolumn->name = strdup(column->name);
+		}
+		else if (mem_table_find_column(memtable, column->name) == -1) {
+			// ADD COLUMN
+			mem_table_add_column(memtable, column);
+		}
+	}
+
+	// index of primary key may be changed
+	memtable->primary = -1;
+	mem_table_update_primary(memtable);
+}
+
+static void mem_rename_table(SqdbMemory *sqdb, const char *old_name, const char *new_name)
+{
+	MemTable     *memtable;
+	unsigned int  index;
+
+	memtable = mem_table_find(sqdb, old_name, &index);
+	if (memtable == NULL)
+		return;
+	// keep tables sorted by name
+	sq_ptr_array_steal(&sqdb->tables, index, 1);
+	free(memtable->name);
+	memtable->name = strdup(new_name);
+	if (mem_table_find(sqdb, new_name, &index)) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: table '%s' already exists.\n", "SqdbMemory", new_name);
+#endif
+		mem_table_free(memtable);
+		return;
+	}
+	sq_ptr_array_push_in(&sqdb->tables, index, memtable);
+}
+
+static void mem_drop_table(SqdbMemory *sqdb, const char *name)
+{
+	unsigned int  index;
+
+	// SqPtrArray::clear_func frees table
+	if (mem_table_find(sqdb, name, &index))
+		sq_ptr_array_erase(&sqdb->tables, index, 1);
+}
+
+// ----------------------------------------------------------------------------
+// SqdbInfo
+
+static void sqdb_memory_init(SqdbMemory *sqdb, const SqdbConfigMemory *config_src)
+{
+	sqdb->config = config_src;
+	sqdb->version = 0;
+	sq_ptr_array_init(&sqdb->tables, 8, (SqClearFunc)mem_table_free);
+	sqdb_stmt_cache_init(&sqdb->stmt_cache, (Sqdb*)sqdb,
+	                     (config_src) ? config_src->stmt_cache_size : 0,
+	                     (SqdbStmtDestroyFunc)sqdb_memory_destroy_stmt);
+}
+
+static void sqdb_memory_final(SqdbMemory *sqdb)
+{
+	// prepared statements must be destroyed before tables
+	sqdb_stmt_cache_final(&sqdb->stmt_cache);
+	sq_ptr_array_final(&sqdb->tables);
+}
+
+static int  sqdb_memory_open(SqdbMemory *sqdb, const char *database_name)
+{
+	// tables are kept until SqdbMemory is finalized.
+	// Sq::Db.version is the current schema version of these tables.
+	return SQCODE_OK;
+}
+
+static int  sqdb_memory_close(SqdbMemory *sqdb)
+{
+	return SQCODE_OK;
+}
+
+static int  sqdb_memory_migrate(SqdbMemory *sqdb, SqSchema *schema, SqSchema *schema_next)
+{
+	SqTable    *table;
+	SqPtrArray *reentries;
+
+	// If 'schema_next' is NULL, update and sort 'schema'.
+	if (schema_next == NULL) {
+		// sort tables and columns by their name
+		sq_schema_sort_table_column(schema);
+		return SQCODE_OK;
+	}
+
+	if (sqdb->version < schema_next->version) {
+		// do migrations by 'schema_next'
+		reentries = sq_type_entry_array(schema_next->type);
+		for (unsigned int index = 0;  index < reentries->length;  index++) {
+			table = (SqTable*)reentries->data[index];
+
+			if (table->bit_field & SQB_CHANGED) {
+				// ALTER TABLE
+				mem_alter_table(sqdb, table);
+			}
+			else if (table->name == NULL) {
+				// DROP TABLE
+				mem_drop_table(sqdb, table->old_name);
+			}
+			else if (table->old_name && (table->bit_field & SQB_RENAMED) == 0) {
+				// RENAME TABLE
+				mem_rename_table(sqdb, table->old_name, table->name);
+			}
+			else {
+				// CREATE TABLE
+				mem_create_table(sqdb, table);
+			}
+		}
+
+		// update database version
+		sqdb->version = schema_next->version;
+	}
+
+	// include and apply changes from 'schema_next'
+	sq_schema_update(schema, schema_next);
+	schema->version = schema_next->version;
+	return SQCODE_OK;
+}
+
+static int  sqdb_memory_exec(SqdbMemory *sqdb, const char *sql, Sqxc *xc, void *reserve)
+{
+	MemParser  parser;
+	int        code;
+
+	mem_parser_init(&parser, sql);
+	if (mem_parser_accept(&parser, "SELECT"))
+		code = mem_exec_select(sqdb, &parser, xc);
+	else if (mem_parser_accept(&parser, "INSERT"))
+		code = mem_exec_insert(sqdb, &parser, xc);
+	else if (mem_parser_accept(&parser, "UPDATE"))
+		code = mem_exec_update(sqdb, &parser, xc);
+	else if (mem_parser_accept(&parser, "DELETE"))
+		code = mem_exec_delete(sqdb, &parser, xc);
+	else if (mem_parser_is(&parser, "BEGIN") || mem_parser_is(&parser, "START") ||
+	         mem_parser_is(&parser, "COMMIT") || mem_parser_is(&parser, "END"))
+	{
+		// rows are changed immediately, so transaction has nothing to do.
+		code = SQCODE_OK;
+	}
+	else if (mem_parser_is(&parser, "ROLLBACK")) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: ROLLBACK is not supported.\n", "SqdbMemory");
+#endif
+		code = SQCODE_NOT_SUPPORTED;
+	}
+	else {
+		mem_parser_error(&parser);
+		code = SQCODE_NOT_SUPPORTED;
+	}
+	mem_parser_final(&parser);
+	return code;
+}
+
+// ----------------------------------------------------------------------------
+// prepared statement
+
+static void sqdb_memory_destroy_stmt(SqdbMemory *sqdb, SqdbStmt *stmt)
+{
+	MemStmt *memstmt = (MemStmt*)stmt;
+
+	sqdb_memory_reset(sqdb, stmt);
+	for (int index = 0;  index < memstmt->n_params;  index++)
+		free(memstmt->params[index]);
+	free(memstmt->params);
+	free(memstmt->sql);
+	sq_buffer_final(&memstmt->buf);
+	free(memstmt);
+}
+
+static int  sqdb_memory_prepare(SqdbMemory *sqdb, const char *sql, SqdbStmt **stmt)
+{
+	MemStmt *memstmt;
+	char     quote = 0;
+
+	// reuse cached statement
+	memstmt = (MemStmt*)sqdb_stmt_cache_get(&sqdb->stmt_cache, sql);
+	if (memstmt) {
+		*stmt = (SqdbStmt*)memstmt;
+		return SQCODE_OK;
+	}
+
+	memstmt = calloc(1, sizeof(MemStmt));
+	memstmt->sql = strdup(sql);
+	// count placeholders '?'
+	for (const char *cur = sql;  *cur;  cur++) {
+		if (quote) {
+			if (*cur == quote)
+				quote = 0;
+		}
+		else if (*cur == '\'' || *cur == '"')
+			quote = *cur;
+		else if (*cur == '?')
+			memstmt->n_params++;
+	}
+	if (memstmt->n_params > 0)
+		memstmt->params = calloc(memstmt->n_params, sizeof(char*));
+	sq_buffer_init(&memstmt->buf);
+	sqdb_stmt_cache_add(&sqdb->stmt_cache, sql, (SqdbStmt*)memstmt);
+
+	*stmt = (SqdbStmt*)memstmt;
+	return SQCODE_OK;
+}
+
+static int  sqdb_memory_bind(SqdbMemory *sqdb, SqdbStmt *stmt, int index, SqxcType type, const SqValue *value)
+{
+	MemStmt *memstmt = (MemStmt*)stmt;
+	char   **param;
+	char     str[32];
+	char    *timestr;
+	int      length;
+
+	if (index < 1 || index > memstmt->n_params)
+		return SQCODE_EXEC_ERROR;
+	param = memstmt->params + index -1;
+	free(*param);
+	*param = NULL;
+
+	switch (type) {
+	case SQXC_TYPE_NULL:
+		return SQCODE_OK;
+
+	case SQXC_TYPE_BOOL:
+		snprintf(str, sizeof(str), "%d", value->boolean ? 1 : 0);
+		break;
+
+	case SQXC_TYPE_INT:
+		snprintf(str, sizeof(str), "%d", value->integer);
+		break;
+
+	case SQXC_TYPE_UINT:
+		snprintf(str, sizeof(str), "%u", value->uinteger);
+		break;
+
+	case SQXC_TYPE_INT64:
+		snprintf(str, sizeof(str), "%" PRId64, value->int64);
+		break;
+
+	case SQXC_TYPE_UINT64:
+		snprintf(str, sizeof(str), "%" PRIu64, value->uint64);
+		break;
+
+	case SQXC_TYPE_TIME:
+		timestr = sq_time_to_string(value->rawtime, 0);
+		*param = malloc(strlen(timestr) + 3);
+		snprintf(*param, strlen(timestr) + 3, "'%s'", timestr);
+		free(timestr);
+		return SQCODE_OK;
+
+	case SQXC_TYPE_DOUBLE:
+		snprintf(str, sizeof(str), "%.17g", value->double_);
+		break;
+
+	case SQXC_TYPE_STR:
+		if (value->str == NULL)
+			return SQCODE_OK;
+		// string literal. single quote is escaped by ''
+		length = 2;
+		for (const char *cur = value->str;  *cur;  cur++)
+			length += (*cur == '\'') ? 2 : 1;
+		*param = malloc(length + 1);
+		length = 0;
+		(*param)[length++] = '\'';
+		for (const char *cur = value->str;  *cur;  cur++) {
+			if (*cur == '\'')
+				(*param)[length++] = '\'';
+			(*param)[length++] = *cur;
+		}
+		(*param)[length++] = '\'';
+		(*param)[length] = 0;
+		return SQCODE_OK;
+
+	default:
+		return SQCODE_TYPE_NOT_SUPPORTED;
+	}
+
+	*param = strdup(str);
+	return SQCODE_OK;
+}
+
+// used by sqdb_memory_step()
+// write SQL statement to 'buf' and replace placeholders by literals of bound values.
+static void mem_stmt_write_sql(MemStmt *memstmt, SqBuffer *buf)
+{
+	const char *param;
+	char        quote = 0;
+	int         index = 0;
+
+	buf->writed = 0;
+	for (const char *cur = memstmt->sql;  *cur;  cur++) {
+		if (quote) {
+			if (*cur == quote)
+				quote = 0;
+		}
+		else if (*cur == '\'' || *cur == '"')
+			quote = *cur;
+		else if (*cur == '?') {
+			param = memstmt->params[index++];
+			sq_buffer_write(buf, param ? param : "NULL");
+			continue;
+		}
+		sq_buffer_write_c(buf, *cur);
+	}
+	sq_buffer_write_c(buf, 0);    // null-terminated
+}
+
+static int  sqdb_memory_step(SqdbMemory *sqdb, SqdbStmt *stmt, Sqxc *xc)
+{
+	MemStmt  *memstmt = (MemStmt*)stmt;
+	int       code;
+
+	// execute statement in first step
+	if (memstmt->state == MEM_STMT_READY) {
+		mem_stmt_write_sql(memstmt, &memstmt->buf);
+		mem_parser_init(&memstmt->parser, memstmt->buf.mem);
+		// other statements are executed by sqdb_memory_exec() in first step
+		if (mem_parser_is(&memstmt->parser, "SELECT") == false) {
+			mem_parser_final(&memstmt->parser);
+			memstmt->state = MEM_STMT_DONE;
+			code = sqdb_memory_exec(sqdb, memstmt->buf.mem, xc, NULL);
+			return (code == SQCODE_OK || code == SQCODE_NO_DATA) ? SQCODE_DONE : code;
+		}
+		mem_parser_next(&memstmt->parser);
+		memstmt->state = MEM_STMT_SELECT;
+		// rows are found in first step and they are sent one by one
+		code = mem_select_prepare(sqdb, &memstmt->parser, &memstmt->select);
+		if (code == SQCODE_EXEC_ERROR) {
+			sqdb_memory_reset(sqdb, stmt);
+			memstmt->state = MEM_STMT_DONE;
+			return code;
+		}
+	}
+
+	if (memstmt->state == MEM_STMT_DONE || memstmt->select.cur >= memstmt->select.end)
+		return SQCODE_DONE;
+
+	// discard row if 'xc' is NULL
+	if (xc == NULL) {
+		memstmt->select.cur++;
+		return SQCODE_ROW;
+	}
+#ifndef NDEBUG
+	if (xc->info != SQXC_INFO_VALUE) {
+		fprintf(stderr, "%s: SELECT command must use with SqxcValue.\n",
+		        "sqdb_memory_step()");
+		return SQCODE_EXEC_ERROR;
+	}
+#endif
+
+	if (mem_select_send_row(&memstmt->select, &xc) != SQCODE_OK)
+		return SQCODE_EXEC_ERROR;
+	return SQCODE_ROW;
+}
+
+static int  sqdb_memory_reset(SqdbMemory *sqdb, SqdbStmt *stmt)
+{
+	MemStmt *memstmt = (MemStmt*)stmt;
+
+	if (memstmt->state == MEM_STMT_SELECT) {
+		mem_select_final(&memstmt->select);
+		mem_parser_final(&memstmt->parser);
+	}
+	memstmt->state = MEM_STMT_READY;
+	return SQCODE_OK;
+}
+
+static int  sqdb_memory_finalize(SqdbMemory *sqdb, SqdbStmt *stmt)
+{
+	MemStmt *memstmt = (MemStmt*)stmt;
+
+	if (stmt == NULL)
+		return SQCODE_OK;
+	// return cached statement to cache
+	if (sqdb_stmt_cache_release(&sqdb->stmt_cache, stmt)) {
+		sqdb_memory_reset(sqdb, stmt);
+		// clear bound values
+		for (int index = 0;  index < memstmt->n_params;  index++) {
+			free(memstmt->params[index]);
+			memstmt->params[index] = NULL;
+		}
+	}
+	else
+		sqdb_memory_destroy_stmt(sqdb, stmt);
+	return SQCODE_OK;
+}
+
+// ----------------------------------------------------------------------------
+// If C compiler doesn't support C99 inline function.
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+// C99 or C++ inline functions has defined in SqdbMemory.h
+
+#else   // __STDC_VERSION__
+// define functions here if compiler does NOT support inline function.
+
+Sqdb *sqdb_memory_new(const SqdbConfigMemory *config) {
+	return sqdb_new(SQDB_INFO_MEMORY, (SqdbConfig*)config);
+}
+
+#endif  // __STDC_VERSION__
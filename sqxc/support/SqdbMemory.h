@@ -0,0 +1,172 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+#ifndef SQDB_MEMORY_H
+#define SQDB_MEMORY_H
+
+#include <sqxc/Sqdb.h>
+#include <sqxc/SqPtrArray.h>
+#include <sqxc/SqdbStmtCache.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqdbMemory          SqdbMemory;
+typedef struct SqdbConfigMemory    SqdbConfigMemory;
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const SqdbInfo        sqdbInfo_Memory;
+#define SQDB_INFO_MEMORY   (&sqdbInfo_Memory)
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqdbMemory - in-memory Sqdb. Rows of each table are stored in typed column vectors.
+
+	Sqdb
+	|
+	`--- SqdbMemory
+
+	It executes migrations and the SQL statements that SqStorage and SqQuery generate for single table:
+	SELECT (columns, COUNT/MIN/MAX/SUM/AVG, WHERE, ORDER BY, LIMIT, OFFSET), INSERT, UPDATE, and DELETE.
+	INSERT accepts ON CONFLICT DO NOTHING / DO UPDATE if conflict target is integer primary key.
+	UPDATE and ORDER BY accept CASE column WHEN ... END that sq_storage_update_many() and
+	sq_storage_get_many() generate.
+	WHERE supports =, <>, !=, <, <=, >, >=, IS [NOT] NULL, [NOT] IN, [NOT] LIKE, [NOT] BETWEEN,
+	AND, OR, NOT, and parentheses. Rows are sorted by integer primary key, so query by primary key
+	uses binary search.
+	Prepared statement replaces placeholders by literals of bound values. SELECT statement finds
+	result rows in first sqdb_step() and sends one row in each step.
+
+	Note: Data is not durable and it belongs to SqdbMemory instance. Don't use it with SqdbPool.
+	      BEGIN and COMMIT are accepted, but ROLLBACK is not supported.
+	      UPDATE can only assign literal values or CASE expression above. JOIN, GROUP BY, and
+	      sub-query are not supported.
+	      Don't erase rows or drop table while SELECT statement is stepping.
+ */
+
+#ifdef __cplusplus
+struct SqdbMemory : Sq::DbMethod           // <-- 1. inherit C++ member function(method)
+#else
+struct SqdbMemory
+#endif
+{
+	SQDB_MEMBERS;                          // <-- 2. inherit member variable
+/*	// ------ Sqdb members ------
+	const SqdbInfo *info;
+
+	// schema version of the currently opened database
+	int             version;
+
+	// trace hook. It is called before and after executing SQL statement.
+	SqdbTraceFunc   trace;
+	void           *trace_data;
+ */
+
+	// ------ SqdbMemory members ------    // <-- 3. Add variable and non-virtual function in derived struct.
+	const SqdbConfigMemory *config;
+
+	// tables are sorted by name
+	SqPtrArray      tables;
+
+	// prepared statements. 'stmt_cache.hits' and 'stmt_cache.misses' are statistics of cache.
+	SqdbStmtCache   stmt_cache;
+};
+
+/*	SqdbConfigMemory - setting of SqdbMemory
+
+	SqdbConfig
+	|
+	`--- SqdbConfigMemory
+
+	SqdbConfigMemory must have no base struct because I need use aggregate initialization with it.
+ */
+struct SqdbConfigMemory
+{
+	SQDB_CONFIG_MEMBERS;                   // <-- 1. inherit member variable
+/*	// ------ SqdbConfig members ------
+	unsigned int    product;
+	unsigned int    bit_field;   // reserve
+ */
+
+	// ------ SqdbConfigMemory members ------
+	unsigned int    capacity;    // initial number of rows in each table. default is 16 if it is 0.
+
+	// number of cached prepared statements. 0 = SQ_CONFIG_SQDB_STMT_CACHE_SIZE_DEFAULT, -1 = disable cache
+	int             stmt_cache_size;
+};
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define global inline function
+
+#if (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)) || defined(__cplusplus)
+// define inline functions here if compiler supports inline function.
+
+#ifdef __cplusplus  // C++
+inline
+#else               // C99
+static inline
+#endif
+Sqdb *sqdb_memory_new(const SqdbConfigMemory *config) {
+	return sqdb_new(SQDB_INFO_MEMORY, (SqdbConfig*)config);
+}
+
+#else   // __STDC_VERSION__ || __cplusplus
+// declare functions here if compiler does NOT support inline function.
+
+Sqdb *sqdb_memory_new(const SqdbConfigMemory *config);
+
+#endif  // __STDC_VERSION__ || __cplusplus
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+typedef struct SqdbConfigMemory    DbConfigMemory;
+
+struct DbMemory : SqdbMemory
+{
+	// constructor
+	DbMemory(const SqdbConfigMemory *config = NULL) {
+		init(SQDB_INFO_MEMORY, (const SqdbConfig*)config);
+	}
+	DbMemory(const SqdbConfigMemory &config) {
+		init(SQDB_INFO_MEMORY, (const SqdbConfig*)&config);
+	}
+	// destructor
+	~DbMemory() {
+		final();
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+
+#endif  // SQDB_MEMORY_H
@@ -0,0 +1,449 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdio.h>             // fprintf(), stderr, fopen(), fread(), fwrite()
+#include <stdlib.h>            // malloc(), free()
+#include <string.h>            // strcmp(), strlen()
+
+#include <sqxc/SqError.h>
+#include <sqxc/Sqdb-migration.h>
+#include <sqxc/SqxcValue.h>
+#include <sqxc/SqxcSql.h>
+#include <sqxc/SqxcRecord.h>
+#include <sqxc/support/SqdbReplay.h>
+
+#ifdef _MSC_VER
+#define strdup       _strdup
+#endif
+
+#define SQDB_REPLAY_MAGIC      "SQRP"
+#define SQDB_REPLAY_FORMAT     1
+
+typedef struct ReplayEntry     ReplayEntry;
+typedef struct ReplayResult    ReplayResult;
+
+// result of SQL statement
+struct ReplayResult
+{
+	int32_t   code;
+	int64_t   id;         // SqxcSql::id
+	int64_t   changes;    // SqxcSql::changes
+	uint32_t  length;
+	char     *data;       // result set that was recorded by SqxcRecord
+};
+
+// recorded SQL statement and its results
+struct ReplayEntry
+{
+	char         *sql;
+	ReplayResult *results;
+	uint32_t      n_results;
+	uint32_t      cursor;     // index of next result in SQDB_REPLAY_PLAY mode
+};
+
+static void sqdb_replay_init(SqdbReplay *sqdb, const SqdbConfigReplay *config);
+static void sqdb_replay_final(SqdbReplay *sqdb);
+static int  sqdb_replay_open(SqdbReplay *sqdb, const char *database_name);
+static int  sqdb_replay_close(SqdbReplay *sqdb);
+// free instance (and elements in container) that was parsed by SqxcValue
+static void replay_free_instance(Sqxc *xc)
+{
+	const SqType *type = sqxc_value_container(xc);
+	SqType        type_temp;
+
+	if (type == NULL)
+		type = sqxc_value_element(xc);
+	// container_type->final() gets element type from SqType::entry if SqType::n_entry == -1
+	else if (type->n_entry != -1 || type->entry == NULL) {
+		type_temp = *type;
+		type_temp.entry   = (SqEntry**)sqxc_value_element(xc);
+		type_temp.n_entry = -1;
+		type = &type_temp;
+	}
+	sq_type_final_instance(type, &sqxc_value_instance(xc), true);
+}
+
+static int  sqdb_replay_exec(SqdbReplay *sqdb, const char *sql, Sqxc *xc, void *reserve);
+static int  sqdb_replay_migrate(SqdbReplay *sqdb, SqSchema *schema, SqSchema *schema_next);
+
+const SqdbInfo sqdbInfo_Replay = {
+	.size    = sizeof(SqdbReplay),
+	.product = SQDB_PRODUCT_UNKNOWN,
+	.column  = {
+		.use_alter  = 1,
+		.use_modify = 0,
+	},
+	.quote = {
+		.identifier = {'"', '"'}
+	},
+
+	.init    = (void*)sqdb_replay_init,
+	.final   = (void*)sqdb_replay_final,
+	.open    = (void*)sqdb_replay_open,
+	.close   = (void*)sqdb_replay_close,
+	.exec    = (void*)sqdb_replay_exec,
+	.migrate = (void*)sqdb_replay_migrate,
+};
+
+// ----------------------------------------------------------------------------
+// ReplayEntry
+
+static void replay_entry_free(ReplayEntry *entry)
+{
+	for (uint32_t index = 0;  index < entry->n_results;  index++)
+		free(entry->results[index].data);
+	free(entry->results);
+	free(entry->sql);
+	free(entry);
+}
+
+static int  replay_entry_cmp_sql(const void *sql, const void *entry)
+{
+	return strcmp(*(const char**)sql, (*(ReplayEntry**)entry)->sql);
+}
+
+static ReplayEntry *replay_entry_find(SqdbReplay *sqdb, const char *sql, bool create)
+{
+	ReplayEntry  *entry;
+	ReplayEntry **addr;
+	unsigned int  index;
+
+	addr = (ReplayEntry**)sq_ptr_array_find_sorted(&sqdb->entries, &sql,
+	                                               replay_entry_cmp_sql, &index);
+	if (addr)
+		return *addr;
+	if (create == false)
+		return NULL;
+
+	entry = calloc(1, sizeof(ReplayEntry));
+	entry->sql = strdup(sql);
+	sq_ptr_array_push_in(&sqdb->entries, index, entry);
+	return entry;
+}
+
+static ReplayResult *replay_entry_add(ReplayEntry *entry)
+{
+	ReplayResult *result;
+
+	entry->results = realloc(entry->results, sizeof(ReplayResult) * (entry->n_results + 1));
+	result = entry->results + entry->n_results++;
+	memset(result, 0, sizeof(ReplayResult));
+	return result;
+}
+
+// ----------------------------------------------------------------------------
+// file format. Integers are stored in native byte order.
+//
+// header: magic[4], uint32 format, int32 version, uint32 n_entries
+// entry:  uint32 sql_length, sql, uint32 n_results
+// result: int32 code, int64 id, int64 changes, uint32 length, data
+
+static bool replay_read(FILE *file, void *value, size_t size)
+{
+	return fread(value, 1, size, file) == size;
+}
+
+static char *replay_read_mem(FILE *file, uint32_t length, bool null_terminated)
+{
+	char *mem;
+
+	mem = malloc(length + 1);
+	if (replay_read(file, mem, length) == false) {
+		free(mem);
+		return NULL;
+	}
+	if (null_terminated)
+		mem[length] = 0;
+	return mem;
+}
+
+static int  sqdb_replay_load(SqdbReplay *sqdb, const char *path)
+{
+	FILE         *file;
+	ReplayEntry  *entry;
+	ReplayResult *result;
+	char          magic[4];
+	uint32_t      format, n_entries, n_results, length;
+	int32_t       version;
+	bool          ok;
+
+	file = fopen(path, "rb");
+	if (file == NULL)
+		return SQCODE_OPEN_FAILED;
+
+	ok = replay_read(file, magic, 4) && memcmp(magic, SQDB_REPLAY_MAGIC, 4) == 0 &&
+	     replay_read(file, &format, sizeof(format)) && format == SQDB_REPLAY_FORMAT &&
+	     replay_read(file, &version, sizeof(version)) &&
+	     replay_read(file, &n_entries, sizeof(n_entries));
+	sqdb->version = version;
+
+	for (uint32_t index = 0;  ok && index < n_entries;  index++) {
+		// entries were written in sorted order
+		entry = calloc(1, sizeof(ReplayEntry));
+		sq_ptr_array_push(&sqdb->entries, entry);
+		ok = replay_read(file, &length, sizeof(length)) &&
+		     (entry->sql = replay_read_mem(file, length, true)) != NULL &&
+		     replay_read(file, &n_results, sizeof(n_results));
+
+		for (uint32_t count = 0;  ok && count < n_results;  count++) {
+			result = replay_entry_add(entry);
+			ok = replay_read(file, &result->code, sizeof(result->code)) &&
+			     replay_read(file, &result->id, sizeof(result->id)) &&
+			     replay_read(file, &result->changes, sizeof(result->changes)) &&
+			     replay_read(file, &result->length, sizeof(result->length)) &&
+			     (result->data = replay_read_mem(file, result->length, false)) != NULL;
+		}
+	}
+	fclose(file);
+
+	if (ok == false) {
+#ifndef NDEBUG
+		fprintf(stderr, "%s: '%s' is not valid or truncated.\n",
+		        "sqdb_replay_open()", path);
+#endif
+		sq_ptr_array_erase(&sqdb->entries, 0, sqdb->entries.length);
+		return SQCODE_OPEN_FAILED;
+	}
+	return SQCODE_OK;
+}
+
+static int  sqdb_replay_save(SqdbReplay *sqdb, const char *path)
+{
+	FILE         *file;
+	ReplayEntry  *entry;
+	ReplayResult *result;
+	uint32_t      format = SQDB_REPLAY_FORMAT;
+	uint32_t      length;
+	int32_t       version = sqdb->version;
+	bool          ok;
+
+	file = fopen(path, "wb");
+	if (file == NULL)
+		return SQCODE_FILE_OPEN_FAILED;
+
+	ok = fwrite(SQDB_REPLAY_MAGIC, 1, 4, file) == 4 &&
+	     fwrite(&format, sizeof(format), 1, file) == 1 &&
+	     fwrite(&version, sizeof(version), 1, file) == 1 &&
+	     fwrite(&sqdb->entries.length, sizeof(uint32_t), 1, file) == 1;
+
+	for (unsigned int index = 0;  ok && index < sqdb->entries.length;  index++) {
+		entry = sqdb->entries.data[index];
+		length = (uint32_t)strlen(entry->sql);
+		ok = fwrite(&length, sizeof(length), 1, file) == 1 &&
+		     fwrite(entry->sql, 1, length, file) == length &&
+		     fwrite(&entry->n_results, sizeof(entry->n_results), 1, file) == 1;
+
+		for (uint32_t count = 0;  ok && count < entry->n_results;  count++) {
+			result = entry->results + count;
+			ok = fwrite(&result->code, sizeof(result->code), 1, file) == 1 &&
+			     fwrite(&result->id, sizeof(result->id), 1, file) == 1 &&
+			     fwrite(&result->changes, sizeof(result->changes), 1, file) == 1 &&
+			     fwrite(&result->length, sizeof(result->length), 1, file) == 1;
+			// 'data' is NULL if statement doesn't return rows
+			if (ok && result->length > 0)
+				ok = fwrite(result->data, 1, result->length, file) == result->length;
+		}
+	}
+
+	if (fclose(file) != 0)
+		ok = false;
+	return (ok) ? SQCODE_OK : SQCODE_ERROR;
+}
+
+// ----------------------------------------------------------------------------
+// SqdbInfo
+
+static void sqdb_replay_init(SqdbReplay *sqdb, const SqdbConfigReplay *config_src)
+{
+	sqdb->config = config_src;
+	sqdb->version = 0;
+	sqdb->opened = false;
+	sq_ptr_array_init(&sqdb->entries, 64, (SqClearFunc)replay_entry_free);
+}
+
+static void sqdb_replay_final(SqdbReplay *sqdb)
+{
+	// sqdb_replay_close() writes recorded data to file
+	if (sqdb->opened)
+		sqdb_replay_close(sqdb);
+	sq_ptr_array_final(&sqdb->entries);
+}
+
+static int  sqdb_replay_open(SqdbReplay *sqdb, const char *database_name)
+{
+	const SqdbConfigReplay *config = sqdb->config;
+	int   code;
+
+	if (config == NULL || config->path == NULL)
+		return SQCODE_OPEN_FAILED;
+
+	if (config->mode == SQDB_REPLAY_PLAY)
+		code = sqdb_replay_load(sqdb, config->path);
+	else if (config->db == NULL)
+		code = SQCODE_OPEN_FAILED;
+	else {
+		code = sqdb_open(config->db, database_name);
+		sqdb->version = config->db->version;
+	}
+
+	sqdb->opened = (code == SQCODE_OK);
+	return code;
+}
+
+static int  sqdb_replay_close(SqdbReplay *sqdb)
+{
+	const SqdbConfigReplay *config = sqdb->config;
+	int   code = SQCODE_OK;
+
+	if (sqdb->opened == false)
+		return SQCODE_OK;
+	sqdb->opened = false;
+
+	if (config->mode == SQDB_REPLAY_RECORD) {
+		code = sqdb_replay_save(sqdb, config->path);
+#ifndef NDEBUG
+		if (code != SQCODE_OK)
+			fprintf(stderr, "%s: can't write '%s'.\n", "sqdb_replay_close()", config->path);
+#endif
+		sqdb_close(config->db);
+	}
+	sq_ptr_array_erase(&sqdb->entries, 0, sqdb->entries.length);
+	return code;
+}
+
+static int  sqdb_replay_migrate(SqdbReplay *sqdb, SqSchema *schema, SqSchema *schema_next)
+{
+	Sqdb *db = sqdb->config->db;
+	int   code;
+
+	// SQDB_REPLAY_RECORD mode: wrapped Sqdb does migration.
+	if (sqdb->config->mode == SQDB_REPLAY_RECORD) {
+		code = sqdb_migrate(db, schema, schema_next);
+		sqdb->version = db->version;
+		return code;
+	}
+
+	// SQDB_REPLAY_PLAY mode: database doesn't exist, update schema only.
+	if (schema_next == NULL) {
+		// sort tables and columns by their name
+		sq_schema_sort_table_column(schema);
+		return SQCODE_OK;
+	}
+	if (sqdb->version < schema_next->version)
+		sqdb->version = schema_next->version;
+
+	// include and apply changes from 'schema_next'
+	sq_schema_update(schema, schema_next);
+	schema->version = schema_next->version;
+	return SQCODE_OK;
+}
+
+// send recorded result to 'xc'
+static int  sqdb_replay_result(ReplayResult *result, Sqxc *xc)
+{
+	int   code;
+
+	if (xc == NULL)
+		return result->code;
+
+	if (xc->info == SQXC_INFO_SQL) {
+		sqxc_sql_id(xc) = result->id;
+		sqxc_sql_changes(xc) = result->changes;
+	}
+	else if (result->length > 0) {
+		code = sqxc_record_replay(result->data, result->length, xc);
+		if (code != SQCODE_OK)
+			return code;
+	}
+	return result->code;
+}
+
+static int  sqdb_replay_exec(SqdbReplay *sqdb, const char *sql, Sqxc *xc, void *reserve)
+{
+	ReplayEntry  *entry;
+	ReplayResult *result;
+	Sqdb         *db;
+	const SqType *type;
+	void         *instance;
+	SqxcValueStats *stats;
+	size_t        length;
+
+	// --- SQDB_REPLAY_PLAY mode ---
+	if (sqdb->config->mode == SQDB_REPLAY_PLAY) {
+		entry = replay_entry_find(sqdb, sql, false);
+		if (entry == NULL || entry->n_results == 0) {
+#ifndef NDEBUG
+			fprintf(stderr, "%s: SQL is not recorded: %s\n", "sqdb_replay_exec()", sql);
+#endif
+			return SQCODE_EXEC_ERROR;
+		}
+		// replay results in recorded order and repeat the last one
+		result = entry->results + entry->cursor;
+		if (entry->cursor + 1 < entry->n_results)
+			entry->cursor++;
+		return sqdb_replay_result(result, xc);
+	}
+
+	// --- SQDB_REPLAY_RECORD mode ---
+	db = sqdb->config->db;
+	entry  = replay_entry_find(sqdb, sql, true);
+	result = replay_entry_add(entry);
+
+	if (xc && xc->info == SQXC_INFO_VALUE) {
+		// parse result set to new instance, record it, and replay it to 'xc' later.
+		// 'xc' may have instance to receive result set. Rows are counted when they are replayed.
+		type = sqxc_value_container(xc);
+		if (type == NULL)
+			type = sqxc_value_element(xc);
+		instance = sqxc_value_instance(xc);
+		stats = sqxc_value_stats(xc);
+		sqxc_value_instance(xc) = sq_type_init_instance(type, &sqxc_value_instance(xc), true);
+		sqxc_value_stats(xc) = NULL;
+		result->code = sqdb_exec(db, sql, xc, reserve);
+		sqxc_value_stats(xc) = stats;
+		if (result->code == SQCODE_OK) {
+			result->data = sqxc_record_write_instance(sqxc_value_element(xc),
+			                                          sqxc_value_container(xc),
+			                                          sqxc_value_instance(xc), &length);
+			result->length = (uint32_t)length;
+		}
+		replay_free_instance(xc);
+		sqxc_value_instance(xc) = instance;
+		return sqdb_replay_result(result, xc);
+	}
+
+	result->code = sqdb_exec(db, sql, xc, reserve);
+	if (xc && xc->info == SQXC_INFO_SQL) {
+		result->id = sqxc_sql_id(xc);
+		result->changes = sqxc_sql_changes(xc);
+	}
+	return result->code;
+}
+
+// ----------------------------------------------------------------------------
+// If C compiler doesn't support C99 inline function.
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)
+// C99 or C++ inline functions has defined in SqEntry.h
+
+#else   // __STDC_VERSION__
+// define functions here if compiler does NOT support inline function.
+
+Sqdb *sqdb_replay_new(const SqdbConfigReplay *config) {
+	return sqdb_new(SQDB_INFO_REPLAY, (SqdbConfig*)config);
+}
+
+#endif  // __STDC_VERSION__
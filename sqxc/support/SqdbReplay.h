@@ -0,0 +1,169 @@
+/*
+ *   Copyright (C) 2020-2026 by C.H. Huang
+ *   plushuang.tw@gmail.com
+ *
+ * sqxclib is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *          http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ */
+#ifndef SQDB_REPLAY_H
+#define SQDB_REPLAY_H
+
+#include <sqxc/Sqdb.h>
+#include <sqxc/SqPtrArray.h>
+
+// ----------------------------------------------------------------------------
+// C/C++ common declarations: declare type, structure, macro, enumeration.
+
+typedef struct SqdbReplay          SqdbReplay;
+typedef struct SqdbConfigReplay    SqdbConfigReplay;
+
+/* --- SqdbConfigReplay::mode --- */
+#define SQDB_REPLAY_RECORD    0    // run SQL by wrapped Sqdb and record result sets
+#define SQDB_REPLAY_PLAY      1    // replay result sets that were recorded to file
+
+// ----------------------------------------------------------------------------
+// C declarations: declare C data, function, and others.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const SqdbInfo        sqdbInfo_Replay;
+#define SQDB_INFO_REPLAY   (&sqdbInfo_Replay)
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define structure
+
+/*	SqdbReplay - Sqdb that records result sets of other Sqdb and replays them later.
+	             It is used to run deterministic performance tests without Database product.
+
+	Sqdb
+	|
+	`--- SqdbReplay
+
+	In SQDB_REPLAY_RECORD mode, SqdbReplay runs SQL statements by wrapped Sqdb (SqdbConfigReplay::db).
+	Result set of each SQL statement is saved in compact binary form (see SqxcRecord) and
+	all of them are written to file (SqdbConfigReplay::path) when database is closed.
+
+	In SQDB_REPLAY_PLAY mode, SqdbReplay loads file when database is opened and
+	sends recorded result set to Sqxc if it executes the same SQL statement.
+	If the same SQL statement was recorded many times, results are replayed in recorded order and
+	the last one is repeated.
+
+	Note: SQL statements are generated with SqdbInfo of SqdbReplay in both modes, so they are always
+	      the same. Wrapped Sqdb must accept double-quoted identifiers (SQLite and PostgreSQL).
+	      SqdbReplay doesn't support prepared statement, SqStorage puts values in SQL statements.
+ */
+
+#ifdef __cplusplus
+struct SqdbReplay : Sq::DbMethod           // <-- 1. inherit C++ member function(method)
+#else
+struct SqdbReplay
+#endif
+{
+	SQDB_MEMBERS;                          // <-- 2. inherit member variable
+/*	// ------ Sqdb members ------
+	const SqdbInfo *info;
+
+	// schema version of the currently opened database
+	int             version;
+
+	// trace hook. It is called before and after executing SQL statement.
+	SqdbTraceFunc   trace;
+	void           *trace_data;
+ */
+
+	// ------ SqdbReplay members ------    // <-- 3. Add variable and non-virtual function in derived struct.
+	const SqdbConfigReplay *config;
+
+	// recorded SQL statements. They are sorted by SQL.
+	SqPtrArray      entries;
+	bool            opened;
+};
+
+/*	SqdbConfigReplay - setting of SqdbReplay
+
+	SqdbConfig
+	|
+	`--- SqdbConfigReplay
+
+	SqdbConfigReplay must have no base struct because I need use aggregate initialization with it.
+ */
+struct SqdbConfigReplay
+{
+	SQDB_CONFIG_MEMBERS;                   // <-- 1. inherit member variable
+/*	// ------ SqdbConfig members ------
+	unsigned int    product;
+	unsigned int    bit_field;   // reserve
+ */
+
+	// ------ SqdbConfigReplay members ------
+	int          mode;    // SQDB_REPLAY_RECORD or SQDB_REPLAY_PLAY
+	const char  *path;    // file that stores recorded result sets
+	Sqdb        *db;      // Sqdb that is wrapped in SQDB_REPLAY_RECORD mode. SqdbReplay doesn't free it.
+};
+
+// ----------------------------------------------------------------------------
+// C/C++ common definitions: define global inline function
+
+#if (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 199901L)) || defined(__cplusplus)
+// define inline functions here if compiler supports inline function.
+
+#ifdef __cplusplus  // C++
+inline
+#else               // C99
+static inline
+#endif
+Sqdb *sqdb_replay_new(const SqdbConfigReplay *config) {
+	return sqdb_new(SQDB_INFO_REPLAY, (SqdbConfig*)config);
+}
+
+#else   // __STDC_VERSION__ || __cplusplus
+// declare functions here if compiler does NOT support inline function.
+
+Sqdb *sqdb_replay_new(const SqdbConfigReplay *config);
+
+#endif  // __STDC_VERSION__ || __cplusplus
+
+// ----------------------------------------------------------------------------
+// C++ definitions: define C++ data, function, method, and others.
+
+#ifdef __cplusplus
+
+namespace Sq {
+
+/* All derived struct/class must be C++11 standard-layout. */
+
+typedef struct SqdbConfigReplay    DbConfigReplay;
+
+struct DbReplay : SqdbReplay
+{
+	// constructor
+	DbReplay(const SqdbConfigReplay *config) {
+		init(SQDB_INFO_REPLAY, (const SqdbConfig*)config);
+	}
+	DbReplay(const SqdbConfigReplay &config) {
+		init(SQDB_INFO_REPLAY, (const SqdbConfig*)&config);
+	}
+	// destructor
+	~DbReplay() {
+		final();
+	}
+};
+
+};  // namespace Sq
+
+#endif  // __cplusplus
+
+
+#endif  // SQDB_REPLAY_H
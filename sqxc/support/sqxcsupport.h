@@ -31,3 +31,9 @@
 // Empty Sqxc and Sqdb for testing
 #include <sqxc/support/SqxcEmpty.h>
 #include <sqxc/support/SqdbEmpty.h>
+
+// record and replay result sets for testing
+#include <sqxc/support/SqdbReplay.h>
+
+// in-memory Sqdb for testing and caching
+#include <sqxc/support/SqdbMemory.h>
@@ -366,6 +366,13 @@ void test_storage()
 
 	storage->insert<Company>(NULL);
 	storage->get<Company>(1);
+
+	std::future<Company*> future = storage->getAsync<Company>(1);
+	future.get();
+	// write is queued as task that can be grouped by group commit
+	std::future<int64_t>  futureRemove = storage->removeAsync<Company>(1);
+	futureRemove.get();
+	storage->stopWorkers();
 }
 
 // ----------------------------------------------------------------------------
@@ -14,8 +14,10 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <sqxc/SqConfig.h>
+#include <sqxc/SqConvert.h>
 #include <sqxc/SqPtrArray.h>
 #include <sqxc/SqStrArray.h>
 #include <sqxc/SqSchema-macro.h>
@@ -528,10 +530,100 @@ void test_sqxc_sql_output(bool use_update)
 
 // ----------------------------------------------------------------------------
 
+// database products (e.g. SQLite) send column values by their storage class
+void test_sqxc_value_typed_input()
+{
+	Sqxc     *xc;
+	int64_t   int64_value = 0;
+	int       int_value = 0;
+	char     *str_value = NULL;
+	char     *time_str;
+
+	xc = sqxc_new(SQXC_INFO_VALUE);
+
+	// 64-bit integer that exceeds range of int
+	sqxc_value_element(xc)  = SQ_TYPE_INT64;
+	sqxc_value_instance(xc) = &int64_value;
+	sqxc_ready(xc, NULL);
+	xc->name = "id";
+	xc->type = SQXC_TYPE_INT64;
+	xc->value.int64 = 5000000000;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	assert(int64_value == 5000000000);
+
+	// double to int
+	sqxc_value_element(xc)  = SQ_TYPE_INT;
+	sqxc_value_instance(xc) = &int_value;
+	sqxc_ready(xc, NULL);
+	xc->name = "age";
+	xc->type = SQXC_TYPE_DOUBLE;
+	xc->value.double_ = 32.0;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	assert(int_value == 32);
+
+	// 64-bit integer to string
+	sqxc_value_element(xc)  = SQ_TYPE_STR;
+	sqxc_value_instance(xc) = &str_value;
+	sqxc_ready(xc, NULL);
+	xc->name = "name";
+	xc->type = SQXC_TYPE_INT64;
+	xc->value.int64 = -5000000000;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	assert(strcmp(str_value, "-5000000000") == 0);
+	free(str_value);
+
+	// unsigned 64-bit integer to string
+	sqxc_ready(xc, NULL);
+	xc->name = "name";
+	xc->type = SQXC_TYPE_UINT64;
+	xc->value.uint64 = 18446744073709551615ULL;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	assert(strcmp(str_value, "18446744073709551615") == 0);
+	free(str_value);
+
+	// bool to string
+	sqxc_ready(xc, NULL);
+	xc->name = "name";
+	xc->type = SQXC_TYPE_BOOL;
+	xc->value.boolean = true;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	assert(strcmp(str_value, "1") == 0);
+	free(str_value);
+
+	// time to string
+	sqxc_ready(xc, NULL);
+	xc->name = "name";
+	xc->type = SQXC_TYPE_TIME;
+	xc->value.rawtime = 1700000000;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	time_str = sq_time_to_string(1700000000, 0);
+	assert(strcmp(str_value, time_str) == 0);
+	free(time_str);
+	free(str_value);
+
+	// NULL to string
+	sqxc_ready(xc, NULL);
+	xc->name = "name";
+	xc->type = SQXC_TYPE_NULL;
+	xc->value.int64 = 0;
+	sqxc_send(xc);
+	sqxc_finish(xc, NULL);
+	assert(str_value == NULL);
+
+	sqxc_free(xc);
+}
+
 int  main(void)
 {
 	test_sqxc_joint_input();
 	test_sqxc_row_input_output();
+	test_sqxc_value_typed_input();
 #if SQ_CONFIG_HAVE_JSON
 	test_sqxc_json_input();
 	test_sqxc_json_input_user();
@@ -19,6 +19,8 @@
 
 #include <sqxc/sqxclib.h>
 #include <sqxc/SqSchema-macro.h>
+#include <sqxc/support/SqdbReplay.h>
+#include <sqxc/support/SqdbMemory.h>
 
 #define USE_SQLITE_IF_POSSIBLE        1
 #define USE_MYSQL_IF_POSSIBLE         0
@@ -121,7 +123,8 @@ void test_storage_crud(SqStorage *storage)
 	fprintf(stderr, "update(): ok.\n");
 
 	// remove
-	sq_storage_remove(storage, "companies", NULL, id);
+	n_changes = (int)sq_storage_remove(storage, "companies", NULL, id);
+	assert(n_changes == 1);
 
 	company_ptr = sq_storage_get(storage, "companies", NULL, id);
 	assert(company_ptr == NULL);
@@ -130,6 +133,55 @@ void test_storage_crud(SqStorage *storage)
 	fprintf(stderr, "\n");
 }
 
+void test_storage_prepare(SqStorage *storage)
+{
+	Sqdb      *db = storage->db;
+	SqdbStmt  *stmt;
+	SqdbStmt  *stmt_cached;
+	SqxcValue *xc_input;
+	SqValue    value;
+	int        count = -1;
+	int        code;
+
+	if (db->info->prepare == NULL)
+		return;
+
+	xc_input = (SqxcValue*)sqxc_new(SQXC_INFO_VALUE);
+	xc_input->container = NULL;
+	xc_input->element   = SQ_TYPE_INT;
+	xc_input->instance  = &count;
+
+	code = sqdb_prepare(db, "SELECT count(*) FROM companies WHERE age > ?", &stmt);
+	assert(code == SQCODE_OK);
+	value.integer = 0;
+	code = sqdb_bind(db, stmt, 1, SQXC_TYPE_INT, &value);
+	assert(code == SQCODE_OK);
+
+	sqxc_ready((Sqxc*)xc_input, NULL);
+	code = sqdb_exec_stmt(db, stmt, (Sqxc*)xc_input);
+	sqxc_finish((Sqxc*)xc_input, NULL);
+	assert(code == SQCODE_OK);
+	assert(count >= 0);
+	sqdb_finalize(db, stmt);
+
+	// the same SQL statement with different whitespace reuses cached statement
+	code = sqdb_prepare(db, "SELECT count(*)  FROM companies\n WHERE age > ? ;", &stmt_cached);
+	assert(code == SQCODE_OK);
+	assert(stmt_cached == stmt);
+	sqdb_finalize(db, stmt_cached);
+
+#if SQ_CONFIG_HAVE_SQLITE && USE_SQLITE_IF_POSSIBLE
+	// sq_storage_get() and sq_storage_remove() in test_storage_crud() use cached statement too
+	fprintf(stderr, "prepare(): cache hits = %"PRIu64", misses = %"PRIu64"\n",
+	        ((SqdbSqlite*)db)->stmt_cache.hits, ((SqdbSqlite*)db)->stmt_cache.misses);
+	assert(((SqdbSqlite*)db)->stmt_cache.hits >= 3);
+#endif
+
+	sqxc_free((Sqxc*)xc_input);
+	fprintf(stderr, "prepare(): ok.\n");
+	fprintf(stderr, "\n");
+}
+
 void test_storage_query(SqStorage *storage)
 {
 	Company   company;
@@ -137,6 +189,7 @@ void test_storage_query(SqStorage *storage)
 	union {
 		void *unknown;
 		int  *integer;
+		char **str;
 	} ptr;
 
 	fprintf(stderr, "Trying to query rows from a table that doesn't exist.\n");
@@ -160,6 +213,14 @@ void test_storage_query(SqStorage *storage)
 	assert(*ptr.integer == company.id);
 	free(ptr.integer);
 
+	// SQLite sends BLOB with its length
+	if (sq_storage_db_info(storage)->product == SQDB_PRODUCT_SQLITE) {
+		ptr.str = sq_storage_query_raw(storage, "SELECT x'616263'", SQ_TYPE_STR, NULL);
+		assert(strcmp(*ptr.str, "abc") == 0);
+		free(*ptr.str);
+		free(ptr.str);
+	}
+
 	// remove testing row
 	sq_storage_remove(storage, "companies", NULL, company.id);
 
@@ -264,6 +325,771 @@ void test_storage_xxx_all(SqStorage *storage)
 	fprintf(stderr, "\n");
 }
 
+void test_storage_copy(SqStorage *storage)
+{
+	SqPtrArray *array;
+	Company *company_ptr;
+	Company  companies[3] = {
+		{0, "Tab\tName",      21, "Line\nBreak", 1000},
+		{0, "Back\\slash",    22, "C:\\Path",    2000},
+		{0, "It's quoted",    23, "Texas",       3000},
+	};
+	int64_t  n_rows;
+	int      index;
+
+	array = sq_ptr_array_new(3, NULL);
+	for (index = 0;  index < 3;  index++)
+		sq_ptr_array_push(array, &companies[index]);
+
+	// SQLite and MySQL use INSERT with multiple rows, PostgreSQL uses COPY FROM STDIN.
+	n_rows = sq_storage_copy_in(storage, "companies", NULL, NULL, array);
+	sq_ptr_array_free(array);
+	fprintf(stderr, "copy_in(): number of rows inserted = %"PRId64"\n", n_rows);
+	assert(n_rows == 3);
+
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, "ORDER BY age");
+	assert(array != NULL);
+	assert(array->length == 3);
+	for (index = 0;  index < 3;  index++) {
+		company_ptr = array->data[index];
+		assert(company_ptr->age == companies[index].age);
+		assert(strcmp(company_ptr->name, companies[index].name) == 0);
+		assert(strcmp(company_ptr->address, companies[index].address) == 0);
+		company_free(company_ptr);
+	}
+	sq_ptr_array_free(array);
+	fprintf(stderr, "copy_in(): ok.\n");
+
+	// SQLite and MySQL use SELECT, PostgreSQL uses COPY TO STDOUT.
+	array = sq_storage_copy_out(storage, "companies", NULL, NULL, "WHERE age > 21 ORDER BY age");
+	assert(array != NULL);
+	assert(array->length == 2);
+	for (index = 0;  index < 2;  index++) {
+		company_ptr = array->data[index];
+		assert(company_ptr->age == companies[index+1].age);
+		assert(company_ptr->salary == companies[index+1].salary);
+		assert(strcmp(company_ptr->name, companies[index+1].name) == 0);
+		company_free(company_ptr);
+	}
+	sq_ptr_array_free(array);
+	fprintf(stderr, "copy_out(): ok.\n");
+
+	sq_storage_remove_all(storage, "companies", NULL);
+	fprintf(stderr, "\n");
+}
+
+void test_storage_insert_all(SqStorage *storage)
+{
+	SqPtrArray *array;
+	SqArray    *ids;
+	Company    *companies;
+	Company    *company_ptr;
+	unsigned int n_rows = SQ_CONFIG_SQXC_SQL_INSERT_ROWS * 2 + 3;
+	unsigned int index;
+
+	companies = calloc(n_rows, sizeof(Company));
+	array = sq_ptr_array_new(n_rows, NULL);
+	for (index = 0;  index < n_rows;  index++) {
+		companies[index].name = "Bulk";
+		companies[index].age = index;
+		companies[index].address = "Osaka";
+		sq_ptr_array_push(array, &companies[index]);
+	}
+
+	// INSERT with multiple rows is split into 3 statements
+	ids = sq_storage_insert_all(storage, "companies", NULL, NULL, array);
+	sq_ptr_array_free(array);
+	free(companies);
+	assert(ids != NULL);
+	assert(ids->length == n_rows);
+	for (index = 0;  index < n_rows;  index += SQ_CONFIG_SQXC_SQL_INSERT_ROWS / 2) {
+		company_ptr = sq_storage_get(storage, "companies", NULL, sq_array_at(ids, int64_t, index));
+		assert(company_ptr != NULL);
+		assert(company_ptr->age == (int)index);
+		company_free(company_ptr);
+	}
+	sq_array_free(ids);
+
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, "WHERE name = 'Bulk'");
+	assert(array != NULL);
+	assert(array->length == n_rows);
+	for (index = 0;  index < n_rows;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+
+	// failed insert_all() must not affect next insert() and update()
+	companies = calloc(2, sizeof(Company));
+	array = sq_ptr_array_new(2, NULL);
+	for (index = 0;  index < 2;  index++) {
+		companies[index].name = "Failed";
+		companies[index].address = "Nara";
+		sq_ptr_array_push(array, &companies[index]);
+	}
+	ids = sq_storage_insert_all(storage, "no_such_table",
+	                            sq_schema_find(storage->schema, "companies")->type,
+	                            NULL, array);
+	sq_array_free(ids);
+	companies[0].id = (int)sq_storage_insert(storage, "companies", NULL, &companies[0]);
+	assert(companies[0].id > 0);
+	companies[0].name = "Single";
+	assert(sq_storage_update(storage, "companies", NULL, &companies[0]) == 1);
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[0].id);
+	assert(company_ptr != NULL);
+	assert(strcmp(company_ptr->name, "Single") == 0);
+	assert(strcmp(company_ptr->address, "Nara") == 0);
+	company_free(company_ptr);
+	sq_ptr_array_free(array);
+	free(companies);
+
+	sq_storage_remove_all(storage, "companies", NULL);
+	fprintf(stderr, "insert_all(): ok.\n");
+}
+
+void test_storage_upsert(SqStorage *storage)
+{
+	SqPtrArray *array;
+	SqArray    *ids;
+	Company    *company_ptr;
+	Company     companies[3] = {
+		{0, "Alpha", 31, "Rome",  100},
+		{0, "Beta",  32, "Paris", 200},
+		{0, "Gamma", 33, "Lima",  300},
+	};
+	int64_t     changes;
+	int         index;
+
+	array = sq_ptr_array_new(3, NULL);
+	for (index = 0;  index < 3;  index++)
+		sq_ptr_array_push(array, &companies[index]);
+	ids = sq_storage_insert_all(storage, "companies", NULL, NULL, array);
+	assert(ids != NULL && ids->length == 3);
+
+	// 2 rows conflict with PRIMARY KEY, 1 row is new. Only 'salary' is updated on conflict.
+	for (index = 0;  index < 3;  index++) {
+		companies[index].id = (int)sq_array_at(ids, int64_t, index);
+		companies[index].name = "Changed";
+		companies[index].salary += 1000;
+	}
+	companies[2].id += 100;
+	changes = sq_storage_upsert_all(storage, "companies", NULL, NULL, array, "salary", NULL);
+	fprintf(stderr, "upsert_all(): number of rows changed = %"PRId64"\n", changes);
+	assert(changes >= 3);
+	sq_ptr_array_free(array);
+
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[0].id);
+	assert(company_ptr != NULL);
+	assert(company_ptr->salary == 1100);
+	assert(strcmp(company_ptr->name, "Alpha") == 0);
+	company_free(company_ptr);
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[2].id);
+	assert(company_ptr != NULL);
+	assert(strcmp(company_ptr->name, "Changed") == 0);
+	company_free(company_ptr);
+
+	// update all columns except PRIMARY KEY on conflict
+	companies[1].name = "Updated";
+	changes = sq_storage_upsert(storage, "companies", NULL, &companies[1], NULL);
+	assert(changes >= 1);
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[1].id);
+	assert(company_ptr != NULL);
+	assert(strcmp(company_ptr->name, "Updated") == 0);
+	assert(company_ptr->salary == 1200);
+	company_free(company_ptr);
+
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+	assert(array != NULL && array->length == 4);
+	for (index = 0;  index < (int)array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+	sq_array_free(ids);
+
+	sq_storage_remove_all(storage, "companies", NULL);
+	fprintf(stderr, "upsert(): ok.\n");
+}
+
+void test_storage_update_many(SqStorage *storage)
+{
+	SqPtrArray *array;
+	SqArray    *ids;
+	Company    *companies;
+	Company    *company_ptr;
+	unsigned int n_rows = SQ_CONFIG_SQXC_SQL_UPDATE_ROWS + 5;
+	int64_t     changes;
+	unsigned int index;
+
+	companies = calloc(n_rows, sizeof(Company));
+	array = sq_ptr_array_new(n_rows, NULL);
+	for (index = 0;  index < n_rows;  index++) {
+		companies[index].name = "Many";
+		companies[index].age = index;
+		companies[index].address = "Oslo";
+		sq_ptr_array_push(array, &companies[index]);
+	}
+	ids = sq_storage_insert_all(storage, "companies", NULL, NULL, array);
+	assert(ids != NULL && ids->length == n_rows);
+
+	// UPDATE with multiple rows is split into 2 statements. Only 'salary' is updated.
+	for (index = 0;  index < n_rows;  index++) {
+		companies[index].id = (int)sq_array_at(ids, int64_t, index);
+		companies[index].name = "Ignored";
+		companies[index].salary = index * 10;
+	}
+	changes = sq_storage_update_many(storage, "companies", NULL, NULL, array, "salary", NULL);
+	fprintf(stderr, "update_many(): number of rows changed = %"PRId64"\n", changes);
+	assert(changes == n_rows);
+
+	for (index = 0;  index < n_rows;  index += SQ_CONFIG_SQXC_SQL_UPDATE_ROWS / 2) {
+		company_ptr = sq_storage_get(storage, "companies", NULL, companies[index].id);
+		assert(company_ptr != NULL);
+		assert(company_ptr->salary == index * 10);
+		assert(strcmp(company_ptr->name, "Many") == 0);
+		company_free(company_ptr);
+	}
+
+	// update all columns except PRIMARY KEY
+	array->length = 2;
+	companies[0].name = "O'Brien";
+	companies[1].address = "Bergen";
+	changes = sq_storage_update_many(storage, "companies", NULL, NULL, array, NULL);
+	assert(changes == 2);
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[0].id);
+	assert(company_ptr != NULL);
+	assert(strcmp(company_ptr->name, "O'Brien") == 0);
+	assert(strcmp(company_ptr->address, "Oslo") == 0);
+	company_free(company_ptr);
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[1].id);
+	assert(company_ptr != NULL);
+	assert(strcmp(company_ptr->name, "Ignored") == 0);
+	assert(strcmp(company_ptr->address, "Bergen") == 0);
+	assert(company_ptr->salary == 10);
+	company_free(company_ptr);
+
+	// failed update_many() must not affect next update(). It should update 1 row only.
+	sq_storage_update_many(storage, "no_such_table",
+	                       sq_schema_find(storage->schema, "companies")->type,
+	                       NULL, array, NULL);
+	companies[2].name = "Single";
+	changes = sq_storage_update(storage, "companies", NULL, &companies[2]);
+	assert(changes == 1);
+	company_ptr = sq_storage_get(storage, "companies", NULL, companies[3].id);
+	assert(company_ptr != NULL);
+	assert(strcmp(company_ptr->name, "Many") == 0);
+	company_free(company_ptr);
+
+	sq_ptr_array_free(array);
+	sq_array_free(ids);
+	free(companies);
+	sq_storage_remove_all(storage, "companies", NULL);
+	fprintf(stderr, "update_many(): ok.\n");
+}
+
+void test_storage_get_many(SqStorage *storage)
+{
+	SqPtrArray *array;
+	SqArray    *ids;
+	Company    *companies;
+	Company    *company_ptr;
+	int64_t    *keys;
+	int64_t     changes;
+	unsigned int n_rows = SQ_CONFIG_STORAGE_MANY_KEYS + 5;
+	unsigned int index;
+
+	companies = calloc(n_rows, sizeof(Company));
+	array = sq_ptr_array_new(n_rows, NULL);
+	for (index = 0;  index < n_rows;  index++) {
+		companies[index].name = "Many";
+		companies[index].age = index;
+		companies[index].address = "Kyoto";
+		sq_ptr_array_push(array, &companies[index]);
+	}
+	ids = sq_storage_insert_all(storage, "companies", NULL, NULL, array);
+	sq_ptr_array_free(array);
+	free(companies);
+	assert(ids != NULL && ids->length == n_rows);
+
+	// rows are in the order of keys. duplicated key is returned once and missing key is skipped.
+	keys = malloc(sizeof(int64_t) * 5);
+	keys[0] = sq_array_at(ids, int64_t, 3);
+	keys[1] = sq_array_at(ids, int64_t, 1);
+	keys[2] = sq_array_at(ids, int64_t, 3);
+	keys[3] = sq_array_at(ids, int64_t, n_rows - 1) + 100;
+	keys[4] = sq_array_at(ids, int64_t, 2);
+	array = sq_storage_get_many(storage, "companies", NULL, keys, 5, NULL);
+	assert(array != NULL && array->length == 3);
+	assert(((Company*)array->data[0])->age == 3);
+	assert(((Company*)array->data[1])->age == 1);
+	assert(((Company*)array->data[2])->age == 2);
+	for (index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+	free(keys);
+
+	// keys are split into 2 statements
+	array = sq_storage_get_many(storage, "companies", NULL, (int64_t*)ids->data, n_rows, NULL);
+	assert(array != NULL && array->length == n_rows);
+	for (index = 0;  index < n_rows;  index++) {
+		assert(((Company*)array->data[index])->age == (int)index);
+		company_free(array->data[index]);
+	}
+	sq_ptr_array_free(array);
+
+	// remove all rows except the last one
+	changes = sq_storage_remove_many(storage, "companies", NULL, (int64_t*)ids->data, n_rows - 1);
+	assert(changes == n_rows - 1);
+	company_ptr = sq_storage_get(storage, "companies", NULL, sq_array_at(ids, int64_t, 0));
+	assert(company_ptr == NULL);
+	company_ptr = sq_storage_get(storage, "companies", NULL, sq_array_at(ids, int64_t, n_rows - 1));
+	assert(company_ptr != NULL);
+	company_free(company_ptr);
+	array = sq_storage_get_many(storage, "companies", NULL, (int64_t*)ids->data, n_rows, NULL);
+	assert(array != NULL && array->length == 1);
+	company_free(array->data[0]);
+	sq_ptr_array_free(array);
+
+	sq_array_free(ids);
+	sq_storage_remove_all(storage, "companies", NULL);
+	fprintf(stderr, "get_many(): ok.\n");
+}
+
+void test_storage_cursor(SqStorage *storage)
+{
+	SqStorageCursor *cursor;
+	SqPtrArray *array;
+	SqArray    *ids;
+	SqQuery    *query;
+	Company    *companies;
+	Company    *company_ptr;
+	Company    *reused;
+	unsigned int n_rows = 25;
+	unsigned int count;
+	unsigned int index;
+
+	companies = calloc(n_rows, sizeof(Company));
+	array = sq_ptr_array_new(n_rows, NULL);
+	for (index = 0;  index < n_rows;  index++) {
+		companies[index].name = "Cursor";
+		companies[index].age = index;
+		companies[index].address = "Osaka";
+		sq_ptr_array_push(array, &companies[index]);
+	}
+	ids = sq_storage_insert_all(storage, "companies", NULL, NULL, array);
+	sq_ptr_array_free(array);
+	free(companies);
+	assert(ids != NULL && ids->length == n_rows);
+
+	// caller frees every row
+	cursor = sq_storage_cursor_open_table(storage, "companies", NULL, "WHERE age >= 10");
+	assert(cursor != NULL);
+	for (count = 0;  (company_ptr = sq_storage_cursor_next(cursor)) != NULL;  count++) {
+		assert(company_ptr->age == (int)count + 10);
+		assert(strcmp(company_ptr->address, "Osaka") == 0);
+		company_free(company_ptr);
+	}
+	assert(count == n_rows - 10);
+	assert(cursor->code == SQCODE_DONE);
+	assert(sq_storage_cursor_next(cursor) == NULL);
+	sq_storage_cursor_close(cursor);
+
+	// every row is parsed into the same instance
+	cursor = sq_storage_cursor_open_table(storage, "companies", NULL, NULL);
+	assert(cursor != NULL);
+	sq_storage_cursor_reuse(cursor, true);
+	reused = NULL;
+	for (count = 0;  (company_ptr = sq_storage_cursor_next(cursor)) != NULL;  count++) {
+		if (reused == NULL)
+			reused = company_ptr;
+		assert(company_ptr == reused);
+		assert(company_ptr->age == (int)count);
+	}
+	assert(count == n_rows);
+	assert(cursor->code == SQCODE_DONE);
+	sq_storage_cursor_close(cursor);
+
+	// rows in batches and other operations while cursor is open
+	query = sq_query_new("companies");
+	sq_query_where_raw(query, "age < %d", 12);
+	cursor = sq_storage_cursor_open(storage, query, NULL);
+	assert(cursor != NULL);
+	for (count = 0;  (array = sq_storage_cursor_next_batch(cursor, 5, NULL)) != NULL;  ) {
+		assert(array->length <= 5);
+		for (index = 0;  index < array->length;  index++, count++) {
+			assert(((Company*)array->data[index])->age == (int)count);
+			company_free(array->data[index]);
+		}
+		sq_ptr_array_free(array);
+
+		company_ptr = sq_storage_get(storage, "companies", NULL, sq_array_at(ids, int64_t, 0));
+		assert(company_ptr != NULL && company_ptr->age == 0);
+		company_free(company_ptr);
+	}
+	assert(count == 12);
+	assert(cursor->code == SQCODE_DONE);
+	sq_storage_cursor_close(cursor);
+	sq_query_free(query);
+
+	// close cursor before all rows are returned
+	cursor = sq_storage_cursor_open_table(storage, "companies", NULL, NULL);
+	company_ptr = sq_storage_cursor_next(cursor);
+	assert(company_ptr != NULL && company_ptr->age == 0);
+	company_free(company_ptr);
+	sq_storage_cursor_close(cursor);
+
+	sq_array_free(ids);
+	sq_storage_remove_all(storage, "companies", NULL);
+	fprintf(stderr, "cursor(): ok.\n");
+}
+
+void test_storage_identity_map(SqStorage *storage)
+{
+	SqIdentityMap *map;
+	SqPtrArray *array;
+	Company *company_ptr;
+	Company  company = {0, "Tom", 25, "Texas", 10245};
+	int64_t  id;
+
+	sq_storage_set_identity_map(storage, 2);
+	map = storage->identity_map;
+	assert(map != NULL);
+
+	// insert() adds row to identity map
+	id = sq_storage_insert(storage, "companies", NULL, &company);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr != NULL);
+	assert(company_ptr->id == id);
+	assert(strcmp(company_ptr->name, "Tom") == 0);
+	assert(map->hits == 1 && map->misses == 0);
+	company_free(company_ptr);
+
+	// update() removes row from identity map
+	company.id = (int)id;
+	company.age = 28;
+	sq_storage_update(storage, "companies", NULL, &company);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr->age == 28);
+	assert(map->hits == 1 && map->misses == 1);
+	company_free(company_ptr);
+	// get() added row to identity map
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr->age == 28);
+	assert(map->hits == 2);
+	company_free(company_ptr);
+
+	// get_all() adds rows to identity map, the least recently used row is evicted.
+	company.id = 0;
+	sq_storage_insert(storage, "companies", NULL, &company);
+	sq_storage_insert(storage, "companies", NULL, &company);
+	assert(map->entries.length == 2 && map->evictions == 1);
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+	assert(array->length == 3);
+	assert(map->entries.length == 2 && map->evictions == 4);
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+
+	// remove_all() removes all rows of table from identity map
+	sq_storage_remove_all(storage, "companies", NULL);
+	assert(map->entries.length == 0);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr == NULL);
+
+	sq_storage_set_identity_map(storage, -1);
+	assert(storage->identity_map == NULL);
+	fprintf(stderr, "identity_map: ok.\n\n");
+}
+
+void test_storage_row_cache(SqStorage *storage)
+{
+	SqRowCacheConfig config = {0, 0, 4};
+	SqRowCacheStats  stats;
+	SqRowCache   *cache;
+	SqStorage    *storage2;
+	SqPtrArray   *array;
+	const SqType *type;
+	Company      *company_ptr;
+	Company       company = {0, "Ruby", 31, "Ohio", 9800};
+	int64_t       id, id2;
+	uint64_t      time;
+
+	// two SqStorage share rows by SqRowCache
+	cache = sq_row_cache_new(&config);
+	type = sq_storage_find(storage, "companies")->type;
+	storage2 = sq_storage_new(storage->db);
+	sq_storage_set_row_cache(storage, cache);
+	sq_storage_set_row_cache(storage2, cache);
+
+	id = sq_storage_insert(storage, "companies", NULL, &company);
+	id2 = sq_storage_insert(storage, "companies", NULL, &company);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	company_free(company_ptr);
+	company_ptr = sq_storage_get(storage2, "companies", type, id);
+	assert(company_ptr != NULL);
+	assert(company_ptr->id == id && strcmp(company_ptr->address, "Ohio") == 0);
+	company_free(company_ptr);
+	sq_row_cache_get_stats(cache, &stats);
+	assert(stats.hits == 1 && stats.misses == 1 && stats.n_rows == 1);
+
+	// update() in one SqStorage removes row that is cached by another
+	company.id = (int)id;
+	company.age = 32;
+	sq_storage_update(storage2, "companies", type, &company);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr->age == 32);
+	company_free(company_ptr);
+	sq_row_cache_get_stats(cache, &stats);
+	assert(stats.hits == 1 && stats.misses == 2);
+
+	// get_all() puts all rows
+	array = sq_storage_get_all(storage2, "companies", type, NULL, NULL);
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id2);
+	assert(company_ptr->id == id2);
+	company_free(company_ptr);
+	sq_row_cache_get_stats(cache, &stats);
+	assert(stats.hits == 2 && stats.n_rows == 2);
+
+	// table that is changed in transaction doesn't use cache until commit
+	sq_storage_begin_trans(storage);
+	company.age = 33;
+	sq_storage_update(storage, "companies", NULL, &company);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr->age == 33);
+	company_free(company_ptr);
+	sq_storage_commit_trans(storage);
+	sq_row_cache_get_stats(cache, &stats);
+	assert(stats.hits == 2 && stats.misses == 2 && stats.n_rows == 0);
+
+	// remove_all() removes all rows of table
+	company_ptr = sq_storage_get(storage2, "companies", type, id2);
+	company_free(company_ptr);
+	sq_storage_remove_all(storage2, "companies", NULL);
+	sq_row_cache_get_stats(cache, &stats);
+	assert(stats.n_rows == 0 && stats.n_bytes == 0);
+	company_ptr = sq_storage_get(storage, "companies", NULL, id2);
+	assert(company_ptr == NULL);
+
+	sq_storage_set_row_cache(storage, NULL);
+	sq_storage_free(storage2);
+	sq_row_cache_free(cache);
+
+	// row expires after 'ttl' milliseconds
+	config.ttl = 1;
+	cache = sq_row_cache_new(&config);
+	company.id = 7;
+	sq_row_cache_put(cache, "companies", 7, type, &company, sq_row_cache_version(cache, "companies"));
+	company_ptr = sq_row_cache_get(cache, "companies", 7, type, &time);
+	assert(company_ptr != NULL && company_ptr->age == 33);
+	company_free(company_ptr);
+	for (time = sq_clock_msec();  sq_clock_msec() < time + 2;)
+		continue;
+	company_ptr = sq_row_cache_get(cache, "companies", 7, type, &time);
+	assert(company_ptr == NULL);
+	sq_row_cache_put(cache, "companies", 7, type, NULL, time);
+	sq_row_cache_get_stats(cache, &stats);
+	assert(stats.expirations == 1 && stats.n_rows == 0);
+	sq_row_cache_free(cache);
+	fprintf(stderr, "row_cache: ok.\n\n");
+}
+
+void test_storage_query_cache(SqStorage *storage)
+{
+	SqQueryCacheStats stats;
+	SqQueryCache *cache;
+	SqPtrArray   *array;
+	SqQuery      *query;
+	Company       company = {0, "Eva", 45, "Utah", 12000};
+
+	cache = sq_query_cache_new(NULL);
+	sq_storage_set_query_cache(storage, cache);
+	sq_storage_insert(storage, "companies", NULL, &company);
+
+	// the same SQL statement returns copy of cached result
+	for (int count = 0;  count < 2;  count++) {
+		array = sq_storage_get_all(storage, "companies", NULL, NULL, "WHERE age > 40");
+		assert(array->length == 1);
+		assert(strcmp(((Company*)array->data[0])->name, "Eva") == 0);
+		company_free(array->data[0]);
+		sq_ptr_array_free(array);
+	}
+	sq_query_cache_get_stats(cache, &stats);
+	assert(stats.hits == 1 && stats.misses == 1 && stats.n_results == 1);
+
+	query = sq_query_new("companies");
+	sq_query_where_raw(query, "age > %d", 40);
+	for (int count = 0;  count < 2;  count++) {
+		array = sq_storage_query(storage, query, NULL, NULL);
+		assert(array->length == 1);
+		company_free(array->data[0]);
+		sq_ptr_array_free(array);
+	}
+	sq_query_cache_get_stats(cache, &stats);
+	assert(stats.hits == 2 && stats.misses == 2 && stats.n_results == 2);
+
+	// writing to table removes results that use it
+	sq_storage_insert(storage, "companies", NULL, &company);
+	sq_query_cache_get_stats(cache, &stats);
+	assert(stats.n_results == 0 && stats.invalidations == 2);
+	array = sq_storage_query(storage, query, NULL, NULL);
+	assert(array->length == 2);
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+	sq_query_free(query);
+
+	sq_storage_remove_all(storage, "companies", NULL);
+	sq_storage_set_query_cache(storage, NULL);
+	sq_query_cache_free(cache);
+	fprintf(stderr, "query_cache: ok.\n\n");
+}
+
+typedef struct TraceResult    TraceResult;
+
+struct TraceResult
+{
+	int       n_begin;
+	int       n_end;
+	SqdbTrace last;
+};
+
+static void test_storage_trace_func(void *data, Sqdb *db, const SqdbTrace *trace)
+{
+	TraceResult *result = data;
+
+	if (trace->stage == SQDB_TRACE_BEGIN)
+		result->n_begin++;
+	else {
+		result->n_end++;
+		result->last = *trace;
+		assert(trace->time == trace->server_time + trace->parse_time);
+	}
+}
+
+void test_storage_trace(SqStorage *storage)
+{
+	TraceResult   result = {0};
+	SqPtrArray   *array;
+	Company      *company;
+	Company       companies[] = {
+		{0, "Ada",  30, "Paris", 1000},
+		{0, "Bob",  40, "Tokyo", 2000},
+		{0, "Cory", 50, "Rome",  3000},
+	};
+
+	sqdb_set_trace(storage->db, test_storage_trace_func, &result);
+
+	for (int index = 0;  index < 3;  index++)
+		companies[index].id = (int)sq_storage_insert(storage, "companies", NULL, &companies[index]);
+	assert(result.n_begin == 3 && result.n_end == 3);
+	assert(result.last.code == SQCODE_OK);
+
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+	assert(array->length == 3);
+	assert(result.last.sql && strncmp(result.last.sql, "SELECT", 6) == 0);
+	assert(result.last.n_rows == 3);
+	assert(result.last.n_bytes >= strlen("AdaParisBobTokyoCoryRome"));
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+
+	company = sq_storage_get(storage, "companies", NULL, companies[1].id);
+	assert(company && strcmp(company->name, "Bob") == 0);
+	assert(result.last.sql != NULL && result.last.n_rows == 1);
+	company_free(company);
+
+	sqdb_set_trace(storage->db, NULL, NULL);
+	sq_storage_remove_all(storage, "companies", NULL);
+	assert(result.n_begin == result.n_end && result.n_end == 5);
+	fprintf(stderr, "trace: ok.\n\n");
+}
+
+static void test_storage_slow_func(void *data, const SqMetricsSlow *slow)
+{
+	int *n_slow_get = data;
+
+	if (slow->operation == SQ_METRICS_GET) {
+		assert(strcmp(slow->table_name, "companies") == 0);
+		assert(slow->sql != NULL);
+		// only prepared statement has bound values
+		if (slow->params)
+			*n_slow_get += 1;
+	}
+}
+
+void test_storage_metrics(SqStorage *storage)
+{
+	SqMetrics      *metrics;
+	SqMetricsEntry *entries;
+	SqPtrArray     *array;
+	Company        *company;
+	Company         temp = {0, "Dan", 33, "Oslo", 1500};
+	TraceResult     result = {0};
+	int             n_entries;
+	int             n_slow_get = 0;
+	int64_t         id;
+
+	metrics = sq_metrics_new();
+	// every statement is slow if threshold is 1 microsecond
+	sq_metrics_set_slow_log(metrics, 1, test_storage_slow_func, &n_slow_get);
+	sq_storage_set_metrics(storage, metrics);
+	// trace hook that is set by user is still called
+	sqdb_set_trace(storage->db, test_storage_trace_func, &result);
+
+	id = sq_storage_insert(storage, "companies", NULL, &temp);
+	for (int count = 0;  count < 3;  count++) {
+		company = sq_storage_get(storage, "companies", NULL, id);
+		assert(company && company->id == id);
+		company_free(company);
+	}
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+	assert(array->length == 1);
+	company_free(array->data[0]);
+	sq_ptr_array_free(array);
+	array = sq_storage_get_many(storage, "companies", NULL, &id, 1, NULL);
+	assert(array->length == 1);
+	company_free(array->data[0]);
+	sq_ptr_array_free(array);
+	sq_storage_remove(storage, "companies", NULL, id);
+	assert(result.n_end == 7);
+	assert(storage->db->trace == test_storage_trace_func);
+	if (storage->db->info->prepare)
+		assert(n_slow_get == 3);
+
+	entries = sq_metrics_snapshot(metrics, &n_entries);
+	assert(n_entries == 5);
+	for (int index = 0;  index < n_entries;  index++) {
+		assert(strcmp(entries[index].table_name, "companies") == 0);
+		if (entries[index].operation == SQ_METRICS_GET)
+			assert(entries[index].histogram.count == 3);
+		else
+			assert(entries[index].histogram.count == 1);
+		assert(sq_histogram_percentile(&entries[index].histogram, 50) <= entries[index].histogram.max);
+		assert(sq_histogram_percentile(&entries[index].histogram, 99.9) == entries[index].histogram.max ||
+		       entries[index].histogram.count > 1);
+	}
+	sq_metrics_free_snapshot(entries, n_entries);
+
+	sqdb_set_trace(storage->db, NULL, NULL);
+	sq_storage_set_metrics(storage, NULL);
+	sq_metrics_free(metrics);
+	fprintf(stderr, "metrics: ok.\n\n");
+}
+
+void test_storage_histogram(void)
+{
+	SqHistogram histogram;
+
+	sq_histogram_init(&histogram);
+	for (uint64_t value = 1;  value <= 10000;  value++)
+		sq_histogram_record(&histogram, value);
+	// relative error is less than 1/32
+	assert(sq_histogram_percentile(&histogram, 50)   >= 5000 && sq_histogram_percentile(&histogram, 50)   <= 5000 + 5000 / 32);
+	assert(sq_histogram_percentile(&histogram, 99)   >= 9900 && sq_histogram_percentile(&histogram, 99)   <= 9900 + 9900 / 32);
+	assert(sq_histogram_percentile(&histogram, 99.9) >= 9990 && sq_histogram_percentile(&histogram, 99.9) <= 10000);
+	assert(histogram.min == 1 && histogram.max == 10000 && histogram.count == 10000);
+	fprintf(stderr, "histogram: ok.\n\n");
+}
+
 void test_storage(const SqdbInfo *dbinfo, const SqdbConfig *config)
 {
 	Sqdb      *db;
@@ -289,10 +1115,34 @@ void test_storage(const SqdbInfo *dbinfo, const SqdbConfig *config)
 
 	// test get(), insert(), update(), and remove()
 	test_storage_crud(storage);
+	// test prepared statement and statement cache
+	test_storage_prepare(storage);
 	// test query()
 	test_storage_query(storage);
 	// test update_all(), get_all(), and remove_all()
 	test_storage_xxx_all(storage);
+	// test copy_in() and copy_out()
+	test_storage_copy(storage);
+	// test insert_all()
+	test_storage_insert_all(storage);
+	// test upsert() and upsert_all()
+	test_storage_upsert(storage);
+	// test update_many()
+	test_storage_update_many(storage);
+	test_storage_get_many(storage);
+	// test cursor
+	test_storage_cursor(storage);
+	// test identity map
+	test_storage_identity_map(storage);
+	// test row cache that is shared by SqStorage
+	test_storage_row_cache(storage);
+	// test query cache
+	test_storage_query_cache(storage);
+	// test trace hook of Sqdb
+	test_storage_trace(storage);
+	// test latency histograms and slow-query log
+	test_storage_histogram();
+	test_storage_metrics(storage);
 
 	sq_storage_close(storage);
 
@@ -301,6 +1151,554 @@ void test_storage(const SqdbInfo *dbinfo, const SqdbConfig *config)
 	sqdb_free(db);
 }
 
+// ----------------------------------------------------------------------------
+// SqdbPool
+
+#define TEST_POOL_N_THREADS       4
+#define TEST_POOL_N_LOOPS        20
+
+static void *test_pool_thread(void *data)
+{
+	SqdbPool  *pool = data;
+	SqxcValue *xc;
+	Sqdb      *db;
+	int        integer;
+	int        code;
+
+	xc = (SqxcValue*)sqxc_new(SQXC_INFO_VALUE);
+	for (int count = 0;  count < TEST_POOL_N_LOOPS;  count++) {
+		code = sqdb_pool_acquire(pool, &db);
+		assert(code == SQCODE_OK);
+
+		integer = -1;
+		xc->container = NULL;
+		xc->element   = SQ_TYPE_INT;
+		xc->instance  = &integer;
+		code = sqdb_exec(db, "SELECT 1", (Sqxc*)xc, NULL);
+		assert(code == SQCODE_OK);
+		assert(integer == 1);
+
+		sqdb_pool_release(pool, db);
+	}
+	sqxc_free((Sqxc*)xc);
+	return NULL;
+}
+
+void test_pool(const SqdbInfo *dbinfo, const SqdbConfig *config)
+{
+	SqdbPool       *pool;
+	SqdbPoolConfig  pool_config = {0};
+	SqdbPoolStats   stats;
+	SqThread        threads[TEST_POOL_N_THREADS];
+	Sqdb           *db, *db2;
+	int             code;
+
+	// --- threads share 2 connections ---
+	pool_config.min_size = 1;
+	pool_config.max_size = 2;
+	pool_config.timeout  = -1;
+	pool = sqdb_pool_new(dbinfo, config, &pool_config);
+	code = sqdb_pool_open(pool, "test-storage");
+	assert(code == SQCODE_OK);
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_connections == 1);
+	assert(stats.n_idle == 1);
+
+	for (int index = 0;  index < TEST_POOL_N_THREADS;  index++)
+		sq_thread_create(&threads[index], test_pool_thread, pool);
+	for (int index = 0;  index < TEST_POOL_N_THREADS;  index++)
+		sq_thread_join(threads[index]);
+
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_acquired == TEST_POOL_N_THREADS * TEST_POOL_N_LOOPS);
+	assert(stats.n_connections <= 2);
+	assert(stats.n_in_use == 0);
+	assert(stats.n_in_use_peak <= 2);
+	assert(stats.n_timeouts == 0);
+	sqdb_pool_free(pool);
+	fprintf(stderr, "SqdbPool: %d threads - ok.\n", TEST_POOL_N_THREADS);
+
+	// --- timeout ---
+	pool_config.min_size = 0;
+	pool_config.max_size = 1;
+	pool_config.timeout  = 10;
+	pool = sqdb_pool_new(dbinfo, config, &pool_config);
+	sqdb_pool_open(pool, "test-storage");
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_connections == 0);    // lazy connect
+
+	code = sqdb_pool_acquire(pool, &db);
+	assert(code == SQCODE_OK);
+	code = sqdb_pool_acquire(pool, &db2);
+	assert(code == SQCODE_TIMEOUT);
+	assert(db2 == NULL);
+	sqdb_pool_release(pool, db);
+
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_timeouts == 1);
+	assert(stats.n_waited == 1);
+	assert(stats.wait_time >= 10);
+	sqdb_pool_free(pool);
+	fprintf(stderr, "SqdbPool: timeout - ok.\n");
+}
+
+// ----------------------------------------------------------------------------
+// multi-threaded SqStorage
+
+#define TEST_STORAGE_POOL_N_ROWS    8
+
+static void *test_storage_pool_thread(void *data)
+{
+	SqStorage  *storage = data;
+	SqPtrArray *array;
+	Company    *company;
+
+	for (int count = 0;  count < TEST_POOL_N_LOOPS;  count++) {
+		array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+		assert(array != NULL);
+		assert(array->length == TEST_STORAGE_POOL_N_ROWS);
+
+		company = sq_storage_get(storage, "companies", NULL, ((Company*)array->data[count % array->length])->id);
+		assert(company != NULL);
+		assert(strcmp(company->name, "Pool") == 0);
+		company_free(company);
+
+		for (unsigned int index = 0;  index < array->length;  index++)
+			company_free(array->data[index]);
+		sq_ptr_array_free(array);
+	}
+	return NULL;
+}
+
+typedef struct TestAsync    TestAsync;
+
+struct TestAsync
+{
+	SqMutex  mutex;
+	int      n_rows;
+	int      n_done;
+};
+
+static void test_storage_async_callback(SqStorage *storage, void *result, int64_t number, void *user_data)
+{
+	TestAsync  *test = user_data;
+	SqPtrArray *array = result;
+
+	assert(array != NULL);
+	sq_mutex_lock(&test->mutex);
+	test->n_rows += array->length;
+	test->n_done++;
+	sq_mutex_unlock(&test->mutex);
+
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+}
+
+static void test_storage_group_callback(SqStorage *storage, void *result, int64_t number, void *user_data)
+{
+	TestAsync  *test = user_data;
+
+	// callback is called after COMMIT. 'number' is id of inserted row.
+	assert(result == NULL);
+	assert(number != 0);
+	sq_mutex_lock(&test->mutex);
+	test->n_done++;
+	sq_mutex_unlock(&test->mutex);
+}
+
+static void test_storage_remove_callback(SqStorage *storage, void *result, int64_t number, void *user_data)
+{
+	TestAsync  *test = user_data;
+
+	// 'number' is number of rows deleted
+	sq_mutex_lock(&test->mutex);
+	test->n_rows += (int)number;
+	test->n_done++;
+	sq_mutex_unlock(&test->mutex);
+}
+
+void test_storage_pool(const SqdbInfo *dbinfo, const SqdbConfig *config)
+{
+	Company         companies[TEST_STORAGE_POOL_N_ROWS] = {{0}};
+	SqPtrArray     *array;
+	TestAsync       test_async = {0};
+	SqMetrics      *metrics;
+	SqMetricsEntry *entries;
+	int             n_entries;
+	SqdbPool       *pool;
+	SqdbPoolConfig  pool_config = {0};
+	SqdbPoolStats   stats;
+	SqStorage      *storage;
+	SqSchema       *schema;
+	SqThread        threads[TEST_POOL_N_THREADS];
+	Company        *company_ptr;
+	Company         company = {0};
+	int64_t         id;
+	int             code;
+
+	pool_config.max_size = 2;
+	pool_config.timeout  = -1;
+	pool = sqdb_pool_new(dbinfo, config, &pool_config);
+	storage = sq_storage_new_pool(pool);
+
+	code = sq_storage_open(storage, "test-storage");
+	assert(code == SQCODE_OK);
+
+	schema = sq_schema_new(NULL);
+	create_company_table(schema);
+	sq_storage_migrate(storage, schema);
+	sq_storage_migrate(storage, NULL);
+	sq_schema_free(schema);
+
+	sq_storage_remove_all(storage, "companies", NULL);
+
+	// SqMetrics is shared by threads
+	metrics = sq_metrics_new();
+	sq_storage_set_metrics(storage, metrics);
+
+	// transaction pins connection to this thread
+	sq_storage_begin_trans(storage);
+	company.name = "Pool";
+	company.address = "Taipei";
+	for (int index = 0;  index < TEST_STORAGE_POOL_N_ROWS;  index++) {
+		company.age = 20 + index;
+		id = sq_storage_insert(storage, "companies", NULL, &company);
+		assert(id != 0);
+	}
+	// uncommitted row is visible because the same connection is used
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr != NULL);
+	company_free(company_ptr);
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_in_use == 1);
+	code = sq_storage_commit_trans(storage);
+	assert(code == SQCODE_OK);
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_in_use == 0);
+
+	// threads share SqStorage
+	for (int index = 0;  index < TEST_POOL_N_THREADS;  index++)
+		sq_thread_create(&threads[index], test_storage_pool_thread, storage);
+	for (int index = 0;  index < TEST_POOL_N_THREADS;  index++)
+		sq_thread_join(threads[index]);
+
+	sqdb_pool_get_stats(pool, &stats);
+	assert(stats.n_in_use == 0);
+	assert(stats.n_in_use_peak <= 2);
+
+	entries = sq_metrics_snapshot(metrics, &n_entries);
+	for (int index = 0;  index < n_entries;  index++) {
+		if (entries[index].operation == SQ_METRICS_INSERT)
+			assert(entries[index].histogram.count >= TEST_STORAGE_POOL_N_ROWS);
+	}
+	assert(n_entries > 0);
+	sq_metrics_free_snapshot(entries, n_entries);
+
+	// asynchronous functions
+	sq_mutex_init(&test_async.mutex);
+	for (int index = 0;  index < TEST_POOL_N_LOOPS;  index++) {
+		sq_storage_get_all_async(storage, "companies", NULL, NULL, "WHERE age >= 24",
+		                         test_storage_async_callback, &test_async);
+	}
+	// wait for all tasks
+	sq_storage_stop_workers(storage);
+	assert(test_async.n_done == TEST_POOL_N_LOOPS);
+	assert(test_async.n_rows == TEST_POOL_N_LOOPS * 4);
+	fprintf(stderr, "SqStorage: async - ok.\n");
+
+	// group commit: deadline is long, so sq_storage_flush() commits these writes
+	test_async.n_done = 0;
+	sq_storage_set_group_commit(storage, TEST_STORAGE_POOL_N_ROWS * 2, 60 * 1000);
+	for (int index = 0;  index < TEST_STORAGE_POOL_N_ROWS;  index++) {
+		companies[index].name = "Group";
+		companies[index].address = "Tainan";
+		companies[index].age = 60 + index;
+		sq_storage_insert_async(storage, "companies", NULL, &companies[index],
+		                        test_storage_group_callback, &test_async);
+	}
+	sq_storage_flush(storage);
+	assert(test_async.n_done == TEST_STORAGE_POOL_N_ROWS);
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, "WHERE age >= 60");
+	assert(array != NULL);
+	assert(array->length == TEST_STORAGE_POOL_N_ROWS);
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+
+	// group commit: failed task doesn't affect other tasks in the same group
+	test_async.n_done = 0;
+	test_async.n_rows = 0;
+	sq_storage_remove_all_async(storage, "no_such_table", NULL,
+	                            test_storage_remove_callback, &test_async);
+	sq_storage_remove_all_async(storage, "companies", "WHERE age >= 60",
+	                            test_storage_remove_callback, &test_async);
+	sq_storage_flush(storage);
+	assert(test_async.n_done == 2);
+	// callback gets number of rows deleted
+	assert(test_async.n_rows == TEST_STORAGE_POOL_N_ROWS);
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, "WHERE age >= 60");
+	assert(array == NULL);
+	sq_storage_set_group_commit(storage, 0, 0);
+	sq_storage_stop_workers(storage);
+	sq_mutex_final(&test_async.mutex);
+	fprintf(stderr, "SqStorage: group commit - ok.\n");
+
+	sq_storage_remove_all(storage, "companies", NULL);
+	sq_storage_close(storage);
+	sq_storage_free(storage);
+	sq_metrics_free(metrics);
+	sqdb_pool_free(pool);
+	fprintf(stderr, "SqStorage + SqdbPool: %d threads - ok.\n", TEST_POOL_N_THREADS);
+}
+
+#if SQ_CONFIG_HAVE_SQLITE && USE_SQLITE_IF_POSSIBLE
+// SQLite WAL mode: one writer connection and read-only connections
+static void *test_storage_wal_thread(void *data)
+{
+	SqStorage  *storage = data;
+	SqPtrArray *array;
+
+	// reader doesn't see uncommitted rows and it isn't blocked by writer
+	// sq_storage_get_all() returns NULL if no row
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+	assert(array == NULL);
+	return NULL;
+}
+
+void test_storage_wal(void)
+{
+	SqdbConfigSqlite  writer_config = {
+		.folder = ".",
+		.extension = "db",
+		.journal_mode = "WAL",
+		.synchronous  = "NORMAL",
+		.busy_timeout = 5000,
+	};
+	SqdbConfigSqlite  reader_config = {
+		.bit_field = SQDB_CONFIG_READ_ONLY,
+		.folder = ".",
+		.extension = "db",
+		.busy_timeout = 5000,
+		.cache_size = -4000,
+		.mmap_size = 64 * 1024 * 1024,
+	};
+	SqdbPoolConfig  pool_config = {0};
+	SqdbPoolStats   stats;
+	SqdbPool       *writer;
+	SqdbPool       *readers;
+	SqStorage      *storage;
+	SqSchema       *schema;
+	SqThread        threads[TEST_POOL_N_THREADS];
+	Company         company = {0};
+	Company        *company_ptr;
+	int64_t         id;
+	int             code;
+
+	pool_config.timeout  = -1;
+	pool_config.max_size = 1;
+	writer  = sqdb_pool_new(SQDB_INFO_SQLITE, (SqdbConfig*)&writer_config, &pool_config);
+	pool_config.max_size = TEST_POOL_N_THREADS;
+	readers = sqdb_pool_new(SQDB_INFO_SQLITE, (SqdbConfig*)&reader_config, &pool_config);
+	storage = sq_storage_new_pool(writer);
+	sq_storage_set_pool_read(storage, readers);
+
+	code = sq_storage_open(storage, "test-storage");
+	assert(code == SQCODE_OK);
+
+	schema = sq_schema_new(NULL);
+	create_company_table(schema);
+	sq_storage_migrate(storage, schema);
+	sq_storage_migrate(storage, NULL);
+	sq_schema_free(schema);
+	sq_storage_remove_all(storage, "companies", NULL);
+
+	sq_storage_begin_trans(storage);
+	company.name = "Pool";
+	company.address = "Taipei";
+	for (int index = 0;  index < TEST_STORAGE_POOL_N_ROWS;  index++) {
+		company.age = 20 + index;
+		id = sq_storage_insert(storage, "companies", NULL, &company);
+		assert(id != 0);
+	}
+	// read in transaction uses writer connection
+	company_ptr = sq_storage_get(storage, "companies", NULL, id);
+	assert(company_ptr != NULL);
+	company_free(company_ptr);
+	sq_thread_create(&threads[0], test_storage_wal_thread, storage);
+	sq_thread_join(threads[0]);
+	code = sq_storage_commit_trans(storage);
+	assert(code == SQCODE_OK);
+
+	// readers run concurrently
+	for (int index = 0;  index < TEST_POOL_N_THREADS;  index++)
+		sq_thread_create(&threads[index], test_storage_pool_thread, storage);
+	for (int index = 0;  index < TEST_POOL_N_THREADS;  index++)
+		sq_thread_join(threads[index]);
+
+	sqdb_pool_get_stats(writer, &stats);
+	assert(stats.n_in_use_peak == 1);
+	sqdb_pool_get_stats(readers, &stats);
+	assert(stats.n_in_use == 0);
+	assert(stats.n_acquired == 1 + TEST_POOL_N_THREADS * TEST_POOL_N_LOOPS * 2);
+
+	sq_storage_remove_all(storage, "companies", NULL);
+	sq_storage_close(storage);
+	sq_storage_free(storage);
+	sqdb_pool_free(readers);
+	sqdb_pool_free(writer);
+	fprintf(stderr, "SqStorage + SQLite WAL: 1 writer, %d readers - ok.\n", TEST_POOL_N_THREADS);
+}
+#endif  // SQ_CONFIG_HAVE_SQLITE && USE_SQLITE_IF_POSSIBLE
+
+// ----------------------------------------------------------------------------
+// SqdbReplay
+
+static int64_t test_storage_replay_run(SqStorage *storage, int64_t *id)
+{
+	SqSchema   *schema;
+	SqPtrArray *array;
+	Company    *company;
+	Company     temp = {0, "Replay", 40, "Seoul", 2000};
+	int64_t     sum = 0;
+
+	schema = sq_schema_new(NULL);
+	create_company_table(schema);
+	sq_storage_migrate(storage, schema);
+	sq_storage_migrate(storage, NULL);
+	sq_schema_free(schema);
+
+	*id = sq_storage_insert(storage, "companies", NULL, &temp);
+	company = sq_storage_get(storage, "companies", NULL, *id);
+	assert(company && strcmp(company->name, "Replay") == 0);
+	company_free(company);
+
+	array = sq_storage_get_all(storage, "companies", NULL, NULL, NULL);
+	assert(array != NULL);
+	for (unsigned int index = 0;  index < array->length;  index++) {
+		sum += ((Company*)array->data[index])->age;
+		company_free(array->data[index]);
+	}
+	sq_ptr_array_free(array);
+
+	// the same SQL is replayed in recorded order
+	sq_storage_remove(storage, "companies", NULL, *id);
+	company = sq_storage_get(storage, "companies", NULL, *id);
+	assert(company == NULL);
+	return sum;
+}
+
+void test_storage_replay(const SqdbInfo *dbinfo, const SqdbConfig *config)
+{
+	SqdbConfigReplay  replay_config = {
+		.mode = SQDB_REPLAY_RECORD,
+		.path = "test-storage.replay",
+	};
+	Sqdb      *db;
+	SqStorage *storage;
+	int64_t    sum, id, id_replayed;
+	int        code;
+
+	// record result sets of real database
+	replay_config.db = sqdb_new(dbinfo, config);
+	db = sqdb_new(SQDB_INFO_REPLAY, (SqdbConfig*)&replay_config);
+	storage = sq_storage_new(db);
+	code = sq_storage_open(storage, "test-storage");
+	assert(code == SQCODE_OK);
+	sum = test_storage_replay_run(storage, &id);
+	sq_storage_close(storage);
+	sq_storage_free(storage);
+	sqdb_free(db);
+	sqdb_free(replay_config.db);
+
+	// replay them without database
+	replay_config.mode = SQDB_REPLAY_PLAY;
+	replay_config.db = NULL;
+	db = sqdb_new(SQDB_INFO_REPLAY, (SqdbConfig*)&replay_config);
+	storage = sq_storage_new(db);
+	code = sq_storage_open(storage, "test-storage");
+	assert(code == SQCODE_OK);
+	assert(test_storage_replay_run(storage, &id_replayed) == sum);
+	assert(id_replayed == id);
+	// SQL statement that was not recorded
+	assert(sq_storage_get(storage, "companies", NULL, id + 1) == NULL);
+	sq_storage_close(storage);
+	sq_storage_free(storage);
+	sqdb_free(db);
+	fprintf(stderr, "SqdbReplay: ok.\n");
+}
+
+// ----------------------------------------------------------------------------
+// SqdbMemory
+
+void test_storage_memory(void)
+{
+	SqdbConfigMemory  config = {
+		.capacity = 2,
+	};
+	Company     companies[4] = {
+		{0, "Ada",  30, "Paris", 1000},
+		{0, "Bob",  40, NULL,    2000},
+		{0, "Cory", 50, "Rome",  3000},
+		{9, "Dan",  20, "Oslo",  4000},
+	};
+	Sqdb       *db;
+	SqStorage  *storage;
+	SqSchema   *schema;
+	SqPtrArray *array;
+	int        *count;
+	int64_t     id;
+
+	// SqdbMemory passes the same tests as other Sqdb
+	test_storage(SQDB_INFO_MEMORY, NULL);
+
+	db = sqdb_new(SQDB_INFO_MEMORY, (SqdbConfig*)&config);
+	storage = sq_storage_new(db);
+	sq_storage_open(storage, "test-storage");
+	schema = sq_schema_new(NULL);
+	create_company_table(schema);
+	sq_storage_migrate(storage, schema);
+	sq_storage_migrate(storage, NULL);
+	sq_schema_free(schema);
+
+	// the number of rows is more than capacity
+	for (int index = 0;  index < 4;  index++)
+		id = sq_storage_insert(storage, "companies", NULL, &companies[index]);
+	assert(id == 9);
+	// primary key must be unique
+	assert(sq_storage_insert(storage, "companies", NULL, &companies[3]) == 0);
+	// generated id is larger than the largest id
+	assert(sq_storage_insert(storage, "companies", NULL, &companies[0]) == 10);
+
+	// WHERE, ORDER BY, LIMIT, and OFFSET
+	array = sq_storage_get_all(storage, "companies", NULL, NULL,
+	                           "WHERE (age >= 30 AND address IS NOT NULL AND id < 10) OR name LIKE 'd%' "
+	                           "ORDER BY age DESC LIMIT 2 OFFSET 1");
+	assert(array != NULL && array->length == 2);
+	assert(strcmp(((Company*)array->data[0])->name, "Ada") == 0);
+	assert(((Company*)array->data[1])->id == 9);
+	for (unsigned int index = 0;  index < array->length;  index++)
+		company_free(array->data[index]);
+	sq_ptr_array_free(array);
+
+	// aggregate function
+	count = sq_storage_query_raw(storage, "SELECT COUNT(*) FROM companies "
+	                             "WHERE age BETWEEN 25 AND 45 AND id NOT IN (1, 10)", SQ_TYPE_INT, NULL);
+	assert(count != NULL && *count == 1);
+	free(count);
+
+	// remove rows by condition
+	sq_storage_remove_all(storage, "companies", "WHERE salary > 1500");
+	count = sq_storage_query_raw(storage, "SELECT SUM(age) FROM companies", SQ_TYPE_INT, NULL);
+	assert(count != NULL && *count == 60);
+	free(count);
+
+	sq_storage_close(storage);
+	sq_storage_free(storage);
+	sqdb_free(db);
+	fprintf(stderr, "SqdbMemory: ok.\n");
+}
+
 // ----------------------------------------------------------------------------
 
 #if   SQ_CONFIG_HAVE_SQLITE && USE_SQLITE_IF_POSSIBLE
@@ -356,5 +1754,12 @@ int  main(int argc, char *argv[])
 #endif
 
 	test_storage(db_info, db_config);
+	test_pool(db_info, db_config);
+	test_storage_pool(db_info, db_config);
+#if SQ_CONFIG_HAVE_SQLITE && USE_SQLITE_IF_POSSIBLE
+	test_storage_wal();
+#endif
+	test_storage_replay(db_info, db_config);
+	test_storage_memory();
 	return EXIT_SUCCESS;
 }